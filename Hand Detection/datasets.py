@@ -8,9 +8,11 @@
 #                                                                            #
 ##############################################################################
 
-import os, json
+import os, io, json, sys
+from concurrent.futures import ThreadPoolExecutor
 import numpy as np
 import torch
+import torch.nn.functional as F
 from torch.utils.data import Dataset
 from torchvision import transforms
 from PIL import Image
@@ -18,6 +20,120 @@ from funcs import array_to_heatmaps, project_points
 
 from variables import ORG_IMG_SIZE, CVT_IMG_SIZE, DATASET_MEAN, DATASET_STD
 
+# The native reader, if it has been built in native/.
+sys.path.append(os.path.join(os.path.dirname(os.path.abspath(__file__)), "native"))
+try:
+    import handy_reader
+except ImportError:
+    handy_reader = None
+
+# Layout of the .idx files written next to each tar shard by HandyVariations.
+SHARD_INDEX_DTYPE = np.dtype([
+    ("frame_id", "<u4"),
+    ("image_size", "<u4"),
+    ("image_offset", "<u8"),
+    ("annotation_offset", "<u8"),
+    ("annotation_size", "<u4"),
+    ("reserved", "<u4"),
+])
+
+def load_shard_index(shards_path):
+
+    '''
+    Load the indices of the tar shards of a dataset.
+
+    Params:
+        shards_path: The directory of the shards.
+
+    Returns:
+        A list of (frame_id, shard, image_offset, image_size) sorted by frame
+        id, or None if the dataset has no shards.
+    '''
+
+    if not os.path.isdir(shards_path):
+        return None
+
+    entries = []
+    for idx_name in sorted(f for f in os.listdir(shards_path) if f.endswith(".idx")):
+        shard_fn = os.path.join(shards_path, idx_name[:-4] + ".tar")
+        index = np.fromfile(os.path.join(shards_path, idx_name), dtype=SHARD_INDEX_DTYPE)
+        for entry in index:
+            entries.append((int(entry["frame_id"]), shard_fn, int(entry["image_offset"]), int(entry["image_size"])))
+
+    entries.sort()
+    return entries
+
+def load_tensor_shards(tensors_path):
+
+    '''
+    Map the raw tensor shards of a dataset. Each shard is a .npy array of
+    shape (N, H, W, 3) or (N, 3, H, W) with a .ids file holding the frame id
+    of each of its samples.
+
+    Params:
+        tensors_path: The directory of the shards.
+
+    Returns:
+        A list of (frame_id, shard, row) sorted by frame id, or None if the
+        dataset has no tensor shards.
+    '''
+
+    if not os.path.isdir(tensors_path):
+        return None
+
+    entries = []
+    for shard_name in sorted(f for f in os.listdir(tensors_path) if f.endswith(".npy")):
+        shard = np.load(os.path.join(tensors_path, shard_name), mmap_mode="r")
+        ids = np.fromfile(os.path.join(tensors_path, shard_name[:-4] + ".ids"), dtype="<u4")
+        for row, frame_id in enumerate(ids):
+            entries.append((int(frame_id), shard, row))
+
+    entries.sort(key=lambda entry: entry[0])
+    return entries
+
+def load_annotations(data_dir, name):
+
+    '''
+    Load an annotations array. The .npy arrays written by HandyVariations are
+    memory-mapped, so nothing is read until a sample is used. Otherwise, the
+    json file is parsed.
+
+    Params:
+        data_dir: The directory of the dataset.
+        name: The name of the file, without extension.
+
+    Returns:
+        The annotations array.
+    '''
+
+    npy_fn = os.path.join(data_dir, name + ".npy")
+    if os.path.exists(npy_fn):
+        return np.load(npy_fn, mmap_mode="r")
+
+    with open(os.path.join(data_dir, name + ".json"), "r") as f:
+        return np.array(json.load(f))
+
+def dataset_range(num_samples, dataset_type):
+
+    '''
+    Get the samples of a split of the dataset.
+
+    Params:
+        num_samples: The amount of samples in the dataset.
+        dataset_type: "train", "val" or "test".
+
+    Returns:
+        The first sample and the one after the last.
+    '''
+
+    if dataset_type == "train":
+        return 0, 26000
+
+    elif dataset_type == "val":
+        return 26000, 31000
+
+    return num_samples - 1560, num_samples
+
 class FreiHand(Dataset):
 
     '''
@@ -35,32 +151,29 @@ class FreiHand(Dataset):
 
         self.device = config["device"]
         self.dataset_path = os.path.join(config["data_dir"], "training/rgb")
-        self.dataset_names = np.sort(os.listdir(self.dataset_path))
-
-        mat = os.path.join(config["data_dir"], "training_K.json")
-        with open(mat, "r") as f:
-            self.matrix = np.array(json.load(f))
-
-        annotation_fn = os.path.join(config["data_dir"], "training_xyz.json")
-        with open(annotation_fn, "r") as f:
-            self.annotation = np.array(json.load(f))
-
-        if dataset_type == "train":
-            ind_start = 0
-            ind_end = 26000
-
-        elif dataset_type == "val":
-            ind_start = 26000
-            ind_end = 31000
+        self.shards = load_shard_index(os.path.join(config["data_dir"], "training/shards"))
+        self.tensors = load_tensor_shards(os.path.join(config["data_dir"], "training/tensors"))
+        self.heatmaps = load_tensor_shards(os.path.join(config["data_dir"], "training/heatmaps"))
 
+        if self.tensors is not None:
+            self.dataset_names = np.array(["%08i.jpg" % entry[0] for entry in self.tensors])
+        elif self.shards is not None:
+            self.dataset_names = np.array(["%08i.jpg" % entry[0] for entry in self.shards])
         else:
-            ind_start = len(self.annotation) - 1560
-            ind_end = len(self.annotation)
+            self.dataset_names = np.sort(os.listdir(self.dataset_path))
+
+        self.matrix = load_annotations(config["data_dir"], "training_K")
+        self.annotation = load_annotations(config["data_dir"], "training_xyz")
 
-            #ind_start = 0
-            #ind_end = 1560
+        ind_start, ind_end = dataset_range(len(self.annotation), dataset_type)
 
         self.dataset_names = self.dataset_names[ind_start:ind_end]
+        if self.shards is not None:
+            self.shards = self.shards[ind_start:ind_end]
+        if self.tensors is not None:
+            self.tensors = self.tensors[ind_start:ind_end]
+        if self.heatmaps is not None:
+            self.heatmaps = self.heatmaps[ind_start:ind_end]
         self.matrix = self.matrix[ind_start:ind_end]
         self.annotation = self.annotation[ind_start:ind_end]
 
@@ -87,14 +200,32 @@ class FreiHand(Dataset):
         
         # Get the parameters.
         img_name = self.dataset_names[idx]
-        img_raw = Image.open(os.path.join(self.dataset_path, img_name))
+        if self.tensors is not None:
+            _, shard, row = self.tensors[idx]
+            pixels = np.asarray(shard[row])
+            if pixels.shape[0] == 3:
+                pixels = pixels.transpose(1, 2, 0)
+            img_raw = Image.fromarray(pixels)
+        elif self.shards is not None:
+            _, shard_fn, offset, size = self.shards[idx]
+            with open(shard_fn, "rb") as f:
+                f.seek(offset)
+                img_raw = Image.open(io.BytesIO(f.read(size)))
+        else:
+            img_raw = Image.open(os.path.join(self.dataset_path, img_name))
         image = self.img_transform(img_raw)
         img_raw = self.img_raw_transform(img_raw)
         
         # Transform the data.
         keypoints = project_points(self.annotation[idx], self.matrix[idx])
         keypoints = keypoints / ORG_IMG_SIZE
-        heatmaps = array_to_heatmaps(keypoints)
+        if self.heatmaps is not None:
+            _, shard, row = self.heatmaps[idx]
+            heatmaps = np.asarray(shard[row], dtype=np.float32)
+            if shard.dtype == np.uint8:
+                heatmaps = heatmaps / 255
+        else:
+            heatmaps = array_to_heatmaps(keypoints)
         keypoints = torch.from_numpy(keypoints)
         heatmaps = torch.from_numpy(np.float32(heatmaps))
 
@@ -105,3 +236,146 @@ class FreiHand(Dataset):
             "image_name": img_name,
             "image_raw": img_raw,
         }
+
+class NativeLoader:
+
+    '''
+    Loads batches of a dataset written by HandyVariations with the native
+    reader, in place of a DataLoader over FreiHand. The JPEGs are decoded in
+    C++ threads without the GIL while the previous batch is being used, and
+    the batches come as tensors over the buffers of the reader, without
+    copies. Build it first with `python setup.py build_ext --inplace` in
+    native/.
+    '''
+
+    def __init__(self, config, dataset_type="train", shuffle=True, num_threads=4):
+
+        '''
+        Create a new instance.
+        '''
+
+        if handy_reader is None:
+            raise ImportError("The native reader has not been built, see native/setup.py.")
+
+        self.reader = handy_reader.DatasetReader(
+            config["data_dir"], CVT_IMG_SIZE, ORG_IMG_SIZE, DATASET_MEAN, DATASET_STD, num_threads
+        )
+        self.batch_size = config["batch_size"]
+        self.shuffle = shuffle
+
+        ind_start, ind_end = dataset_range(len(self.reader), dataset_type)
+        self.indices = np.arange(ind_start, min(ind_end, len(self.reader)))
+
+    def __len__(self):
+
+        '''
+        Get the amount of batches, leaving the last one out if incomplete.
+        '''
+
+        return len(self.indices) // self.batch_size
+
+    def _read(self, indices):
+
+        '''
+        Read a batch and wrap its buffers in tensors.
+        '''
+
+        batch = self.reader.read(indices.tolist())
+        return {name: torch.from_numpy(values) for name, values in batch.items()}
+
+    def __iter__(self):
+
+        '''
+        Iterate over the batches of an epoch, reading the next one while the
+        current one is being used.
+        '''
+
+        order = np.random.permutation(self.indices) if self.shuffle else self.indices
+        batches = [order[i * self.batch_size:(i + 1) * self.batch_size] for i in range(len(self))]
+
+        with ThreadPoolExecutor(max_workers=1) as executor:
+            pending = executor.submit(self._read, batches[0]) if batches else None
+            for i in range(len(batches)):
+                batch = pending.result()
+                if i + 1 < len(batches):
+                    pending = executor.submit(self._read, batches[i + 1])
+                yield batch
+
+class StreamLoader:
+
+    '''
+    Loads batches straight from a HandyVariations run that streams its
+    samples through shared memory (output format "Shared-memory stream", or
+    --stream <name>), without anything going to disk. The batches come as
+    fast as the generator renders them, and the generator waits whenever the
+    trainer falls behind. Several loaders can share a stream, and each
+    sample goes to only one of them. Iterating ends when the generator does.
+    '''
+
+    def __init__(self, config, name="/handy_variations", timeout=60.0):
+
+        '''
+        Create a new instance, waiting up to timeout seconds for the
+        generator to open the stream.
+        '''
+
+        if handy_reader is None:
+            raise ImportError("The native reader has not been built, see native/setup.py.")
+
+        self.reader = handy_reader.StreamReader(name, timeout)
+        self.batch_size = config["batch_size"]
+        self.mean = torch.tensor(DATASET_MEAN, dtype=torch.float32).view(1, 3, 1, 1)
+        self.std = torch.tensor(DATASET_STD, dtype=torch.float32).view(1, 3, 1, 1)
+
+    def _read(self):
+
+        '''
+        Take a batch from the stream and convert it like FreiHand does.
+        '''
+
+        batch = self.reader.read(self.batch_size)
+        if len(batch["frame_id"]) == 0:
+            return None
+
+        # Resize and normalise the images.
+        img_raw = torch.from_numpy(batch["image"]).permute(0, 3, 1, 2).float() / 255
+        image = F.interpolate(img_raw, size=(CVT_IMG_SIZE, CVT_IMG_SIZE), mode="bilinear", align_corners=False, antialias=True)
+        image = (image - self.mean) / self.std
+
+        # The keypoints come in pixels of the images.
+        size = np.array([self.reader.width, self.reader.height], dtype=np.float32)
+        keypoints = batch["keypoints"][:, :, :2] / size
+        if batch["heatmaps"] is not None:
+            heatmaps = np.asarray(batch["heatmaps"], dtype=np.float32)
+            if batch["heatmaps"].dtype == np.uint8:
+                heatmaps = heatmaps / 255
+        else:
+            heatmaps = np.stack([array_to_heatmaps(points) for points in keypoints])
+
+        return {
+            "image": image,
+            "keypoints": torch.from_numpy(keypoints),
+            "heatmaps": torch.from_numpy(np.float32(heatmaps)),
+            "frame_id": torch.from_numpy(batch["frame_id"]),
+            "image_raw": img_raw,
+        }
+
+    def __iter__(self):
+
+        '''
+        Iterate over the batches until the generator finishes, taking the
+        next one while the current one is being used. The last batch may be
+        incomplete.
+        '''
+
+        with ThreadPoolExecutor(max_workers=1) as executor:
+            pending = executor.submit(self._read)
+            while True:
+                batch = pending.result()
+                if batch is None:
+                    if self.reader.finished:
+                        return
+                    pending = executor.submit(self._read)
+                    continue
+                pending = executor.submit(self._read)
+                yield batch
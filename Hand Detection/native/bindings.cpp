@@ -0,0 +1,158 @@
+/**
+ * @file bindings.cpp
+ * @brief Python bindings of the native dataset and stream readers.
+ * @version 1.0.0 (2024-03-24)
+ * @date 2024-03-24
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as
+ * complementary materials to the dissertation submitted as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include "dataset_reader.h"
+#include "stream_reader.h"
+
+namespace py = pybind11;
+
+namespace {
+
+    /**
+     * @brief Hand a batch to Python.
+     *
+     * Wrap the buffers of a batch in NumPy arrays without copying them. The
+     * arrays share a capsule that frees the batch once none of them is used.
+     *
+     * @param batch The batch.
+     * @param reader The reader of the batch.
+     *
+     * @returns A dict with the images, keypoints, heatmaps and frame ids.
+     */
+    py::dict wrapBatch(std::unique_ptr<bgq_native::Batch> batch, const bgq_native::DatasetReader &reader) {
+
+        bgq_native::Batch* owned = batch.release();
+        py::capsule owner(owned, [](void* pointer) {
+            delete (bgq_native::Batch*) pointer;
+        });
+
+        py::ssize_t size = owned->size;
+        py::ssize_t keypoints = reader.getNumOfKeypoints();
+        py::ssize_t image_size = reader.getImageSize();
+        py::ssize_t heatmap_size = reader.getHeatmapSize();
+
+        py::dict result;
+        result["image"] = py::array_t<float>({size, (py::ssize_t) 3, image_size, image_size}, owned->images.data(), owner);
+        result["keypoints"] = py::array_t<float>({size, keypoints, (py::ssize_t) 2}, owned->keypoints.data(), owner);
+        result["heatmaps"] = py::array_t<float>({size, keypoints, heatmap_size, heatmap_size}, owned->heatmaps.data(), owner);
+        result["frame_id"] = py::array_t<int32_t>({size}, owned->frame_ids.data(), owner);
+
+        return result;
+
+    }
+
+    /**
+     * @brief Hand the samples of a stream to Python.
+     *
+     * Wrap the buffers of a batch taken from a stream in NumPy arrays without
+     * copying them, like wrapBatch does.
+     *
+     * @param batch The batch.
+     * @param reader The reader of the batch.
+     *
+     * @returns A dict with the images, keypoints, heatmaps and frame ids.
+     */
+    py::dict wrapStreamBatch(std::unique_ptr<bgq_native::StreamBatch> batch, const bgq_native::StreamReader &reader) {
+
+        bgq_native::StreamBatch* owned = batch.release();
+        py::capsule owner(owned, [](void* pointer) {
+            delete (bgq_native::StreamBatch*) pointer;
+        });
+
+        py::ssize_t size = owned->size;
+        py::ssize_t keypoints = reader.getNumOfKeypoints();
+        py::ssize_t heatmap_size = reader.getHeatmapSize();
+
+        py::dict result;
+        result["image"] = py::array_t<uint8_t>({size, (py::ssize_t) reader.getHeight(), (py::ssize_t) reader.getWidth(), (py::ssize_t) 3}, owned->images.data(), owner);
+        result["keypoints"] = py::array_t<float>({size, keypoints, (py::ssize_t) 3}, owned->keypoints.data(), owner);
+        result["frame_id"] = py::array_t<int32_t>({size}, owned->frame_ids.data(), owner);
+
+        // The heatmaps keep the type they were rendered with.
+        if (heatmap_size > 0) {
+            py::dtype type = (reader.getHeatmapType() == 0) ? py::dtype("uint8") : py::dtype("float16");
+            result["heatmaps"] = py::array(type, {size, keypoints, heatmap_size, heatmap_size}, owned->heatmaps.data(), owner);
+        } else {
+            result["heatmaps"] = py::none();
+        }
+
+        return result;
+
+    }
+
+}  // namespace
+
+PYBIND11_MODULE(handy_reader, module) {
+
+    module.doc() = "Native reader of the datasets written by HandyVariations.";
+
+    py::class_<bgq_native::DatasetReader>(module, "DatasetReader")
+        .def(py::init<const std::string&, int, int, const std::vector<float>&, const std::vector<float>&, int>(),
+             py::arg("data_dir"), py::arg("image_size"), py::arg("original_size"),
+             py::arg("mean"), py::arg("std"), py::arg("num_threads") = 4)
+        .def("read", [](bgq_native::DatasetReader &reader, const std::vector<int> &indices) {
+
+            // Decode without the GIL, so Python can train in the meantime.
+            std::unique_ptr<bgq_native::Batch> batch;
+            {
+                py::gil_scoped_release release;
+                batch = reader.read(indices);
+            }
+
+            return wrapBatch(std::move(batch), reader);
+
+        }, py::arg("indices"))
+        .def("__len__", &bgq_native::DatasetReader::getNumOfSamples)
+        .def_property_readonly("num_of_keypoints", &bgq_native::DatasetReader::getNumOfKeypoints)
+        .def_property_readonly("image_size", &bgq_native::DatasetReader::getImageSize)
+        .def_property_readonly("heatmap_size", &bgq_native::DatasetReader::getHeatmapSize);
+
+    py::class_<bgq_native::StreamReader>(module, "StreamReader")
+        .def(py::init([](const std::string &name, double timeout) {
+
+            // Wait for the generator without the GIL.
+            py::gil_scoped_release release;
+            return new bgq_native::StreamReader(name, timeout);
+
+        }), py::arg("name") = "/handy_variations", py::arg("timeout") = 60.0)
+        .def("read", [](bgq_native::StreamReader &reader, int batch_size, double timeout) {
+
+            // Wait for the samples without the GIL, so Python can train in
+            // the meantime.
+            std::unique_ptr<bgq_native::StreamBatch> batch;
+            {
+                py::gil_scoped_release release;
+                batch = reader.read(batch_size, timeout);
+            }
+
+            return wrapStreamBatch(std::move(batch), reader);
+
+        }, py::arg("batch_size"), py::arg("timeout") = 1.0)
+        .def_property_readonly("finished", &bgq_native::StreamReader::isFinished)
+        .def_property_readonly("width", &bgq_native::StreamReader::getWidth)
+        .def_property_readonly("height", &bgq_native::StreamReader::getHeight)
+        .def_property_readonly("num_of_keypoints", &bgq_native::StreamReader::getNumOfKeypoints)
+        .def_property_readonly("heatmap_size", &bgq_native::StreamReader::getHeatmapSize);
+
+}
@@ -0,0 +1,779 @@
+/**
+ * @file dataset_reader.cpp
+ * @brief DatasetReader class implementation file.
+ * @version 1.0.0 (2024-03-24)
+ * @date 2024-03-24
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as
+ * complementary materials to the dissertation submitted as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#include "dataset_reader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <csetjmp>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <jpeglib.h>
+
+// The heatmaps of the trainer, as in funcs.py.
+#define HEATMAP_SIGMA 3.0f
+#define HEATMAP_RADIUS 25
+
+namespace bgq_native {
+
+    namespace {
+
+        /// The layout of the .idx files written next to each tar shard.
+        struct ShardIndexEntry {
+            uint32_t frame_id;
+            uint32_t image_size;
+            uint64_t image_offset;
+            uint64_t annotation_offset;
+            uint32_t annotation_size;
+            uint32_t reserved;
+        };
+
+        /// The error manager of libjpeg, which jumps back instead of exiting.
+        struct JPEGError {
+            jpeg_error_mgr manager;
+            jmp_buf jump;
+            char message[JMSG_LENGTH_MAX];
+        };
+
+        void exitJPEG(j_common_ptr info) {
+
+            JPEGError* error = (JPEGError*) info->err;
+            (*info->err->format_message)(info, error->message);
+            longjmp(error->jump, 1);
+
+        }
+
+        float halfToFloat(uint16_t half) {
+
+            uint32_t sign = (uint32_t) (half & 0x8000) << 16;
+            uint32_t exponent = (half >> 10) & 0x1f;
+            uint32_t mantissa = half & 0x3ff;
+            uint32_t bits;
+
+            if (exponent == 0x1f) {
+
+                bits = sign | 0x7f800000 | (mantissa << 13);
+
+            } else if (exponent != 0) {
+
+                bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+
+            } else {
+
+                // Subnormal halves are normal floats.
+                float value = std::ldexp((float) mantissa, -24);
+                memcpy(&bits, &value, sizeof(bits));
+                bits |= sign;
+
+            }
+
+            float value;
+            memcpy(&value, &bits, sizeof(value));
+            return value;
+
+        }
+
+        std::vector<std::string> listFiles(const std::string &directory, const std::string &extension) {
+
+            std::vector<std::string> filenames;
+            if (!std::filesystem::is_directory(directory))
+                return filenames;
+
+            for (const auto &entry : std::filesystem::directory_iterator(directory)) {
+                std::string filename = entry.path().filename().string();
+                if (extension.empty() || entry.path().extension() == extension)
+                    filenames.push_back(filename);
+            }
+
+            std::sort(filenames.begin(), filenames.end());
+            return filenames;
+
+        }
+
+        std::vector<uint32_t> readIds(const std::string &filename) {
+
+            std::ifstream file(filename, std::ios::binary | std::ios::ate);
+            if (!file)
+                throw std::runtime_error("Could not read " + filename);
+
+            std::vector<uint32_t> ids((size_t) file.tellg() / sizeof(uint32_t));
+            file.seekg(0);
+            file.read((char*) ids.data(), ids.size() * sizeof(uint32_t));
+            return ids;
+
+        }
+
+        /// The input pixels each output pixel is made of along an axis.
+        struct Taps {
+            std::vector<int> first;
+            std::vector<int> count;
+            std::vector<float> weights;
+            int max_count = 0;
+        };
+
+        // Find the taps of an antialiased bilinear filter, like the one PIL
+        // resizes the images with in the trainer.
+        Taps findTaps(int input_size, int output_size) {
+
+            double scale = (double) input_size / output_size;
+            double filter_scale = std::max(scale, 1.0);
+            double support = filter_scale;
+
+            Taps taps;
+            taps.max_count = (int) std::ceil(support) * 2 + 1;
+            taps.first.resize(output_size);
+            taps.count.resize(output_size);
+            taps.weights.assign((size_t) output_size * taps.max_count, 0.0f);
+
+            for (int i = 0; i < output_size; i++) {
+
+                double center = (i + 0.5) * scale;
+                int first = std::max((int) (center - support + 0.5), 0);
+                int last = std::min((int) (center + support + 0.5), input_size);
+                int count = std::min(last - first, taps.max_count);
+
+                double total = 0.0;
+                std::vector<double> values(count);
+                for (int k = 0; k < count; k++) {
+                    values[k] = std::max(0.0, 1.0 - std::abs((first + k + 0.5 - center) / filter_scale));
+                    total += values[k];
+                }
+
+                for (int k = 0; k < count; k++)
+                    taps.weights[(size_t) i * taps.max_count + k] = (float) (values[k] / total);
+
+                taps.first[i] = first;
+                taps.count[i] = count;
+
+            }
+
+            return taps;
+
+        }
+
+    }  // namespace
+
+    DatasetReader::DatasetReader(const std::string &data_dir, int image_size, int original_size,
+                                 const std::vector<float> &mean, const std::vector<float> &std, int num_threads) {
+
+        this->data_dir = data_dir;
+        this->image_size = image_size;
+        this->original_size = original_size;
+
+        if (mean.size() != 3 || std.size() != 3)
+            throw std::invalid_argument("The mean and the standard deviation need a value per channel.");
+
+        // Normalise with a multiply-add per value.
+        for (int c = 0; c < 3; c++) {
+            this->scale[c] = 1.0f / (255.0f * std[c]);
+            this->offset[c] = -mean[c] / std[c];
+        }
+
+        // The annotations have to be the .npy arrays.
+        this->annotations = this->mapArray(data_dir + "/training_xyz.npy");
+        this->k_matrices = this->mapArray(data_dir + "/training_K.npy");
+
+        if (this->annotations.shape.size() != 3 || this->annotations.shape[2] != 3 || this->annotations.descr != "<f4")
+            throw std::runtime_error("training_xyz.npy is not a float32 array of keypoints.");
+        if (this->k_matrices.shape.size() != 3 || this->k_matrices.shape[1] != 3 || this->k_matrices.shape[2] != 3 || this->k_matrices.descr != "<f4")
+            throw std::runtime_error("training_K.npy is not a float32 array of 3x3 matrices.");
+
+        this->findImages();
+        this->findHeatmaps();
+
+        // The heatmaps are rendered like the trainer does if the dataset has
+        // none.
+        if (this->heatmap_shards.empty()) {
+            this->heatmap_size = image_size;
+            this->heatmap_renderer.reset(new bgq_opengl::HeatmapRenderer(this->getNumOfKeypoints(), image_size, original_size, original_size, HEATMAP_SIGMA, HEATMAP_RADIUS, bgq_opengl::TENSOR_FLOAT16));
+        }
+
+        // Start the threads, which wait for the first batch.
+        for (int t = 0; t < std::max(num_threads, 1); t++)
+            this->threads.emplace_back(&DatasetReader::work, this);
+
+    }
+
+    DatasetReader::~DatasetReader() {
+
+        // Stop the threads.
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->stopping = true;
+        }
+        this->batch_ready.notify_all();
+
+        for (std::thread &thread : this->threads)
+            thread.join();
+
+        // Unmap every file.
+        for (const MappedFile &file : this->files)
+            munmap((void*) file.data, file.size);
+
+    }
+
+    std::unique_ptr<Batch> DatasetReader::read(const std::vector<int> &indices) {
+
+        std::lock_guard<std::mutex> read_lock(this->read_mutex);
+
+        for (int index : indices)
+            if (index < 0 || index >= this->getNumOfSamples())
+                throw std::out_of_range("Sample " + std::to_string(index) + " is not in the dataset.");
+
+        // Allocate the whole batch, so every thread writes straight into it.
+        int num_of_keypoints = this->getNumOfKeypoints();
+        std::unique_ptr<Batch> batch(new Batch());
+        batch->size = (int) indices.size();
+        batch->images.resize((size_t) batch->size * 3 * this->image_size * this->image_size);
+        batch->keypoints.resize((size_t) batch->size * num_of_keypoints * 2);
+        batch->heatmaps.resize((size_t) batch->size * num_of_keypoints * this->heatmap_size * this->heatmap_size);
+        batch->frame_ids.resize(batch->size);
+
+        if (indices.empty())
+            return batch;
+
+        // Hand it to the threads and wait until every sample is loaded and
+        // no thread is still looking at it.
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->batch_indices = &indices;
+        this->batch = batch.get();
+        this->next_sample = 0;
+        this->finished_samples = 0;
+        this->error.clear();
+        this->generation++;
+        this->batch_ready.notify_all();
+
+        this->batch_done.wait(lock, [&] {
+            return this->finished_samples == batch->size && this->active_threads == 0;
+        });
+
+        this->batch_indices = nullptr;
+        this->batch = nullptr;
+
+        if (!this->error.empty())
+            throw std::runtime_error(this->error);
+
+        return batch;
+
+    }
+
+    int DatasetReader::getNumOfSamples() const {
+
+        return (int) std::min(this->images.size(), (size_t) this->annotations.shape[0]);
+
+    }
+
+    int DatasetReader::getNumOfKeypoints() const {
+
+        return this->annotations.shape[1];
+
+    }
+
+    int DatasetReader::getImageSize() const {
+
+        return this->image_size;
+
+    }
+
+    int DatasetReader::getHeatmapSize() const {
+
+        return this->heatmap_size;
+
+    }
+
+    DatasetReader::MappedFile DatasetReader::mapFile(const std::string &filename) {
+
+        int file_descriptor = open(filename.c_str(), O_RDONLY);
+        if (file_descriptor < 0)
+            throw std::runtime_error("Could not open " + filename);
+
+        struct stat status;
+        if (fstat(file_descriptor, &status) != 0 || status.st_size == 0) {
+            close(file_descriptor);
+            throw std::runtime_error("Could not map " + filename);
+        }
+
+        void* mapping = mmap(nullptr, (size_t) status.st_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+        close(file_descriptor);
+
+        if (mapping == MAP_FAILED)
+            throw std::runtime_error("Could not map " + filename);
+
+        MappedFile file;
+        file.data = (const unsigned char*) mapping;
+        file.size = (size_t) status.st_size;
+
+        return file;
+
+    }
+
+    DatasetReader::MappedArray DatasetReader::mapArray(const std::string &filename) {
+
+        MappedArray array;
+        array.file = mapFile(filename);
+        this->files.push_back(array.file);
+
+        const unsigned char* data = array.file.data;
+        if (array.file.size < 12 || memcmp(data, "\x93NUMPY", 6) != 0)
+            throw std::runtime_error(filename + " is not a .npy array.");
+
+        // The length of the header has 2 bytes in version 1 and 4 after it.
+        size_t start = (data[6] == 1) ? 10 : 12;
+        size_t length = (data[6] == 1) ? (data[8] | (data[9] << 8)) : (data[8] | (data[9] << 8) | (data[10] << 16) | ((size_t) data[11] << 24));
+        if (start + length > array.file.size)
+            throw std::runtime_error(filename + " has a broken header.");
+
+        std::string header((const char*) data + start, length);
+
+        // Get the type of the elements.
+        size_t descr = header.find("'descr'");
+        size_t descr_start = header.find('\'', header.find(':', descr) + 1);
+        size_t descr_end = header.find('\'', descr_start + 1);
+        if (descr == std::string::npos || descr_start == std::string::npos || descr_end == std::string::npos)
+            throw std::runtime_error(filename + " has no type.");
+        array.descr = header.substr(descr_start + 1, descr_end - descr_start - 1);
+
+        if (header.find("'fortran_order': True") != std::string::npos)
+            throw std::runtime_error(filename + " is in Fortran order.");
+
+        // And its shape.
+        size_t shape = header.find("'shape'");
+        size_t shape_start = header.find('(', shape);
+        size_t shape_end = header.find(')', shape_start);
+        if (shape == std::string::npos || shape_start == std::string::npos || shape_end == std::string::npos)
+            throw std::runtime_error(filename + " has no shape.");
+
+        std::string dimensions = header.substr(shape_start + 1, shape_end - shape_start - 1);
+        for (size_t position = 0; position < dimensions.size();) {
+            size_t comma = dimensions.find(',', position);
+            std::string dimension = dimensions.substr(position, comma - position);
+            if (dimension.find_first_of("0123456789") != std::string::npos)
+                array.shape.push_back(std::stoi(dimension));
+            if (comma == std::string::npos)
+                break;
+            position = comma + 1;
+        }
+
+        if (array.shape.empty())
+            throw std::runtime_error(filename + " is a scalar.");
+
+        size_t element_size = (size_t) std::stoi(array.descr.substr(2));
+        array.row_size = element_size;
+        for (size_t i = 1; i < array.shape.size(); i++)
+            array.row_size *= array.shape[i];
+
+        array.data = data + start + length;
+        if (array.data + array.row_size * array.shape[0] > data + array.file.size)
+            throw std::runtime_error(filename + " is shorter than its shape.");
+
+        return array;
+
+    }
+
+    void DatasetReader::findImages() {
+
+        std::string tensors_path = this->data_dir + "/training/tensors";
+        std::string shards_path = this->data_dir + "/training/shards";
+        std::string rgb_path = this->data_dir + "/training/rgb";
+
+        if (std::filesystem::is_directory(tensors_path)) {
+
+            // Raw images, with the ids of each shard next to it.
+            this->raw_images = true;
+
+            for (const std::string &filename : listFiles(tensors_path, ".npy")) {
+
+                this->image_shards.push_back(this->mapArray(tensors_path + "/" + filename));
+                std::vector<uint32_t> ids = readIds(tensors_path + "/" + filename.substr(0, filename.size() - 4) + ".ids");
+
+                for (size_t row = 0; row < ids.size(); row++) {
+                    ImageEntry entry;
+                    entry.frame_id = (int) ids[row];
+                    entry.file = (int) this->image_shards.size() - 1;
+                    entry.offset = row;
+                    this->images.push_back(entry);
+                }
+
+            }
+
+        } else if (std::filesystem::is_directory(shards_path)) {
+
+            // Encoded images inside tar shards, found through their index.
+            for (const std::string &filename : listFiles(shards_path, ".idx")) {
+
+                std::string stem = shards_path + "/" + filename.substr(0, filename.size() - 4);
+                this->files.push_back(mapFile(stem + ".tar"));
+
+                std::ifstream index(stem + ".idx", std::ios::binary);
+                ShardIndexEntry record;
+                while (index.read((char*) &record, sizeof(record))) {
+                    ImageEntry entry;
+                    entry.frame_id = (int) record.frame_id;
+                    entry.file = (int) this->files.size() - 1;
+                    entry.offset = record.image_offset;
+                    entry.size = record.image_size;
+                    if (entry.offset + entry.size > this->files.back().size)
+                        throw std::runtime_error(stem + ".tar is shorter than its index.");
+                    this->images.push_back(entry);
+                }
+
+            }
+
+        } else {
+
+            // Loose files, named after their frame id.
+            for (const std::string &filename : listFiles(rgb_path, "")) {
+                ImageEntry entry;
+                entry.frame_id = std::atoi(filename.c_str());
+                entry.filename = rgb_path + "/" + filename;
+                this->images.push_back(entry);
+            }
+
+        }
+
+        std::stable_sort(this->images.begin(), this->images.end(), [](const ImageEntry &a, const ImageEntry &b) {
+            return a.frame_id < b.frame_id;
+        });
+
+    }
+
+    void DatasetReader::findHeatmaps() {
+
+        std::string heatmaps_path = this->data_dir + "/training/heatmaps";
+
+        std::vector<std::pair<int, std::pair<int, size_t>>> entries;
+        for (const std::string &filename : listFiles(heatmaps_path, ".npy")) {
+
+            MappedArray shard = this->mapArray(heatmaps_path + "/" + filename);
+            if (shard.shape.size() != 4 || shard.shape[1] != this->getNumOfKeypoints() || shard.shape[2] != shard.shape[3])
+                throw std::runtime_error(filename + " does not hold a heatmap per keypoint.");
+
+            this->heatmap_shards.push_back(shard);
+            this->heatmap_size = shard.shape[2];
+
+            std::vector<uint32_t> ids = readIds(heatmaps_path + "/" + filename.substr(0, filename.size() - 4) + ".ids");
+            for (size_t row = 0; row < ids.size(); row++)
+                entries.push_back({(int) ids[row], {(int) this->heatmap_shards.size() - 1, row}});
+
+        }
+
+        if (entries.empty())
+            return;
+
+        // They go with the images in the same order.
+        if (entries.size() != this->images.size())
+            throw std::runtime_error("The dataset has a different amount of heatmaps and images.");
+
+        std::stable_sort(entries.begin(), entries.end(), [](const auto &a, const auto &b) {
+            return a.first < b.first;
+        });
+
+        for (const auto &entry : entries)
+            this->heatmaps.push_back(entry.second);
+
+    }
+
+    void DatasetReader::loadSample(int index, int slot, Batch &batch) const {
+
+        const ImageEntry &entry = this->images[index];
+        int num_of_keypoints = this->getNumOfKeypoints();
+        size_t image_floats = (size_t) 3 * this->image_size * this->image_size;
+        size_t heatmap_floats = (size_t) num_of_keypoints * this->heatmap_size * this->heatmap_size;
+
+        thread_local std::vector<unsigned char> pixels;
+        thread_local std::vector<unsigned char> encoded;
+        int width, height;
+
+        // Get the pixels of the image, top row first.
+        if (this->raw_images) {
+
+            const MappedArray &shard = this->image_shards[entry.file];
+            const unsigned char* tensor = shard.data + entry.offset * shard.row_size;
+
+            if (shard.shape[1] == 3) {
+
+                // Interleave the planes.
+                height = shard.shape[2];
+                width = shard.shape[3];
+                size_t plane = (size_t) width * height;
+                pixels.resize(plane * 3);
+                for (size_t i = 0; i < plane; i++)
+                    for (int c = 0; c < 3; c++)
+                        pixels[i * 3 + c] = tensor[c * plane + i];
+
+            } else {
+
+                height = shard.shape[1];
+                width = shard.shape[2];
+                pixels.assign(tensor, tensor + shard.row_size);
+
+            }
+
+        } else if (entry.file >= 0) {
+
+            const MappedFile &shard = this->files[entry.file];
+            this->decodeJPEG(shard.data + entry.offset, entry.size, pixels, width, height);
+
+        } else {
+
+            std::ifstream file(entry.filename, std::ios::binary | std::ios::ate);
+            if (!file)
+                throw std::runtime_error("Could not read " + entry.filename);
+
+            encoded.resize((size_t) file.tellg());
+            file.seekg(0);
+            file.read((char*) encoded.data(), encoded.size());
+            this->decodeJPEG(encoded.data(), encoded.size(), pixels, width, height);
+
+        }
+
+        this->resizeNormalised(pixels.data(), width, height, batch.images.data() + slot * image_floats);
+
+        // Project the keypoints with their k_matrix, like project_points.
+        const float* points = (const float*) (this->annotations.data + (size_t) index * this->annotations.row_size);
+        const float* matrix = (const float*) (this->k_matrices.data + (size_t) index * this->k_matrices.row_size);
+        float* keypoints = batch.keypoints.data() + (size_t) slot * num_of_keypoints * 2;
+
+        thread_local std::vector<float> projected;
+        projected.resize((size_t) num_of_keypoints * 3);
+
+        for (int k = 0; k < num_of_keypoints; k++) {
+
+            const float* point = points + k * 3;
+            float uv[3];
+            for (int row = 0; row < 3; row++)
+                uv[row] = matrix[row * 3] * point[0] + matrix[row * 3 + 1] * point[1] + matrix[row * 3 + 2] * point[2];
+
+            projected[k * 3] = uv[0] / uv[2];
+            projected[k * 3 + 1] = uv[1] / uv[2];
+            projected[k * 3 + 2] = 0.0f;
+
+            keypoints[k * 2] = projected[k * 3] / this->original_size;
+            keypoints[k * 2 + 1] = projected[k * 3 + 1] / this->original_size;
+
+        }
+
+        // Get the heatmaps, from the shards if there are any.
+        float* heatmaps = batch.heatmaps.data() + slot * heatmap_floats;
+
+        if (this->heatmap_renderer != nullptr) {
+
+            thread_local std::vector<uint16_t> halves;
+            halves.resize(heatmap_floats);
+            this->heatmap_renderer->render(projected, halves.data());
+            for (size_t i = 0; i < heatmap_floats; i++)
+                heatmaps[i] = halfToFloat(halves[i]);
+
+        } else {
+
+            const MappedArray &shard = this->heatmap_shards[this->heatmaps[index].first];
+            const unsigned char* row = shard.data + this->heatmaps[index].second * shard.row_size;
+
+            if (shard.descr == "|u1") {
+                for (size_t i = 0; i < heatmap_floats; i++)
+                    heatmaps[i] = row[i] / 255.0f;
+            } else if (shard.descr == "<f2") {
+                for (size_t i = 0; i < heatmap_floats; i++) {
+                    uint16_t half;
+                    memcpy(&half, row + i * 2, sizeof(half));
+                    heatmaps[i] = halfToFloat(half);
+                }
+            } else {
+                memcpy(heatmaps, row, heatmap_floats * sizeof(float));
+            }
+
+        }
+
+        batch.frame_ids[slot] = entry.frame_id;
+
+    }
+
+    void DatasetReader::decodeJPEG(const unsigned char* data, size_t size, std::vector<unsigned char> &pixels, int &width, int &height) const {
+
+        if (size < 2 || data[0] != 0xFF || data[1] != 0xD8)
+            throw std::runtime_error("The native reader only decodes JPEG images.");
+
+        jpeg_decompress_struct info;
+        JPEGError error;
+        info.err = jpeg_std_error(&error.manager);
+        error.manager.error_exit = exitJPEG;
+
+        if (setjmp(error.jump)) {
+            jpeg_destroy_decompress(&info);
+            throw std::runtime_error(std::string("Could not decode an image: ") + error.message);
+        }
+
+        jpeg_create_decompress(&info);
+        jpeg_mem_src(&info, (unsigned char*) data, (unsigned long) size);
+        jpeg_read_header(&info, TRUE);
+
+        // Let the IDCT scale it down as much as it can while still covering
+        // the size of the batch, which costs much less than decoding it
+        // whole. libjpeg-turbo takes any eighth, older versions round up to
+        // the closest power of two they have.
+        info.out_color_space = JCS_RGB;
+        info.scale_denom = 8;
+        info.scale_num = 8;
+        for (unsigned int num = 1; num < 8; num++) {
+            if ((info.image_width * num + 7) / 8 >= (unsigned int) this->image_size && (info.image_height * num + 7) / 8 >= (unsigned int) this->image_size) {
+                info.scale_num = num;
+                break;
+            }
+        }
+
+        jpeg_start_decompress(&info);
+
+        width = (int) info.output_width;
+        height = (int) info.output_height;
+        pixels.resize((size_t) width * height * 3);
+
+        while (info.output_scanline < info.output_height) {
+            JSAMPROW row = pixels.data() + (size_t) info.output_scanline * width * 3;
+            jpeg_read_scanlines(&info, &row, 1);
+        }
+
+        jpeg_finish_decompress(&info);
+        jpeg_destroy_decompress(&info);
+
+    }
+
+    void DatasetReader::resizeNormalised(const unsigned char* pixels, int width, int height, float* output) const {
+
+        int size = this->image_size;
+
+        // The images of a dataset usually have the same size, so keep the
+        // taps of the last one.
+        thread_local int taps_width = 0, taps_height = 0, taps_size = 0;
+        thread_local Taps horizontal, vertical;
+        if (taps_width != width || taps_height != height || taps_size != size) {
+            horizontal = findTaps(width, size);
+            vertical = findTaps(height, size);
+            taps_width = width;
+            taps_height = height;
+            taps_size = size;
+        }
+
+        // Resample the columns of every row first.
+        thread_local std::vector<float> columns;
+        columns.resize((size_t) height * size * 3);
+
+        for (int y = 0; y < height; y++) {
+
+            const unsigned char* row = pixels + (size_t) y * width * 3;
+            float* destination = columns.data() + (size_t) y * size * 3;
+
+            for (int x = 0; x < size; x++) {
+
+                const unsigned char* source = row + (size_t) horizontal.first[x] * 3;
+                const float* weights = &horizontal.weights[(size_t) x * horizontal.max_count];
+                float sum[3] = {0.0f, 0.0f, 0.0f};
+
+                for (int k = 0; k < horizontal.count[x]; k++)
+                    for (int c = 0; c < 3; c++)
+                        sum[c] += source[k * 3 + c] * weights[k];
+
+                for (int c = 0; c < 3; c++)
+                    destination[x * 3 + c] = sum[c];
+
+            }
+
+        }
+
+        // Then the rows, normalising each value into its plane.
+        size_t plane = (size_t) size * size;
+
+        for (int y = 0; y < size; y++) {
+
+            const float* weights = &vertical.weights[(size_t) y * vertical.max_count];
+
+            for (int x = 0; x < size; x++) {
+
+                float sum[3] = {0.0f, 0.0f, 0.0f};
+
+                for (int k = 0; k < vertical.count[y]; k++) {
+                    const float* source = columns.data() + ((size_t) (vertical.first[y] + k) * size + x) * 3;
+                    for (int c = 0; c < 3; c++)
+                        sum[c] += source[c] * weights[k];
+                }
+
+                for (int c = 0; c < 3; c++)
+                    output[c * plane + (size_t) y * size + x] = sum[c] * this->scale[c] + this->offset[c];
+
+            }
+
+        }
+
+    }
+
+    void DatasetReader::work() {
+
+        uint64_t seen = 0;
+
+        while (true) {
+
+            // Wait for a batch this thread has not worked on.
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->batch_ready.wait(lock, [&] {
+                return this->stopping || (this->batch != nullptr && this->generation != seen);
+            });
+
+            if (this->stopping)
+                return;
+
+            seen = this->generation;
+            const std::vector<int> &indices = *this->batch_indices;
+            Batch &current = *this->batch;
+            this->active_threads++;
+            lock.unlock();
+
+            // Take samples until there are none left.
+            int loaded = 0;
+            std::string failure;
+            for (int slot = this->next_sample++; slot < (int) indices.size(); slot = this->next_sample++) {
+
+                try {
+                    this->loadSample(indices[slot], slot, current);
+                } catch (const std::exception &exception) {
+                    if (failure.empty())
+                        failure = exception.what();
+                }
+
+                loaded++;
+
+            }
+
+            lock.lock();
+            this->finished_samples += loaded;
+            this->active_threads--;
+            if (!failure.empty() && this->error.empty())
+                this->error = failure;
+            if (this->finished_samples == (int) indices.size() && this->active_threads == 0)
+                this->batch_done.notify_one();
+
+        }
+
+    }
+
+}  // namespace bgq_native
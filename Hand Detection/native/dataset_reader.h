@@ -0,0 +1,280 @@
+/**
+ * @file dataset_reader.h
+ * @brief DatasetReader class header file.
+ * @version 1.0.0 (2024-03-24)
+ * @date 2024-03-24
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as
+ * complementary materials to the dissertation submitted as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_NATIVE_DATASET_READER_H_
+#define BGQ_NATIVE_DATASET_READER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "classes/heatmap_renderer/heatmap_renderer.h"
+
+namespace bgq_native {
+
+    /// The samples of a batch, ready for the trainer.
+    struct Batch {
+        int size = 0;                       /// The amount of samples.
+        std::vector<float> images;          /// The normalised images, (size, 3, image_size, image_size).
+        std::vector<float> keypoints;       /// The keypoints over the original size of the images, (size, keypoints, 2).
+        std::vector<float> heatmaps;        /// The heatmaps of the keypoints, (size, keypoints, heatmap_size, heatmap_size).
+        std::vector<int32_t> frame_ids;     /// The id of each of the samples.
+    };
+
+    /**
+     * @brief Implementation of a DatasetReader class.
+     *
+     * Implementation of a reader of the datasets written by HandyVariations
+     * that hands whole batches to the trainer. The annotations and every
+     * shard are mapped into memory, so nothing is read until a sample is
+     * used. The JPEGs are decoded by a pool of threads with the DCT already
+     * scaled down to the size closest above the one of the trainer, then
+     * resized with an antialiased bilinear filter and normalised in the same
+     * pass. The heatmaps are read from the heatmap shards when the dataset
+     * has them, and rendered like the trainer does otherwise.
+     *
+     * @author Borja García Quiroga <garcaqub@tcd.ie>
+     */
+    class DatasetReader {
+
+    public:
+
+        /**
+         * @brief Creates a new reader.
+         *
+         * Creates a new reader of a dataset, with the images stored as
+         * tensor shards, tar shards or loose files, in that order of
+         * preference.
+         *
+         * @param data_dir The directory of the dataset.
+         * @param image_size The width and height of the images of the batches.
+         * @param original_size The size the keypoints are normalised by.
+         * @param mean The mean of each channel, over values from 0 to 1.
+         * @param std The standard deviation of each channel.
+         * @param num_threads The amount of decoding threads.
+         */
+        DatasetReader(const std::string &data_dir, int image_size, int original_size,
+                      const std::vector<float> &mean, const std::vector<float> &std, int num_threads);
+
+        /**
+         * @brief Destroys the reader.
+         *
+         * Stops the threads and unmaps every file.
+         */
+        ~DatasetReader();
+
+        DatasetReader(const DatasetReader&) = delete;
+        DatasetReader& operator=(const DatasetReader&) = delete;
+
+        /**
+         * @brief Read a batch.
+         *
+         * Read some samples into a new batch, decoding them in parallel.
+         *
+         * @param indices The positions of the samples in the dataset.
+         *
+         * @returns The batch.
+         */
+        std::unique_ptr<Batch> read(const std::vector<int> &indices);
+
+        /**
+         * @brief Get the amount of samples.
+         *
+         * Get the amount of samples in the dataset.
+         *
+         * @returns The amount of samples.
+         */
+        int getNumOfSamples() const;
+
+        /**
+         * @brief Get the amount of keypoints.
+         *
+         * Get the amount of keypoints of each sample.
+         *
+         * @returns The amount of keypoints.
+         */
+        int getNumOfKeypoints() const;
+
+        /**
+         * @brief Get the image size.
+         *
+         * Get the width and height of the images of the batches.
+         *
+         * @returns The size.
+         */
+        int getImageSize() const;
+
+        /**
+         * @brief Get the heatmap size.
+         *
+         * Get the width and height of the heatmaps of the batches.
+         *
+         * @returns The size.
+         */
+        int getHeatmapSize() const;
+
+    private:
+
+        /// A file mapped into memory.
+        struct MappedFile {
+            const unsigned char* data = nullptr;    /// The contents.
+            size_t size = 0;                        /// The size of the file.
+        };
+
+        /// A .npy array mapped into memory.
+        struct MappedArray {
+            MappedFile file;                /// The file of the array.
+            const unsigned char* data = nullptr;    /// The first element.
+            std::string descr;              /// The type of the elements, as numpy writes it.
+            std::vector<int> shape;         /// The shape.
+            size_t row_size = 0;            /// The size of each element of the first axis.
+        };
+
+        /// Where the image of a sample is.
+        struct ImageEntry {
+            int frame_id = 0;               /// The id of the sample.
+            int file = -1;                  /// The mapped shard, or -1 for a loose file.
+            size_t offset = 0;              /// The offset in the shard, or its row in tensor shards.
+            size_t size = 0;                /// The size of the encoded image.
+            std::string filename;           /// The loose file.
+        };
+
+        /**
+         * @brief Map a file.
+         *
+         * Map a whole file into memory, read only.
+         *
+         * @param filename The name of the file.
+         *
+         * @returns The mapped file.
+         */
+        static MappedFile mapFile(const std::string &filename);
+
+        /**
+         * @brief Map a .npy array.
+         *
+         * Map a .npy array and parse its header.
+         *
+         * @param filename The name of the file.
+         *
+         * @returns The mapped array.
+         */
+        MappedArray mapArray(const std::string &filename);
+
+        /**
+         * @brief Find the images.
+         *
+         * Find the image of every sample in the tensor shards, the tar
+         * shards or the loose files, sorted by frame id.
+         */
+        void findImages();
+
+        /**
+         * @brief Find the heatmaps.
+         *
+         * Find the heatmap shards, if the dataset has them.
+         */
+        void findHeatmaps();
+
+        /**
+         * @brief Load a sample.
+         *
+         * Decode, resize and normalise the image of a sample, and get its
+         * keypoints and heatmaps, into its slot of a batch.
+         *
+         * @param index The position of the sample in the dataset.
+         * @param slot The position of the sample in the batch.
+         * @param batch The batch.
+         */
+        void loadSample(int index, int slot, Batch &batch) const;
+
+        /**
+         * @brief Decode a JPEG.
+         *
+         * Decode a JPEG to RGB, with the DCT scaled down as much as it can be
+         * while still covering the image size.
+         *
+         * @param data The encoded image.
+         * @param size The size of the encoded image.
+         * @param pixels Output vector for the pixels, top row first.
+         * @param width Output for the width of the decoded image.
+         * @param height Output for the height of the decoded image.
+         */
+        void decodeJPEG(const unsigned char* data, size_t size, std::vector<unsigned char> &pixels, int &width, int &height) const;
+
+        /**
+         * @brief Resize and normalise an image.
+         *
+         * Resize an RGB image with an antialiased bilinear filter and
+         * normalise it into planes of floats.
+         *
+         * @param pixels The pixels, top row first.
+         * @param width The width of the image.
+         * @param height The height of the image.
+         * @param output The image_size x image_size x 3 planes.
+         */
+        void resizeNormalised(const unsigned char* pixels, int width, int height, float* output) const;
+
+        /**
+         * @brief The loop of each of the threads.
+         *
+         * Take samples of the current batch until there are none left, and
+         * wait for the next batch.
+         */
+        void work();
+
+        std::string data_dir;               /// The directory of the dataset.
+        int image_size;                     /// The size of the images of the batches.
+        int original_size;                  /// The size the keypoints are normalised by.
+        float scale[3];                     /// 1 / (255 std) of each channel.
+        float offset[3];                    /// -mean / std of each channel.
+        std::vector<MappedFile> files;      /// Every mapped file.
+        MappedArray annotations;            /// The keypoints of every sample.
+        MappedArray k_matrices;             /// The k_matrices of every sample.
+        std::vector<ImageEntry> images;     /// The image of every sample, sorted by frame id.
+        std::vector<MappedArray> image_shards;      /// The tensor shards of the images, if any.
+        bool raw_images = false;            /// Whether the images are in tensor shards.
+        std::vector<std::pair<int, size_t>> heatmaps;   /// The shard and row of the heatmaps of every sample, if any.
+        std::vector<MappedArray> heatmap_shards;    /// The heatmap shards, if any.
+        int heatmap_size = 0;               /// The size of the heatmaps.
+        std::unique_ptr<bgq_opengl::HeatmapRenderer> heatmap_renderer;     /// Renders the heatmaps when the dataset has none.
+
+        std::vector<std::thread> threads;   /// The decoding threads.
+        std::mutex read_mutex;              /// Lets a single batch be read at a time.
+        std::mutex mutex;                   /// Guards the current batch.
+        std::condition_variable batch_ready;        /// Wakes the threads up for a batch.
+        std::condition_variable batch_done;         /// Wakes the caller up when the batch is complete.
+        const std::vector<int>* batch_indices = nullptr;    /// The samples of the current batch.
+        Batch* batch = nullptr;             /// The current batch.
+        std::atomic<int> next_sample{0};    /// The next sample of the current batch to load.
+        int finished_samples = 0;           /// The samples of the current batch loaded so far.
+        int active_threads = 0;             /// The threads still working on the current batch.
+        uint64_t generation = 0;            /// Counts the batches, so each thread takes each batch once.
+        std::string error;                  /// The first error of the current batch.
+        bool stopping = false;              /// Whether the threads have to stop.
+
+    };
+
+}  // namespace bgq_native
+
+#endif  //!BGQ_NATIVE_DATASET_READER_H_
@@ -0,0 +1,59 @@
+##############################################################################
+#                                                                            #
+# Copyright (c) Borja García Quiroga, All Rights Reserved.                   #
+#                                                                            #
+# The information and material provided below was developed as complementary #
+# materials to the dissertation submitted as partial requirements for the    #
+# MSc in Computer Science at Trinity College Dublin, Ireland.                #
+#                                                                            #
+##############################################################################
+
+'''
+Builds the native dataset and stream readers. They need pybind11 and
+libjpeg-turbo. If libjpeg-turbo is not where the compiler looks, point
+JPEG_PREFIX to it (e.g. JPEG_PREFIX=$(brew --prefix jpeg-turbo)).
+
+    pip install pybind11
+    python setup.py build_ext --inplace
+'''
+
+import os
+import sys
+from setuptools import setup
+from pybind11.setup_helpers import Pybind11Extension, build_ext
+
+# The heatmaps are rendered by the same code the generator writes them with.
+HANDY_VARIATIONS = os.path.join("..", "..", "HandyVariations")
+
+include_dirs = [HANDY_VARIATIONS]
+library_dirs = []
+libraries = ["jpeg"]
+
+# shm_open lives in librt on older Linux systems.
+if sys.platform.startswith("linux"):
+    libraries.append("rt")
+
+jpeg_prefix = os.environ.get("JPEG_PREFIX")
+if jpeg_prefix:
+    include_dirs.append(os.path.join(jpeg_prefix, "include"))
+    library_dirs.append(os.path.join(jpeg_prefix, "lib"))
+
+extension = Pybind11Extension(
+    "handy_reader",
+    [
+        "bindings.cpp",
+        "dataset_reader.cpp",
+        "stream_reader.cpp",
+        os.path.join(HANDY_VARIATIONS, "classes", "heatmap_renderer", "heatmap_renderer.cpp"),
+    ],
+    include_dirs=include_dirs,
+    library_dirs=library_dirs,
+    libraries=libraries,
+    cxx_std=17,
+)
+
+setup(
+    name="handy_reader",
+    ext_modules=[extension],
+    cmdclass={"build_ext": build_ext},
+)
@@ -0,0 +1,187 @@
+/**
+ * @file stream_reader.cpp
+ * @brief StreamReader class implementation file.
+ * @version 1.0.0 (2024-03-24)
+ * @date 2024-03-24
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as
+ * complementary materials to the dissertation submitted as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#include "stream_reader.h"
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// How long to sleep while there is nothing to take.
+#define STREAM_WAIT_US 100
+
+namespace bgq_native {
+
+    StreamReader::StreamReader(const std::string &name, double timeout) {
+
+        this->name = name;
+
+        // The generator may not have created the stream yet, or not filled
+        // its header, so keep trying until the magic is there.
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(timeout);
+        uint32_t magic;
+        memcpy(&magic, HV_STREAM_MAGIC, 4);
+
+        for (;;) {
+
+            int file_descriptor = shm_open(name.c_str(), O_RDWR, 0);
+            if (file_descriptor >= 0) {
+
+                struct stat status;
+                if (fstat(file_descriptor, &status) == 0 && (size_t) status.st_size >= sizeof(HVStreamHeader)) {
+
+                    void* mapping = mmap(nullptr, status.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, file_descriptor, 0);
+                    if (mapping == MAP_FAILED) {
+                        close(file_descriptor);
+                        throw std::runtime_error("Could not map the stream " + name);
+                    }
+
+                    this->header = (HVStreamHeader*) mapping;
+                    this->mapped_size = status.st_size;
+                    if (__atomic_load_n((uint32_t*) this->header->magic, __ATOMIC_ACQUIRE) == magic) {
+                        close(file_descriptor);
+                        break;
+                    }
+
+                    munmap(mapping, this->mapped_size);
+                    this->header = nullptr;
+
+                }
+
+                close(file_descriptor);
+
+            }
+
+            if (std::chrono::steady_clock::now() >= deadline)
+                throw std::runtime_error("The stream " + name + " did not appear.");
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        }
+
+        // Check that the ring is one this reader understands, and that it
+        // is all there.
+        const HVStreamHeader &ring = *this->header;
+        size_t sample_size = hv_stream_sample_size(ring.width, ring.height, ring.num_keypoints, ring.heatmap_size, ring.heatmap_type);
+        bool valid = ring.version == HV_STREAM_VERSION && ring.num_slots > 0
+            && ring.slot_size >= sizeof(HVStreamSlot) + sample_size
+            && this->mapped_size >= sizeof(HVStreamHeader) + (size_t) ring.num_slots * ring.slot_size;
+
+        if (!valid) {
+            munmap(this->header, this->mapped_size);
+            throw std::runtime_error("The stream " + name + " has an unknown layout.");
+        }
+
+        this->image_size = (size_t) ring.width * ring.height * 3;
+        this->keypoints_size = (size_t) ring.num_keypoints * 3 * sizeof(float);
+        this->heatmaps_size = sample_size - hv_stream_image_size(ring.width, ring.height) - this->keypoints_size;
+
+    }
+
+    StreamReader::~StreamReader() {
+
+        munmap(this->header, this->mapped_size);
+
+    }
+
+    std::unique_ptr<StreamBatch> StreamReader::read(int batch_size, double timeout) {
+
+        if (batch_size < 1)
+            throw std::invalid_argument("The batch size has to be positive.");
+
+        std::unique_ptr<StreamBatch> batch(new StreamBatch());
+        batch->images.resize(batch_size * this->image_size);
+        batch->keypoints.resize(batch_size * this->keypoints_size / sizeof(float));
+        batch->heatmaps.resize(batch_size * this->heatmaps_size);
+        batch->frame_ids.resize(batch_size);
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(timeout);
+
+        while (batch->size < batch_size) {
+
+            int64_t position = hv_stream_claim(this->header);
+
+            // Wait for the generator, unless it is done or the time is up.
+            if (position < 0) {
+
+                if (hv_stream_finished(this->header) || std::chrono::steady_clock::now() >= deadline)
+                    break;
+
+                std::this_thread::sleep_for(std::chrono::microseconds(STREAM_WAIT_US));
+                continue;
+
+            }
+
+            // Copy the sample out and give the slot back straight away.
+            HVStreamSlot* slot = hv_stream_slot(this->header, position);
+            int index = batch->size++;
+
+            batch->frame_ids[index] = slot->frame_id;
+            memcpy(batch->images.data() + index * this->image_size, hv_stream_image(slot), this->image_size);
+            memcpy(batch->keypoints.data() + index * this->keypoints_size / sizeof(float), hv_stream_keypoints(this->header, slot), this->keypoints_size);
+            memcpy(batch->heatmaps.data() + index * this->heatmaps_size, hv_stream_heatmaps(this->header, slot), this->heatmaps_size);
+
+            hv_stream_release(this->header, position);
+
+        }
+
+        return batch;
+
+    }
+
+    bool StreamReader::isFinished() const {
+
+        return hv_stream_finished(this->header);
+
+    }
+
+    int StreamReader::getWidth() const {
+
+        return this->header->width;
+
+    }
+
+    int StreamReader::getHeight() const {
+
+        return this->header->height;
+
+    }
+
+    int StreamReader::getNumOfKeypoints() const {
+
+        return this->header->num_keypoints;
+
+    }
+
+    int StreamReader::getHeatmapSize() const {
+
+        return this->header->heatmap_size;
+
+    }
+
+    int StreamReader::getHeatmapType() const {
+
+        return this->header->heatmap_type;
+
+    }
+
+}  // namespace bgq_native
@@ -0,0 +1,150 @@
+/**
+ * @file stream_reader.h
+ * @brief StreamReader class header file.
+ * @version 1.0.0 (2024-03-24)
+ * @date 2024-03-24
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as
+ * complementary materials to the dissertation submitted as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_NATIVE_STREAM_READER_H_
+#define BGQ_NATIVE_STREAM_READER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "classes/sample_stream/sample_stream_layout.h"
+
+namespace bgq_native {
+
+    /// The samples taken from a stream, as the generator published them.
+    struct StreamBatch {
+        int size = 0;                       /// The amount of samples.
+        std::vector<uint8_t> images;        /// The RGB images, (size, height, width, 3).
+        std::vector<float> keypoints;       /// The keypoints in pixels of the images, (size, keypoints, 3).
+        std::vector<uint8_t> heatmaps;      /// The heatmaps, (size, keypoints, heatmap_size, heatmap_size) of uint8 or float16.
+        std::vector<int32_t> frame_ids;     /// The id of each of the samples.
+    };
+
+    /**
+     * @brief Implementation of a StreamReader class.
+     *
+     * Implementation of a consumer of the shared-memory ring the generator
+     * streams its samples through. Several readers, in one or several
+     * processes, can take samples from the same stream, and each sample
+     * goes to only one of them. The samples are copied out of the ring as
+     * soon as they are claimed, so the generator can reuse their slots.
+     *
+     * @author Borja García Quiroga <garcaqub@tcd.ie>
+     */
+    class StreamReader {
+
+    public:
+
+        /**
+         * @brief Creates a new reader.
+         *
+         * Maps the ring of a stream, waiting for the generator to create it.
+         *
+         * @param name The name of the shared memory object, starting with a slash.
+         * @param timeout The seconds to wait for the stream to appear.
+         */
+        StreamReader(const std::string &name, double timeout);
+
+        /**
+         * @brief Destroys the reader.
+         *
+         * Unmaps the ring.
+         */
+        ~StreamReader();
+
+        StreamReader(const StreamReader&) = delete;
+        StreamReader& operator=(const StreamReader&) = delete;
+
+        /**
+         * @brief Read a batch.
+         *
+         * Take samples from the stream until the batch is full, the
+         * generator has finished or the time is up.
+         *
+         * @param batch_size The amount of samples of a full batch.
+         * @param timeout The seconds to wait for the batch to be full.
+         *
+         * @returns The batch, which may have fewer samples.
+         */
+        std::unique_ptr<StreamBatch> read(int batch_size, double timeout);
+
+        /**
+         * @brief Whether the stream is over.
+         *
+         * Whether the generator has finished and every sample has been taken.
+         *
+         * @returns True if no more samples will come.
+         */
+        bool isFinished() const;
+
+        /**
+         * @brief Get the width of the images.
+         *
+         * @returns The width.
+         */
+        int getWidth() const;
+
+        /**
+         * @brief Get the height of the images.
+         *
+         * @returns The height.
+         */
+        int getHeight() const;
+
+        /**
+         * @brief Get the amount of keypoints.
+         *
+         * Get the amount of keypoints of each sample.
+         *
+         * @returns The amount of keypoints.
+         */
+        int getNumOfKeypoints() const;
+
+        /**
+         * @brief Get the heatmap size.
+         *
+         * Get the width and height of the heatmaps, 0 if there are none.
+         *
+         * @returns The size.
+         */
+        int getHeatmapSize() const;
+
+        /**
+         * @brief Get the heatmap type.
+         *
+         * Get the type of the heatmaps, 0 for uint8 and 1 for float16.
+         *
+         * @returns The type.
+         */
+        int getHeatmapType() const;
+
+    private:
+
+        std::string name;                   /// The name of the shared memory object.
+        HVStreamHeader* header = nullptr;   /// The mapped ring.
+        size_t mapped_size = 0;             /// The size of the mapping.
+        size_t image_size = 0;              /// The size of each image.
+        size_t keypoints_size = 0;          /// The size of the keypoints of each sample.
+        size_t heatmaps_size = 0;           /// The size of the heatmaps of each sample.
+
+    };
+
+}  // namespace bgq_native
+
+#endif  //!BGQ_NATIVE_STREAM_READER_H_
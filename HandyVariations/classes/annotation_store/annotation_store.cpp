@@ -0,0 +1,121 @@
+/**
+ * @file annotation_store.cpp
+ * @brief Annotation store class implementation file.
+ * @version 1.0.0 (2024-03-11)
+ * @date 2024-03-11
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#include "annotation_store.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace bgq_opengl {
+
+    AnnotationStore::AnnotationStore(const char* filename, int num_samples, int rows, int cols, bool keep) {
+
+        this->filename = filename;
+        this->num_samples = num_samples;
+        this->sample_size = (size_t) rows * cols;
+        this->byte_size = ANNOTATION_STORE_HEADER_SIZE + (size_t) num_samples * this->sample_size * sizeof(float);
+
+        // Create the file with its final size. The samples that are never
+        // written are left as zeros.
+        this->file_descriptor = open(filename, O_RDWR | O_CREAT | (keep ? 0 : O_TRUNC), 0644);
+        if (this->file_descriptor < 0 || ftruncate(this->file_descriptor, this->byte_size) != 0) {
+            std::cerr << "Could not create the annotations store " << filename << std::endl;
+            exit(1);
+        }
+
+        // Map the whole file.
+        void* mapping = mmap(nullptr, this->byte_size, PROT_READ | PROT_WRITE, MAP_SHARED, this->file_descriptor, 0);
+        if (mapping == MAP_FAILED) {
+            std::cerr << "Could not map the annotations store " << filename << std::endl;
+            exit(1);
+        }
+        this->data = (unsigned char*) mapping;
+
+        // Build the .npy header. It is padded with spaces to a fixed size, so
+        // that the data starts at an aligned offset.
+        char header[ANNOTATION_STORE_HEADER_SIZE];
+        memset(header, ' ', ANNOTATION_STORE_HEADER_SIZE);
+
+        int dict_length = snprintf(header + 10, ANNOTATION_STORE_HEADER_SIZE - 10,
+                                   "{'descr': '<f4', 'fortran_order': False, 'shape': (%i, %i, %i), }",
+                                   num_samples, rows, cols);
+        assert(dict_length > 0 && dict_length < ANNOTATION_STORE_HEADER_SIZE - 11);
+        header[10 + dict_length] = ' ';
+        header[ANNOTATION_STORE_HEADER_SIZE - 1] = '\n';
+
+        // Magic, version 1.0 and the little endian length of the dictionary.
+        memcpy(header, "\x93NUMPY\x01\x00", 8);
+        header[8] = (char) ((ANNOTATION_STORE_HEADER_SIZE - 10) & 0xFF);
+        header[9] = (char) ((ANNOTATION_STORE_HEADER_SIZE - 10) >> 8);
+
+        memcpy(this->data, header, ANNOTATION_STORE_HEADER_SIZE);
+
+    }
+
+    AnnotationStore::~AnnotationStore() {
+
+        this->close();
+
+    }
+
+    void AnnotationStore::write(int index, const float* values) {
+
+        assert(index >= 0 && index < this->num_samples);
+
+        size_t offset = ANNOTATION_STORE_HEADER_SIZE + (size_t) index * this->sample_size * sizeof(float);
+        memcpy(this->data + offset, values, this->sample_size * sizeof(float));
+
+    }
+
+    int AnnotationStore::getNumOfSamples() const {
+
+        return this->num_samples;
+
+    }
+
+    bool AnnotationStore::sync() {
+
+        if (this->data == nullptr)
+            return false;
+
+        return msync(this->data, this->byte_size, MS_SYNC) == 0;
+
+    }
+
+    bool AnnotationStore::close() {
+
+        if (this->data == nullptr)
+            return false;
+
+        // Make sure the data reaches the file before unmapping it.
+        bool success = msync(this->data, this->byte_size, MS_SYNC) == 0;
+        munmap(this->data, this->byte_size);
+        ::close(this->file_descriptor);
+
+        this->data = nullptr;
+        this->file_descriptor = -1;
+
+        return success;
+
+    }
+
+}  // namespace bgq_opengl
@@ -0,0 +1,115 @@
+/**
+ * @file annotation_store.h
+ * @brief Annotation store class header file.
+ * @version 1.0.0 (2024-03-11)
+ * @date 2024-03-11
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_CLASSES_ANNOTATION_STORE_H_
+#define BGQ_OPENGL_CLASSES_ANNOTATION_STORE_H_
+
+#include <cstddef>
+#include <string>
+
+#define ANNOTATION_STORE_HEADER_SIZE 128
+
+namespace bgq_opengl {
+
+    /**
+     * @brief Implementation of an AnnotationStore class.
+     *
+     * Implementation of a preallocated float32 .npy array of shape
+     * (samples, rows, cols) mapped into memory. Every sample has a fixed
+     * position in the file, so samples can be written in any order and from
+     * any thread without coordination.
+     *
+     * @author Borja García Quiroga <garcaqub@tcd.ie>
+     */
+    class AnnotationStore {
+
+    public:
+
+        /**
+         * @brief Creates a new store.
+         *
+         * Creates the .npy file with its final size and maps it into memory.
+         * If keep is set, the samples of an existing file are kept and the file
+         * is resized to the new amount of samples.
+         *
+         * @param filename The name of the .npy file.
+         * @param num_samples The amount of samples.
+         * @param rows The amount of rows of each sample.
+         * @param cols The amount of columns of each sample.
+         * @param keep Whether to keep the samples of an existing file.
+         */
+        AnnotationStore(const char* filename, int num_samples, int rows, int cols, bool keep = false);
+
+        /**
+         * @brief Destroys the store.
+         *
+         * Unmaps the file if it has not been closed.
+         */
+        ~AnnotationStore();
+
+        AnnotationStore(const AnnotationStore&) = delete;
+        AnnotationStore& operator=(const AnnotationStore&) = delete;
+
+        /**
+         * @brief Write a sample.
+         *
+         * Write the rows * cols values of a sample at its position.
+         *
+         * @param index The index of the sample.
+         * @param values The values of the sample in row-major order.
+         */
+        void write(int index, const float* values);
+
+        /**
+         * @brief Get the amount of samples.
+         *
+         * Get the amount of samples the store has room for.
+         *
+         * @returns The amount of samples.
+         */
+        int getNumOfSamples() const;
+
+        /**
+         * @brief Sync the store.
+         *
+         * Sync the mapped data to the file, keeping it mapped.
+         *
+         * @returns True if the data was synced.
+         */
+        bool sync();
+
+        /**
+         * @brief Close the store.
+         *
+         * Sync the mapped data to the file and unmap it.
+         *
+         * @returns True if the data was synced.
+         */
+        bool close();
+
+    private:
+
+        std::string filename;               /// The name of the file.
+        int file_descriptor = -1;           /// The .npy file.
+        int num_samples = 0;                /// The amount of samples.
+        size_t sample_size = 0;             /// The amount of floats per sample.
+        size_t byte_size = 0;               /// The size of the file in bytes.
+        unsigned char* data = nullptr;      /// The mapped file.
+
+    };
+
+}  // namespace bgq_opengl
+
+#endif  //!BGQ_OPENGL_CLASSES_ANNOTATION_STORE_H_
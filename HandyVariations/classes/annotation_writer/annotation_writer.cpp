@@ -0,0 +1,208 @@
+/**
+ * @file annotation_writer.cpp
+ * @brief Annotation writer class implementation file.
+ * @version 1.0.0 (2024-03-10)
+ * @date 2024-03-10
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#include "annotation_writer.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace bgq_opengl {
+
+    AnnotationWriter::AnnotationWriter(const char* filename) {
+
+        this->filename = filename;
+        this->tmp_filename = this->filename + ".tmp";
+
+        // Open the temporary file.
+        this->file_descriptor = open(this->tmp_filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (this->file_descriptor < 0) {
+            std::cerr << "Could not create the annotations file " << this->tmp_filename << std::endl;
+            exit(1);
+        }
+
+        // Allocate the buffer.
+        this->buffer.resize(ANNOTATION_WRITER_BUFFER_SIZE);
+
+        // Write the start of the json.
+        this->append("[", 1);
+
+    }
+
+    AnnotationWriter::AnnotationWriter(const char* filename, size_t size) {
+
+        this->filename = filename;
+        this->tmp_filename = this->filename + ".tmp";
+
+        // Reopen the array if it was already closed.
+        if (access(this->tmp_filename.c_str(), F_OK) != 0)
+            rename(this->filename.c_str(), this->tmp_filename.c_str());
+
+        // Open the temporary file and drop anything past the valid contents.
+        this->file_descriptor = open(this->tmp_filename.c_str(), O_WRONLY);
+        off_t file_size = (this->file_descriptor < 0) ? -1 : lseek(this->file_descriptor, 0, SEEK_END);
+
+        if (file_size < (off_t) size || size < 1 || ftruncate(this->file_descriptor, size) != 0) {
+            std::cerr << "Could not reopen the annotations file " << this->tmp_filename << std::endl;
+            exit(1);
+        }
+        lseek(this->file_descriptor, size, SEEK_SET);
+
+        // Allocate the buffer.
+        this->buffer.resize(ANNOTATION_WRITER_BUFFER_SIZE);
+
+        // Only the start of the json is there if nothing else was written.
+        this->size = size;
+        this->first = size == 1;
+
+    }
+
+    AnnotationWriter::~AnnotationWriter() {
+
+        // Keep whatever was written in the temporary file.
+        if (this->file_descriptor >= 0) {
+            this->flush();
+            ::close(this->file_descriptor);
+        }
+
+    }
+
+    void AnnotationWriter::writeMatrix(const float* values, int rows, int cols) {
+
+        // The separator goes before every element but the first one, so there
+        // is never anything to remove.
+        if (this->first)
+            this->first = false;
+        else
+            this->append(", ", 2);
+
+        this->append("[", 1);
+
+        for (int i = 0; i < rows; i++) {
+
+            if (i > 0)
+                this->append(", ", 2);
+
+            this->append("[", 1);
+
+            for (int j = 0; j < cols; j++) {
+
+                if (j > 0)
+                    this->append(", ", 2);
+
+                this->appendFloat(values[i * cols + j]);
+
+            }
+
+            this->append("]", 1);
+
+        }
+
+        this->append("]", 1);
+
+    }
+
+    size_t AnnotationWriter::getSize() const {
+
+        return this->size;
+
+    }
+
+    void AnnotationWriter::flush() {
+
+        // Write the whole buffer, even if it takes several calls.
+        size_t written = 0;
+        while (written < this->used) {
+
+            ssize_t result = write(this->file_descriptor, this->buffer.data() + written, this->used - written);
+            if (result < 0) {
+                std::cerr << "Could not write to the annotations file " << this->tmp_filename << std::endl;
+                this->failed = true;
+                break;
+            }
+
+            written += result;
+
+        }
+
+        this->used = 0;
+
+    }
+
+    bool AnnotationWriter::sync() {
+
+        if (this->file_descriptor < 0)
+            return false;
+
+        this->flush();
+
+        return !this->failed && fsync(this->file_descriptor) == 0;
+
+    }
+
+    bool AnnotationWriter::close() {
+
+        if (this->file_descriptor < 0)
+            return false;
+
+        // Close the array. Its end is not part of the size, so that it can be
+        // reopened after the last element.
+        this->append("]\n", 2);
+        this->flush();
+        this->size -= 2;
+
+        // Make sure everything is on the disk before replacing the final file.
+        bool success = !this->failed && fsync(this->file_descriptor) == 0;
+        ::close(this->file_descriptor);
+        this->file_descriptor = -1;
+
+        // Replace the final file in a single step.
+        if (success)
+            success = rename(this->tmp_filename.c_str(), this->filename.c_str()) == 0;
+
+        return success;
+
+    }
+
+    void AnnotationWriter::append(const char* text, size_t length) {
+
+        if (this->used + length > this->buffer.size())
+            this->flush();
+
+        memcpy(this->buffer.data() + this->used, text, length);
+        this->used += length;
+        this->size += length;
+
+    }
+
+    void AnnotationWriter::appendFloat(float value) {
+
+        // No float takes more than 32 characters.
+        if (this->used + 32 > this->buffer.size())
+            this->flush();
+
+        char* start = this->buffer.data() + this->used;
+        std::to_chars_result result = std::to_chars(start, start + 32, value);
+        this->used += result.ptr - start;
+        this->size += result.ptr - start;
+
+    }
+
+}  // namespace bgq_opengl
@@ -0,0 +1,155 @@
+/**
+ * @file annotation_writer.h
+ * @brief Annotation writer class header file.
+ * @version 1.0.0 (2024-03-10)
+ * @date 2024-03-10
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_CLASSES_ANNOTATION_WRITER_H_
+#define BGQ_OPENGL_CLASSES_ANNOTATION_WRITER_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#define ANNOTATION_WRITER_BUFFER_SIZE (1 << 20)
+
+namespace bgq_opengl {
+
+    /**
+     * @brief Implementation of an AnnotationWriter class.
+     *
+     * Implementation of a streaming writer for JSON arrays of matrices. The
+     * output is accumulated in a large buffer and written to a temporary file,
+     * which only replaces the final file once the array has been closed, so
+     * the final file is never left as invalid JSON.
+     *
+     * @author Borja García Quiroga <garcaqub@tcd.ie>
+     */
+    class AnnotationWriter {
+
+    public:
+
+        /**
+         * @brief Starts a new JSON array.
+         *
+         * Starts a new JSON array on a temporary file next to the final one.
+         *
+         * @param filename The name of the final file.
+         */
+        AnnotationWriter(const char* filename);
+
+        /**
+         * @brief Reopens an unfinished JSON array.
+         *
+         * Reopens the array of a previous run to keep adding elements to it,
+         * dropping anything written past the given size. If the array was
+         * closed, it is reopened.
+         *
+         * @param filename The name of the final file.
+         * @param size The size of the contents to keep, as given by getSize().
+         */
+        AnnotationWriter(const char* filename, size_t size);
+
+        /**
+         * @brief Destroys the writer.
+         *
+         * Flushes the pending data. If the writer has not been closed, the
+         * final file is not created.
+         */
+        ~AnnotationWriter();
+
+        AnnotationWriter(const AnnotationWriter&) = delete;
+        AnnotationWriter& operator=(const AnnotationWriter&) = delete;
+
+        /**
+         * @brief Write a matrix.
+         *
+         * Write a matrix as the next element of the array, as a list of rows.
+         *
+         * @param values The values of the matrix in row-major order.
+         * @param rows The amount of rows.
+         * @param cols The amount of columns.
+         */
+        void writeMatrix(const float* values, int rows, int cols);
+
+        /**
+         * @brief Get the size of the array.
+         *
+         * Get the size of the contents written so far, without the end of the
+         * array.
+         *
+         * @returns The size in bytes.
+         */
+        size_t getSize() const;
+
+        /**
+         * @brief Flush the writer.
+         *
+         * Write the contents of the buffer to the temporary file.
+         */
+        void flush();
+
+        /**
+         * @brief Sync the writer.
+         *
+         * Write the contents of the buffer to the temporary file and sync it
+         * to the disk, so that the array can be reopened from getSize().
+         *
+         * @returns True if everything written so far is on the disk.
+         */
+        bool sync();
+
+        /**
+         * @brief Close the writer.
+         *
+         * Close the array, sync the temporary file to the disk and rename it
+         * to the final file.
+         *
+         * @returns True if the final file was written.
+         */
+        bool close();
+
+    private:
+
+        /**
+         * @brief Append some text.
+         *
+         * Append some text to the buffer, flushing it if needed.
+         *
+         * @param text The text.
+         * @param length The length of the text.
+         */
+        void append(const char* text, size_t length);
+
+        /**
+         * @brief Append a number.
+         *
+         * Append the shortest representation of a float to the buffer.
+         *
+         * @param value The number.
+         */
+        void appendFloat(float value);
+
+        std::string filename;               /// The name of the final file.
+        std::string tmp_filename;           /// The name of the temporary file.
+        int file_descriptor = -1;           /// The temporary file.
+        std::vector<char> buffer;           /// The pending output.
+        size_t used = 0;                    /// The amount of bytes used in the buffer.
+        size_t size = 0;                    /// The amount of bytes written so far.
+        bool first = true;                  /// Whether no element has been written yet.
+        bool failed = false;                /// Whether a write has failed.
+
+    };
+
+}  // namespace bgq_opengl
+
+#endif  //!BGQ_OPENGL_CLASSES_ANNOTATION_WRITER_H_
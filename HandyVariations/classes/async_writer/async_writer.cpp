@@ -0,0 +1,141 @@
+/**
+ * @file async_writer.cpp
+ * @brief Asynchronous writer class implementation file.
+ * @version 1.0.0 (2024-03-16)
+ * @date 2024-03-16
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#include "async_writer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace bgq_opengl {
+
+    AsyncWriter::AsyncWriter(int num_threads) {
+
+        if (num_threads < 1)
+            num_threads = 1;
+
+        // Start the threads.
+        for (int i = 0; i < num_threads; i++)
+            this->threads.emplace_back(&AsyncWriter::run, this);
+
+    }
+
+    AsyncWriter::~AsyncWriter() {
+
+        this->wait();
+
+        // Tell the threads to stop and wait for them.
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->stopping = true;
+        }
+        this->job_ready.notify_all();
+
+        for (std::thread &thread : this->threads)
+            thread.join();
+
+    }
+
+    std::vector<unsigned char> AsyncWriter::acquireBuffer() {
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        if (this->pool.empty())
+            return std::vector<unsigned char>();
+
+        std::vector<unsigned char> buffer = std::move(this->pool.back());
+        this->pool.pop_back();
+
+        return buffer;
+
+    }
+
+    void AsyncWriter::submit(std::vector<unsigned char> &&buffer, Job job) {
+
+        std::unique_lock<std::mutex> lock(this->mutex);
+
+        // Wait for room in the queue, so the memory in use stays bounded.
+        if (this->pending >= ASYNC_WRITER_MAX_PENDING) {
+            this->stats.stalls++;
+            this->job_done.wait(lock, [this] { return this->pending < ASYNC_WRITER_MAX_PENDING; });
+        }
+
+        this->queue.push_back({std::move(buffer), std::move(job), std::chrono::steady_clock::now()});
+        this->pending++;
+        this->stats.max_queue_depth = std::max(this->stats.max_queue_depth, this->pending);
+
+        lock.unlock();
+        this->job_ready.notify_one();
+
+    }
+
+    void AsyncWriter::wait() {
+
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->job_done.wait(lock, [this] { return this->pending == 0; });
+
+    }
+
+    AsyncWriterStats AsyncWriter::getStats() {
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        AsyncWriterStats current = this->stats;
+        current.queue_depth = this->pending;
+        current.mean_latency = (current.completed > 0) ? this->total_latency / current.completed : 0.0;
+
+        return current;
+
+    }
+
+    void AsyncWriter::run() {
+
+        while (true) {
+
+            // Wait for a job.
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->job_ready.wait(lock, [this] { return this->stopping || !this->queue.empty(); });
+
+            if (this->queue.empty())
+                return;
+
+            PendingJob pending_job = std::move(this->queue.front());
+            this->queue.pop_front();
+            lock.unlock();
+
+            // Run it without holding the lock.
+            pending_job.job(pending_job.buffer);
+
+            double latency = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - pending_job.submitted).count();
+
+            // Give the buffer back and update the statistics.
+            lock.lock();
+            this->pool.push_back(std::move(pending_job.buffer));
+            this->pending--;
+            this->stats.completed++;
+            this->total_latency += latency;
+            this->stats.max_latency = std::max(this->stats.max_latency, latency);
+            lock.unlock();
+
+            this->job_done.notify_all();
+
+        }
+
+    }
+
+}  // namespace bgq_opengl
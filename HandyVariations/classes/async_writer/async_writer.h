@@ -0,0 +1,153 @@
+/**
+ * @file async_writer.h
+ * @brief Asynchronous writer class header file.
+ * @version 1.0.0 (2024-03-16)
+ * @date 2024-03-16
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_CLASSES_ASYNC_WRITER_H_
+#define BGQ_OPENGL_CLASSES_ASYNC_WRITER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define ASYNC_WRITER_MAX_PENDING 64
+
+namespace bgq_opengl {
+
+    /**
+     * @brief The statistics of an asynchronous writer.
+     *
+     * The statistics of an asynchronous writer since it was created.
+     */
+    struct AsyncWriterStats {
+        int queue_depth = 0;                /// The amount of jobs waiting or running.
+        int max_queue_depth = 0;            /// The highest queue depth seen.
+        long completed = 0;                 /// The amount of jobs completed.
+        long stalls = 0;                    /// The amount of times a submission had to wait.
+        double mean_latency = 0.0;          /// The mean time from submission to completion, in ms.
+        double max_latency = 0.0;           /// The highest time from submission to completion, in ms.
+    };
+
+    /**
+     * @brief Implementation of an AsyncWriter class.
+     *
+     * Implementation of a pool of threads that encode and write the outputs
+     * of the samples, so that the render loop does not wait for the disk.
+     * Every job gets a buffer that is returned to a pool once the job is
+     * done, so the buffers are reused instead of allocated for every sample.
+     * The amount of pending jobs is bounded, and submitting more than that
+     * waits for the oldest ones to finish.
+     *
+     * @author Borja García Quiroga <garcaqub@tcd.ie>
+     */
+    class AsyncWriter {
+
+    public:
+
+        /// A job, which gets the buffer it was submitted with.
+        typedef std::function<void(std::vector<unsigned char>&)> Job;
+
+        /**
+         * @brief Starts the writer.
+         *
+         * Starts the threads of the writer.
+         *
+         * @param num_threads The amount of threads.
+         */
+        AsyncWriter(int num_threads);
+
+        /**
+         * @brief Stops the writer.
+         *
+         * Waits for the pending jobs and stops the threads.
+         */
+        ~AsyncWriter();
+
+        AsyncWriter(const AsyncWriter&) = delete;
+        AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+        /**
+         * @brief Get a buffer from the pool.
+         *
+         * Get a buffer from the pool, or a new one if the pool is empty.
+         *
+         * @returns The buffer.
+         */
+        std::vector<unsigned char> acquireBuffer();
+
+        /**
+         * @brief Submit a job.
+         *
+         * Queue a job to be run on one of the threads. The buffer is moved to
+         * the job and returned to the pool afterwards.
+         *
+         * @param buffer The buffer of the job.
+         * @param job The job.
+         */
+        void submit(std::vector<unsigned char> &&buffer, Job job);
+
+        /**
+         * @brief Wait for the pending jobs.
+         *
+         * Wait until every job submitted so far has finished.
+         */
+        void wait();
+
+        /**
+         * @brief Get the statistics.
+         *
+         * Get the statistics of the writer.
+         *
+         * @returns The statistics.
+         */
+        AsyncWriterStats getStats();
+
+    private:
+
+        /**
+         * @brief A job waiting in the queue.
+         */
+        struct PendingJob {
+            std::vector<unsigned char> buffer;                      /// The buffer of the job.
+            Job job;                                                /// The job.
+            std::chrono::steady_clock::time_point submitted;        /// When the job was submitted.
+        };
+
+        /**
+         * @brief Run the jobs.
+         *
+         * The loop of each of the threads.
+         */
+        void run();
+
+        std::vector<std::thread> threads;                   /// The threads.
+        std::deque<PendingJob> queue;                       /// The jobs waiting for a thread.
+        std::vector<std::vector<unsigned char>> pool;       /// The buffers ready to be reused.
+        std::mutex mutex;                                   /// Protects everything below.
+        std::condition_variable job_ready;                  /// Signals a new job or the end.
+        std::condition_variable job_done;                   /// Signals a finished job.
+        int pending = 0;                                    /// The amount of jobs waiting or running.
+        bool stopping = false;                              /// Whether the threads have to stop.
+        AsyncWriterStats stats;                             /// The statistics.
+        double total_latency = 0.0;                         /// The sum of the latencies, in ms.
+
+    };
+
+}  // namespace bgq_opengl
+
+#endif  //!BGQ_OPENGL_CLASSES_ASYNC_WRITER_H_
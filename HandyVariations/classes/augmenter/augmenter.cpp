@@ -0,0 +1,449 @@
+/**
+ * @file augmenter.cpp
+ * @brief Augmenter class implementation file.
+ * @version 1.0.0 (2024-03-24)
+ * @date 2024-03-24
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#include "augmenter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// The weights of the blur are fixed point numbers with this many fractional
+// bits, and those of the colour jitter with the second.
+#define BLUR_PRECISION 14
+#define COLOUR_PRECISION 12
+
+namespace bgq_opengl {
+
+    namespace {
+
+        // Add up the bytes at some distance of each other with some weights.
+        void convolveScalar(const unsigned char* input, size_t stride, int count, const int16_t* weights, size_t begin, size_t size, unsigned char* output) {
+
+            for (size_t i = begin; i < size; i++) {
+
+                int sum = 1 << (BLUR_PRECISION - 1);
+                for (int k = 0; k < count; k++)
+                    sum += input[i + k * stride] * weights[k];
+
+                output[i] = (unsigned char) std::clamp(sum >> BLUR_PRECISION, 0, 255);
+
+            }
+
+        }
+
+        // Add the noise, which has a standard deviation of 16, scaled by the
+        // amount over 256.
+        void addNoiseScalar(unsigned char* pixels, const int8_t* noise, int amount, size_t begin, size_t size) {
+
+            for (size_t i = begin; i < size; i++)
+                pixels[i] = (unsigned char) std::clamp(pixels[i] + ((noise[i] * amount + 128) >> 8), 0, 255);
+
+        }
+
+#if defined(__x86_64__) || defined(__i386__)
+
+        // Built for AVX2 whatever the flags of the build, and only called if
+        // the processor has it.
+        __attribute__((target("avx2")))
+        void convolveAVX2(const unsigned char* input, size_t stride, int count, const int16_t* weights, size_t size, unsigned char* output) {
+
+            const __m256i rounding = _mm256_set1_epi32(1 << (BLUR_PRECISION - 1));
+            const __m256i zero = _mm256_setzero_si256();
+
+            // Sixteen bytes at a time, two taps at a time, so that each
+            // multiply-add takes a byte of both taps with their weights.
+            size_t i = 0;
+            for (; i + 16 <= size; i += 16) {
+
+                __m256i low = rounding;
+                __m256i high = rounding;
+
+                for (int k = 0; k < count; k += 2) {
+
+                    const unsigned char* tap = input + i + k * stride;
+                    __m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) tap));
+                    __m256i b = zero;
+                    uint16_t weight_b = 0;
+
+                    if (k + 1 < count) {
+                        b = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) (tap + stride)));
+                        weight_b = (uint16_t) weights[k + 1];
+                    }
+
+                    __m256i pair = _mm256_set1_epi32((int) (((uint32_t) weight_b << 16) | (uint16_t) weights[k]));
+                    low = _mm256_add_epi32(low, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), pair));
+                    high = _mm256_add_epi32(high, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), pair));
+
+                }
+
+                // Saturate down to bytes, and put the 8 bytes of each half
+                // together.
+                low = _mm256_srai_epi32(low, BLUR_PRECISION);
+                high = _mm256_srai_epi32(high, BLUR_PRECISION);
+                __m256i result = _mm256_packus_epi16(_mm256_packs_epi32(low, high), zero);
+                result = _mm256_permute4x64_epi64(result, 0x08);
+                _mm_storeu_si128((__m128i*) (output + i), _mm256_castsi256_si128(result));
+
+            }
+
+            // The bytes left.
+            convolveScalar(input, stride, count, weights, i, size, output);
+
+        }
+
+        __attribute__((target("avx2")))
+        void addNoiseAVX2(unsigned char* pixels, const int8_t* noise, int amount, size_t size) {
+
+            const __m256i scale = _mm256_set1_epi16((short) amount);
+            const __m256i half = _mm256_set1_epi16(128);
+
+            // Thirty-two bytes at a time, in two halves of 16 bits.
+            size_t i = 0;
+            for (; i + 32 <= size; i += 32) {
+
+                __m256i values = _mm256_loadu_si256((const __m256i*) (pixels + i));
+                __m256i offsets = _mm256_loadu_si256((const __m256i*) (noise + i));
+                __m256i halves[2];
+
+                for (int h = 0; h < 2; h++) {
+                    __m128i value = h ? _mm256_extracti128_si256(values, 1) : _mm256_castsi256_si128(values);
+                    __m128i offset = h ? _mm256_extracti128_si256(offsets, 1) : _mm256_castsi256_si128(offsets);
+                    __m256i delta = _mm256_srai_epi16(_mm256_add_epi16(_mm256_mullo_epi16(_mm256_cvtepi8_epi16(offset), scale), half), 8);
+                    halves[h] = _mm256_add_epi16(_mm256_cvtepu8_epi16(value), delta);
+                }
+
+                // Saturate down to bytes, and undo the interleaving of the
+                // halves by the packing.
+                __m256i result = _mm256_permute4x64_epi64(_mm256_packus_epi16(halves[0], halves[1]), 0xD8);
+                _mm256_storeu_si256((__m256i*) (pixels + i), result);
+
+            }
+
+            // The bytes left.
+            addNoiseScalar(pixels, noise, amount, i, size);
+
+        }
+
+#elif defined(__ARM_NEON)
+
+        void convolveNEON(const unsigned char* input, size_t stride, int count, const int16_t* weights, size_t size, unsigned char* output) {
+
+            // Eight bytes at a time.
+            size_t i = 0;
+            for (; i + 8 <= size; i += 8) {
+
+                int32x4_t low = vdupq_n_s32(1 << (BLUR_PRECISION - 1));
+                int32x4_t high = low;
+
+                for (int k = 0; k < count; k++) {
+                    int16x8_t tap = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(input + i + k * stride)));
+                    low = vmlal_n_s16(low, vget_low_s16(tap), weights[k]);
+                    high = vmlal_n_s16(high, vget_high_s16(tap), weights[k]);
+                }
+
+                int16x8_t result = vcombine_s16(vqshrn_n_s32(low, BLUR_PRECISION), vqshrn_n_s32(high, BLUR_PRECISION));
+                vst1_u8(output + i, vqmovun_s16(result));
+
+            }
+
+            // The bytes left.
+            convolveScalar(input, stride, count, weights, i, size, output);
+
+        }
+
+        void addNoiseNEON(unsigned char* pixels, const int8_t* noise, int amount, size_t size) {
+
+            const int16x8_t half = vdupq_n_s16(128);
+
+            // Sixteen bytes at a time, in two halves of 16 bits.
+            size_t i = 0;
+            for (; i + 16 <= size; i += 16) {
+
+                uint8x16_t values = vld1q_u8(pixels + i);
+                int8x16_t offsets = vld1q_s8(noise + i);
+
+                int16x8_t low = vshrq_n_s16(vmlaq_n_s16(half, vmovl_s8(vget_low_s8(offsets)), (int16_t) amount), 8);
+                int16x8_t high = vshrq_n_s16(vmlaq_n_s16(half, vmovl_s8(vget_high_s8(offsets)), (int16_t) amount), 8);
+                low = vaddq_s16(low, vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(values))));
+                high = vaddq_s16(high, vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(values))));
+
+                vst1q_u8(pixels + i, vcombine_u8(vqmovun_s16(low), vqmovun_s16(high)));
+
+            }
+
+            // The bytes left.
+            addNoiseScalar(pixels, noise, amount, i, size);
+
+        }
+
+#endif
+
+        void convolve(const unsigned char* input, size_t stride, int count, const int16_t* weights, size_t size, unsigned char* output) {
+
+#if defined(__x86_64__) || defined(__i386__)
+            static const bool has_avx2 = __builtin_cpu_supports("avx2");
+            if (has_avx2) {
+                convolveAVX2(input, stride, count, weights, size, output);
+                return;
+            }
+#elif defined(__ARM_NEON)
+            convolveNEON(input, stride, count, weights, size, output);
+            return;
+#endif
+
+            convolveScalar(input, stride, count, weights, 0, size, output);
+
+        }
+
+        void addNoise(unsigned char* pixels, const int8_t* noise, int amount, size_t size) {
+
+#if defined(__x86_64__) || defined(__i386__)
+            static const bool has_avx2 = __builtin_cpu_supports("avx2");
+            if (has_avx2) {
+                addNoiseAVX2(pixels, noise, amount, size);
+                return;
+            }
+#elif defined(__ARM_NEON)
+            addNoiseNEON(pixels, noise, amount, size);
+            return;
+#endif
+
+            addNoiseScalar(pixels, noise, amount, 0, size);
+
+        }
+
+    }  // namespace
+
+    Augmenter::Augmenter(int width, int height) {
+
+        this->width = width;
+        this->height = height;
+
+        // Draw the noise once, with a fixed seed. Each sample starts reading
+        // it at its own offset.
+        std::mt19937 generator(0x48564147);
+        std::normal_distribution<float> distribution(0.0f, 16.0f);
+
+        this->noise.resize(AUGMENTER_NOISE_OFFSETS + (size_t) width * height * 3);
+        for (int8_t &value : this->noise)
+            value = (int8_t) std::clamp((int) std::lround(distribution(generator)), -127, 127);
+
+    }
+
+    void Augmenter::augment(const std::vector<unsigned char> &input, const Augmentation &augmentation, std::vector<unsigned char> &output) const {
+
+        size_t size = (size_t) this->width * this->height * 3;
+        output.resize(size);
+
+        // Move the image and jitter its colours in a single pass.
+        this->warp(input.data(), augmentation, output.data());
+
+        // Blur it like a camera out of focus would.
+        if (augmentation.blur > 0.0f)
+            this->blur(output.data(), augmentation.blur);
+
+        // Then add the noise of the sensor.
+        int amount = std::clamp((int) std::lround(augmentation.noise * 16.0f), 0, 255);
+        if (amount > 0)
+            addNoise(output.data(), this->noise.data() + augmentation.noise_offset % AUGMENTER_NOISE_OFFSETS, amount, size);
+
+    }
+
+    void Augmenter::transformKeypoints(const std::vector<float> &annotations, const Augmentation &augmentation, std::vector<float> &transformed) const {
+
+        float affine[6];
+        this->getAffine(augmentation, affine);
+
+        transformed.resize(annotations.size());
+        for (size_t i = 0; i + 2 < annotations.size(); i += 3) {
+            transformed[i] = affine[0] * annotations[i] + affine[1] * annotations[i + 1] + affine[2];
+            transformed[i + 1] = affine[3] * annotations[i] + affine[4] * annotations[i + 1] + affine[5];
+            transformed[i + 2] = annotations[i + 2];
+        }
+
+    }
+
+    const char* Augmenter::getInstructionSet() {
+
+#if defined(__x86_64__) || defined(__i386__)
+        return __builtin_cpu_supports("avx2") ? "AVX2" : "scalar";
+#elif defined(__ARM_NEON)
+        return "NEON";
+#else
+        return "scalar";
+#endif
+
+    }
+
+    void Augmenter::getAffine(const Augmentation &augmentation, float affine[6]) const {
+
+        float angle = augmentation.rotation * (float) M_PI / 180.0f;
+        float cosine = augmentation.scale * std::cos(angle);
+        float sine = augmentation.scale * std::sin(angle);
+        float center_x = this->width * 0.5f;
+        float center_y = this->height * 0.5f;
+
+        // Scale and rotate around the centre, with y pointing down, and then
+        // move.
+        affine[0] = cosine;
+        affine[1] = sine;
+        affine[2] = center_x - cosine * center_x - sine * center_y + augmentation.offset_x * this->width;
+        affine[3] = -sine;
+        affine[4] = cosine;
+        affine[5] = center_y + sine * center_x - cosine * center_y + augmentation.offset_y * this->height;
+
+    }
+
+    void Augmenter::warp(const unsigned char* input, const Augmentation &augmentation, unsigned char* output) const {
+
+        // Invert the transform, to find where each output pixel comes from.
+        float affine[6];
+        this->getAffine(augmentation, affine);
+
+        float determinant = affine[0] * affine[4] - affine[1] * affine[3];
+        float inverse[6] = {
+            affine[4] / determinant, -affine[1] / determinant, (affine[1] * affine[5] - affine[4] * affine[2]) / determinant,
+            -affine[3] / determinant, affine[0] / determinant, (affine[3] * affine[2] - affine[0] * affine[5]) / determinant
+        };
+
+        // Combine the saturation around the luma, the contrast around mid
+        // grey and the brightness into a single colour transform.
+        const float luma[3] = {0.299f, 0.587f, 0.114f};
+        float gain = augmentation.brightness * augmentation.contrast;
+        int matrix[3][3];
+        int offset = (int) std::lround(augmentation.brightness * 128.0f * (1.0f - augmentation.contrast) * (1 << COLOUR_PRECISION));
+
+        for (int c = 0; c < 3; c++)
+            for (int k = 0; k < 3; k++)
+                matrix[c][k] = (int) std::lround(gain * ((c == k) * augmentation.saturation + (1.0f - augmentation.saturation) * luma[k]) * (1 << COLOUR_PRECISION));
+
+        // The last pixel that can be interpolated with the next one.
+        int last_column = std::max(this->width - 2, 0);
+        int last_row = std::max(this->height - 2, 0);
+        int next_column = this->width > 1 ? 3 : 0;
+        size_t row_size = (size_t) this->width * 3;
+        size_t next_row = this->height > 1 ? row_size : 0;
+
+        for (int y = 0; y < this->height; y++) {
+
+            // The rows are bottom first, and the transform works top first.
+            float top_y = this->height - y - 0.5f;
+            float source_x = inverse[0] * 0.5f + inverse[1] * top_y + inverse[2] - 0.5f;
+            float source_y = this->height - (inverse[3] * 0.5f + inverse[4] * top_y + inverse[5]) - 0.5f;
+            unsigned char* destination = output + y * row_size;
+
+            for (int x = 0; x < this->width; x++, source_x += inverse[0], source_y -= inverse[3]) {
+
+                // Leave black what comes from outside the image.
+                if (source_x < -0.5f || source_x > this->width - 0.5f || source_y < -0.5f || source_y > this->height - 0.5f) {
+                    memset(destination + x * 3, 0, 3);
+                    continue;
+                }
+
+                float clamped_x = std::clamp(source_x, 0.0f, (float) (this->width - 1));
+                float clamped_y = std::clamp(source_y, 0.0f, (float) (this->height - 1));
+                int column = std::min((int) clamped_x, last_column);
+                int row = std::min((int) clamped_y, last_row);
+                int weight_x = (int) ((clamped_x - column) * 256.0f);
+                int weight_y = (int) ((clamped_y - row) * 256.0f);
+
+                // Interpolate in 8 bit fixed point.
+                const unsigned char* a = input + row * row_size + column * 3;
+                const unsigned char* b = a + next_row;
+                int colour[3];
+
+                for (int c = 0; c < 3; c++) {
+                    int upper = a[c] * (256 - weight_x) + a[c + next_column] * weight_x;
+                    int lower = b[c] * (256 - weight_x) + b[c + next_column] * weight_x;
+                    colour[c] = (upper * (256 - weight_y) + lower * weight_y + 32768) >> 16;
+                }
+
+                // Jitter the colour.
+                for (int c = 0; c < 3; c++) {
+                    int value = matrix[c][0] * colour[0] + matrix[c][1] * colour[1] + matrix[c][2] * colour[2] + offset;
+                    destination[x * 3 + c] = (unsigned char) std::clamp((value + (1 << (COLOUR_PRECISION - 1))) >> COLOUR_PRECISION, 0, 255);
+                }
+
+            }
+
+        }
+
+    }
+
+    void Augmenter::blur(unsigned char* pixels, float sigma) const {
+
+        int radius = std::min((int) std::ceil(3.0f * sigma), AUGMENTER_MAX_BLUR_RADIUS);
+        if (radius < 1)
+            return;
+
+        // Get the weights of the kernel.
+        int count = 2 * radius + 1;
+        float values[2 * AUGMENTER_MAX_BLUR_RADIUS + 1];
+        float total = 0.0f;
+
+        for (int k = 0; k < count; k++) {
+            values[k] = std::exp(-0.5f * (k - radius) * (k - radius) / (sigma * sigma));
+            total += values[k];
+        }
+
+        int16_t weights[2 * AUGMENTER_MAX_BLUR_RADIUS + 1];
+        for (int k = 0; k < count; k++)
+            weights[k] = (int16_t) std::lround(values[k] / total * (1 << BLUR_PRECISION));
+
+        size_t row_size = (size_t) this->width * 3;
+        size_t edge_size = (size_t) radius * 3;
+        thread_local std::vector<unsigned char> padded_row;
+        thread_local std::vector<unsigned char> rows;
+        padded_row.resize(row_size + 2 * edge_size);
+        rows.resize(row_size * (this->height + 2 * radius));
+
+        // Blur each row, with its first and last pixels repeated, into a copy
+        // with room for the first and last rows repeated. The neighbours in a
+        // row are 3 bytes away.
+        for (int y = 0; y < this->height; y++) {
+
+            const unsigned char* row = pixels + y * row_size;
+
+            for (int k = 0; k < radius; k++) {
+                memcpy(padded_row.data() + k * 3, row, 3);
+                memcpy(padded_row.data() + edge_size + row_size + k * 3, row + row_size - 3, 3);
+            }
+
+            memcpy(padded_row.data() + edge_size, row, row_size);
+            convolve(padded_row.data(), 3, count, weights, row_size, rows.data() + (y + radius) * row_size);
+
+        }
+
+        for (int k = 0; k < radius; k++) {
+            memcpy(rows.data() + k * row_size, rows.data() + radius * row_size, row_size);
+            memcpy(rows.data() + (this->height + radius + k) * row_size, rows.data() + (this->height + radius - 1) * row_size, row_size);
+        }
+
+        // Then blur the columns back into the image. The neighbours in a
+        // column are a row away.
+        for (int y = 0; y < this->height; y++)
+            convolve(rows.data() + y * row_size, row_size, count, weights, row_size, pixels + y * row_size);
+
+    }
+
+}  // namespace bgq_opengl
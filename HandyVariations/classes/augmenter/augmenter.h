@@ -0,0 +1,136 @@
+/**
+ * @file augmenter.h
+ * @brief Augmenter class header file.
+ * @version 1.0.0 (2024-03-24)
+ * @date 2024-03-24
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_CLASSES_AUGMENTER_H_
+#define BGQ_OPENGL_CLASSES_AUGMENTER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "structs/augmentation/augmentation.h"
+
+#define AUGMENTER_NOISE_OFFSETS 65536
+#define AUGMENTER_MAX_BLUR_RADIUS 6
+
+namespace bgq_opengl {
+
+    /**
+     * @brief Implementation of an Augmenter class.
+     *
+     * Implementation of the augmentation of the RGB8 images read back from
+     * OpenGL, bottom row first, so that a single render gives several
+     * samples. The image is scaled, rotated and moved with the colours jittered
+     * in the same pass, then blurred and made noisy. The keypoints go through
+     * the same affine transform. The blur and the noise use AVX2 or NEON when
+     * available, and every path gives exactly the same result. Augmenting is
+     * thread safe.
+     *
+     * @author Borja García Quiroga <garcaqub@tcd.ie>
+     */
+    class Augmenter {
+
+    public:
+
+        /**
+         * @brief Creates a new augmenter.
+         *
+         * Creates a new augmenter for images of a given size, and its table
+         * of Gaussian noise.
+         *
+         * @param width The width of the images.
+         * @param height The height of the images.
+         */
+        Augmenter(int width, int height);
+
+        /**
+         * @brief Augment an image.
+         *
+         * Augment some tightly packed RGB8 pixels, bottom row first. The
+         * pixels that come from outside the image are black.
+         *
+         * @param input The pixels of the image.
+         * @param augmentation The augmentation.
+         * @param output Output vector for the pixels of the augmented image.
+         */
+        void augment(const std::vector<unsigned char> &input, const Augmentation &augmentation, std::vector<unsigned char> &output) const;
+
+        /**
+         * @brief Transform some keypoints.
+         *
+         * Move some keypoints, in pixels from the top left corner, to where
+         * the augmentation puts them.
+         *
+         * @param annotations The x, y and z of each keypoint.
+         * @param augmentation The augmentation.
+         * @param transformed Output vector for the moved keypoints.
+         */
+        void transformKeypoints(const std::vector<float> &annotations, const Augmentation &augmentation, std::vector<float> &transformed) const;
+
+        /**
+         * @brief Get the instruction set.
+         *
+         * Get the name of the instructions the blur and the noise use on this
+         * processor.
+         *
+         * @returns The name of the instruction set.
+         */
+        static const char* getInstructionSet();
+
+    private:
+
+        /**
+         * @brief Get the affine transform of an augmentation.
+         *
+         * Get the transform that takes a point of the image, in pixels from
+         * the top left corner, to where the augmentation puts it.
+         *
+         * @param augmentation The augmentation.
+         * @param affine Output array for the 2x3 matrix, row by row.
+         */
+        void getAffine(const Augmentation &augmentation, float affine[6]) const;
+
+        /**
+         * @brief Warp and recolour an image.
+         *
+         * Sample the input bilinearly through the inverse of the affine
+         * transform and apply the colour jitter in fixed point.
+         *
+         * @param input The pixels of the image.
+         * @param augmentation The augmentation.
+         * @param output The pixels of the augmented image.
+         */
+        void warp(const unsigned char* input, const Augmentation &augmentation, unsigned char* output) const;
+
+        /**
+         * @brief Blur an image.
+         *
+         * Blur an image in place with a separable Gaussian, with the edges
+         * repeated.
+         *
+         * @param pixels The pixels of the image.
+         * @param sigma The standard deviation of the blur, in pixels.
+         */
+        void blur(unsigned char* pixels, float sigma) const;
+
+        int width;                          /// The width of the images.
+        int height;                         /// The height of the images.
+        std::vector<int8_t> noise;          /// Gaussian noise with a standard deviation of 16, long enough for an image from any offset.
+
+    };
+
+}  // namespace bgq_opengl
+
+#endif  //!BGQ_OPENGL_CLASSES_AUGMENTER_H_
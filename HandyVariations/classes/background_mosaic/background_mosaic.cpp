@@ -0,0 +1,134 @@
+/**
+ * @file background_mosaic.cpp
+ * @brief BackgroundMosaic class implementation file.
+ * @version 1.0.0 (2024-03-23)
+ * @date 2024-03-23
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#include "background_mosaic.h"
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "GL/glew.h"
+#include "glm/glm.hpp"
+#include "stb/stb_image.h"
+
+#include "classes/compositor/compositor.h"
+
+namespace bgq_opengl {
+
+    BackgroundMosaic::BackgroundMosaic(const std::vector<std::string> &files) {
+
+        const int tiles_per_texture = MOSAIC_TILES_PER_SIDE * MOSAIC_TILES_PER_SIDE;
+        const int texture_size = MOSAIC_TILES_PER_SIDE * MOSAIC_TILE_SIZE;
+
+        this->num_of_images = (int) files.size();
+        this->textures.resize((files.size() + tiles_per_texture - 1) / tiles_per_texture);
+
+        // The images are scaled to their tiles as the backgrounds of the
+        // compositor are, as the largest square crop of their centre.
+        BackgroundCrop whole_image;
+        std::vector<unsigned char> tile((size_t) MOSAIC_TILE_SIZE * MOSAIC_TILE_SIZE * 4);
+        stbi_set_flip_vertically_on_load_thread(1);
+
+        for (size_t t = 0; t < this->textures.size(); t++) {
+
+            // Create the texture, black until the images are in.
+            std::vector<unsigned char> black((size_t) texture_size * texture_size * 4, 0);
+            glGenTextures(1, &this->textures[t]);
+            glBindTexture(GL_TEXTURE_2D, this->textures[t]);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, texture_size, texture_size, 0, GL_RGBA, GL_UNSIGNED_BYTE, black.data());
+
+            // Copy each image into its tile.
+            for (int i = 0; i < tiles_per_texture; i++) {
+
+                size_t image = t * tiles_per_texture + i;
+                if (image >= files.size())
+                    break;
+
+                int width, height, channels;
+                unsigned char* bytes = stbi_load(files[image].c_str(), &width, &height, &channels, 3);
+                if (bytes == nullptr) {
+                    std::cerr << "Could not load the background " << files[image] << std::endl;
+                    continue;
+                }
+
+                Compositor::cropBackground(bytes, width, height, whole_image, MOSAIC_TILE_SIZE, MOSAIC_TILE_SIZE, tile.data());
+                stbi_image_free(bytes);
+
+                glTexSubImage2D(GL_TEXTURE_2D, 0, (i % MOSAIC_TILES_PER_SIDE) * MOSAIC_TILE_SIZE, (i / MOSAIC_TILES_PER_SIDE) * MOSAIC_TILE_SIZE, MOSAIC_TILE_SIZE, MOSAIC_TILE_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, tile.data());
+
+            }
+
+            // The crops are usually minified, so they need the mipmaps.
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glGenerateMipmap(GL_TEXTURE_2D);
+
+        }
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+    }
+
+    void BackgroundMosaic::bind(int image, GLuint unit) const {
+
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, this->textures[image / (MOSAIC_TILES_PER_SIDE * MOSAIC_TILES_PER_SIDE)]);
+
+    }
+
+    glm::mat3 BackgroundMosaic::getCropTransform(const BackgroundCrop &crop) const {
+
+        // Get the corner and size of the tile of the image in its texture.
+        int tile = crop.image % (MOSAIC_TILES_PER_SIDE * MOSAIC_TILES_PER_SIDE);
+        float tile_size = 1.0f / MOSAIC_TILES_PER_SIDE;
+        glm::vec2 tile_corner = glm::vec2((float) (tile % MOSAIC_TILES_PER_SIDE), (float) (tile / MOSAIC_TILES_PER_SIDE)) * tile_size;
+
+        // A square of this side fits the tile for any rotation, and its
+        // centre can move as far as it keeps fitting.
+        float side = 1.0f / (crop.scale * std::sqrt(2.0f));
+        float margin = 0.5f / crop.scale;
+        glm::vec2 centre(margin + (1.0f - 2.0f * margin) * crop.offset_x, margin + (1.0f - 2.0f * margin) * crop.offset_y);
+
+        // Scale, flip and rotate the coordinates around the centre of the
+        // background, in tile units.
+        float angle = glm::radians(crop.rotation);
+        float flip = crop.flip ? -1.0f : 1.0f;
+        glm::vec2 x_axis = glm::vec2(std::cos(angle), std::sin(angle)) * (side * flip * tile_size);
+        glm::vec2 y_axis = glm::vec2(-std::sin(angle), std::cos(angle)) * (side * tile_size);
+
+        // Move the centre of the background to the centre of the crop.
+        glm::vec2 origin = tile_corner + centre * tile_size - (x_axis + y_axis) * 0.5f;
+
+        return glm::mat3(glm::vec3(x_axis, 0.0f), glm::vec3(y_axis, 0.0f), glm::vec3(origin, 1.0f));
+
+    }
+
+    int BackgroundMosaic::getNumOfImages() const {
+
+        return this->num_of_images;
+
+    }
+
+    void BackgroundMosaic::remove() {
+
+        // Delete the textures in OpenGL.
+        glDeleteTextures((GLsizei) this->textures.size(), this->textures.data());
+
+    }
+
+}  // namespace bgq_opengl
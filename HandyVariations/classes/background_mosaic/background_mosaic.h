@@ -0,0 +1,106 @@
+/**
+ * @file background_mosaic.h
+ * @brief BackgroundMosaic class header file.
+ * @version 1.0.0 (2024-03-23)
+ * @date 2024-03-23
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_CLASSES_BACKGROUND_MOSAIC_H_
+#define BGQ_OPENGL_CLASSES_BACKGROUND_MOSAIC_H_
+
+#include <string>
+#include <vector>
+
+#include "GL/glew.h"
+#include "glm/glm.hpp"
+
+#include "structs/background_crop/background_crop.h"
+
+#define MOSAIC_TILE_SIZE 512
+#define MOSAIC_TILES_PER_SIDE 4
+
+namespace bgq_opengl {
+
+    /**
+     * @brief Implementation of a BackgroundMosaic class.
+     *
+     * Implementation of a set of background images that are loaded once into
+     * a few large textures and stay in the GPU for the whole run. Each
+     * texture holds a grid of MOSAIC_TILES_PER_SIDE x MOSAIC_TILES_PER_SIDE
+     * images, each of them scaled to MOSAIC_TILE_SIZE pixels. The backgrounds
+     * are crops of these images, so nothing is loaded while rendering.
+     *
+     * @author Borja García Quiroga <garcaqub@tcd.ie>
+     */
+    class BackgroundMosaic {
+
+    public:
+
+        /**
+         * @brief Creates a new mosaic.
+         *
+         * Load the images into the textures of the mosaic. An image that
+         * cannot be loaded leaves its tile black.
+         *
+         * @param files The files of the images.
+         */
+        BackgroundMosaic(const std::vector<std::string> &files);
+
+        /**
+         * @brief Bind the texture of an image.
+         *
+         * Bind the texture that holds an image to a texture unit.
+         *
+         * @param image The index of the image.
+         * @param unit The texture unit.
+         */
+        void bind(int image, GLuint unit) const;
+
+        /**
+         * @brief Get the transform of a crop.
+         *
+         * Get the transform from the texture coordinates of the background to
+         * the coordinates of a crop in the texture of its image. The crop is
+         * rotated around its centre, and is small enough to stay inside its
+         * tile for any rotation.
+         *
+         * @param crop The crop.
+         *
+         * @returns The 2D affine transform.
+         */
+        glm::mat3 getCropTransform(const BackgroundCrop &crop) const;
+
+        /**
+         * @brief Get the amount of images.
+         *
+         * Get the amount of images in the mosaic.
+         *
+         * @returns The amount of images.
+         */
+        int getNumOfImages() const;
+
+        /**
+         * @brief Removes the mosaic.
+         *
+         * Removes the textures of the mosaic from OpenGL.
+         */
+        void remove();
+
+    private:
+
+        std::vector<GLuint> textures;       /// The GL IDs of the textures.
+        int num_of_images;                  /// The amount of images.
+
+    };
+
+}  // namespace bgq_opengl
+
+#endif  //!BGQ_OPENGL_CLASSES_BACKGROUND_MOSAIC_H_
@@ -0,0 +1,74 @@
+/**
+ * @file checkpoint.cpp
+ * @brief Checkpoint class implementation file.
+ * @version 1.0.0 (2024-03-14)
+ * @date 2024-03-14
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#include "checkpoint.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#define CHECKPOINT_MAGIC "HVCK"
+#define CHECKPOINT_VERSION 1
+
+namespace bgq_opengl {
+
+    CheckpointState Checkpoint::create() {
+
+        CheckpointState state;
+        memset(&state, 0, sizeof(CheckpointState));
+        memcpy(state.magic, CHECKPOINT_MAGIC, 4);
+        state.version = CHECKPOINT_VERSION;
+
+        return state;
+
+    }
+
+    bool Checkpoint::save(const char* filename, const CheckpointState &state) {
+
+        std::string tmp_filename = std::string(filename) + ".tmp";
+
+        // Write the new checkpoint next to the previous one.
+        int file_descriptor = open(tmp_filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (file_descriptor < 0)
+            return false;
+
+        bool success = write(file_descriptor, &state, sizeof(CheckpointState)) == (ssize_t) sizeof(CheckpointState);
+        success = success && fsync(file_descriptor) == 0;
+        close(file_descriptor);
+
+        // Replace the previous one in a single step.
+        return success && rename(tmp_filename.c_str(), filename) == 0;
+
+    }
+
+    bool Checkpoint::load(const char* filename, CheckpointState &state) {
+
+        std::ifstream file(filename, std::ios::in | std::ios::binary);
+        if (!file.is_open())
+            return false;
+
+        file.read((char*) &state, sizeof(CheckpointState));
+        size_t size = (size_t) file.gcount();
+
+        return size == sizeof(CheckpointState) && memcmp(state.magic, CHECKPOINT_MAGIC, 4) == 0 &&
+               state.version == CHECKPOINT_VERSION;
+
+    }
+
+}  // namespace bgq_opengl
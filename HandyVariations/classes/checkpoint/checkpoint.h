@@ -0,0 +1,112 @@
+/**
+ * @file checkpoint.h
+ * @brief Checkpoint class header file.
+ * @version 1.0.0 (2024-03-14)
+ * @date 2024-03-14
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_CLASSES_CHECKPOINT_H_
+#define BGQ_OPENGL_CLASSES_CHECKPOINT_H_
+
+#include <cstdint>
+
+#include "structs/shard_state/shard_state.h"
+
+namespace bgq_opengl {
+
+    /**
+     * @brief The state of a run at a checkpoint.
+     *
+     * The state of a run at a point where everything before frame_count is on
+     * the disk, along with where each shard writer was. The variations are derived from the seed and
+     * the frame id, so this is all the random state there is.
+     */
+    struct CheckpointState {
+        char magic[4];                      /// Always "HVCK".
+        uint32_t version;                   /// The version of the format.
+        uint64_t seed;                      /// The seed of the dataset.
+        int32_t frame_count;                /// The amount of frames completely written.
+        int32_t dataset_size;               /// The amount of frames in the dataset.
+        int32_t num_of_variations[7];       /// The size of each of the variation tables.
+        int32_t num_of_camera_params;       /// The amount of camera configurations.
+        int32_t window_width;               /// The width of the images.
+        int32_t window_height;              /// The height of the images.
+        int32_t output_format;              /// The way the images are stored.
+        int32_t tensor_layout;              /// The layout of the tensor shards.
+        int32_t samples_per_shard;          /// The amount of samples in each shard.
+        int32_t store_json_annotations;     /// Whether the json annotations are written.
+        uint32_t finished;                  /// 1 if the dataset is complete.
+        uint64_t annotations_json_size;     /// The valid size of training_xyz.json.
+        uint64_t k_matrices_json_size;      /// The valid size of training_K.json.
+        int32_t appearance_variants;        /// The amount of consecutive frames that share a pose.
+        int32_t num_of_composites;          /// The amount of backgrounds each render is composited over.
+        int32_t output_widths[4];           /// The widths of the smaller copies of the images, 0 when unused.
+        int32_t resample_filter;            /// The filter the copies are resampled with.
+        int32_t num_of_augmentations;       /// The amount of augmented samples per render.
+        int32_t sensor_effects;             /// The sensor effects applied to the renders.
+        int32_t heatmap_size;               /// The size of the training heatmaps, 0 when unused.
+        int32_t heatmap_type;               /// The type of the elements of the heatmaps.
+        ShardState images;                  /// The progress of the shards of the images.
+        ShardState heatmaps;                /// The progress of the heatmap shards.
+        ShardState output_levels[4];        /// The progress of the shards of the smaller copies.
+    };
+
+    /**
+     * @brief Implementation of a Checkpoint class.
+     *
+     * Implementation of the reading and writing of the checkpoints that allow
+     * resuming and extending a dataset.
+     *
+     * @author Borja García Quiroga <garcaqub@tcd.ie>
+     */
+    class Checkpoint {
+
+    public:
+
+        /**
+         * @brief Create an empty state.
+         *
+         * Create a state with the magic and version already filled in.
+         *
+         * @returns The state.
+         */
+        static CheckpointState create();
+
+        /**
+         * @brief Save a checkpoint.
+         *
+         * Save a checkpoint atomically, by writing it to a temporary file that
+         * then replaces the previous checkpoint.
+         *
+         * @param filename The name of the checkpoint file.
+         * @param state The state of the run.
+         *
+         * @returns True if the checkpoint was saved.
+         */
+        static bool save(const char* filename, const CheckpointState &state);
+
+        /**
+         * @brief Load a checkpoint.
+         *
+         * Load and check a checkpoint.
+         *
+         * @param filename The name of the checkpoint file.
+         * @param state Output variable for the state of the run.
+         *
+         * @returns True if a valid checkpoint was loaded.
+         */
+        static bool load(const char* filename, CheckpointState &state);
+
+    };
+
+}  // namespace bgq_opengl
+
+#endif  //!BGQ_OPENGL_CLASSES_CHECKPOINT_H_
@@ -0,0 +1,258 @@
+/**
+ * @file compositor.cpp
+ * @brief Compositor class implementation file.
+ * @version 1.0.0 (2024-03-22)
+ * @date 2024-03-22
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#include "compositor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "stb/stb_image.h"
+
+namespace bgq_opengl {
+
+    namespace {
+
+        // Blend a channel, rounding bg * (255 - alpha) / 255 exactly as the
+        // vector paths do.
+        inline unsigned char blendChannel(unsigned char fg, unsigned char bg, unsigned char alpha) {
+
+            unsigned int scaled = bg * (255u - alpha) + 128u;
+            unsigned int value = fg + ((scaled + (scaled >> 8)) >> 8);
+
+            return (unsigned char) std::min(value, 255u);
+
+        }
+
+        void blendScalar(const unsigned char* foreground, const unsigned char* background, size_t num_pixels, unsigned char* output) {
+
+            for (size_t i = 0; i < num_pixels; i++)
+                for (int c = 0; c < 3; c++)
+                    output[i * 3 + c] = blendChannel(foreground[i * 4 + c], background[i * 4 + c], foreground[i * 4 + 3]);
+
+        }
+
+#if defined(__x86_64__) || defined(__i386__)
+
+        // Built for AVX2 whatever the flags of the build, and only called if
+        // the processor has it.
+        __attribute__((target("avx2")))
+        void blendAVX2(const unsigned char* foreground, const unsigned char* background, size_t num_pixels, unsigned char* output) {
+
+            // Spread the alpha of each pixel over its channels, and drop the
+            // fourth channel of each pixel at the end.
+            const __m256i alpha_mask = _mm256_setr_epi8(3, 3, 3, 3, 7, 7, 7, 7, 11, 11, 11, 11, 15, 15, 15, 15,
+                                                        3, 3, 3, 3, 7, 7, 7, 7, 11, 11, 11, 11, 15, 15, 15, 15);
+            const __m256i rgb_mask = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+                                                      0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+            const __m256i ones = _mm256_set1_epi8((char) 0xFF);
+            const __m256i half = _mm256_set1_epi16(128);
+            const __m256i zero = _mm256_setzero_si256();
+
+            // Eight pixels at a time.
+            size_t i = 0;
+            for (; i + 8 <= num_pixels; i += 8) {
+
+                __m256i fg = _mm256_loadu_si256((const __m256i*) (foreground + i * 4));
+                __m256i bg = _mm256_loadu_si256((const __m256i*) (background + i * 4));
+                __m256i inverse_alpha = _mm256_sub_epi8(ones, _mm256_shuffle_epi8(fg, alpha_mask));
+
+                // Scale the background in 16 bits.
+                __m256i low = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(bg, zero), _mm256_unpacklo_epi8(inverse_alpha, zero)), half);
+                __m256i high = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(bg, zero), _mm256_unpackhi_epi8(inverse_alpha, zero)), half);
+                low = _mm256_srli_epi16(_mm256_add_epi16(low, _mm256_srli_epi16(low, 8)), 8);
+                high = _mm256_srli_epi16(_mm256_add_epi16(high, _mm256_srli_epi16(high, 8)), 8);
+
+                // Add the foreground and pack the 12 bytes of each half.
+                __m256i result = _mm256_shuffle_epi8(_mm256_adds_epu8(fg, _mm256_packus_epi16(low, high)), rgb_mask);
+                __m128i halves[2] = {_mm256_castsi256_si128(result), _mm256_extracti128_si256(result, 1)};
+
+                for (int h = 0; h < 2; h++) {
+                    unsigned char* destination = output + (i + h * 4) * 3;
+                    int last = _mm_extract_epi32(halves[h], 2);
+                    _mm_storel_epi64((__m128i*) destination, halves[h]);
+                    memcpy(destination + 8, &last, 4);
+                }
+
+            }
+
+            // The pixels left.
+            blendScalar(foreground + i * 4, background + i * 4, num_pixels - i, output + i * 3);
+
+        }
+
+#elif defined(__ARM_NEON)
+
+        void blendNEON(const unsigned char* foreground, const unsigned char* background, size_t num_pixels, unsigned char* output) {
+
+            const uint16x8_t half = vdupq_n_u16(128);
+
+            // Eight pixels at a time, with the channels split into registers.
+            size_t i = 0;
+            for (; i + 8 <= num_pixels; i += 8) {
+
+                uint8x8x4_t fg = vld4_u8(foreground + i * 4);
+                uint8x8x4_t bg = vld4_u8(background + i * 4);
+                uint8x8_t inverse_alpha = vmvn_u8(fg.val[3]);
+
+                uint8x8x3_t result;
+                for (int c = 0; c < 3; c++) {
+                    uint16x8_t scaled = vmlal_u8(half, bg.val[c], inverse_alpha);
+                    scaled = vaddq_u16(scaled, vshrq_n_u16(scaled, 8));
+                    result.val[c] = vqadd_u8(fg.val[c], vshrn_n_u16(scaled, 8));
+                }
+
+                vst3_u8(output + i * 3, result);
+
+            }
+
+            // The pixels left.
+            blendScalar(foreground + i * 4, background + i * 4, num_pixels - i, output + i * 3);
+
+        }
+
+#endif
+
+    }  // namespace
+
+    Compositor::Compositor(int width, int height) {
+
+        this->width = width;
+        this->height = height;
+
+    }
+
+    void Compositor::composite(const std::vector<unsigned char> &foreground, const char* background_file, const BackgroundCrop &crop, std::vector<unsigned char> &output) const {
+
+        size_t num_pixels = (size_t) this->width * this->height;
+        thread_local std::vector<unsigned char> background;
+        background.assign(num_pixels * 4, 0);
+
+        // Load the image bottom row first, like the foreground. The flag of
+        // stb is set per thread, so the textures are not affected.
+        stbi_set_flip_vertically_on_load_thread(1);
+        int image_width, image_height, channels;
+        unsigned char* image = stbi_load(background_file, &image_width, &image_height, &channels, 3);
+
+        if (image != nullptr) {
+            cropBackground(image, image_width, image_height, crop, this->width, this->height, background.data());
+            stbi_image_free(image);
+        } else {
+            std::cerr << "Could not load the background " << background_file << std::endl;
+        }
+
+        // Blend the foreground over it.
+        output.resize(num_pixels * 3);
+        blend(foreground.data(), background.data(), num_pixels, output.data());
+
+    }
+
+    void Compositor::cropBackground(const unsigned char* image, int image_width, int image_height, const BackgroundCrop &crop, int width, int height, unsigned char* background) {
+
+        // Get the largest crop with the aspect ratio of the samples, and zoom
+        // it in.
+        float aspect = (float) width / height;
+        float crop_width = std::min((float) image_width, image_height * aspect) / crop.scale;
+        float crop_height = crop_width / aspect;
+        float x0 = (image_width - crop_width) * crop.offset_x;
+        float y0 = (image_height - crop_height) * crop.offset_y;
+        float step_x = crop_width / width;
+        float step_y = crop_height / height;
+
+        // The last pixel that can be interpolated with the next one.
+        int last_column = std::max(image_width - 2, 0);
+        int last_row = std::max(image_height - 2, 0);
+
+        // Find the columns and weights once, they are the same for every row.
+        std::vector<int> columns(width);
+        std::vector<int> weights_x(width);
+        for (int x = 0; x < width; x++) {
+            int target = crop.flip ? width - 1 - x : x;
+            float source = std::clamp(x0 + (target + 0.5f) * step_x - 0.5f, 0.0f, (float) (image_width - 1));
+            columns[x] = std::min((int) source, last_column);
+            weights_x[x] = (int) ((source - columns[x]) * 256.0f);
+        }
+
+        int next_column = image_width > 1 ? 3 : 0;
+
+        for (int y = 0; y < height; y++) {
+
+            float source = std::clamp(y0 + (y + 0.5f) * step_y - 0.5f, 0.0f, (float) (image_height - 1));
+            int row = std::min((int) source, last_row);
+            int weight_y = (int) ((source - row) * 256.0f);
+
+            const unsigned char* top = image + (size_t) row * image_width * 3;
+            const unsigned char* bottom = image_height > 1 ? top + (size_t) image_width * 3 : top;
+            unsigned char* destination = background + (size_t) y * width * 4;
+
+            // Interpolate in 8 bit fixed point.
+            for (int x = 0; x < width; x++) {
+
+                const unsigned char* a = top + columns[x] * 3;
+                const unsigned char* b = bottom + columns[x] * 3;
+                int wx = weights_x[x];
+
+                for (int c = 0; c < 3; c++) {
+                    int upper = a[c] * (256 - wx) + a[c + next_column] * wx;
+                    int lower = b[c] * (256 - wx) + b[c + next_column] * wx;
+                    destination[x * 4 + c] = (unsigned char) ((upper * (256 - weight_y) + lower * weight_y + 32768) >> 16);
+                }
+
+                destination[x * 4 + 3] = 255;
+
+            }
+
+        }
+
+    }
+
+    void Compositor::blend(const unsigned char* foreground, const unsigned char* background, size_t num_pixels, unsigned char* output) {
+
+#if defined(__x86_64__) || defined(__i386__)
+        static const bool has_avx2 = __builtin_cpu_supports("avx2");
+        if (has_avx2) {
+            blendAVX2(foreground, background, num_pixels, output);
+            return;
+        }
+#elif defined(__ARM_NEON)
+        blendNEON(foreground, background, num_pixels, output);
+        return;
+#endif
+
+        blendScalar(foreground, background, num_pixels, output);
+
+    }
+
+    const char* Compositor::getInstructionSet() {
+
+#if defined(__x86_64__) || defined(__i386__)
+        return __builtin_cpu_supports("avx2") ? "AVX2" : "scalar";
+#elif defined(__ARM_NEON)
+        return "NEON";
+#else
+        return "scalar";
+#endif
+
+    }
+
+}  // namespace bgq_opengl
@@ -0,0 +1,113 @@
+/**
+ * @file compositor.h
+ * @brief Compositor class header file.
+ * @version 1.0.0 (2024-03-22)
+ * @date 2024-03-22
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_CLASSES_COMPOSITOR_H_
+#define BGQ_OPENGL_CLASSES_COMPOSITOR_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "structs/background_crop/background_crop.h"
+
+namespace bgq_opengl {
+
+    /**
+     * @brief Implementation of a Compositor class.
+     *
+     * Implementation of the compositing of a hand rendered with premultiplied
+     * alpha over background images on the CPU, so that a single render gives
+     * several samples with different backgrounds. The pixels are kept bottom
+     * row first, as they are read from OpenGL. The blending uses AVX2 or NEON
+     * when available, and every path gives exactly the same result.
+     * Compositing is thread safe.
+     *
+     * @author Borja García Quiroga <garcaqub@tcd.ie>
+     */
+    class Compositor {
+
+    public:
+
+        /**
+         * @brief Creates a new compositor.
+         *
+         * Creates a new compositor for images of a given size.
+         *
+         * @param width The width of the images.
+         * @param height The height of the images.
+         */
+        Compositor(int width, int height);
+
+        /**
+         * @brief Composite a sample.
+         *
+         * Load a background image, crop it and blend the foreground over it.
+         * If the background cannot be loaded, the foreground is blended over
+         * black.
+         *
+         * @param foreground The premultiplied RGBA8 pixels of the foreground.
+         * @param background_file The file of the background image.
+         * @param crop The crop of the background.
+         * @param output Output vector for the RGB8 pixels of the sample.
+         */
+        void composite(const std::vector<unsigned char> &foreground, const char* background_file, const BackgroundCrop &crop, std::vector<unsigned char> &output) const;
+
+        /**
+         * @brief Crop a background.
+         *
+         * Cut a crop out of an image and scale it bilinearly to the size of the
+         * samples.
+         *
+         * @param image The RGB8 pixels of the image, bottom row first.
+         * @param image_width The width of the image.
+         * @param image_height The height of the image.
+         * @param crop The crop.
+         * @param width The width of the samples.
+         * @param height The height of the samples.
+         * @param background Output for the RGBX8 pixels of the crop, width * height * 4 bytes.
+         */
+        static void cropBackground(const unsigned char* image, int image_width, int image_height, const BackgroundCrop &crop, int width, int height, unsigned char* background);
+
+        /**
+         * @brief Blend a foreground over a background.
+         *
+         * Blend premultiplied RGBA8 pixels over RGBX8 pixels, giving tightly
+         * packed RGB8 pixels.
+         *
+         * @param foreground The foreground pixels.
+         * @param background The background pixels.
+         * @param num_pixels The amount of pixels.
+         * @param output Output for the blended pixels, num_pixels * 3 bytes.
+         */
+        static void blend(const unsigned char* foreground, const unsigned char* background, size_t num_pixels, unsigned char* output);
+
+        /**
+         * @brief Get the instruction set of the blending.
+         *
+         * Get the name of the instructions the blending uses on this machine.
+         *
+         * @returns "AVX2", "NEON" or "scalar".
+         */
+        static const char* getInstructionSet();
+
+    private:
+
+        int width;                          /// The width of the images.
+        int height;                         /// The height of the images.
+
+    };
+
+}  // namespace bgq_opengl
+
+#endif  //!BGQ_OPENGL_CLASSES_COMPOSITOR_H_
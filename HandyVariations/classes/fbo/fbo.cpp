@@ -0,0 +1,179 @@
+/**
+ * @file fbo.cpp
+ * @brief FBO class implementation file.
+ * @version 1.0.0 (2024-03-18)
+ * @date 2024-03-18
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#include "fbo.h"
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "GL/glew.h"
+#include "glm/glm.hpp"
+
+namespace bgq_opengl {
+
+	FBO::FBO(int tile_width, int tile_height, int num_of_tiles, bool alpha) {
+
+		// Lay the tiles out in a grid that is as square as possible.
+		this->tile_width = tile_width;
+		this->tile_height = tile_height;
+		this->columns = (int) std::ceil(std::sqrt((double) num_of_tiles));
+		this->rows = (num_of_tiles + this->columns - 1) / this->columns;
+		this->channels = alpha ? 4 : 3;
+
+		int width = this->columns * tile_width;
+		int height = this->rows * tile_height;
+
+		// Check that the driver can hold it.
+		GLint max_size;
+		glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &max_size);
+		if (width > max_size || height > max_size) {
+			std::cerr << "A framebuffer of " << width << "x" << height << " is bigger than the maximum of " << max_size << "." << std::endl;
+			exit(1);
+		}
+
+		// Generate the attachments.
+		glGenRenderbuffers(1, &this->color_ID);
+		glBindRenderbuffer(GL_RENDERBUFFER, this->color_ID);
+		glRenderbufferStorage(GL_RENDERBUFFER, alpha ? GL_RGBA8 : GL_RGB8, width, height);
+
+		glGenRenderbuffers(1, &this->depth_ID);
+		glBindRenderbuffer(GL_RENDERBUFFER, this->depth_ID);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+		// Generate the framebuffer and attach them.
+		glGenFramebuffers(1, &this->ID);
+		glBindFramebuffer(GL_FRAMEBUFFER, this->ID);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->color_ID);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, this->depth_ID);
+
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+			std::cerr << "The tiled framebuffer is not complete." << std::endl;
+			exit(1);
+		}
+
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	}
+
+	void FBO::bind() {
+
+		// Bind the FBO.
+		glBindFramebuffer(GL_FRAMEBUFFER, this->ID);
+
+	}
+
+	void FBO::blitTile(int tile) {
+
+		int x = (tile % this->columns) * this->tile_width;
+		int y = (tile / this->columns) * this->tile_height;
+
+		// Copy the tile into the window.
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, this->ID);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+		glBlitFramebuffer(x, y, x + this->tile_width, y + this->tile_height, 0, 0, this->tile_width, this->tile_height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	}
+
+	int FBO::getChannels() const {
+
+		return this->channels;
+
+	}
+
+	int FBO::getColumns() const {
+
+		return this->columns;
+
+	}
+
+	int FBO::getHeight() const {
+
+		return this->rows * this->tile_height;
+
+	}
+
+	void FBO::getTile(const std::vector<unsigned char> &pixels, int tile, std::vector<unsigned char> &tile_pixels) const {
+
+		size_t row_size = (size_t) this->tile_width * this->channels;
+		size_t stride = row_size * this->columns;
+		size_t x = (tile % this->columns) * row_size;
+		size_t y = (size_t) (tile / this->columns) * this->tile_height;
+
+		// Copy each of the rows of the tile.
+		tile_pixels.resize(row_size * this->tile_height);
+		for (int row = 0; row < this->tile_height; row++)
+			memcpy(tile_pixels.data() + row * row_size, pixels.data() + (y + row) * stride + x, row_size);
+
+	}
+
+	glm::vec4 FBO::getTileRect(int tile) const {
+
+		float x = (float) ((tile % this->columns) * this->tile_width);
+		float y = (float) ((tile / this->columns) * this->tile_height);
+
+		return glm::vec4(x, y, x + this->tile_width, y + this->tile_height);
+
+	}
+
+	int FBO::getWidth() const {
+
+		return this->columns * this->tile_width;
+
+	}
+
+	void FBO::readPixels(std::vector<unsigned char> &pixels) {
+
+		int width = this->getWidth();
+		int height = this->getHeight();
+
+		// Read the pixels without any padding between rows.
+		pixels.resize((size_t) width * height * this->channels);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, this->ID);
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glReadBuffer(GL_COLOR_ATTACHMENT0);
+		glReadPixels(0, 0, width, height, this->channels == 4 ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+	}
+
+	void FBO::remove() {
+
+		// Delete the framebuffer and its attachments in OpenGL.
+		glDeleteFramebuffers(1, &this->ID);
+		glDeleteRenderbuffers(1, &this->color_ID);
+		glDeleteRenderbuffers(1, &this->depth_ID);
+
+	}
+
+	void FBO::setTileViewport(int tile) {
+
+		// Point the viewport at the tile.
+		glViewport((tile % this->columns) * this->tile_width, (tile / this->columns) * this->tile_height, this->tile_width, this->tile_height);
+
+	}
+
+	void FBO::unbind() {
+
+		// Unbind it.
+		// To do so, just bind the window.
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	}
+
+}  // namespace bgq_opengl
@@ -0,0 +1,178 @@
+/**
+ * @file fbo.h
+ * @brief FBO class header file.
+ * @version 1.0.0 (2024-03-18)
+ * @date 2024-03-18
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_CLASS_FBO_H_
+#define BGQ_OPENGL_CLASS_FBO_H_
+
+#include <vector>
+
+#include "GL/glew.h"
+#include "glm/glm.hpp"
+
+namespace bgq_opengl {
+
+	/**
+	 * @brief Implementation of an FBO class.
+	 *
+	 * Implementation of a framebuffer made of a grid of equally sized tiles,
+	 * so that several samples can be rendered, each into its own tile, and
+	 * read back at once. The tiles are numbered row by row, starting at the
+	 * bottom left corner.
+	 *
+	 * @author Borja García Quiroga <garcaqub@tcd.ie>
+	 */
+	class FBO {
+
+	public:
+
+		/**
+		 * @brief Constructs a Framebuffer Object.
+		 *
+		 * Constructs a Framebuffer Object with RGB8 or RGBA8 colour and depth,
+		 * big enough to hold the tiles in a roughly square grid.
+		 *
+		 * @param tile_width The width of each tile.
+		 * @param tile_height The height of each tile.
+		 * @param num_of_tiles The amount of tiles.
+		 * @param alpha Whether the colour keeps an alpha channel.
+		 */
+		FBO(int tile_width, int tile_height, int num_of_tiles, bool alpha = false);
+
+		/**
+		 * @brief Binds the FBO.
+		 *
+		 * Binds the FBO in the GL pipe, so everything is drawn into it.
+		 */
+		void bind();
+
+		/**
+		 * @brief Blits a tile to the window.
+		 *
+		 * Copy a tile to the bottom left corner of the default framebuffer.
+		 *
+		 * @param tile The tile.
+		 */
+		void blitTile(int tile);
+
+		/**
+		 * @brief Get the amount of channels.
+		 *
+		 * Get the amount of channels of the pixels read back, 3 for RGB or 4
+		 * for RGBA.
+		 *
+		 * @returns The amount of channels.
+		 */
+		int getChannels() const;
+
+		/**
+		 * @brief Get the amount of columns.
+		 *
+		 * Get the amount of tiles in each row of the FBO. Tile i is in
+		 * column i % columns and row i / columns.
+		 *
+		 * @returns The amount of columns.
+		 */
+		int getColumns() const;
+
+		/**
+		 * @brief Get the height.
+		 *
+		 * Get the height of the whole FBO.
+		 *
+		 * @returns The height in pixels.
+		 */
+		int getHeight() const;
+
+		/**
+		 * @brief Get the pixels of a tile.
+		 *
+		 * Cut a tile out of the pixels read by readPixels. It does not use
+		 * OpenGL, so it can be called from any thread.
+		 *
+		 * @param pixels The pixels of the whole FBO.
+		 * @param tile The tile.
+		 * @param tile_pixels Output vector for the pixels of the tile, bottom row first.
+		 */
+		void getTile(const std::vector<unsigned char> &pixels, int tile, std::vector<unsigned char> &tile_pixels) const;
+
+		/**
+		 * @brief Get the rectangle of a tile.
+		 *
+		 * Get the rectangle a tile covers in the FBO.
+		 *
+		 * @param tile The tile.
+		 *
+		 * @returns The rectangle as (x0, y0, x1, y1) in pixels.
+		 */
+		glm::vec4 getTileRect(int tile) const;
+
+		/**
+		 * @brief Get the width.
+		 *
+		 * Get the width of the whole FBO.
+		 *
+		 * @returns The width in pixels.
+		 */
+		int getWidth() const;
+
+		/**
+		 * @brief Read the pixels.
+		 *
+		 * Read the whole FBO as tightly packed RGB8 or RGBA8 pixels, bottom
+		 * row first.
+		 *
+		 * @param pixels Output vector for the pixels.
+		 */
+		void readPixels(std::vector<unsigned char> &pixels);
+
+		/**
+		 * @brief Removes the FBO.
+		 *
+		 * Removes the FBO and its attachments from OpenGL.
+		 */
+		void remove();
+
+		/**
+		 * @brief Set the viewport to a tile.
+		 *
+		 * Set the viewport to a tile, so that what is drawn next fills it.
+		 *
+		 * @param tile The tile.
+		 */
+		void setTileViewport(int tile);
+
+		/**
+		 * @brief Unbinds the FBO.
+		 *
+		 * Unbinds the FBO in the GL pipe, going back to the window.
+		 */
+		void unbind();
+
+	private:
+
+		GLuint ID;				// GL ID of the FBO.
+		GLuint color_ID;		// GL ID of the colour renderbuffer.
+		GLuint depth_ID;		// GL ID of the depth renderbuffer.
+		int tile_width;			// The width of each tile.
+		int tile_height;		// The height of each tile.
+		int columns;			// The amount of tiles in each row.
+		int rows;				// The amount of rows of tiles.
+		int channels;			// The amount of channels of the colour.
+
+	};
+
+}  // namespace bgq_opengl
+
+#endif //!BGQ_OPENGL_CLASS_FBO_H_
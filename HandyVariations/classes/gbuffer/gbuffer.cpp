@@ -0,0 +1,129 @@
+/**
+ * @file gbuffer.cpp
+ * @brief GBuffer class implementation file.
+ * @version 1.0.0 (2024-03-21)
+ * @date 2024-03-21
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#include "gbuffer.h"
+
+#include <iostream>
+
+#include "GL/glew.h"
+
+namespace bgq_opengl {
+
+	GBuffer::GBuffer(int width, int height) {
+
+		this->width = width;
+		this->height = height;
+		this->previous_ID = 0;
+
+		// Generate the attachments. The normals are signed, so they need floats.
+		const GLenum internal_formats[3] = {GL_RGBA16F, GL_RGBA8, GL_DEPTH_COMPONENT24};
+		const GLenum formats[3] = {GL_RGBA, GL_RGBA, GL_DEPTH_COMPONENT};
+		const GLenum types[3] = {GL_FLOAT, GL_UNSIGNED_BYTE, GL_FLOAT};
+		GLuint *ids[3] = {&this->normal_ID, &this->albedo_ID, &this->depth_ID};
+
+		for (int i = 0; i < 3; i++) {
+
+			// Every pixel of the G-buffer is read as it is, without filtering.
+			glGenTextures(1, ids[i]);
+			glBindTexture(GL_TEXTURE_2D, *ids[i]);
+			glTexImage2D(GL_TEXTURE_2D, 0, internal_formats[i], width, height, 0, formats[i], types[i], nullptr);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		}
+
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		// Generate the framebuffer and attach them.
+		glGenFramebuffers(1, &this->ID);
+		glBindFramebuffer(GL_FRAMEBUFFER, this->ID);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->normal_ID, 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, this->albedo_ID, 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, this->depth_ID, 0);
+
+		const GLenum draw_buffers[2] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+		glDrawBuffers(2, draw_buffers);
+
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+			std::cerr << "The G-buffer is not complete." << std::endl;
+			exit(1);
+		}
+
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+		// The core profile needs a VAO to draw, even if it has no attributes.
+		glGenVertexArrays(1, &this->vao_ID);
+
+	}
+
+	void GBuffer::bind() {
+
+		// Keep what was bound to go back to it.
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &this->previous_ID);
+		glGetIntegerv(GL_VIEWPORT, this->previous_viewport);
+		glGetFloatv(GL_COLOR_CLEAR_VALUE, this->previous_clear_color);
+
+		// Bind the G-buffer and clear it. A coverage of 0 means no hand.
+		glBindFramebuffer(GL_FRAMEBUFFER, this->ID);
+		glViewport(0, 0, this->width, this->height);
+		glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	}
+
+	void GBuffer::bindTextures(GLuint first_unit) {
+
+		// Bind each attachment to its unit.
+		glActiveTexture(GL_TEXTURE0 + first_unit);
+		glBindTexture(GL_TEXTURE_2D, this->normal_ID);
+		glActiveTexture(GL_TEXTURE0 + first_unit + 1);
+		glBindTexture(GL_TEXTURE_2D, this->albedo_ID);
+		glActiveTexture(GL_TEXTURE0 + first_unit + 2);
+		glBindTexture(GL_TEXTURE_2D, this->depth_ID);
+
+	}
+
+	void GBuffer::drawFullscreen() {
+
+		// Draw the triangle.
+		glBindVertexArray(this->vao_ID);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		glBindVertexArray(0);
+
+	}
+
+	void GBuffer::remove() {
+
+		// Delete the framebuffer and its attachments in OpenGL.
+		glDeleteFramebuffers(1, &this->ID);
+		glDeleteTextures(1, &this->normal_ID);
+		glDeleteTextures(1, &this->albedo_ID);
+		glDeleteTextures(1, &this->depth_ID);
+		glDeleteVertexArrays(1, &this->vao_ID);
+
+	}
+
+	void GBuffer::unbind() {
+
+		// Go back to the framebuffer, viewport and clear color there were.
+		glBindFramebuffer(GL_FRAMEBUFFER, this->previous_ID);
+		glViewport(this->previous_viewport[0], this->previous_viewport[1], this->previous_viewport[2], this->previous_viewport[3]);
+		glClearColor(this->previous_clear_color[0], this->previous_clear_color[1], this->previous_clear_color[2], this->previous_clear_color[3]);
+
+	}
+
+}  // namespace bgq_opengl
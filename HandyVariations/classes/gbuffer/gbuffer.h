@@ -0,0 +1,107 @@
+/**
+ * @file gbuffer.h
+ * @brief GBuffer class header file.
+ * @version 1.0.0 (2024-03-21)
+ * @date 2024-03-21
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_CLASS_GBUFFER_H_
+#define BGQ_OPENGL_CLASS_GBUFFER_H_
+
+#include "GL/glew.h"
+
+namespace bgq_opengl {
+
+	/**
+	 * @brief Implementation of a GBuffer class.
+	 *
+	 * Implementation of a geometry buffer: a framebuffer that keeps what the
+	 * lighting needs of every pixel instead of its colour. It holds the view
+	 * space normal after the normal mapping with the coverage in its alpha,
+	 * the albedo with the specular mask in its alpha, and the depth. A pose
+	 * rasterised into it can then be lit many times with a fullscreen pass.
+	 *
+	 * @author Borja García Quiroga <garcaqub@tcd.ie>
+	 */
+	class GBuffer {
+
+	public:
+
+		/**
+		 * @brief Constructs a GBuffer.
+		 *
+		 * Constructs a GBuffer and its attachments.
+		 *
+		 * @param width The width in pixels.
+		 * @param height The height in pixels.
+		 */
+		GBuffer(int width, int height);
+
+		/**
+		 * @brief Binds the GBuffer.
+		 *
+		 * Binds the GBuffer in the GL pipe, points the viewport at it and
+		 * clears it. The framebuffer, viewport and clear color there were are
+		 * kept to go back to them when unbinding.
+		 */
+		void bind();
+
+		/**
+		 * @brief Binds the attachments as textures.
+		 *
+		 * Binds the normal, albedo and depth attachments to three consecutive
+		 * texture units.
+		 *
+		 * @param first_unit The texture unit of the normals.
+		 */
+		void bindTextures(GLuint first_unit);
+
+		/**
+		 * @brief Draws a fullscreen triangle.
+		 *
+		 * Draws a triangle that covers the whole viewport, for the lighting
+		 * pass. The vertices are made up in the shader from their IDs.
+		 */
+		void drawFullscreen();
+
+		/**
+		 * @brief Removes the GBuffer.
+		 *
+		 * Removes the GBuffer and its attachments from OpenGL.
+		 */
+		void remove();
+
+		/**
+		 * @brief Unbinds the GBuffer.
+		 *
+		 * Unbinds the GBuffer, going back to the framebuffer, viewport and
+		 * clear color there were before binding it.
+		 */
+		void unbind();
+
+	private:
+
+		GLuint ID;					// GL ID of the framebuffer.
+		GLuint normal_ID;			// GL ID of the normal and coverage texture.
+		GLuint albedo_ID;			// GL ID of the albedo and specular mask texture.
+		GLuint depth_ID;			// GL ID of the depth texture.
+		GLuint vao_ID;				// GL ID of the empty VAO of the fullscreen pass.
+		int width;					// The width in pixels.
+		int height;					// The height in pixels.
+		GLint previous_ID;			// The framebuffer bound before this one.
+		GLint previous_viewport[4];	// The viewport set before binding this one.
+		GLfloat previous_clear_color[4];	// The clear color set before binding this one.
+
+	};
+
+}  // namespace bgq_opengl
+
+#endif //!BGQ_OPENGL_CLASS_GBUFFER_H_
@@ -0,0 +1,425 @@
+/**
+ * @file generator.cpp
+ * @brief Generator class implementation file.
+ * @version 1.0.0 (2024-03-24)
+ * @date 2024-03-24
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#define GLM_ENABLE_EXPERIMENTAL
+
+#include "generator.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "GL/glew.h"
+#include "GLFW/glfw3.h"
+#include "glm/glm.hpp"
+
+#include "classes/bone/bone.h"
+#include "classes/texture/texture.h"
+#include "classes/variation_sampler/variation_sampler.h"
+#include "structs/bounding_box/bounding_box.h"
+#include "structs/vertex/vertex.h"
+
+namespace bgq_opengl {
+
+    namespace {
+
+        /// Maps each keypoint to its reference bone.
+        const std::vector<int> key_mapping = {1, 2, 3, 4, 4, 6, 7, 14, 14, 9, 15, 18, 18,
+            11, 16, 19, 19, 13, 17, 20, 20};
+
+        /// Maps the keypoints to their reference vertex in the mesh.
+        const std::vector<int> keypoint_bone_map = {36563, 30249, 53106, 790, 528, 28613, 20338,
+            21906, 17825, 38509, 25734, 24593, 23377, 28657, 9382, 10482, 6617, 60805,
+            15913, 16162, 12608};
+
+        /// Maps indices to bones.
+        const std::vector<std::string> name_joint_mapping = {"Bone037", "Bone038", "Bone039",
+            "Bone040", "Bone043", "Bone044", "Bone045", "Bone048", "Bone049", "Bone050",
+            "Bone053", "Bone054", "Bone055", "Bone058", "Bone059", "Bone060"};
+
+    }  // namespace
+
+    Generator::Generator(int width, int height, int max_batch_size, const std::string &resources_dir, const std::string &backgrounds_path)
+        : camera(VariationSampler(0).getCamera(0, width, height)) {
+
+        this->width = width;
+        this->height = height;
+        this->max_batch_size = std::max(max_batch_size, 1);
+        this->backgrounds_path = backgrounds_path;
+
+        // The hand, its textures and the shaders are all in the resources, and
+        // their loaders cannot report a missing file, so look for them first.
+        std::string dir = resources_dir.empty() ? "" : resources_dir + "/";
+        for (const char* resource : {"hand.fbx", "hand_base_color.jpg", "hand_normals.jpg", "hand_specular.jpg",
+                                     "blinn_phong_normal.vert", "blinn_phong_normal.frag", "background.vert", "background.frag"}) {
+            if (!std::filesystem::exists(dir + resource))
+                throw std::runtime_error("The resources dir " + resources_dir + " has no " + resource + ".");
+        }
+
+        // Start GLFW, which can be done more than once.
+        if (!glfwInit())
+            throw std::runtime_error("Could not start GLFW.");
+
+        // Create a window that is never shown, only for its context.
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+        this->window = glfwCreateWindow(width, height, "Generator", nullptr, nullptr);
+        glfwDefaultWindowHints();
+
+        if (!this->window)
+            throw std::runtime_error("Error 121-1001 - Failed to create the window.");
+        glfwMakeContextCurrent(this->window);
+
+        // Initialize GLEW and OpenGL.
+        GLenum res = glewInit();
+        if (res != GLEW_OK) {
+            glfwDestroyWindow(this->window);
+            throw std::runtime_error(std::string("Error 121-1002 - GLEW could not be initialized: ") + (const char*) glewGetErrorString(res));
+        }
+
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_LESS);
+
+        this->shader = new Shader((dir + "blinn_phong_normal.vert").c_str(), (dir + "blinn_phong_normal.frag").c_str());
+        this->shaderBck = new Shader((dir + "background.vert").c_str(), (dir + "background.frag").c_str());
+        this->hand = new ObjectRigged((dir + "hand.fbx").c_str());
+
+        // Get everything else the samples are drawn with.
+        this->backbox = new Background();
+        this->fbo = new FBO(width, height, this->max_batch_size);
+
+        // The buffers of the batches are as large as the largest batch from
+        // the start, so they never move and what points into them stays valid.
+        this->images.resize((size_t) this->max_batch_size * width * height * 3);
+        this->batch_keypoints.resize((size_t) this->max_batch_size * NUM_OF_KEYPOINTS * 3);
+
+    }
+
+    Generator::~Generator() {
+
+        glfwMakeContextCurrent(this->window);
+
+        this->fbo->remove();
+        this->shader->remove();
+        this->shaderBck->remove();
+
+        delete this->fbo;
+        delete this->backbox;
+        delete this->hand;
+        delete this->shaderBck;
+        delete this->shader;
+
+        // Other generators may still use GLFW, so it is not terminated.
+        glfwDestroyWindow(this->window);
+
+    }
+
+    void Generator::render(const std::vector<RenderParams> &params) {
+
+        if ((int) params.size() > this->max_batch_size)
+            throw std::invalid_argument("A batch of " + std::to_string(params.size()) + " samples is larger than " + std::to_string(this->max_batch_size) + ".");
+
+        glfwMakeContextCurrent(this->window);
+
+        // Draw into the tiles, over the same colour the application uses
+        // when there is no background.
+        this->fbo->bind();
+        glClearColor(1.0f, 0.0f, 1.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        size_t sample_keypoints = NUM_OF_KEYPOINTS * 3;
+
+        for (size_t sample = 0; sample < params.size(); sample++) {
+
+            const RenderParams &sample_params = params[sample];
+            this->fbo->setTileViewport((int) sample);
+
+            // Draw the background.
+            if (sample_params.background >= 0) {
+
+                std::string bg_filename = getBackgroundFilename(this->backgrounds_path, sample_params.background);
+                Texture back_text(bg_filename.c_str(), "image", 4);
+
+                this->shaderBck->activate();
+                this->shaderBck->passTexture(back_text);
+                this->shaderBck->passMat("cropTransform", glm::mat3(1.0f));
+                this->backbox->draw(*this->shaderBck, this->camera);
+
+                back_text.remove();
+
+            }
+
+            // Pose the hand and draw it.
+            poseHand(*this->hand, sample_params.joint_angles, sample_params.arm_position, sample_params.arm_rotation);
+
+            this->shader->activate();
+            this->shader->passLight(sample_params.light);
+            this->shader->passFloat("skinTone", sample_params.skin_tone);
+            this->shader->passFloat("shininess", sample_params.shininess);
+            this->hand->draw(*this->shader, this->camera);
+
+            // Annotate it.
+            calculateKeypoints(*this->hand, this->keypoints);
+            projectKeypoints(this->camera, this->keypoints, this->width, this->height, this->annotations);
+            std::copy(this->annotations.begin(), this->annotations.end(), this->batch_keypoints.begin() + sample * sample_keypoints);
+
+        }
+
+        // Read the whole batch at once and cut it into the images, with their
+        // rows top first.
+        this->fbo->readPixels(this->pixels);
+        this->fbo->unbind();
+
+        size_t row_size = (size_t) this->width * 3;
+        size_t image_size = row_size * this->height;
+
+        for (size_t sample = 0; sample < params.size(); sample++) {
+
+            this->fbo->getTile(this->pixels, (int) sample, this->tile_pixels);
+
+            unsigned char* image = this->images.data() + sample * image_size;
+            for (int row = 0; row < this->height; row++)
+                memcpy(image + row * row_size, this->tile_pixels.data() + (this->height - 1 - row) * row_size, row_size);
+
+        }
+
+    }
+
+    const std::vector<unsigned char>& Generator::getImages() const {
+
+        return this->images;
+
+    }
+
+    const std::vector<float>& Generator::getKeypoints() const {
+
+        return this->batch_keypoints;
+
+    }
+
+    int Generator::getWidth() const {
+
+        return this->width;
+
+    }
+
+    int Generator::getHeight() const {
+
+        return this->height;
+
+    }
+
+    int Generator::getMaxBatchSize() const {
+
+        return this->max_batch_size;
+
+    }
+
+    void Generator::poseHand(ObjectRigged &hand, const std::vector<glm::vec3> &joint_angles, glm::vec3 arm_position, glm::vec3 arm_rotation) {
+
+        // Reset the transformations to not apply them on top.
+        hand.resetTransforms();
+
+        // Obtain the original bounding box of the hand.
+        BoundingBox bb = hand.getBoundingBox();
+
+        // Obtain the center and sizes of the bounding box.
+        glm::vec3 center = (bb.min + bb.max) * 0.5f;
+        glm::vec3 size = (bb.max - bb.min);
+        float size_max = std::max(std::max(size.x, size.y), size.z);
+        float scaling_factor = 1.0f / size_max;
+
+        // Move the hand to center it.
+        hand.translate(-center.x, -center.y, -center.z);
+
+        // Scale it to normalise its displacements.
+        hand.scale(scaling_factor, scaling_factor, scaling_factor);
+
+        // Rotate it to obtain the right configuration.
+        hand.rotate(1.0f, 0.0f, 0.0f, -90.0f);
+
+        // Rotate the hand.
+        hand.rotate(1.0, 0.0, 0.0, arm_rotation.x);
+        hand.rotate(0.0, 1.0, 0.0, arm_rotation.y);
+        hand.rotate(0.0, 0.0, 1.0, arm_rotation.z);
+
+        // Move the hand to its position.
+        hand.translate(arm_position.x, arm_position.y, arm_position.z);
+
+        // Reset the joints.
+        hand.resetBones();
+
+        // Iterate through the relevant bones mapped in the variable.
+        int num_of_joints = (int) std::min(joint_angles.size(), name_joint_mapping.size());
+        for (int i = num_of_joints - 1; i >= 0; i--) {
+
+            hand.rotateBone(name_joint_mapping[i], 1.0f, 0.0f, 0.0f, joint_angles[i].x);
+            hand.rotateBone(name_joint_mapping[i], 0.0f, 1.0f, 0.0f, joint_angles[i].y);
+            hand.rotateBone(name_joint_mapping[i], 0.0f, 0.0f, 1.0f, joint_angles[i].z);
+
+        }
+
+    }
+
+    void Generator::calculateKeypoints(ObjectRigged &hand, std::vector<glm::vec3> &keypoints) {
+
+        // Init the keypoints.
+        keypoints = std::vector<glm::vec3>(NUM_OF_KEYPOINTS, glm::vec3(0.0f, 0.0f, 0.0f));
+
+        // Get the bones.
+        std::vector<Bone> bones = hand.getBones();
+
+        // Get the vertices.
+        std::vector<Vertex> vertices = hand.getMeshes()[0].getVertices();
+
+        // For each bone
+        for (unsigned int i = 0; i < key_mapping.size(); i++) {
+
+            glm::vec4 aux_pnt = glm::vec4(keypoints[i], 1.0f);
+
+            // Apply the inverse of the offset to this point to pass it from bone
+            // to world point, as all bone centers are in the 0,0,0 relatively to
+            // themselves (duh).
+            aux_pnt = glm::inverse(bones[key_mapping[i]].getOffset()) * aux_pnt;
+
+            // Get the initial value for each.
+            // Check if it is one of the cases that needs further reconstruction.
+            switch (i) {
+
+                case 4:
+                    aux_pnt += glm::vec4(-2.712357f, 10.171295f, 18.986443f, 0.0f);
+                    break;
+
+                case 8:
+                    aux_pnt += glm::vec4(-0.000015f, 8.476074f, 12.544624f, 0.0f);
+                    break;
+
+                case 12:
+                    aux_pnt += glm::vec4(1.017120f, 10.171303f, 11.527489f, 0.0f);
+                    break;
+
+                case 16:
+                    aux_pnt += glm::vec4(2.034241f, 12.544601f, 10.510353f, 0.0f);
+                    break;
+
+                case 20:
+                    aux_pnt += glm::vec4(0.678085f, 10.171295f, 7.119926f, 0.0f);
+                    break;
+
+                default:
+                    break;
+
+            }
+
+            // We now retrieve the closest vertex.
+            Vertex closest = vertices[keypoint_bone_map[i]];
+
+            // Now we apply to it the same logic as in the shader.
+
+            // Init the value of the variables to 0 to add the right values to them.
+            glm::vec4 interpol_pnt = glm::vec4(0.0, 0.0, 0.0, 0.0);
+
+            // Init the total sums of weights to normalise them at the end.
+            float accum_weight = 0.0f;
+
+            // Iterate through the influencing bones.
+            for (unsigned int j = 0; j < MAX_BONE_INFLUEN; j++) {
+
+                // If this bone is -1, it is not initialised. Don't use it.
+                if(closest.bone_ids[j] <= -1)
+                    continue;
+
+                // Check that this bone is in the usable range.
+                if(closest.bone_ids[j] >= bones.size())
+                    continue;
+
+                // Apply the bone transforms to obtain the component points.
+                glm::vec4 partial_pnt = bones[closest.bone_ids[j]].getTransformMatrix() * aux_pnt;
+
+                // Add a pondered version of this point.
+                interpol_pnt += partial_pnt * closest.bone_weights[j];
+
+                // Add this weight to the weight accumulator to normalise the
+                // pondered intermediate point.
+                accum_weight += closest.bone_weights[j];
+
+            }
+
+            // If the accum weight is 0, we understand that no bones have been
+            // applied.
+            if (accum_weight == 0.0) {
+
+                // Set the original point as the final point.
+                interpol_pnt = aux_pnt;
+
+            } else {
+
+                // Normalise the boneVertex;
+                interpol_pnt /= accum_weight;
+
+            }
+
+            // Then, apply the very same transformations we applied to the hand.
+            aux_pnt = hand.getMeshes()[0].getTransformMat() * interpol_pnt;
+
+            // Put that back in the keypoint.
+            keypoints[i] = glm::vec3(aux_pnt);
+
+        }
+
+    }
+
+    void Generator::projectKeypoints(Camera &camera, const std::vector<glm::vec3> &keypoints, int width, int height, std::vector<float> &annotations) {
+
+        // Now we're gonna calculate, for each keypoints, their coordinates and matrixes.
+        glm::mat4 mvp_matrix = camera.getProjection() * camera.getView();
+
+        // For each keypoint, do that.
+        annotations.resize(keypoints.size() * 3);
+        for (unsigned int i = 0; i < keypoints.size(); i++) {
+
+            // Calculate its homogeneous coordinates.
+            glm::vec4 homogeneous_keypoint = mvp_matrix * glm::vec4(keypoints[i], 1.0f);
+
+            // Transform to clipping space.
+            glm::vec3 clip_keypoint = glm::vec3(homogeneous_keypoint) / homogeneous_keypoint.w;
+
+            // Transform them to pixel coordinates.
+            annotations[i * 3] = (clip_keypoint.x + 1.0f) / 2.0f * width;
+            annotations[i * 3 + 1] = (-clip_keypoint.y + 1.0f) / 2.0f * height;
+            annotations[i * 3 + 2] = 1.0f;
+
+        }
+
+    }
+
+    std::string Generator::getBackgroundFilename(const std::string &backgrounds_path, int backgr_id) {
+
+        // Get the name with the right amount of zeros.
+        std::string bg_filename = "000000000000" + std::to_string(backgr_id);
+        bg_filename = bg_filename.substr(bg_filename.size() - 12);
+
+        return backgrounds_path + "rdm_bg_" + bg_filename + ".jpg";
+
+    }
+
+}  // namespace bgq_opengl
@@ -0,0 +1,206 @@
+/**
+ * @file generator.h
+ * @brief Generator class header file.
+ * @version 1.0.0 (2024-03-24)
+ * @date 2024-03-24
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_CLASSES_GENERATOR_H_
+#define BGQ_OPENGL_CLASSES_GENERATOR_H_
+
+#include <string>
+#include <vector>
+
+#include "GL/glew.h"
+#include "GLFW/glfw3.h"
+#include "glm/glm.hpp"
+
+#include "classes/background/background.h"
+#include "classes/camera/camera.h"
+#include "classes/fbo/fbo.h"
+#include "classes/object_rigged/object_rigged.h"
+#include "classes/shader/shader.h"
+#include "structs/render_params/render_params.h"
+
+#define NUM_OF_KEYPOINTS 21
+
+namespace bgq_opengl {
+
+    /**
+     * @brief Implementation of a Generator class.
+     *
+     * Implementation of a generator that renders samples from the values of
+     * their parameters, for programs that embed it instead of running the
+     * whole application. It opens its own hidden window, loads the hand and
+     * the shaders once, and draws each batch into the tiles of a framebuffer
+     * that is read back at once. The hand is posed, and its keypoints found
+     * and projected, by the same functions the application uses.
+     *
+     * @author Borja García Quiroga <garcaqub@tcd.ie>
+     */
+    class Generator {
+
+    public:
+
+        /**
+         * @brief Creates a new generator.
+         *
+         * Creates the OpenGL context of the generator and loads everything
+         * it draws with.
+         *
+         * @param width The width of the images.
+         * @param height The height of the images.
+         * @param max_batch_size The most samples that can be rendered at once.
+         * @param resources_dir The directory of the hand, its textures and the shaders, or empty for the working directory.
+         * @param backgrounds_path The directory of the background images.
+         *
+         * @throws std::runtime_error If a resource is missing or the context cannot be created.
+         */
+        Generator(int width, int height, int max_batch_size, const std::string &resources_dir, const std::string &backgrounds_path);
+
+        /**
+         * @brief Destroys the generator.
+         *
+         * Frees everything it drew with and closes its window.
+         */
+        ~Generator();
+
+        Generator(const Generator&) = delete;
+        Generator& operator=(const Generator&) = delete;
+
+        /**
+         * @brief Render a batch.
+         *
+         * Render some samples with the default camera. The images and the
+         * keypoints stay in the buffers of the generator until the next
+         * batch.
+         *
+         * @param params The parameters of each of the samples, at most max_batch_size.
+         *
+         * @throws std::invalid_argument If the batch is larger than max_batch_size.
+         */
+        void render(const std::vector<RenderParams> &params);
+
+        /**
+         * @brief Get the images.
+         *
+         * Get the images of the last batch, one after the other, each with
+         * its rows of RGB pixels top first. There is room for max_batch_size
+         * images, and the buffer never moves.
+         *
+         * @returns The pixels.
+         */
+        const std::vector<unsigned char>& getImages() const;
+
+        /**
+         * @brief Get the keypoints.
+         *
+         * Get the keypoints of the last batch, NUM_OF_KEYPOINTS per sample,
+         * as x, y and z in pixels from the top left corner. There is room for
+         * max_batch_size samples, and the buffer never moves.
+         *
+         * @returns The keypoints.
+         */
+        const std::vector<float>& getKeypoints() const;
+
+        /**
+         * @brief Get the width.
+         *
+         * @returns The width of the images.
+         */
+        int getWidth() const;
+
+        /**
+         * @brief Get the height.
+         *
+         * @returns The height of the images.
+         */
+        int getHeight() const;
+
+        /**
+         * @brief Get the largest batch.
+         *
+         * @returns The most samples that can be rendered at once.
+         */
+        int getMaxBatchSize() const;
+
+        /**
+         * @brief Pose the hand.
+         *
+         * Move the hand to the centre of the scene, normalise its size and
+         * apply the arm transform and the joint angles of a sample.
+         *
+         * @param hand The hand.
+         * @param joint_angles The euler angles of each joint in degrees, empty for the rest pose.
+         * @param arm_position The translation of the arm.
+         * @param arm_rotation The euler angles of the arm in degrees.
+         */
+        static void poseHand(ObjectRigged &hand, const std::vector<glm::vec3> &joint_angles, glm::vec3 arm_position, glm::vec3 arm_rotation);
+
+        /**
+         * @brief Calculate the keypoints.
+         *
+         * Find the keypoints of a posed hand in world space, skinning their
+         * reference vertices like the shaders do.
+         *
+         * @param hand The posed hand.
+         * @param keypoints Output vector for the NUM_OF_KEYPOINTS keypoints.
+         */
+        static void calculateKeypoints(ObjectRigged &hand, std::vector<glm::vec3> &keypoints);
+
+        /**
+         * @brief Project the keypoints.
+         *
+         * Project the keypoints into the pixels of the image of a camera.
+         *
+         * @param camera The camera.
+         * @param keypoints The keypoints in world space.
+         * @param width The width of the image.
+         * @param height The height of the image.
+         * @param annotations Output vector for the x, y and z of each keypoint, in pixels from the top left corner.
+         */
+        static void projectKeypoints(Camera &camera, const std::vector<glm::vec3> &keypoints, int width, int height, std::vector<float> &annotations);
+
+        /**
+         * @brief Get the file of a background image.
+         *
+         * @param backgrounds_path The directory of the background images.
+         * @param backgr_id The id of the background image.
+         *
+         * @returns The path of the image.
+         */
+        static std::string getBackgroundFilename(const std::string &backgrounds_path, int backgr_id);
+
+    private:
+
+        int width;                          /// The width of the images.
+        int height;                         /// The height of the images.
+        int max_batch_size;                 /// The most samples of a batch.
+        std::string backgrounds_path;       /// The directory of the background images.
+        GLFWwindow* window = nullptr;       /// The hidden window that owns the context.
+        Shader* shader = nullptr;           /// The shaders of the hand.
+        Shader* shaderBck = nullptr;        /// The shaders of the background.
+        ObjectRigged* hand = nullptr;       /// The hand.
+        Background* backbox = nullptr;      /// The quad the backgrounds are drawn on.
+        FBO* fbo = nullptr;                 /// The tiles the batches are drawn into.
+        Camera camera;                      /// The default camera.
+        std::vector<glm::vec3> keypoints;   /// The keypoints of the sample being drawn.
+        std::vector<float> annotations;     /// The projected keypoints of the sample being drawn.
+        std::vector<unsigned char> pixels;  /// The whole framebuffer, bottom row first.
+        std::vector<unsigned char> tile_pixels;     /// The tile being cut out.
+        std::vector<unsigned char> images;  /// The images of the last batch.
+        std::vector<float> batch_keypoints; /// The keypoints of the last batch.
+
+    };
+
+}  // namespace bgq_opengl
+
+#endif  //!BGQ_OPENGL_CLASSES_GENERATOR_H_
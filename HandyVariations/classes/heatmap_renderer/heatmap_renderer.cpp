@@ -0,0 +1,309 @@
+/**
+ * @file heatmap_renderer.cpp
+ * @brief HeatmapRenderer class implementation file.
+ * @version 1.0.0 (2024-03-24)
+ * @date 2024-03-24
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#include "heatmap_renderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace bgq_opengl {
+
+    namespace {
+
+        inline uint32_t floatBits(float value) {
+
+            uint32_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            return bits;
+
+        }
+
+        inline float bitsFloat(uint32_t bits) {
+
+            float value;
+            memcpy(&value, &bits, sizeof(value));
+            return value;
+
+        }
+
+        // Round a float to the nearest half, ties to even, like the
+        // conversion instructions do.
+        uint16_t toHalf(float value) {
+
+            uint32_t bits = floatBits(value);
+            uint32_t sign = bits & 0x80000000u;
+            bits ^= sign;
+
+            uint16_t half;
+
+            if (bits >= (127u + 16u) << 23) {
+
+                // Too large for a half, or not a number at all.
+                half = (bits > 255u << 23) ? 0x7e00 : 0x7c00;
+
+            } else if (bits < 113u << 23) {
+
+                // Subnormal, so let the addition round the mantissa.
+                const uint32_t magic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+                half = (uint16_t) (floatBits(bitsFloat(bits) + bitsFloat(magic)) - magic);
+
+            } else {
+
+                // Normal, so rebias the exponent and round the mantissa.
+                uint32_t odd = (bits >> 13) & 1u;
+                bits += ((uint32_t) (15 - 127) << 23) + 0xfffu + odd;
+                half = (uint16_t) (bits >> 13);
+
+            }
+
+            return half | (uint16_t) (sign >> 16);
+
+        }
+
+        // Fill a row of a heatmap with a profile times a weight, from the
+        // element begin to the element end.
+        void splatRowScalar(const float* profile, float weight, int begin, int end, TensorType type, unsigned char* row) {
+
+            if (type == TENSOR_UINT8) {
+
+                for (int x = begin; x < end; x++)
+                    row[x] = (unsigned char) std::lrint(profile[x] * weight);
+
+            } else {
+
+                uint16_t* halves = (uint16_t*) row;
+                for (int x = begin; x < end; x++)
+                    halves[x] = toHalf(profile[x] * weight);
+
+            }
+
+        }
+
+#if defined(__x86_64__) || defined(__i386__)
+
+        // Built for AVX2 whatever the flags of the build, and only called if
+        // the processor has it. The halves need F16C, which comes with it.
+        __attribute__((target("avx2,f16c")))
+        void splatRowAVX2(const float* profile, float weight, int begin, int end, TensorType type, unsigned char* row) {
+
+            const __m256 weights = _mm256_set1_ps(weight);
+
+            // Eight elements at a time, rounded to the nearest even like
+            // the scalar path.
+            int x = begin;
+            for (; x + 8 <= end; x += 8) {
+
+                __m256 values = _mm256_mul_ps(_mm256_loadu_ps(profile + x), weights);
+
+                if (type == TENSOR_UINT8) {
+                    __m256i integers = _mm256_cvtps_epi32(values);
+                    __m128i words = _mm_packus_epi32(_mm256_castsi256_si128(integers), _mm256_extracti128_si256(integers, 1));
+                    _mm_storel_epi64((__m128i*) (row + x), _mm_packus_epi16(words, words));
+                } else {
+                    __m128i halves = _mm256_cvtps_ph(values, _MM_FROUND_TO_NEAREST_INT);
+                    _mm_storeu_si128((__m128i*) (row + (size_t) x * 2), halves);
+                }
+
+            }
+
+            // The elements left.
+            splatRowScalar(profile, weight, x, end, type, row);
+
+        }
+
+#elif defined(__ARM_NEON)
+
+        void splatRowNEON(const float* profile, float weight, int begin, int end, TensorType type, unsigned char* row) {
+
+            // Eight elements at a time, rounded to the nearest even like the
+            // scalar path.
+            int x = begin;
+            for (; x + 8 <= end; x += 8) {
+
+                float32x4_t low = vmulq_n_f32(vld1q_f32(profile + x), weight);
+                float32x4_t high = vmulq_n_f32(vld1q_f32(profile + x + 4), weight);
+
+                if (type == TENSOR_UINT8) {
+                    uint16x8_t words = vcombine_u16(vqmovn_u32(vcvtnq_u32_f32(low)), vqmovn_u32(vcvtnq_u32_f32(high)));
+                    vst1_u8(row + x, vqmovn_u16(words));
+                } else {
+                    uint16_t* halves = (uint16_t*) row + x;
+                    vst1_u16(halves, vreinterpret_u16_f16(vcvt_f16_f32(low)));
+                    vst1_u16(halves + 4, vreinterpret_u16_f16(vcvt_f16_f32(high)));
+                }
+
+            }
+
+            // The elements left.
+            splatRowScalar(profile, weight, x, end, type, row);
+
+        }
+
+#endif
+
+        void splatRow(const float* profile, float weight, int begin, int end, TensorType type, unsigned char* row) {
+
+#if defined(__x86_64__) || defined(__i386__)
+            static const bool has_avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c");
+            if (has_avx2) {
+                splatRowAVX2(profile, weight, begin, end, type, row);
+                return;
+            }
+#elif defined(__ARM_NEON)
+            splatRowNEON(profile, weight, begin, end, type, row);
+            return;
+#endif
+
+            splatRowScalar(profile, weight, begin, end, type, row);
+
+        }
+
+    }  // namespace
+
+    HeatmapRenderer::HeatmapRenderer(int num_of_keypoints, int size, int image_width, int image_height, float sigma, int radius, TensorType type) {
+
+        this->num_of_keypoints = num_of_keypoints;
+        this->size = size;
+        this->image_width = image_width;
+        this->image_height = image_height;
+        this->radius = radius;
+        this->type = type;
+
+        // The Gaussian is symmetric, so keep half of it.
+        this->gaussian.resize(radius + 1);
+        for (int d = 0; d <= radius; d++)
+            this->gaussian[d] = std::exp(-(double) d * d / (2.0 * sigma * sigma));
+
+    }
+
+    void HeatmapRenderer::render(const std::vector<float> &annotations, void* output) const {
+
+        size_t element_size = (this->type == TENSOR_UINT8) ? 1 : 2;
+        size_t row_size = (size_t) this->size * element_size;
+        size_t heatmap_size = row_size * this->size;
+
+        // Most of every heatmap is empty.
+        unsigned char* heatmaps = (unsigned char*) output;
+        memset(heatmaps, 0, this->getSampleSize());
+
+        // The uint8 heatmaps go from 0 to 255.
+        float scale = (this->type == TENSOR_UINT8) ? 255.0f : 1.0f;
+
+        thread_local std::vector<float> columns, rows;
+        columns.resize(this->size);
+        rows.resize(this->size);
+
+        for (int k = 0; k < this->num_of_keypoints && (size_t) k * 3 + 1 < annotations.size(); k++) {
+
+            // Put the keypoint in the same pixel the trainer does, leaving
+            // the heatmap empty if it is outside.
+            double x = (double) annotations[k * 3] / this->image_width * this->size;
+            double y = (double) annotations[k * 3 + 1] / this->image_height * this->size;
+
+            if (!(x > -1.0 && x < this->size && y > -1.0 && y < this->size))
+                continue;
+
+            int center_x = (int) x;
+            int center_y = (int) y;
+
+            this->findProfile(center_x, columns.data());
+            this->findProfile(center_y, rows.data());
+
+            // Only the rows and columns under the Gaussian are not empty.
+            int first_x = std::max(center_x - this->radius, 0);
+            int last_x = std::min(center_x + this->radius + 1, this->size);
+            int first_y = std::max(center_y - this->radius, 0);
+            int last_y = std::min(center_y + this->radius + 1, this->size);
+
+            unsigned char* heatmap = heatmaps + (size_t) k * heatmap_size;
+            for (int row = first_y; row < last_y; row++)
+                splatRow(columns.data(), rows[row] * scale, first_x, last_x, this->type, heatmap + (size_t) row * row_size);
+
+        }
+
+    }
+
+    std::vector<int> HeatmapRenderer::getShape() const {
+
+        return {this->num_of_keypoints, this->size, this->size};
+
+    }
+
+    size_t HeatmapRenderer::getSampleSize() const {
+
+        size_t element_size = (this->type == TENSOR_UINT8) ? 1 : 2;
+        return (size_t) this->num_of_keypoints * this->size * this->size * element_size;
+
+    }
+
+    const char* HeatmapRenderer::getInstructionSet() {
+
+#if defined(__x86_64__) || defined(__i386__)
+        return (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c")) ? "AVX2" : "scalar";
+#elif defined(__ARM_NEON)
+        return "NEON";
+#else
+        return "scalar";
+#endif
+
+    }
+
+    void HeatmapRenderer::findProfile(int center, float* profile) const {
+
+        int first = std::max(center - this->radius, 0);
+        int last = std::min(center + this->radius + 1, this->size);
+
+        std::fill(profile, profile + this->size, 0.0f);
+
+        // The Gaussian at a distance, or nothing past the radius.
+        auto gaussian = [this](int distance) {
+            distance = std::abs(distance);
+            return (distance <= this->radius) ? this->gaussian[distance] : 0.0;
+        };
+
+        // OpenCV reflects the edges without repeating the edge pixel, so a
+        // keypoint near one is also blurred from its reflection. Those only
+        // reach the pixels the Gaussian already covers.
+        double peak = 0.0;
+        thread_local std::vector<double> values;
+        values.resize(last - first);
+        for (int i = first; i < last; i++) {
+
+            double value = gaussian(i - center);
+            if (center > 0)
+                value += gaussian(i + center);
+            if (center < this->size - 1)
+                value += gaussian(2 * (this->size - 1) - center - i);
+
+            values[i - first] = value;
+            peak = std::max(peak, value);
+
+        }
+
+        // Scale it so that the heatmap peaks at 1.
+        for (int i = first; i < last; i++)
+            profile[i] = (float) (values[i - first] / peak);
+
+    }
+
+}  // namespace bgq_opengl
@@ -0,0 +1,125 @@
+/**
+ * @file heatmap_renderer.h
+ * @brief HeatmapRenderer class header file.
+ * @version 1.0.0 (2024-03-24)
+ * @date 2024-03-24
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_CLASSES_HEATMAP_RENDERER_H_
+#define BGQ_OPENGL_CLASSES_HEATMAP_RENDERER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "classes/tensor_shard_writer/tensor_shard_writer.h"
+
+namespace bgq_opengl {
+
+    /**
+     * @brief Implementation of a HeatmapRenderer class.
+     *
+     * Implementation of the heatmaps the trainer learns the keypoints from,
+     * one per keypoint. Each of them is the pixel of its keypoint blurred
+     * with a truncated Gaussian and scaled to a peak of 1, with the edges
+     * reflected like OpenCV does. The Gaussian is separable, so each heatmap
+     * is the product of a row and a column profile, and only the rows under
+     * the Gaussian are filled. They are quantised to uint8 or float16 with
+     * AVX2 or NEON when available, and every path gives exactly the same
+     * result. Rendering is thread safe.
+     *
+     * @author Borja García Quiroga <garcaqub@tcd.ie>
+     */
+    class HeatmapRenderer {
+
+    public:
+
+        /**
+         * @brief Creates a new heatmap renderer.
+         *
+         * Creates a new heatmap renderer for the keypoints of images of a
+         * given size.
+         *
+         * @param num_of_keypoints The amount of keypoints, and of heatmaps.
+         * @param size The width and height of the heatmaps.
+         * @param image_width The width of the images the keypoints are in.
+         * @param image_height The height of the images the keypoints are in.
+         * @param sigma The standard deviation of the Gaussian, in pixels of the heatmaps.
+         * @param radius The radius the Gaussian is truncated at.
+         * @param type The type of the elements, TENSOR_UINT8 or TENSOR_FLOAT16.
+         */
+        HeatmapRenderer(int num_of_keypoints, int size, int image_width, int image_height, float sigma, int radius, TensorType type);
+
+        /**
+         * @brief Render the heatmaps of some keypoints.
+         *
+         * Render the heatmaps of some keypoints, one after the other. The
+         * heatmap of a keypoint outside the image is empty.
+         *
+         * @param annotations The x, y and z of each keypoint, in pixels from the top left corner.
+         * @param output Output buffer of getSampleSize() bytes.
+         */
+        void render(const std::vector<float> &annotations, void* output) const;
+
+        /**
+         * @brief Get the shape of a sample.
+         *
+         * Get the shape of the heatmaps of a sample, keypoints first.
+         *
+         * @returns The shape.
+         */
+        std::vector<int> getShape() const;
+
+        /**
+         * @brief Get the size of a sample.
+         *
+         * Get the size of the heatmaps of a sample.
+         *
+         * @returns The size in bytes.
+         */
+        size_t getSampleSize() const;
+
+        /**
+         * @brief Get the instruction set.
+         *
+         * Get the name of the instructions the heatmaps are quantised with
+         * on this processor.
+         *
+         * @returns The name of the instruction set.
+         */
+        static const char* getInstructionSet();
+
+    private:
+
+        /**
+         * @brief Find the profile of an axis.
+         *
+         * Find the Gaussian along an axis around the pixel of a keypoint,
+         * with the edges reflected, scaled to a peak of 1.
+         *
+         * @param center The pixel of the keypoint.
+         * @param profile Output array of size values.
+         */
+        void findProfile(int center, float* profile) const;
+
+        int num_of_keypoints;               /// The amount of keypoints.
+        int size;                           /// The width and height of the heatmaps.
+        int image_width;                    /// The width of the images.
+        int image_height;                   /// The height of the images.
+        int radius;                         /// The radius the Gaussian is truncated at.
+        TensorType type;                    /// The type of the elements.
+        std::vector<double> gaussian;       /// The Gaussian from its centre to the radius.
+
+    };
+
+}  // namespace bgq_opengl
+
+#endif  //!BGQ_OPENGL_CLASSES_HEATMAP_RENDERER_H_
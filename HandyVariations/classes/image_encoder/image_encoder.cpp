@@ -0,0 +1,205 @@
+/**
+ * @file image_encoder.cpp
+ * @brief Image encoder class implementation file.
+ * @version 1.0.0 (2024-03-17)
+ * @date 2024-03-17
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#include "image_encoder.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "stb/stb_image_write.h"
+
+namespace bgq_opengl {
+
+    ImageEncoder::ImageEncoder(ImageCodec codec, int jpeg_quality, int png_compression_level, int png_filter) {
+
+        this->codec = codec;
+        this->jpeg_quality = jpeg_quality;
+
+        // OpenGL gives the rows bottom to top.
+        stbi_flip_vertically_on_write(1);
+
+        // These are global to stb, so they are set once here.
+        if (codec == CODEC_PNG) {
+            stbi_write_png_compression_level = png_compression_level;
+            stbi_write_force_png_filter = png_filter;
+        }
+
+    }
+
+    void ImageEncoder::encode(const std::vector<unsigned char> &pixels, int width, int height, std::vector<unsigned char> &output) const {
+
+        output.clear();
+
+        if (this->codec == CODEC_QOI) {
+            encodeQoi(pixels, width, height, output);
+            return;
+        }
+
+        if (this->codec == CODEC_PPM) {
+            encodePpm(pixels, width, height, output);
+            return;
+        }
+
+        // Append every chunk produced by stb to the output.
+        auto write_chunk = [](void* context, void* data, int size) {
+            std::vector<unsigned char>* chunks = (std::vector<unsigned char>*) context;
+            chunks->insert(chunks->end(), (unsigned char*) data, (unsigned char*) data + size);
+        };
+
+        if (this->codec == CODEC_PNG)
+            stbi_write_png_to_func(write_chunk, &output, width, height, 3, pixels.data(), width * 3);
+        else
+            stbi_write_jpg_to_func(write_chunk, &output, width, height, 3, pixels.data(), this->jpeg_quality);
+
+    }
+
+    ImageCodec ImageEncoder::getCodec() const {
+
+        return this->codec;
+
+    }
+
+    const char* ImageEncoder::getExtension(int codec) {
+
+        static const char* extensions[] = {"jpg", "png", "qoi", "ppm"};
+
+        if (codec < CODEC_JPEG || codec > CODEC_PPM)
+            return extensions[CODEC_JPEG];
+
+        return extensions[codec];
+
+    }
+
+    void ImageEncoder::encodeQoi(const std::vector<unsigned char> &pixels, int width, int height, std::vector<unsigned char> &output) {
+
+        // The worst case is a 4 byte op per pixel, plus the header and the end.
+        output.resize(14 + (size_t) width * height * 4 + 8);
+        unsigned char* out = output.data();
+
+        // Write the header, with big endian sizes.
+        memcpy(out, "qoif", 4);
+        for (int i = 0; i < 4; i++) {
+            out[4 + i] = (unsigned char) ((uint32_t) width >> (24 - i * 8));
+            out[8 + i] = (unsigned char) ((uint32_t) height >> (24 - i * 8));
+        }
+        out[12] = 3;                        // Channels.
+        out[13] = 0;                        // sRGB with linear alpha.
+        size_t position = 14;
+
+        // The alpha is always opaque, so only the colour is tracked. The slots
+        // start empty, as the ones of the decoder are transparent black.
+        unsigned char index[64][3];
+        bool used[64];
+        memset(used, 0, sizeof(used));
+
+        unsigned char previous[3] = {0, 0, 0};
+        int run = 0;
+        size_t row_size = (size_t) width * 3;
+        size_t num_of_pixels = (size_t) width * height;
+        size_t pixel = 0;
+
+        for (int y = height - 1; y >= 0; y--) {
+
+            const unsigned char* row = pixels.data() + y * row_size;
+
+            for (int x = 0; x < width; x++, pixel++) {
+
+                const unsigned char* current = row + x * 3;
+
+                // Extend the current run while the pixel repeats.
+                if (current[0] == previous[0] && current[1] == previous[1] && current[2] == previous[2]) {
+
+                    run++;
+                    if (run == 62 || pixel == num_of_pixels - 1) {
+                        out[position++] = 0xC0 | (run - 1);
+                        run = 0;
+                    }
+
+                    continue;
+
+                }
+
+                if (run > 0) {
+                    out[position++] = 0xC0 | (run - 1);
+                    run = 0;
+                }
+
+                // Refer to a recently seen pixel if possible.
+                int hash = (current[0] * 3 + current[1] * 5 + current[2] * 7 + 255 * 11) % 64;
+
+                if (used[hash] && memcmp(index[hash], current, 3) == 0) {
+
+                    out[position++] = (unsigned char) hash;
+
+                } else {
+
+                    memcpy(index[hash], current, 3);
+                    used[hash] = true;
+
+                    // Otherwise store the difference to the previous pixel
+                    // in as few bytes as possible.
+                    signed char dr = (signed char) (current[0] - previous[0]);
+                    signed char dg = (signed char) (current[1] - previous[1]);
+                    signed char db = (signed char) (current[2] - previous[2]);
+                    signed char dr_dg = (signed char) (dr - dg);
+                    signed char db_dg = (signed char) (db - dg);
+
+                    if (dr > -3 && dr < 2 && dg > -3 && dg < 2 && db > -3 && db < 2) {
+                        out[position++] = 0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2);
+                    } else if (dr_dg > -9 && dr_dg < 8 && dg > -33 && dg < 32 && db_dg > -9 && db_dg < 8) {
+                        out[position++] = 0x80 | (dg + 32);
+                        out[position++] = (dr_dg + 8) << 4 | (db_dg + 8);
+                    } else {
+                        out[position++] = 0xFE;
+                        out[position++] = current[0];
+                        out[position++] = current[1];
+                        out[position++] = current[2];
+                    }
+
+                }
+
+                memcpy(previous, current, 3);
+
+            }
+
+        }
+
+        // Mark the end of the stream.
+        static const unsigned char end[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+        memcpy(out + position, end, 8);
+        position += 8;
+
+        output.resize(position);
+
+    }
+
+    void ImageEncoder::encodePpm(const std::vector<unsigned char> &pixels, int width, int height, std::vector<unsigned char> &output) {
+
+        char header[32];
+        int header_size = snprintf(header, 32, "P6\n%i %i\n255\n", width, height);
+
+        size_t row_size = (size_t) width * 3;
+        output.resize(header_size + row_size * height);
+        memcpy(output.data(), header, header_size);
+
+        // Store the rows top to bottom.
+        for (int y = 0; y < height; y++)
+            memcpy(output.data() + header_size + y * row_size, pixels.data() + (height - 1 - y) * row_size, row_size);
+
+    }
+
+}  // namespace bgq_opengl
@@ -0,0 +1,123 @@
+/**
+ * @file image_encoder.h
+ * @brief Image encoder class header file.
+ * @version 1.0.0 (2024-03-17)
+ * @date 2024-03-17
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_CLASSES_IMAGE_ENCODER_H_
+#define BGQ_OPENGL_CLASSES_IMAGE_ENCODER_H_
+
+#include <vector>
+
+namespace bgq_opengl {
+
+    /// The codecs the images can be encoded with.
+    enum ImageCodec {
+        CODEC_JPEG = 0,                     /// Lossy jpg.
+        CODEC_PNG = 1,                      /// Lossless png.
+        CODEC_QOI = 2,                      /// Lossless qoi, much faster than png.
+        CODEC_PPM = 3,                      /// Uncompressed binary ppm.
+    };
+
+    /**
+     * @brief Implementation of an ImageEncoder class.
+     *
+     * Implementation of an encoder that turns the RGB8 pixels read from an
+     * OpenGL framebuffer, bottom row first, into an image file in memory.
+     * Encoding is thread safe. The png settings are global to stb, so they are
+     * applied when the encoder is created, and png encoders with different
+     * settings must not be used at the same time.
+     *
+     * @author Borja García Quiroga <garcaqub@tcd.ie>
+     */
+    class ImageEncoder {
+
+    public:
+
+        /**
+         * @brief Creates a new encoder.
+         *
+         * Creates a new encoder for a codec.
+         *
+         * @param codec The codec.
+         * @param jpeg_quality The quality of the jpg images, from 1 to 100.
+         * @param png_compression_level The zlib level of the png images, from 0 to 9.
+         * @param png_filter The png filter used on every row, or -1 to pick the best one per row.
+         */
+        ImageEncoder(ImageCodec codec, int jpeg_quality = 95, int png_compression_level = 8, int png_filter = -1);
+
+        /**
+         * @brief Encode an image.
+         *
+         * Encode some tightly packed RGB8 pixels, bottom row first.
+         *
+         * @param pixels The pixels.
+         * @param width The width of the image.
+         * @param height The height of the image.
+         * @param output Output vector for the encoded image.
+         */
+        void encode(const std::vector<unsigned char> &pixels, int width, int height, std::vector<unsigned char> &output) const;
+
+        /**
+         * @brief Get the codec.
+         *
+         * Get the codec of the encoder.
+         *
+         * @returns The codec.
+         */
+        ImageCodec getCodec() const;
+
+        /**
+         * @brief Get the extension of a codec.
+         *
+         * Get the file extension of the images of a codec, without the dot.
+         *
+         * @param codec The codec.
+         *
+         * @returns The extension.
+         */
+        static const char* getExtension(int codec);
+
+    private:
+
+        /**
+         * @brief Encode an image as qoi.
+         *
+         * Encode an image following the qoi specification, with 3 channels.
+         *
+         * @param pixels The pixels.
+         * @param width The width of the image.
+         * @param height The height of the image.
+         * @param output Output vector for the encoded image.
+         */
+        static void encodeQoi(const std::vector<unsigned char> &pixels, int width, int height, std::vector<unsigned char> &output);
+
+        /**
+         * @brief Encode an image as ppm.
+         *
+         * Encode an image as a binary ppm, which is just a header and the rows.
+         *
+         * @param pixels The pixels.
+         * @param width The width of the image.
+         * @param height The height of the image.
+         * @param output Output vector for the encoded image.
+         */
+        static void encodePpm(const std::vector<unsigned char> &pixels, int width, int height, std::vector<unsigned char> &output);
+
+        ImageCodec codec;                   /// The codec.
+        int jpeg_quality;                   /// The quality of the jpg images.
+
+    };
+
+}  // namespace bgq_opengl
+
+#endif  //!BGQ_OPENGL_CLASSES_IMAGE_ENCODER_H_
@@ -15,6 +15,9 @@
 
 #include "mesh.h"
 
+#include <algorithm>
+#include <memory>
+#include <string>
 #include <vector>
 #include <stdexcept>
 #include <iostream>
@@ -31,15 +34,18 @@
 #include "classes/bone/bone.h"
 #include "classes/camera/camera.h"
 #include "classes/ebo/ebo.h"
+#include "classes/light/light.h"
 #include "classes/shader/shader.h"
+#include "classes/tbo/tbo.h"
 #include "classes/texture/texture.h"
 #include "classes/vao/vao.h"
+#include "classes/xfb/xfb.h"
 #include "structs/vertex/vertex.h"
 #include "structs/bounding_box/bounding_box.h"
 
 namespace bgq_opengl {
 
-	Mesh::Mesh(const aiScene* scene, const aiMesh* mesh) {
+	Mesh::Mesh(const aiScene* scene, const aiMesh* mesh, const std::string &textures_dir) {
         
         // Store the global transform.
         this->global_trans = aiMatToGLM(scene->mRootNode->mTransformation);
@@ -174,7 +180,7 @@ namespace bgq_opengl {
 		// Generate a VAO and bind it, generate a VBO for the vertices and a EBO for the indices.
 		this->vao.bind();
 		VBO vbo(this->vertices);
-		EBO ebo(this->indices);
+		this->element_buffer = std::make_unique<EBO>(this->indices);
 
 		// Links VBO attributes such as coordinates and colors to VAO.
 		vao.link_attribute(vbo, 0, 3, GL_FLOAT, sizeof(bgq_opengl::Vertex), (void*) offsetof(Vertex, position));
@@ -188,12 +194,12 @@ namespace bgq_opengl {
 
 		vao.unbind();
 		vbo.unbind();
-		ebo.unbind();
+		this->element_buffer->unbind();
         
         // Load the textures.
-        this->textures.push_back(Texture("hand_base_color.jpg", "baseColor", 1));
-        this->textures.push_back(Texture("hand_normals.jpg", "normalMap", 2));
-        this->textures.push_back(Texture("hand_specular.jpg", "specularMap", 3));
+        this->textures.push_back(Texture((textures_dir + "hand_base_color.jpg").c_str(), "baseColor", 1));
+        this->textures.push_back(Texture((textures_dir + "hand_normals.jpg").c_str(), "normalMap", 2));
+        this->textures.push_back(Texture((textures_dir + "hand_specular.jpg").c_str(), "specularMap", 3));
 
 	}
 
@@ -316,6 +322,68 @@ namespace bgq_opengl {
             
         }
 
+		// Pass the model, modelView and normal matrices.
+		this->passTransforms(shader, camera);
+
+		// Draw the actual Mesh
+		shader.passBool("instanced", false);
+		glDrawElements(GL_TRIANGLES, (GLsizei) this->indices.size(), GL_UNSIGNED_INT, 0);
+
+	}
+
+    void Mesh::skin(Shader &shader) {
+        
+        // Activate the VAO and the shader to access the uniforms.
+        shader.activate();
+        vao.bind();
+        
+        // Pass the bones to the shader.
+        for (std::map<std::string, Bone>::iterator it = this->bone_mapping.begin();
+             it != this->bone_mapping.end(); it++) {
+            
+            shader.passBone("boneMatrices", it->second);
+            
+        }
+        
+        if (this->skin_cache == nullptr)
+            this->skin_cache = std::make_unique<XFB>((GLsizei) this->vertices.size(), *this->element_buffer);
+        
+        // Skin every vertex once, in order, so the indices still apply.
+        this->skin_cache->begin();
+        glDrawArrays(GL_POINTS, 0, (GLsizei) this->vertices.size());
+        this->skin_cache->end();
+        
+    }
+
+    void Mesh::drawSkinned(Shader &shader, Camera &camera) {
+        
+        if (this->skin_cache == nullptr)
+            return;
+        
+        // Activate the skinned vertices and the shader to access the uniforms.
+        shader.activate();
+        this->skin_cache->bind();
+        
+        for (size_t i = 0; i < textures.size(); i++) {
+            
+            textures[i].bind();
+            shader.passTexture(textures[i]);
+            
+        }
+        
+        // Pass the camera to the shader. The bones are already applied.
+        shader.passCamera(camera);
+        shader.passFloat("materialShininess", this->shininess);
+        this->passTransforms(shader, camera);
+        
+        // Draw the skinned Mesh.
+        shader.passBool("instanced", false);
+        glDrawElements(GL_TRIANGLES, (GLsizei) this->indices.size(), GL_UNSIGNED_INT, 0);
+        
+    }
+
+    void Mesh::passTransforms(Shader &shader, Camera &camera) {
+        
 		// Get the model matrix and pass it.
 		glm::mat4 model = this->transforms;
 		glUniformMatrix4fv(glGetUniformLocation(shader.getProgramID(), "Model"), 1, GL_FALSE, glm::value_ptr(model));
@@ -328,11 +396,147 @@ namespace bgq_opengl {
 		// Get the normal matrix and pass it.
 		glm::mat4 normal_matrix = glm::transpose(glm::inverse(model_view));
 		glUniformMatrix4fv(glGetUniformLocation(shader.getProgramID(), "normalMatrix"), 1, GL_FALSE, glm::value_ptr(normal_matrix));
+        
+    }
 
-		// Draw the actual Mesh
-		glDrawElements(GL_TRIANGLES, (GLsizei) this->indices.size(), GL_UNSIGNED_INT, 0);
+    void Mesh::addInstance(const glm::mat4 &view, Light light, float skin_tone, float shininess, const glm::vec4 &tile) {
+        
+        // Get the matrices as they would be passed to the shader.
+        glm::mat4 model_view = view * this->transforms;
+        glm::mat4 normal_matrix = glm::transpose(glm::inverse(model_view));
+        
+        for (int i = 0; i < 4; i++)
+            this->instance_data.push_back(model_view[i]);
+        
+        for (int i = 0; i < 4; i++)
+            this->instance_data.push_back(normal_matrix[i]);
+        
+        // The light is passed in view space, like in passCamera.
+        glm::vec3 light_position = glm::vec3(view * glm::vec4(light.getPosition(), 1.0f));
+        this->instance_data.push_back(light.getColor());
+        this->instance_data.push_back(glm::vec4(light_position, light.getPower()));
+        
+        // The material and the tile.
+        this->instance_data.push_back(glm::vec4(skin_tone, shininess, 0.0f, 0.0f));
+        this->instance_data.push_back(tile);
+        
+        // The bone palette, indexed by the ID of each bone.
+        size_t palette = this->instance_data.size();
+        this->instance_data.resize(palette + this->bone_count * 4);
+        
+        for (std::map<std::string, Bone>::iterator it = this->bone_mapping.begin();
+             it != this->bone_mapping.end(); it++) {
+            
+            glm::mat4 bone_matrix = it->second.getTransformMatrix();
+            for (int i = 0; i < 4; i++)
+                this->instance_data[palette + it->second.getID() * 4 + i] = bone_matrix[i];
+            
+        }
+        
+    }
 
-	}
+    void Mesh::drawInstances(Shader &shader, Camera &camera, glm::vec2 framebuffer_size) {
+        
+        GLsizei num_of_instances = this->bindInstances(shader);
+        
+        if (num_of_instances == 0)
+            return;
+        
+        // Pass the camera to the shader. Everything else comes from the
+        // instance data.
+        shader.passCamera(camera);
+        shader.passVec("framebufferSize", framebuffer_size);
+        
+        // Draw all of them at once.
+        shader.passBool("instanced", true);
+        this->drawInstanceData(num_of_instances);
+        shader.passBool("instanced", false);
+        
+    }
+
+    void Mesh::drawInstances(Shader &shader, std::vector<Camera> &cameras, glm::vec2 framebuffer_size, int tile_columns) {
+        
+        GLsizei num_of_instances = this->bindInstances(shader);
+        
+        if (num_of_instances == 0)
+            return;
+        
+        // Pass every view. The lighting is done in the space of each view,
+        // where the camera is always at the origin.
+        int num_of_views = std::min((int) cameras.size(), MAX_INSTANCE_VIEWS);
+        for (int i = 0; i < num_of_views; i++) {
+            
+            shader.passMat("Views[" + std::to_string(i) + "]", cameras[i].getView());
+            shader.passMat("Projections[" + std::to_string(i) + "]", cameras[i].getProjection());
+            
+        }
+        
+        shader.passInt("numOfViews", num_of_views);
+        shader.passInt("tileColumns", tile_columns);
+        shader.passVec("cameraPosition", glm::vec3(0.0f));
+        shader.passVec("framebufferSize", framebuffer_size);
+        
+        // Skin every instance once and draw all of its views at once.
+        shader.passBool("instanced", true);
+        this->drawInstanceData(num_of_instances);
+        shader.passBool("instanced", false);
+        
+    }
+
+    GLsizei Mesh::bindInstances(Shader &shader) {
+        
+        int stride = INSTANCE_HEADER_TEXELS + this->bone_count * 4;
+        GLsizei num_of_instances = (GLsizei) (this->instance_data.size() / stride);
+        
+        if (num_of_instances == 0)
+            return 0;
+        
+        // Activate the VAO and the shader to access the uniforms.
+        shader.activate();
+        vao.bind();
+        
+        for (size_t i = 0; i < textures.size(); i++) {
+            
+            textures[i].bind();
+            shader.passTexture(textures[i]);
+            
+        }
+        
+        // The data of the instances is uploaded when they are drawn.
+        if (this->instance_buffer == nullptr)
+            this->instance_buffer = std::make_unique<TBO>();
+        
+        shader.passInt("instanceData", INSTANCE_DATA_SLOT);
+        shader.passInt("instanceStride", stride);
+        
+        return num_of_instances;
+        
+    }
+
+    void Mesh::drawInstanceData(GLsizei num_of_instances) {
+        
+        // A texture buffer can only hold so many texels, so the instances
+        // are drawn in as few chunks as fit in it. The limit is the one of
+        // the context the mesh was created in, so it is asked only once.
+        if (this->max_texels == 0)
+            glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &this->max_texels);
+        
+        int stride = INSTANCE_HEADER_TEXELS + this->bone_count * 4;
+        GLsizei chunk_size = std::max(this->max_texels / stride, 1);
+        
+        for (GLsizei first = 0; first < num_of_instances; first += chunk_size) {
+            
+            GLsizei num_of_chunk = std::min(chunk_size, num_of_instances - first);
+            this->instance_buffer->update(this->instance_data.data() + (size_t) first * stride, (size_t) num_of_chunk * stride);
+            this->instance_buffer->bind(INSTANCE_DATA_SLOT);
+            
+            glDrawElementsInstanced(GL_TRIANGLES, (GLsizei) this->indices.size(), GL_UNSIGNED_INT, 0, num_of_chunk);
+            
+        }
+        
+        this->instance_data.clear();
+        
+    }
 
 	BoundingBox Mesh::getBoundingBox() const {
 
@@ -370,6 +574,28 @@ namespace bgq_opengl {
 
 	}
 
+    void Mesh::remove() {
+        
+        this->vao.remove();
+        
+        if (this->instance_buffer != nullptr) {
+            
+            this->instance_buffer->remove();
+            this->instance_buffer.reset();
+            
+        }
+        
+        if (this->skin_cache != nullptr) {
+            
+            this->skin_cache->remove();
+            this->skin_cache.reset();
+            
+        }
+        
+        this->element_buffer->remove();
+        
+    }
+
     void Mesh::resetBones() {
         
         // Iterate through the elements in the map.
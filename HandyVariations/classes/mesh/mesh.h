@@ -17,6 +17,8 @@
 #define BGQ_OPENGL_CLASSES_MESH_H_
 
 #include <map>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "GL/glew.h"
@@ -28,14 +30,21 @@
 
 #include "classes/bone/bone.h"
 #include "classes/camera/camera.h"
+#include "classes/light/light.h"
 #include "classes/shader/shader.h"
+#include "classes/tbo/tbo.h"
 #include "classes/texture/texture.h"
 #include "classes/ebo/ebo.h"
 #include "classes/vbo/vbo.h"
 #include "classes/vao/vao.h"
+#include "classes/xfb/xfb.h"
 #include "structs/vertex/vertex.h"
 #include "structs/bounding_box/bounding_box.h"
 
+#define INSTANCE_DATA_SLOT 5
+#define INSTANCE_HEADER_TEXELS 12
+#define MAX_INSTANCE_VIEWS 8
+
 namespace bgq_opengl {
 
 	/**
@@ -57,8 +66,9 @@ namespace bgq_opengl {
              *
              * @param scene The scene that holds the mesh.
              * @param mesh The mesh that will be loaded.
+             * @param textures_dir The directory of the textures, ending in a slash, or empty for the working directory.
              */
-            Mesh(const aiScene* scene, const aiMesh* mesh);
+            Mesh(const aiScene* scene, const aiMesh* mesh, const std::string &textures_dir = "");
             
             /**
              * @brief Get the bone mapping.
@@ -167,12 +177,89 @@ namespace bgq_opengl {
              */
 			void draw(Shader &shader, Camera &camera);
         
+            /**
+             * @brief Adds an instance of the Mesh.
+             *
+             * Records the current transforms and bones of the Mesh, together
+             * with the parameters of its sample, as a new instance for the
+             * next call to drawInstances.
+             *
+             * @param view The view matrix of the camera.
+             * @param light The light of the sample.
+             * @param skin_tone The skin tone of the sample.
+             * @param shininess The shininess of the sample.
+             * @param tile The rectangle of the framebuffer the instance is drawn into, as (x0, y0, x1, y1) in pixels.
+             */
+            void addInstance(const glm::mat4 &view, Light light, float skin_tone, float shininess, const glm::vec4 &tile);
+        
+            /**
+             * @brief Draws the instances of the Mesh.
+             *
+             * Displays every instance added since the last call with a
+             * single instanced draw call, or a few if they do not fit in one
+             * instance buffer, each one in its own tile of the framebuffer.
+             * The viewport must cover the whole framebuffer.
+             *
+             * @param shader The shader program that will be used to render the mesh.
+             * @param camera The camera that will be used to render the mesh.
+             * @param framebuffer_size The size of the framebuffer.
+             */
+            void drawInstances(Shader &shader, Camera &camera, glm::vec2 framebuffer_size);
+        
+            /**
+             * @brief Draws the skinned Mesh.
+             *
+             * Displays the vertices captured by the last call to skin, with a
+             * shader that does not apply the bones again. The current
+             * transforms are still applied.
+             *
+             * @param shader The shader program that will be used to render the mesh.
+             * @param camera The camera that will be used to render the mesh.
+             */
+            void drawSkinned(Shader &shader, Camera &camera);
+        
+            /**
+             * @brief Draws the instances of the Mesh from several views.
+             *
+             * Displays every instance added since the last call from each of
+             * the cameras with a single instanced draw call, or a few if
+             * they do not fit in one instance buffer. The instances
+             * must have been added in world space, and the geometry shader
+             * fans each skinned triangle out to the views. View v of an
+             * instance is drawn into the tile that follows its own tile by v.
+             * The viewport must cover the whole framebuffer.
+             *
+             * @param shader The multi-view shader program.
+             * @param cameras The cameras of the views, up to MAX_INSTANCE_VIEWS.
+             * @param framebuffer_size The size of the framebuffer.
+             * @param tile_columns The amount of tiles in each row of the framebuffer.
+             */
+            void drawInstances(Shader &shader, std::vector<Camera> &cameras, glm::vec2 framebuffer_size, int tile_columns);
+        
+            /**
+             * @brief Removes the mesh.
+             *
+             * Deletes the GL objects of the mesh. It cannot be drawn afterwards.
+             */
+            void remove();
+        
             /**
              * @brief Resets the bone transformations.
              *
              * Resets the bone transformations.
              */
             void resetBones();
+        
+            /**
+             * @brief Skins the Mesh.
+             *
+             * Applies the current bones to every vertex once and keeps the
+             * result, so that the pose can then be drawn many times with
+             * drawSkinned.
+             *
+             * @param shader The skinning shader, whose outputs are captured.
+             */
+            void skin(Shader &shader);
 
 			/**
 			 * @brief Reset the transformations.
@@ -261,6 +348,39 @@ namespace bgq_opengl {
              * @param weight The given weight to that bone.
              */
             void updateVertexBones(int vertex_id, int bone_id, float weight);
+        
+            /**
+             * @brief Binds the instance data.
+             *
+             * Activates the shader and the VAO, binds the textures and
+             * passes the layout of the instances added since the last draw.
+             *
+             * @param shader The shader program that will be used to render the mesh.
+             *
+             * @returns The amount of instances.
+             */
+            GLsizei bindInstances(Shader &shader);
+        
+            /**
+             * @brief Draws the instance data.
+             *
+             * Uploads the instances added since the last draw and draws
+             * them, split into as many draw calls as needed for each upload
+             * to fit in GL_MAX_TEXTURE_BUFFER_SIZE.
+             *
+             * @param num_of_instances The amount of instances.
+             */
+            void drawInstanceData(GLsizei num_of_instances);
+        
+            /**
+             * @brief Passes the transforms.
+             *
+             * Passes the model, modelView and normal matrices to the shader.
+             *
+             * @param shader The shader program that will be used to render the mesh.
+             * @param camera The camera that will be used to render the mesh.
+             */
+            void passTransforms(Shader &shader, Camera &camera);
 
 			std::vector<GLuint> indices;				/// Indices of the vertices.
 			std::vector<Texture> textures;				/// Textures that will color this mesh.
@@ -271,6 +391,11 @@ namespace bgq_opengl {
             glm::mat4 global_trans = glm::mat4(1.0f);   /// The global tranform obtained from the model.
             int bone_count = 0;                         /// The current bone count.
             std::map<std::string, Bone> bone_mapping;   /// The mapping of names into bones.
+            std::vector<glm::vec4> instance_data;       /// The data of the instances to be drawn.
+            std::unique_ptr<TBO> instance_buffer;       /// The buffer the instance data is read from.
+            GLint max_texels = 0;                       /// The texels its context fits in a texture buffer.
+            std::unique_ptr<EBO> element_buffer;        /// The indices of the vertices.
+            std::unique_ptr<XFB> skin_cache;            /// The vertices of the last skinned pose.
 
 	};
 
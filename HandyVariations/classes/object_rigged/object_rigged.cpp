@@ -46,6 +46,11 @@ namespace bgq_opengl {
             
         }
 
+        // The textures are next to the model.
+        std::string textures_dir = filename;
+        size_t last_slash = textures_dir.find_last_of('/');
+        textures_dir = (last_slash == std::string::npos) ? "" : textures_dir.substr(0, last_slash + 1);
+
         for (int i = 0; i < scene->mNumMeshes; i++) {
             
             // Get this mesh from assimp.
@@ -57,7 +62,7 @@ namespace bgq_opengl {
                 continue;
             
             // Load this mesh into the system.
-            this->meshes.push_back(Mesh(scene, mesh));
+            this->meshes.push_back(Mesh(scene, mesh, textures_dir));
             
         }
 
@@ -140,7 +145,7 @@ namespace bgq_opengl {
 
     }
 
-    std::vector<Mesh> ObjectRigged::getMeshes() {
+    std::vector<Mesh> &ObjectRigged::getMeshes() {
         
         return this->meshes;
         
@@ -157,6 +162,60 @@ namespace bgq_opengl {
         
     }
 
+    void ObjectRigged::addInstance(const glm::mat4 &view, Light light, float skin_tone, float shininess, const glm::vec4 &tile) {
+        
+        // Iterate through the different meshes and just propagate.
+        for (unsigned int i = 0; i < this->meshes.size(); i++) {
+            
+            this->meshes[i].addInstance(view, light, skin_tone, shininess, tile);
+            
+        }
+        
+    }
+
+    void ObjectRigged::drawInstances(Shader &shader, Camera &camera, glm::vec2 framebuffer_size) {
+        
+        // Iterate through the different meshes and just propagate.
+        for (unsigned int i = 0; i < this->meshes.size(); i++) {
+            
+            this->meshes[i].drawInstances(shader, camera, framebuffer_size);
+            
+        }
+        
+    }
+
+    void ObjectRigged::drawInstances(Shader &shader, std::vector<Camera> &cameras, glm::vec2 framebuffer_size, int tile_columns) {
+        
+        // Iterate through the different meshes and just propagate.
+        for (unsigned int i = 0; i < this->meshes.size(); i++) {
+            
+            this->meshes[i].drawInstances(shader, cameras, framebuffer_size, tile_columns);
+            
+        }
+        
+    }
+
+    void ObjectRigged::drawSkinned(Shader &shader, Camera &camera) {
+        
+        // Iterate through the different meshes and just propagate.
+        for (unsigned int i = 0; i < this->meshes.size(); i++) {
+            
+            this->meshes[i].drawSkinned(shader, camera);
+            
+        }
+        
+    }
+
+    void ObjectRigged::remove() {
+        
+        for (unsigned int i = 0; i < this->meshes.size(); i++) {
+            
+            this->meshes[i].remove();
+            
+        }
+        
+    }
+
     void ObjectRigged::resetBones() {
         
         for (unsigned int i = 0; i < this->meshes.size(); i++) {
@@ -207,6 +266,17 @@ namespace bgq_opengl {
         
     }
 
+    void ObjectRigged::skin(Shader &shader) {
+        
+        // Iterate through the different meshes and just propagate.
+        for (unsigned int i = 0; i < this->meshes.size(); i++) {
+            
+            this->meshes[i].skin(shader);
+            
+        }
+        
+    }
+
     void ObjectRigged::translate(float x, float y, float z) {
 
         for (unsigned int i = 0; i < this->meshes.size(); i++) {
@@ -35,7 +35,8 @@ namespace bgq_opengl {
 			/**
 			 * @brief Loads a model in the specified format.
 			 *
-			 * Loads in a model from a file.
+			 * Loads in a model from a file. Its textures are read from the
+			 * same directory.
 			 * 
 			 * @param filename The name of the model file.
 			 */
@@ -75,7 +76,7 @@ namespace bgq_opengl {
              *
              * @returns The list of meshes.
              */
-            std::vector<Mesh> getMeshes();
+            std::vector<Mesh> &getMeshes();
         
             /**
              * @brief Draws the Mesh.
@@ -87,6 +88,64 @@ namespace bgq_opengl {
              */
             void draw(Shader &shader, Camera &camera);
         
+            /**
+             * @brief Adds an instance of the object.
+             *
+             * Records the current pose of the object, together with the
+             * parameters of its sample, as a new instance for the next call
+             * to drawInstances.
+             *
+             * @param view The view matrix of the camera.
+             * @param light The light of the sample.
+             * @param skin_tone The skin tone of the sample.
+             * @param shininess The shininess of the sample.
+             * @param tile The rectangle of the framebuffer the instance is drawn into, as (x0, y0, x1, y1) in pixels.
+             */
+            void addInstance(const glm::mat4 &view, Light light, float skin_tone, float shininess, const glm::vec4 &tile);
+        
+            /**
+             * @brief Draws the instances of the object.
+             *
+             * Displays every instance added since the last call, with one
+             * draw call per mesh.
+             *
+             * @param shader The shader program that will be used to render the mesh.
+             * @param camera The camera that will be used to render the mesh.
+             * @param framebuffer_size The size of the framebuffer.
+             */
+            void drawInstances(Shader &shader, Camera &camera, glm::vec2 framebuffer_size);
+        
+            /**
+             * @brief Draws the instances of the object from several views.
+             *
+             * Displays every instance added since the last call from each of
+             * the cameras, with one draw call per mesh.
+             *
+             * @param shader The multi-view shader program.
+             * @param cameras The cameras of the views.
+             * @param framebuffer_size The size of the framebuffer.
+             * @param tile_columns The amount of tiles in each row of the framebuffer.
+             */
+            void drawInstances(Shader &shader, std::vector<Camera> &cameras, glm::vec2 framebuffer_size, int tile_columns);
+        
+            /**
+             * @brief Draws the skinned object.
+             *
+             * Displays the pose captured by the last call to skin, without
+             * applying the bones again.
+             *
+             * @param shader The shader program that will be used to render the mesh.
+             * @param camera The camera that will be used to render the mesh.
+             */
+            void drawSkinned(Shader &shader, Camera &camera);
+        
+            /**
+             * @brief Removes the object.
+             *
+             * Deletes the GL objects of every mesh in the object.
+             */
+            void remove();
+        
             /**
              * @brief Resets the bone transformations.
              *
@@ -94,6 +153,16 @@ namespace bgq_opengl {
              */
             void resetBones();
         
+            /**
+             * @brief Skins the object.
+             *
+             * Applies the current bones to every mesh once and keeps the
+             * result for drawSkinned.
+             *
+             * @param shader The skinning shader.
+             */
+            void skin(Shader &shader);
+        
             /**
              * @brief Reset
              *
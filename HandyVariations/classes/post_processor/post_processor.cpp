@@ -0,0 +1,94 @@
+/**
+ * @file post_processor.cpp
+ * @brief PostProcessor class implementation file.
+ * @version 1.0.0 (2024-03-24)
+ * @date 2024-03-24
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#include "post_processor.h"
+
+#include "GL/glew.h"
+#include "glm/glm.hpp"
+
+namespace bgq_opengl {
+
+	PostProcessor::PostProcessor() {
+
+		this->width = 0;
+		this->height = 0;
+
+		// The effects sample between the pixels, so filter linearly.
+		glGenTextures(1, &this->texture_ID);
+		glBindTexture(GL_TEXTURE_2D, this->texture_ID);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		// The core profile needs a VAO to draw, even if it has no attributes.
+		glGenVertexArrays(1, &this->vao_ID);
+
+	}
+
+	void PostProcessor::capture() {
+
+		GLint viewport[4];
+		glGetIntegerv(GL_VIEWPORT, viewport);
+
+		glBindTexture(GL_TEXTURE_2D, this->texture_ID);
+
+		// Resize the texture only when the viewport changes.
+		if (viewport[2] != this->width || viewport[3] != this->height) {
+			this->width = viewport[2];
+			this->height = viewport[3];
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, this->width, this->height, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+		}
+
+		// Copy the viewport, without going through the CPU.
+		glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, viewport[0], viewport[1], this->width, this->height);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+	}
+
+	void PostProcessor::bindTexture(GLuint unit) {
+
+		glActiveTexture(GL_TEXTURE0 + unit);
+		glBindTexture(GL_TEXTURE_2D, this->texture_ID);
+
+	}
+
+	void PostProcessor::drawFullscreen() {
+
+		// Draw the triangle over whatever is there.
+		glDepthFunc(GL_ALWAYS);
+		glBindVertexArray(this->vao_ID);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+		glBindVertexArray(0);
+		glDepthFunc(GL_LESS);
+
+	}
+
+	glm::vec2 PostProcessor::getSize() const {
+
+		return glm::vec2(this->width, this->height);
+
+	}
+
+	void PostProcessor::remove() {
+
+		// Delete the texture and the VAO in OpenGL.
+		glDeleteTextures(1, &this->texture_ID);
+		glDeleteVertexArrays(1, &this->vao_ID);
+
+	}
+
+}  // namespace bgq_opengl
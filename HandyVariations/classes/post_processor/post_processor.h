@@ -0,0 +1,98 @@
+/**
+ * @file post_processor.h
+ * @brief PostProcessor class header file.
+ * @version 1.0.0 (2024-03-24)
+ * @date 2024-03-24
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_CLASS_POST_PROCESSOR_H_
+#define BGQ_OPENGL_CLASS_POST_PROCESSOR_H_
+
+#include "GL/glew.h"
+#include "glm/glm.hpp"
+
+namespace bgq_opengl {
+
+	/**
+	 * @brief Implementation of a PostProcessor class.
+	 *
+	 * Implementation of a fullscreen post-processing pass. What has been drawn
+	 * into the current viewport is copied into a texture, and a shader then
+	 * draws it back over the viewport with its effects. It works the same on
+	 * the window and on a tile of a framebuffer.
+	 *
+	 * @author Borja García Quiroga <garcaqub@tcd.ie>
+	 */
+	class PostProcessor {
+
+	public:
+
+		/**
+		 * @brief Constructs a PostProcessor.
+		 *
+		 * Constructs a PostProcessor and its texture, which gets its size
+		 * the first time something is copied into it.
+		 */
+		PostProcessor();
+
+		/**
+		 * @brief Copies the viewport.
+		 *
+		 * Copies what has been drawn into the current viewport of the bound
+		 * framebuffer into the texture.
+		 */
+		void capture();
+
+		/**
+		 * @brief Binds the texture.
+		 *
+		 * Binds the copy of the viewport to a texture unit.
+		 *
+		 * @param unit The texture unit.
+		 */
+		void bindTexture(GLuint unit);
+
+		/**
+		 * @brief Draws a fullscreen triangle.
+		 *
+		 * Draws a triangle that covers the whole viewport, without testing
+		 * the depth. The vertices are made up in the shader from their IDs.
+		 */
+		void drawFullscreen();
+
+		/**
+		 * @brief Get the size.
+		 *
+		 * Get the size of the last copy of the viewport.
+		 *
+		 * @returns The width and height in pixels.
+		 */
+		glm::vec2 getSize() const;
+
+		/**
+		 * @brief Removes the PostProcessor.
+		 *
+		 * Removes the PostProcessor and its texture from OpenGL.
+		 */
+		void remove();
+
+	private:
+
+		GLuint texture_ID;			// GL ID of the copy of the viewport.
+		GLuint vao_ID;				// GL ID of the empty VAO of the fullscreen pass.
+		int width;					// The width of the texture in pixels.
+		int height;					// The height of the texture in pixels.
+
+	};
+
+}  // namespace bgq_opengl
+
+#endif //!BGQ_OPENGL_CLASS_POST_PROCESSOR_H_
@@ -0,0 +1,281 @@
+/**
+ * @file resampler.cpp
+ * @brief Resampler class implementation file.
+ * @version 1.0.0 (2024-03-24)
+ * @date 2024-03-24
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#include "resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// The weights are fixed point numbers with this many fractional bits.
+#define RESAMPLE_PRECISION 14
+
+namespace bgq_opengl {
+
+    namespace {
+
+        double sinc(double x) {
+
+            if (x == 0.0)
+                return 1.0;
+
+            x *= M_PI;
+            return std::sin(x) / x;
+
+        }
+
+        double filterValue(double x, ResampleFilter filter) {
+
+            if (filter == RESAMPLE_LANCZOS)
+                return (std::abs(x) < 3.0) ? sinc(x) * sinc(x / 3.0) : 0.0;
+
+            return (x > -0.5 && x <= 0.5) ? 1.0 : 0.0;
+
+        }
+
+        inline unsigned char roundWeighted(int sum) {
+
+            return (unsigned char) std::clamp(sum >> RESAMPLE_PRECISION, 0, 255);
+
+        }
+
+        // Blend some input rows into an output row, from the byte begin on.
+        void verticalScalar(const unsigned char* input, size_t row_size, int first, int count, const int16_t* weights, size_t begin, unsigned char* output) {
+
+            for (size_t x = begin; x < row_size; x++) {
+
+                int sum = 1 << (RESAMPLE_PRECISION - 1);
+                for (int k = 0; k < count; k++)
+                    sum += input[(size_t) (first + k) * row_size + x] * weights[k];
+
+                output[x] = roundWeighted(sum);
+
+            }
+
+        }
+
+#if defined(__x86_64__) || defined(__i386__)
+
+        // Built for AVX2 whatever the flags of the build, and only called if
+        // the processor has it.
+        __attribute__((target("avx2")))
+        void verticalAVX2(const unsigned char* input, size_t row_size, int first, int count, const int16_t* weights, unsigned char* output) {
+
+            const __m256i rounding = _mm256_set1_epi32(1 << (RESAMPLE_PRECISION - 1));
+            const __m256i zero = _mm256_setzero_si256();
+
+            // Sixteen bytes at a time, two rows at a time, so that each
+            // multiply-add takes a byte of both rows with their weights.
+            size_t x = 0;
+            for (; x + 16 <= row_size; x += 16) {
+
+                __m256i low = rounding;
+                __m256i high = rounding;
+
+                for (int k = 0; k < count; k += 2) {
+
+                    const unsigned char* row = input + (size_t) (first + k) * row_size + x;
+                    __m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) row));
+                    __m256i b = zero;
+                    uint16_t weight_b = 0;
+
+                    if (k + 1 < count) {
+                        b = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) (row + row_size)));
+                        weight_b = (uint16_t) weights[k + 1];
+                    }
+
+                    __m256i pair = _mm256_set1_epi32((int) (((uint32_t) weight_b << 16) | (uint16_t) weights[k]));
+                    low = _mm256_add_epi32(low, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), pair));
+                    high = _mm256_add_epi32(high, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), pair));
+
+                }
+
+                // Saturate down to bytes, and put the 8 bytes of each half
+                // together.
+                low = _mm256_srai_epi32(low, RESAMPLE_PRECISION);
+                high = _mm256_srai_epi32(high, RESAMPLE_PRECISION);
+                __m256i result = _mm256_packus_epi16(_mm256_packs_epi32(low, high), zero);
+                result = _mm256_permute4x64_epi64(result, 0x08);
+                _mm_storeu_si128((__m128i*) (output + x), _mm256_castsi256_si128(result));
+
+            }
+
+            // The bytes left.
+            verticalScalar(input, row_size, first, count, weights, x, output);
+
+        }
+
+#elif defined(__ARM_NEON)
+
+        void verticalNEON(const unsigned char* input, size_t row_size, int first, int count, const int16_t* weights, unsigned char* output) {
+
+            // Eight bytes at a time.
+            size_t x = 0;
+            for (; x + 8 <= row_size; x += 8) {
+
+                int32x4_t low = vdupq_n_s32(1 << (RESAMPLE_PRECISION - 1));
+                int32x4_t high = low;
+
+                for (int k = 0; k < count; k++) {
+                    int16x8_t row = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(input + (size_t) (first + k) * row_size + x)));
+                    low = vmlal_n_s16(low, vget_low_s16(row), weights[k]);
+                    high = vmlal_n_s16(high, vget_high_s16(row), weights[k]);
+                }
+
+                int16x8_t result = vcombine_s16(vqshrn_n_s32(low, RESAMPLE_PRECISION), vqshrn_n_s32(high, RESAMPLE_PRECISION));
+                vst1_u8(output + x, vqmovun_s16(result));
+
+            }
+
+            // The bytes left.
+            verticalScalar(input, row_size, first, count, weights, x, output);
+
+        }
+
+#endif
+
+        void resampleRows(const unsigned char* input, size_t row_size, int first, int count, const int16_t* weights, unsigned char* output) {
+
+#if defined(__x86_64__) || defined(__i386__)
+            static const bool has_avx2 = __builtin_cpu_supports("avx2");
+            if (has_avx2) {
+                verticalAVX2(input, row_size, first, count, weights, output);
+                return;
+            }
+#elif defined(__ARM_NEON)
+            verticalNEON(input, row_size, first, count, weights, output);
+            return;
+#endif
+
+            verticalScalar(input, row_size, first, count, weights, 0, output);
+
+        }
+
+    }  // namespace
+
+    Resampler::Resampler(int input_width, int input_height, int output_width, int output_height, ResampleFilter filter) {
+
+        this->input_width = input_width;
+        this->input_height = input_height;
+        this->output_width = output_width;
+        this->output_height = output_height;
+
+        // Find the weights of both axes once.
+        this->horizontal = findTaps(input_width, output_width, filter);
+        this->vertical = findTaps(input_height, output_height, filter);
+
+    }
+
+    void Resampler::resample(const std::vector<unsigned char> &input, std::vector<unsigned char> &output) const {
+
+        size_t input_row_size = (size_t) this->input_width * 3;
+        size_t output_row_size = (size_t) this->output_width * 3;
+
+        // Resample the rows first, into images as wide as the input.
+        thread_local std::vector<unsigned char> rows;
+        rows.resize(input_row_size * this->output_height);
+
+        for (int y = 0; y < this->output_height; y++)
+            resampleRows(input.data(), input_row_size, this->vertical.first[y], this->vertical.count[y], &this->vertical.weights[(size_t) y * this->vertical.max_count], rows.data() + y * input_row_size);
+
+        // Then the columns of each of them.
+        output.resize(output_row_size * this->output_height);
+
+        for (int y = 0; y < this->output_height; y++) {
+
+            const unsigned char* row = rows.data() + y * input_row_size;
+            unsigned char* destination = output.data() + y * output_row_size;
+
+            for (int x = 0; x < this->output_width; x++) {
+
+                const unsigned char* source = row + (size_t) this->horizontal.first[x] * 3;
+                const int16_t* weights = &this->horizontal.weights[(size_t) x * this->horizontal.max_count];
+                int sum[3] = {1 << (RESAMPLE_PRECISION - 1), 1 << (RESAMPLE_PRECISION - 1), 1 << (RESAMPLE_PRECISION - 1)};
+
+                for (int k = 0; k < this->horizontal.count[x]; k++)
+                    for (int c = 0; c < 3; c++)
+                        sum[c] += source[k * 3 + c] * weights[k];
+
+                for (int c = 0; c < 3; c++)
+                    destination[x * 3 + c] = roundWeighted(sum[c]);
+
+            }
+
+        }
+
+    }
+
+    int Resampler::getOutputWidth() const {
+
+        return this->output_width;
+
+    }
+
+    int Resampler::getOutputHeight() const {
+
+        return this->output_height;
+
+    }
+
+    Resampler::Taps Resampler::findTaps(int input_size, int output_size, ResampleFilter filter) {
+
+        // When shrinking, the filter is stretched to cover every input pixel.
+        double scale = (double) input_size / output_size;
+        double filter_scale = std::max(scale, 1.0);
+        double support = ((filter == RESAMPLE_LANCZOS) ? 3.0 : 0.5) * filter_scale;
+
+        Taps taps;
+        taps.max_count = (int) std::ceil(support) * 2 + 1;
+        taps.first.resize(output_size);
+        taps.count.resize(output_size);
+        taps.weights.assign((size_t) output_size * taps.max_count, 0);
+
+        std::vector<double> values(taps.max_count);
+
+        for (int i = 0; i < output_size; i++) {
+
+            // Get the input pixels under the filter, centred on the output
+            // pixel.
+            double center = (i + 0.5) * scale;
+            int first = std::max((int) (center - support + 0.5), 0);
+            int last = std::min((int) (center + support + 0.5), input_size);
+            int count = std::min(last - first, taps.max_count);
+
+            double total = 0.0;
+            for (int k = 0; k < count; k++) {
+                values[k] = filterValue((first + k + 0.5 - center) / filter_scale, filter);
+                total += values[k];
+            }
+
+            // Normalise them, so that flat areas keep their value.
+            for (int k = 0; k < count; k++)
+                taps.weights[(size_t) i * taps.max_count + k] = (int16_t) std::lround(values[k] / total * (1 << RESAMPLE_PRECISION));
+
+            taps.first[i] = first;
+            taps.count[i] = count;
+
+        }
+
+        return taps;
+
+    }
+
+}  // namespace bgq_opengl
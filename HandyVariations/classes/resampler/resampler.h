@@ -0,0 +1,123 @@
+/**
+ * @file resampler.h
+ * @brief Resampler class header file.
+ * @version 1.0.0 (2024-03-24)
+ * @date 2024-03-24
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_CLASSES_RESAMPLER_H_
+#define BGQ_OPENGL_CLASSES_RESAMPLER_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace bgq_opengl {
+
+    /// The filters the images can be resampled with.
+    enum ResampleFilter {
+        RESAMPLE_BOX = 0,                   /// The average of the pixels each output pixel covers.
+        RESAMPLE_LANCZOS = 1,               /// Lanczos with 3 lobes, sharper.
+    };
+
+    /**
+     * @brief Implementation of a Resampler class.
+     *
+     * Implementation of the resampling of RGB8 images to a different size
+     * with a separable filter. The weights of every row and column are found
+     * once, in fixed point, when the resampler is created. The vertical pass
+     * goes first, so the horizontal one only sees the output rows, and it uses
+     * AVX2 or NEON when available. Every path gives exactly the same result.
+     * Resampling is thread safe.
+     *
+     * @author Borja García Quiroga <garcaqub@tcd.ie>
+     */
+    class Resampler {
+
+    public:
+
+        /**
+         * @brief Creates a new resampler.
+         *
+         * Creates a new resampler between two sizes.
+         *
+         * @param input_width The width of the input images.
+         * @param input_height The height of the input images.
+         * @param output_width The width of the output images.
+         * @param output_height The height of the output images.
+         * @param filter The filter.
+         */
+        Resampler(int input_width, int input_height, int output_width, int output_height, ResampleFilter filter);
+
+        /**
+         * @brief Resample an image.
+         *
+         * Resample some tightly packed RGB8 pixels. The order of the rows is
+         * kept.
+         *
+         * @param input The pixels of the input image.
+         * @param output Output vector for the pixels of the output image.
+         */
+        void resample(const std::vector<unsigned char> &input, std::vector<unsigned char> &output) const;
+
+        /**
+         * @brief Get the output width.
+         *
+         * Get the width of the output images.
+         *
+         * @returns The width.
+         */
+        int getOutputWidth() const;
+
+        /**
+         * @brief Get the output height.
+         *
+         * Get the height of the output images.
+         *
+         * @returns The height.
+         */
+        int getOutputHeight() const;
+
+    private:
+
+        /// The input pixels each output pixel is made of along an axis.
+        struct Taps {
+            std::vector<int> first;         /// The first input pixel of each output pixel.
+            std::vector<int> count;         /// The amount of input pixels of each output pixel.
+            std::vector<int16_t> weights;   /// The weights, max_count per output pixel.
+            int max_count = 0;              /// The largest amount of input pixels of any output pixel.
+        };
+
+        /**
+         * @brief Find the taps of an axis.
+         *
+         * Find the input pixels of each output pixel along an axis, and their
+         * weights in fixed point.
+         *
+         * @param input_size The size of the input along the axis.
+         * @param output_size The size of the output along the axis.
+         * @param filter The filter.
+         *
+         * @returns The taps.
+         */
+        static Taps findTaps(int input_size, int output_size, ResampleFilter filter);
+
+        int input_width;                    /// The width of the input images.
+        int input_height;                   /// The height of the input images.
+        int output_width;                   /// The width of the output images.
+        int output_height;                  /// The height of the output images.
+        Taps horizontal;                    /// The taps of the columns.
+        Taps vertical;                      /// The taps of the rows.
+
+    };
+
+}  // namespace bgq_opengl
+
+#endif  //!BGQ_OPENGL_CLASSES_RESAMPLER_H_
@@ -0,0 +1,185 @@
+/**
+ * @file sample_manifest.cpp
+ * @brief Sample manifest class implementation file.
+ * @version 1.0.0 (2024-03-08)
+ * @date 2024-03-08
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#include "sample_manifest.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "structs/variation_indices/variation_indices.h"
+
+#define MANIFEST_MAGIC "HVSM"
+#define MANIFEST_VERSION 2
+#define MANIFEST_HEADER_SIZE 128
+
+namespace bgq_opengl {
+
+    static_assert(sizeof(ManifestHeader) <= MANIFEST_HEADER_SIZE, "The manifest header does not fit.");
+
+    SampleManifest::SampleManifest(const char* filename, const ManifestHeader &header) {
+
+        this->filename = filename;
+        this->header = header;
+
+        // Create the file, replacing any previous one.
+        this->file.open(filename, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!this->file.is_open()) {
+            std::cerr << "Could not create the manifest on file " << filename << std::endl;
+            exit(1);
+        }
+
+        // Write the header padded to its fixed size.
+        char header_bytes[MANIFEST_HEADER_SIZE];
+        memset(header_bytes, 0, MANIFEST_HEADER_SIZE);
+        memcpy(header_bytes, &this->header, sizeof(ManifestHeader));
+        this->file.write(header_bytes, MANIFEST_HEADER_SIZE);
+
+    }
+
+    SampleManifest::SampleManifest(const char* filename) {
+
+        this->filename = filename;
+
+        // Open the file without truncating it.
+        this->file.open(filename, std::ios::in | std::ios::out | std::ios::binary);
+        if (!this->file.is_open()) {
+            std::cerr << "Could not read the manifest on file " << filename << std::endl;
+            exit(1);
+        }
+
+        // Read and check the header.
+        char header_bytes[MANIFEST_HEADER_SIZE];
+        this->file.read(header_bytes, MANIFEST_HEADER_SIZE);
+        memcpy(&this->header, header_bytes, sizeof(ManifestHeader));
+
+        if (!this->file || memcmp(this->header.magic, MANIFEST_MAGIC, 4) != 0 || this->header.version != MANIFEST_VERSION) {
+            std::cerr << "The file " << filename << " is not a valid manifest." << std::endl;
+            exit(1);
+        }
+
+    }
+
+    ManifestHeader SampleManifest::getHeader() const {
+
+        return this->header;
+
+    }
+
+    void SampleManifest::setHeader(const ManifestHeader &header) {
+
+        this->header = header;
+
+        char header_bytes[MANIFEST_HEADER_SIZE];
+        memset(header_bytes, 0, MANIFEST_HEADER_SIZE);
+        memcpy(header_bytes, &this->header, sizeof(ManifestHeader));
+
+        this->file.seekp(0);
+        this->file.write(header_bytes, MANIFEST_HEADER_SIZE);
+
+    }
+
+    bool SampleManifest::read(int frame_id, VariationIndices &indices) {
+
+        // Go to the record of this frame.
+        ManifestRecord record;
+        memset(&record, 0, sizeof(ManifestRecord));
+
+        this->file.clear();
+        this->file.seekg(MANIFEST_HEADER_SIZE + (std::streamoff) frame_id * sizeof(ManifestRecord));
+        this->file.read((char*) &record, sizeof(ManifestRecord));
+
+        // Frames past the end of the file or never written have no record.
+        if (!this->file || record.written != 1 || record.frame_id != (uint32_t) frame_id) {
+            this->file.clear();
+            return false;
+        }
+
+        indices.joint_angles = record.indices[0];
+        indices.arm_position = record.indices[1];
+        indices.arm_rotation = record.indices[2];
+        indices.skin_tone = record.indices[3];
+        indices.lighting = record.indices[4];
+        indices.shininess = record.indices[5];
+        indices.background = record.indices[6];
+
+        return true;
+
+    }
+
+    void SampleManifest::write(int frame_id, const VariationIndices &indices, uint32_t extra) {
+
+        // Build the record.
+        ManifestRecord record;
+        memset(&record, 0, sizeof(ManifestRecord));
+        record.frame_id = frame_id;
+        record.written = 1;
+        record.indices[0] = indices.joint_angles;
+        record.indices[1] = indices.arm_position;
+        record.indices[2] = indices.arm_rotation;
+        record.indices[3] = indices.skin_tone;
+        record.indices[4] = indices.lighting;
+        record.indices[5] = indices.shininess;
+        record.indices[6] = indices.background;
+        record.extra = extra;
+
+        // Every record has a fixed position, so the order does not matter.
+        this->file.seekp(MANIFEST_HEADER_SIZE + (std::streamoff) frame_id * sizeof(ManifestRecord));
+        this->file.write((const char*) &record, sizeof(ManifestRecord));
+
+    }
+
+    bool SampleManifest::sync() {
+
+        this->file.flush();
+        if (!this->file)
+            return false;
+
+        // The stream has no descriptor to sync, but any descriptor of the
+        // file syncs all of it.
+        int file_descriptor = open(this->filename.c_str(), O_RDONLY);
+        if (file_descriptor < 0)
+            return false;
+
+        bool success = fsync(file_descriptor) == 0;
+        ::close(file_descriptor);
+
+        return success;
+
+    }
+
+    void SampleManifest::close() {
+
+        this->file.close();
+
+    }
+
+    ManifestHeader SampleManifest::createHeader() {
+
+        ManifestHeader header;
+        memset(&header, 0, sizeof(ManifestHeader));
+        memcpy(header.magic, MANIFEST_MAGIC, 4);
+        header.version = MANIFEST_VERSION;
+
+        return header;
+
+    }
+
+}  // namespace bgq_opengl
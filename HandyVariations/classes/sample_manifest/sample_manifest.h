@@ -0,0 +1,177 @@
+/**
+ * @file sample_manifest.h
+ * @brief Sample manifest class header file.
+ * @version 1.0.0 (2024-03-08)
+ * @date 2024-03-08
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_CLASSES_SAMPLE_MANIFEST_H_
+#define BGQ_OPENGL_CLASSES_SAMPLE_MANIFEST_H_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "structs/variation_indices/variation_indices.h"
+
+namespace bgq_opengl {
+
+    /**
+     * @brief The parameters of the run that produced a manifest.
+     *
+     * The parameters of the run that produced a manifest. Together with the
+     * records, they are all that is needed to render any sample again.
+     */
+    struct ManifestHeader {
+        char magic[4];                      /// Always "HVSM".
+        uint32_t version;                   /// The version of the format.
+        uint64_t seed;                      /// The seed of the dataset.
+        int32_t num_of_variations[7];       /// The size of each of the variation tables.
+        int32_t num_of_camera_params;       /// The amount of camera configurations.
+        int32_t dataset_size;               /// The amount of frames in the dataset.
+        int32_t window_width;               /// The width of the images.
+        int32_t window_height;              /// The height of the images.
+        uint32_t image_codec;               /// The codec of the images.
+        int32_t num_of_composites;          /// The amount of backgrounds each render is composited over.
+        int32_t background_mode;            /// How the backgrounds are drawn.
+        int32_t mosaic_images;              /// The amount of images in the background mosaic.
+        int32_t output_widths[4];           /// The widths of the smaller copies of the images, 0 when unused.
+        int32_t resample_filter;            /// The filter the copies are resampled with.
+        int32_t num_of_augmentations;       /// The amount of augmented samples per render, 0 if they are not augmented.
+        int32_t sensor_effects;             /// The sensor effects applied to the renders, 0 if none.
+        int32_t heatmap_size;               /// The size of the training heatmaps, 0 if they are not written.
+        int32_t heatmap_type;               /// The type of the elements of the heatmaps.
+        int32_t output_format;              /// How the images are stored.
+    };
+
+    /**
+     * @brief The variations that produced a sample.
+     *
+     * A fixed-size record per sample, stored at the position of its frame id.
+     */
+    struct ManifestRecord {
+        uint32_t frame_id;                  /// The id of the frame.
+        uint32_t written;                   /// 1 if the record has been written.
+        uint32_t indices[7];                /// The index selected in each variation table.
+        uint32_t extra;                     /// Parameters of optional stages, such as the seed of a procedural background.
+    };
+
+    /**
+     * @brief Implementation of a SampleManifest class.
+     *
+     * Implementation of a compact binary manifest that records which
+     * variations produced each of the samples of a dataset, so that any subset
+     * of it can be rendered again.
+     *
+     * @author Borja García Quiroga <garcaqub@tcd.ie>
+     */
+    class SampleManifest {
+
+    public:
+
+        /**
+         * @brief Creates a new manifest.
+         *
+         * Creates a new manifest file, replacing any existing one.
+         *
+         * @param filename The name of the manifest file.
+         * @param header The parameters of the run.
+         */
+        SampleManifest(const char* filename, const ManifestHeader &header);
+
+        /**
+         * @brief Opens an existing manifest.
+         *
+         * Opens an existing manifest file to read it or keep writing it.
+         *
+         * @param filename The name of the manifest file.
+         */
+        SampleManifest(const char* filename);
+
+        /**
+         * @brief Get the parameters of the run.
+         *
+         * Get the parameters of the run that produced the manifest.
+         *
+         * @returns The header of the manifest.
+         */
+        ManifestHeader getHeader() const;
+
+        /**
+         * @brief Set the parameters of the run.
+         *
+         * Replace the header of the manifest, such as when a dataset is
+         * extended.
+         *
+         * @param header The new header.
+         */
+        void setHeader(const ManifestHeader &header);
+
+        /**
+         * @brief Read the record of a frame.
+         *
+         * Read the variations that produced a given frame.
+         *
+         * @param frame_id The id of the frame.
+         * @param indices Output variable for the variations.
+         *
+         * @returns True if the frame has a record.
+         */
+        bool read(int frame_id, VariationIndices &indices);
+
+        /**
+         * @brief Write the record of a frame.
+         *
+         * Write the variations that produced a given frame. Records can be
+         * written in any order.
+         *
+         * @param frame_id The id of the frame.
+         * @param indices The variations of the frame.
+         * @param extra The parameters of optional stages, 0 if none.
+         */
+        void write(int frame_id, const VariationIndices &indices, uint32_t extra = 0);
+
+        /**
+         * @brief Sync the manifest.
+         *
+         * Flush the pending records to the file and sync it to the disk.
+         *
+         * @returns True if every record so far is on the disk.
+         */
+        bool sync();
+
+        /**
+         * @brief Close the manifest.
+         *
+         * Close the manifest file.
+         */
+        void close();
+
+        /**
+         * @brief Create a default header.
+         *
+         * Create a header with the magic and version already filled in.
+         *
+         * @returns The header.
+         */
+        static ManifestHeader createHeader();
+
+    private:
+
+        std::string filename;               /// The name of the manifest file.
+        std::fstream file;                  /// The manifest file.
+        ManifestHeader header;              /// The parameters of the run.
+
+    };
+
+}  // namespace bgq_opengl
+
+#endif  //!BGQ_OPENGL_CLASSES_SAMPLE_MANIFEST_H_
@@ -0,0 +1,202 @@
+/**
+ * @file sample_stream.cpp
+ * @brief SampleStream class implementation file.
+ * @version 1.0.0 (2024-03-24)
+ * @date 2024-03-24
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#include "sample_stream.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace bgq_opengl {
+
+    SampleStream::SampleStream(const char* name, int num_slots, int width, int height, int num_of_keypoints, int heatmap_size, int heatmap_type) {
+
+        this->name = name;
+        this->image_size = (size_t) width * height * 3;
+        this->keypoints_size = (size_t) num_of_keypoints * 3 * sizeof(float);
+        this->heatmaps_size = hv_stream_sample_size(width, height, num_of_keypoints, heatmap_size, heatmap_type)
+            - hv_stream_image_size(width, height) - this->keypoints_size;
+
+        if (num_slots < 1)
+            num_slots = 1;
+
+        // Make every slot start on a cache line of its own.
+        size_t slot_size = sizeof(HVStreamSlot) + hv_stream_sample_size(width, height, num_of_keypoints, heatmap_size, heatmap_type);
+        slot_size = (slot_size + HV_STREAM_ALIGNMENT - 1) / HV_STREAM_ALIGNMENT * HV_STREAM_ALIGNMENT;
+        this->mapped_size = sizeof(HVStreamHeader) + slot_size * num_slots;
+
+        // Replace whatever a previous run left behind.
+        shm_unlink(this->name.c_str());
+        int file_descriptor = shm_open(this->name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (file_descriptor < 0 || ftruncate(file_descriptor, (off_t) this->mapped_size) != 0) {
+            std::cerr << "Could not create the shared memory stream " << this->name << std::endl;
+            exit(1);
+        }
+
+        void* mapping = mmap(nullptr, this->mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, file_descriptor, 0);
+        ::close(file_descriptor);
+        if (mapping == MAP_FAILED) {
+            std::cerr << "Could not map the shared memory stream " << this->name << std::endl;
+            shm_unlink(this->name.c_str());
+            exit(1);
+        }
+
+        // Fill the header. The object starts zeroed, so only what is not 0
+        // has to be set.
+        this->header = (HVStreamHeader*) mapping;
+        this->header->version = HV_STREAM_VERSION;
+        this->header->num_slots = num_slots;
+        this->header->slot_size = (uint32_t) slot_size;
+        this->header->width = width;
+        this->header->height = height;
+        this->header->num_keypoints = num_of_keypoints;
+        this->header->heatmap_size = heatmap_size;
+        this->header->heatmap_type = heatmap_type;
+
+        // Every slot starts free for the position it gets first.
+        for (int i = 0; i < num_slots; i++)
+            hv_stream_slot(this->header, i)->sequence = i;
+
+        // The magic goes last, so a consumer that sees it sees the rest too.
+        uint32_t magic;
+        memcpy(&magic, HV_STREAM_MAGIC, 4);
+        __atomic_store_n((uint32_t*) this->header->magic, magic, __ATOMIC_RELEASE);
+
+    }
+
+    SampleStream::~SampleStream() {
+
+        this->close();
+
+    }
+
+    void SampleStream::publish(int frame_id, const unsigned char* pixels, const std::vector<float> &annotations, const void* heatmaps) {
+
+        // Take the next position. The lock is only held for this, so the
+        // samples wait for their slots, and close() for them, without it.
+        uint64_t position;
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+
+            if (this->header == nullptr || this->closing) {
+                this->num_of_dropped++;
+                return;
+            }
+
+            position = this->write_position++;
+            this->num_of_publishers++;
+        }
+
+        HVStreamSlot* slot = hv_stream_slot(this->header, position);
+
+        // Wait for the consumers to release the slot.
+        bool published = true;
+        if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != position) {
+
+            this->num_of_waits++;
+            std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(SAMPLE_STREAM_TIMEOUT_S);
+            while (published && __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != position) {
+
+                if (this->closing) {
+                    published = false;
+                } else if (std::chrono::steady_clock::now() > deadline) {
+                    if (!this->closing.exchange(true))
+                        std::cerr << "The trainer stopped taking samples, dropping the rest of the stream." << std::endl;
+                    published = false;
+                } else {
+                    usleep(SAMPLE_STREAM_WAIT_US);
+                }
+
+            }
+
+        }
+
+        if (published) {
+
+            // Copy the sample in.
+            slot->frame_id = frame_id;
+            memcpy(hv_stream_image(slot), pixels, this->image_size);
+            memcpy(hv_stream_keypoints(this->header, slot), annotations.data(), this->keypoints_size);
+            if (this->heatmaps_size > 0)
+                memcpy(hv_stream_heatmaps(this->header, slot), heatmaps, this->heatmaps_size);
+
+            // And hand it to the consumers.
+            __atomic_store_n(&slot->sequence, position + 1, __ATOMIC_RELEASE);
+
+        }
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        // The samples can finish out of order, so the header keeps the
+        // furthest one, and close() the first one that never made it.
+        if (published) {
+            if (__atomic_load_n(&this->header->write_position, __ATOMIC_RELAXED) < position + 1)
+                __atomic_store_n(&this->header->write_position, position + 1, __ATOMIC_RELEASE);
+        } else {
+            this->num_of_dropped++;
+            this->end_position = std::min(this->end_position, position);
+        }
+
+        this->num_of_publishers--;
+        this->publishers_done.notify_all();
+
+    }
+
+    long SampleStream::getNumOfWaits() const {
+
+        return this->num_of_waits;
+
+    }
+
+    long SampleStream::getNumOfDropped() const {
+
+        return this->num_of_dropped;
+
+    }
+
+    void SampleStream::close() {
+
+        std::unique_lock<std::mutex> lock(this->mutex);
+
+        if (this->header == nullptr)
+            return;
+
+        // Stop the samples still waiting for a slot, and wait for the ones
+        // being copied in.
+        this->closing = true;
+        this->publishers_done.wait(lock, [this] { return this->num_of_publishers == 0; });
+
+        // The consumers can only go as far as the first dropped sample.
+        uint64_t end_position = std::min(this->end_position, this->write_position);
+        __atomic_store_n(&this->header->write_position, end_position, __ATOMIC_RELEASE);
+        __atomic_store_n(&this->header->closed, 1, __ATOMIC_RELEASE);
+
+        munmap(this->header, this->mapped_size);
+        shm_unlink(this->name.c_str());
+        this->header = nullptr;
+
+    }
+
+}  // namespace bgq_opengl
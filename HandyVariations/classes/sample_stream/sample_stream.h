@@ -0,0 +1,144 @@
+/**
+ * @file sample_stream.h
+ * @brief SampleStream class header file.
+ * @version 1.0.0 (2024-03-24)
+ * @date 2024-03-24
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_CLASSES_SAMPLE_STREAM_H_
+#define BGQ_OPENGL_CLASSES_SAMPLE_STREAM_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "sample_stream_layout.h"
+
+#define SAMPLE_STREAM_WAIT_US 100
+#define SAMPLE_STREAM_TIMEOUT_S 300
+
+namespace bgq_opengl {
+
+    /**
+     * @brief Implementation of a SampleStream class.
+     *
+     * Implementation of a ring of samples in POSIX shared memory, so that a
+     * trainer can take the samples as they are rendered instead of reading
+     * them from disk. The layout and the protocol of the ring are in
+     * sample_stream_layout.h, which is all a consumer needs. Publishing waits
+     * while the consumers are a whole ring behind, which in turn fills the
+     * queue of the writer threads and throttles the render loop. Samples can
+     * be published from several threads, and each waits for its own slot.
+     * If the consumers leave a slot taken for SAMPLE_STREAM_TIMEOUT_S
+     * seconds, the trainer is taken to be gone and the rest of the samples
+     * are dropped, so that the generator can still finish.
+     *
+     * @author Borja García Quiroga <garcaqub@tcd.ie>
+     */
+    class SampleStream {
+
+    public:
+
+        /**
+         * @brief Creates a new stream.
+         *
+         * Creates the shared memory object of the ring, replacing any
+         * previous one with the same name.
+         *
+         * @param name The name of the shared memory object, starting with a slash.
+         * @param num_slots The amount of samples the ring holds.
+         * @param width The width of the images.
+         * @param height The height of the images.
+         * @param num_of_keypoints The amount of keypoints of each sample.
+         * @param heatmap_size The size of the heatmaps, 0 if there are none.
+         * @param heatmap_type The type of the heatmaps, TENSOR_UINT8 or TENSOR_FLOAT16.
+         */
+        SampleStream(const char* name, int num_slots, int width, int height, int num_of_keypoints, int heatmap_size, int heatmap_type);
+
+        /**
+         * @brief Destroys the stream.
+         *
+         * Closes the stream if it was not closed yet.
+         */
+        ~SampleStream();
+
+        SampleStream(const SampleStream&) = delete;
+        SampleStream& operator=(const SampleStream&) = delete;
+
+        /**
+         * @brief Publish a sample.
+         *
+         * Copy a sample into the next slot of the ring, waiting for the
+         * consumers to release it first if needed. The sample is dropped if
+         * the stream is closed or the consumers stop releasing slots.
+         *
+         * @param frame_id The id of the sample.
+         * @param pixels The RGB pixels of the image, top row first.
+         * @param annotations The x, y and z of each keypoint, in pixels from the top left corner.
+         * @param heatmaps The heatmaps of the keypoints, or nullptr if there are none.
+         */
+        void publish(int frame_id, const unsigned char* pixels, const std::vector<float> &annotations, const void* heatmaps);
+
+        /**
+         * @brief Get the amount of waits.
+         *
+         * Get the amount of samples that had to wait for the consumers.
+         *
+         * @returns The amount of waits.
+         */
+        long getNumOfWaits() const;
+
+        /**
+         * @brief Get the amount of dropped samples.
+         *
+         * Get the amount of samples that were not published because the
+         * stream was closed or the consumers stopped.
+         *
+         * @returns The amount of dropped samples.
+         */
+        long getNumOfDropped() const;
+
+        /**
+         * @brief Close the stream.
+         *
+         * Stop the samples that are waiting for a slot, tell the consumers
+         * that no more samples will come, and remove the shared memory
+         * object. The consumers that already mapped it can
+         * still take the samples left in it.
+         */
+        void close();
+
+    private:
+
+        std::string name;                   /// The name of the shared memory object.
+        HVStreamHeader* header = nullptr;   /// The mapped ring.
+        size_t mapped_size = 0;             /// The size of the mapping.
+        size_t image_size = 0;              /// The size of each image.
+        size_t keypoints_size = 0;          /// The size of the keypoints of each sample.
+        size_t heatmaps_size = 0;           /// The size of the heatmaps of each sample.
+        uint64_t write_position = 0;        /// The next position to hand to a sample.
+        uint64_t end_position = UINT64_MAX; /// The first position that was dropped.
+        int num_of_publishers = 0;          /// The amount of samples being published.
+        std::atomic<bool> closing{false};   /// Whether the samples should stop waiting.
+        std::atomic<long> num_of_waits{0};  /// The amount of samples that had to wait.
+        std::atomic<long> num_of_dropped{0};    /// The amount of samples that were dropped.
+        std::mutex mutex;                   /// Guards the positions.
+        std::condition_variable publishers_done;    /// Signals a sample that is no longer being published.
+
+    };
+
+}  // namespace bgq_opengl
+
+#endif  //!BGQ_OPENGL_CLASSES_SAMPLE_STREAM_H_
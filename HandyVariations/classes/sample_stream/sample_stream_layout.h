@@ -0,0 +1,132 @@
+/**
+ * @file sample_stream_layout.h
+ * @brief Layout of the shared-memory ring the samples are streamed through.
+ * @version 1.0.0 (2024-03-24)
+ * @date 2024-03-24
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_CLASSES_SAMPLE_STREAM_LAYOUT_H_
+#define BGQ_OPENGL_CLASSES_SAMPLE_STREAM_LAYOUT_H_
+
+/*
+ * This header is plain C, so that any consumer can include it on its own.
+ *
+ * The shared memory object holds an HVStreamHeader followed by num_slots
+ * slots of slot_size bytes. Each slot is an HVStreamSlot followed by the
+ * image (height x width x 3 bytes, top row first, padded to a multiple of
+ * 4), the keypoints (x, y and z floats in pixels of the image) and, if
+ * heatmap_size is not 0, the heatmaps of the keypoints (heatmap_size x
+ * heatmap_size, uint8 or float16).
+ *
+ * The sequence of each slot tells who owns it. The slot of position p is
+ * p % num_slots:
+ *   - sequence == p      it is free for the generator to write position p.
+ *   - sequence == p + 1  it holds position p, ready to be claimed.
+ * Consumers claim the position at read_position by moving it forward with
+ * a compare and swap, copy the sample out and release the slot by setting
+ * its sequence to p + num_slots. Every sample goes to a single consumer, and
+ * the generator waits while the slot it needs next is still being used, so
+ * it never gets more than num_slots samples ahead of the consumers.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HV_STREAM_MAGIC "HVSR"
+#define HV_STREAM_VERSION 1
+#define HV_STREAM_ALIGNMENT 64
+
+/// The header of the ring, written once by the generator.
+typedef struct {
+    char magic[4];                      /// Always "HVSR", written last.
+    uint32_t version;                   /// The version of the layout.
+    uint32_t num_slots;                 /// The amount of slots.
+    uint32_t slot_size;                 /// The size of each slot, header included.
+    int32_t width;                      /// The width of the images.
+    int32_t height;                     /// The height of the images.
+    int32_t num_keypoints;              /// The amount of keypoints of each sample.
+    int32_t heatmap_size;               /// The size of the heatmaps, 0 if there are none.
+    int32_t heatmap_type;               /// The type of the heatmaps, 0 for uint8 and 1 for float16.
+    uint32_t closed;                    /// 1 once the generator will not write any more samples.
+    uint64_t write_position;            /// The amount of samples written so far.
+    uint8_t padding[HV_STREAM_ALIGNMENT - 48];
+    uint64_t read_position;             /// The next position to claim, on a cache line of its own.
+    uint8_t read_padding[HV_STREAM_ALIGNMENT - 8];
+} HVStreamHeader;
+
+/// The header of each slot.
+typedef struct {
+    uint64_t sequence;                  /// Who owns the slot, see above.
+    int32_t frame_id;                   /// The id of the sample.
+    uint32_t reserved;                  /// Padding.
+    uint8_t padding[HV_STREAM_ALIGNMENT - 16];
+} HVStreamSlot;
+
+/// Get the size of an image in a slot, padded so that the keypoints are aligned.
+static inline size_t hv_stream_image_size(int32_t width, int32_t height) {
+    return ((size_t) width * height * 3 + 3) & ~(size_t) 3;
+}
+
+/// Get the size of the samples of a ring, without the slot header.
+static inline size_t hv_stream_sample_size(int32_t width, int32_t height, int32_t num_keypoints, int32_t heatmap_size, int32_t heatmap_type) {
+    size_t heatmap_element = (heatmap_type == 0) ? 1 : 2;
+    return hv_stream_image_size(width, height) + (size_t) num_keypoints * 3 * sizeof(float)
+        + (size_t) num_keypoints * heatmap_size * heatmap_size * heatmap_element;
+}
+
+/// Get the slot of a position.
+static inline HVStreamSlot* hv_stream_slot(HVStreamHeader* header, uint64_t position) {
+    return (HVStreamSlot*) ((uint8_t*) header + sizeof(HVStreamHeader) + (size_t) (position % header->num_slots) * header->slot_size);
+}
+
+/// Get the image of a slot.
+static inline uint8_t* hv_stream_image(HVStreamSlot* slot) {
+    return (uint8_t*) slot + sizeof(HVStreamSlot);
+}
+
+/// Get the keypoints of a slot.
+static inline float* hv_stream_keypoints(const HVStreamHeader* header, HVStreamSlot* slot) {
+    return (float*) (hv_stream_image(slot) + hv_stream_image_size(header->width, header->height));
+}
+
+/// Get the heatmaps of a slot.
+static inline uint8_t* hv_stream_heatmaps(const HVStreamHeader* header, HVStreamSlot* slot) {
+    return (uint8_t*) (hv_stream_keypoints(header, slot) + (size_t) header->num_keypoints * 3);
+}
+
+/// Claim the next sample. Returns its position, or -1 if there is none yet.
+static inline int64_t hv_stream_claim(HVStreamHeader* header) {
+    uint64_t position = __atomic_load_n(&header->read_position, __ATOMIC_RELAXED);
+    for (;;) {
+        uint64_t sequence = __atomic_load_n(&hv_stream_slot(header, position)->sequence, __ATOMIC_ACQUIRE);
+        if (sequence == position + 1) {
+            if (__atomic_compare_exchange_n(&header->read_position, &position, position + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                return (int64_t) position;
+        } else if (sequence < position + 1) {
+            return -1;
+        } else {
+            position = __atomic_load_n(&header->read_position, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/// Give a claimed slot back to the generator once the sample is copied.
+static inline void hv_stream_release(HVStreamHeader* header, uint64_t position) {
+    __atomic_store_n(&hv_stream_slot(header, position)->sequence, position + header->num_slots, __ATOMIC_RELEASE);
+}
+
+/// Whether the generator has finished and every sample has been claimed.
+static inline int hv_stream_finished(HVStreamHeader* header) {
+    return __atomic_load_n(&header->closed, __ATOMIC_ACQUIRE)
+        && __atomic_load_n(&header->read_position, __ATOMIC_RELAXED) >= __atomic_load_n(&header->write_position, __ATOMIC_ACQUIRE);
+}
+
+#endif  //!BGQ_OPENGL_CLASSES_SAMPLE_STREAM_LAYOUT_H_
@@ -16,6 +16,7 @@
 #include "shader.h"
 
 #include <string>
+#include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -41,12 +42,16 @@ namespace bgq_opengl {
     
     }
     
-    Shader::Shader(const char* vertex_filename, const char* fragment_filename) {
+    Shader::Shader(const char* vertex_filename, const char* fragment_filename) : Shader(vertex_filename, nullptr, fragment_filename) {}
+
+    Shader::Shader(const char* vertex_filename, const char* geometry_filename, const char* fragment_filename,
+                   const std::vector<const char*> &feedback_varyings) {
 
         this->light = new Light();
 
         // Init the strings to store the source code in.
         std::string vertex_source_code = "";
+        std::string geometry_source_code = "";
         std::string fragment_source_code = "";
 
         try {
@@ -60,14 +65,33 @@ namespace bgq_opengl {
         
         }
 
-        try {
+        if (geometry_filename != nullptr) {
 
-            readFileContents(fragment_filename, &fragment_source_code);
+            try {
 
-        } catch (std::ifstream::failure& e) {
+                readFileContents(geometry_filename, &geometry_source_code);
 
-            std::cerr << "Shader error - Could not read the fragment shader file: " << e.what() << std::endl;
-            exit(1);
+            } catch (std::ifstream::failure& e) {
+
+                std::cerr << "Shader error - Could not read the geometry shader file: " << e.what() << std::endl;
+                exit(1);
+
+            }
+
+        }
+
+        if (fragment_filename != nullptr) {
+
+            try {
+
+                readFileContents(fragment_filename, &fragment_source_code);
+
+            } catch (std::ifstream::failure& e) {
+
+                std::cerr << "Shader error - Could not read the fragment shader file: " << e.what() << std::endl;
+                exit(1);
+
+            }
 
         }
 
@@ -89,24 +113,56 @@ namespace bgq_opengl {
 
         }
 
-        // Create and compile the fragment shader.
-        GLuint fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fragment_code_char, NULL);
-        glCompileShader(fragment);
+        // Create and compile the geometry shader, if there is one.
+        GLuint geometry = 0;
+        if (geometry_filename != nullptr) {
 
-        // Check for errors.
-        error_msg = "";
-        if (!Shader::checkShader(fragment, "FRAGMENT", &error_msg)) {
+            const char* geometry_code_char = geometry_source_code.c_str();
+            geometry = glCreateShader(GL_GEOMETRY_SHADER);
+            glShaderSource(geometry, 1, &geometry_code_char, NULL);
+            glCompileShader(geometry);
 
-            std::cerr << "Fragment shader error - Could not compile the shader: " << error_msg << std::endl;
-            exit(1);
+            // Check for errors.
+            error_msg = "";
+            if (!Shader::checkShader(geometry, "GEOMETRY", &error_msg)) {
+
+                std::cerr << "Geometry shader error - Could not compile the shader: " << error_msg << std::endl;
+                exit(1);
+
+            }
+
+        }
+
+        // Create and compile the fragment shader, if there is one.
+        GLuint fragment = 0;
+        if (fragment_filename != nullptr) {
+
+            fragment = glCreateShader(GL_FRAGMENT_SHADER);
+            glShaderSource(fragment, 1, &fragment_code_char, NULL);
+            glCompileShader(fragment);
+
+            // Check for errors.
+            error_msg = "";
+            if (!Shader::checkShader(fragment, "FRAGMENT", &error_msg)) {
+
+                std::cerr << "Fragment shader error - Could not compile the shader: " << error_msg << std::endl;
+                exit(1);
+
+            }
 
         }
 
         // Create the program and add the vertex and fragment shaders.
         this->programID = glCreateProgram();
         glAttachShader(this->programID, vertex);
-        glAttachShader(this->programID, fragment);
+        if (geometry != 0)
+            glAttachShader(this->programID, geometry);
+        if (fragment != 0)
+            glAttachShader(this->programID, fragment);
+
+        // The outputs to capture must be known before linking.
+        if (!feedback_varyings.empty())
+            glTransformFeedbackVaryings(this->programID, (GLsizei) feedback_varyings.size(), feedback_varyings.data(), GL_INTERLEAVED_ATTRIBS);
 
         // Link this program and check for program errors.
         glLinkProgram(this->programID);
@@ -121,7 +177,10 @@ namespace bgq_opengl {
         // Clean the shaders.
         // They are in the compiled program now, so clean them.
         glDeleteShader(vertex);
-        glDeleteShader(fragment);
+        if (geometry != 0)
+            glDeleteShader(geometry);
+        if (fragment != 0)
+            glDeleteShader(fragment);
 
         /*
         // Validate the program.
@@ -17,6 +17,7 @@
 #define BGQ_OPENGL_SHADER_H_
 
 #include <string>
+#include <vector>
 
 #include "glm/glm.hpp"
 
@@ -57,6 +58,21 @@ namespace bgq_opengl {
          */
         Shader(const char* vertex_filename, const char* fragment_filename);
 
+        /**
+         * @brief Construct the shader instance.
+         *
+         * Construct the shader instance by passing the shaders' files,
+         * including a geometry shader. A program whose outputs are captured
+         * with transform feedback does not need a fragment shader.
+         *
+         * @param vertex_filename Vertex shader filename.
+         * @param geometry_filename Geometry shader filename, or nullptr for none.
+         * @param fragment_filename Fragment shader filename, or nullptr for none.
+         * @param feedback_varyings The outputs captured with transform feedback, interleaved in this order.
+         */
+        Shader(const char* vertex_filename, const char* geometry_filename, const char* fragment_filename,
+               const std::vector<const char*> &feedback_varyings = {});
+
         /**
          *@brief Returns the program ID.
          *
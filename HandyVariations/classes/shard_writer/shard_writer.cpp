@@ -0,0 +1,440 @@
+/**
+ * @file shard_writer.cpp
+ * @brief Shard writer class implementation file.
+ * @version 1.0.0 (2024-03-12)
+ * @date 2024-03-12
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#include "shard_writer.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace bgq_opengl {
+
+    /**
+     * @brief Append a list of floats to a json string.
+     *
+     * Append the shortest representation of each of the floats as a json list.
+     *
+     * @param json The json string.
+     * @param values The floats.
+     * @param count The amount of floats.
+     */
+    static void appendList(std::string &json, const float* values, int count) {
+
+        char number[32];
+
+        json += "[";
+        for (int i = 0; i < count; i++) {
+
+            if (i > 0)
+                json += ", ";
+
+            std::to_chars_result result = std::to_chars(number, number + 32, values[i]);
+            json.append(number, result.ptr - number);
+
+        }
+        json += "]";
+
+    }
+
+    /**
+     * @brief Write some bytes to a file and sync it.
+     *
+     * Write some bytes at a given position of a file, even if it takes several
+     * calls, and make them durable.
+     *
+     * @param filename The name of the file.
+     * @param data The bytes.
+     * @param size The amount of bytes.
+     * @param offset The position to write them at.
+     * @param truncate Whether to drop the previous contents of the file.
+     *
+     * @returns True if the bytes are on the disk.
+     */
+    static bool writeFile(const std::string &filename, const void* data, size_t size, off_t offset, bool truncate) {
+
+        int file_descriptor = open(filename.c_str(), O_WRONLY | O_CREAT | (truncate ? O_TRUNC : 0), 0644);
+        if (file_descriptor < 0)
+            return false;
+
+        size_t written = 0;
+        while (written < size) {
+
+            ssize_t result = pwrite(file_descriptor, (const char*) data + written, size - written, offset + written);
+            if (result < 0)
+                break;
+
+            written += result;
+
+        }
+
+        bool success = written == size && fsync(file_descriptor) == 0;
+        ::close(file_descriptor);
+
+        return success;
+
+    }
+
+    ShardWriter::ShardWriter(const char* directory, int samples_per_shard, int first_shard) {
+
+        this->directory = directory;
+        this->samples_per_shard = samples_per_shard > 0 ? samples_per_shard : 1;
+        this->num_of_shards = first_shard;
+
+        // Allocate the buffer.
+        this->buffer.resize(SHARD_WRITER_BUFFER_SIZE);
+
+    }
+
+    ShardWriter::~ShardWriter() {
+
+        this->close();
+
+    }
+
+    void ShardWriter::write(int frame_id, const unsigned char* image, size_t image_size, const char* image_extension,
+                            const float* keypoints, int num_keypoints, const float* k_matrix) {
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        // Move on to a new shard when the current one is full.
+        if (this->file_descriptor >= 0 && (int) this->index.size() >= this->samples_per_shard)
+            this->closeShard();
+
+        if (this->file_descriptor < 0)
+            this->openShard();
+
+        // Build the annotation.
+        std::string json = "{\"xyz\": [";
+        for (int i = 0; i < num_keypoints; i++) {
+            if (i > 0)
+                json += ", ";
+            appendList(json, keypoints + i * 3, 3);
+        }
+        json += "], \"K\": [";
+        for (int i = 0; i < 3; i++) {
+            if (i > 0)
+                json += ", ";
+            appendList(json, k_matrix + i * 3, 3);
+        }
+        json += "]}";
+
+        // Both files share the name, so they are read as a single sample.
+        char name[32];
+        snprintf(name, 32, "%08i", frame_id);
+
+        ShardIndexEntry entry;
+        memset(&entry, 0, sizeof(ShardIndexEntry));
+        entry.frame_id = frame_id;
+        entry.image_size = (uint32_t) image_size;
+        entry.image_offset = this->addMember(std::string(name) + "." + image_extension, image, image_size);
+        entry.annotation_size = (uint32_t) json.size();
+        entry.annotation_offset = this->addMember(std::string(name) + ".json", json.data(), json.size());
+
+        this->index.push_back(entry);
+
+    }
+
+    int ShardWriter::getNumOfShards() const {
+
+        return this->num_of_shards;
+
+    }
+
+    ShardState ShardWriter::getState() const {
+
+        ShardState state;
+        memset(&state, 0, sizeof(ShardState));
+        state.num_of_shards = this->num_of_shards;
+
+        // The open shard is not complete yet.
+        if (this->file_descriptor >= 0) {
+            state.num_of_shards--;
+            state.num_of_samples = (int32_t) this->index.size();
+            state.offset = this->offset;
+        }
+
+        return state;
+
+    }
+
+    bool ShardWriter::sync() {
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        if (this->file_descriptor < 0)
+            return !this->failed;
+
+        this->flush();
+
+        // Add the entries written since the last sync to the index of the
+        // open shard.
+        std::string index_filename = this->getShardName(this->num_of_shards - 1) + ".idx.tmp";
+        size_t num_of_new = this->index.size() - this->num_of_synced;
+        if (!writeFile(index_filename, this->index.data() + this->num_of_synced, num_of_new * sizeof(ShardIndexEntry),
+                       (off_t) (this->num_of_synced * sizeof(ShardIndexEntry)), this->num_of_synced == 0)) {
+            std::cerr << "Could not write the index " << index_filename << std::endl;
+            this->failed = true;
+        }
+
+        if (fsync(this->file_descriptor) != 0) {
+            std::cerr << "Could not sync the shard " << this->shard_filename << std::endl;
+            this->failed = true;
+        }
+
+        if (!this->failed)
+            this->num_of_synced = this->index.size();
+
+        return !this->failed;
+
+    }
+
+    int ShardWriter::restore(const ShardState &state) {
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        if (state.num_of_shards != this->num_of_shards || state.num_of_samples < 0 || state.num_of_samples > this->samples_per_shard)
+            return -1;
+
+        // Every complete shard must hold as many samples as its index says.
+        int num_of_samples = 0;
+        for (int i = 0; i < this->num_of_shards; i++) {
+
+            std::ifstream index_file(this->getShardName(i) + ".idx", std::ios::in | std::ios::binary | std::ios::ate);
+            std::ifstream shard_file(this->getShardName(i) + ".tar", std::ios::in | std::ios::binary | std::ios::ate);
+            if (!index_file.is_open() || !shard_file.is_open())
+                return -1;
+
+            size_t index_size = (size_t) index_file.tellg();
+            if (index_size == 0 || index_size % sizeof(ShardIndexEntry) != 0 || index_size / sizeof(ShardIndexEntry) > (size_t) this->samples_per_shard)
+                return -1;
+
+            ShardIndexEntry last;
+            index_file.seekg(index_size - sizeof(ShardIndexEntry));
+            index_file.read((char*) &last, sizeof(ShardIndexEntry));
+            if (!index_file || (uint64_t) shard_file.tellg() < last.annotation_offset + last.annotation_size + TAR_BLOCK_SIZE * 2)
+                return -1;
+
+            num_of_samples += (int) (index_size / sizeof(ShardIndexEntry));
+
+        }
+
+        if (state.num_of_samples == 0)
+            return num_of_samples;
+
+        // The open shard may have been finished after the checkpoint, then it
+        // is reopened from its final name.
+        std::string name = this->getShardName(this->num_of_shards);
+        if (access((name + ".tar.tmp").c_str(), F_OK) != 0) {
+            rename((name + ".tar").c_str(), (name + ".tar.tmp").c_str());
+            rename((name + ".idx").c_str(), (name + ".idx.tmp").c_str());
+        }
+
+        // Keep the samples of the checkpoint.
+        std::vector<ShardIndexEntry> entries(state.num_of_samples);
+        std::ifstream index_file(name + ".idx.tmp", std::ios::in | std::ios::binary);
+        index_file.read((char*) entries.data(), entries.size() * sizeof(ShardIndexEntry));
+
+        const ShardIndexEntry &last = entries.back();
+        if (!index_file || last.annotation_offset + last.annotation_size > state.offset)
+            return -1;
+
+        // And drop anything written past them.
+        int file_descriptor = open((name + ".tar.tmp").c_str(), O_WRONLY);
+        if (file_descriptor < 0)
+            return -1;
+
+        if (lseek(file_descriptor, 0, SEEK_END) < (off_t) state.offset || ftruncate(file_descriptor, state.offset) != 0 ||
+            lseek(file_descriptor, state.offset, SEEK_SET) != (off_t) state.offset) {
+            ::close(file_descriptor);
+            return -1;
+        }
+
+        this->file_descriptor = file_descriptor;
+        this->shard_filename = name + ".tar";
+        this->offset = state.offset;
+        this->index = entries;
+        this->num_of_synced = entries.size();
+        this->num_of_shards++;
+
+        return num_of_samples + state.num_of_samples;
+
+    }
+
+    bool ShardWriter::close() {
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        if (this->file_descriptor >= 0)
+            this->closeShard();
+
+        return !this->failed;
+
+    }
+
+    void ShardWriter::openShard() {
+
+        this->shard_filename = this->getShardName(this->num_of_shards) + ".tar";
+
+        // Write to a temporary file until the shard is complete.
+        std::string tmp_filename = this->shard_filename + ".tmp";
+        this->file_descriptor = open(tmp_filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (this->file_descriptor < 0) {
+            std::cerr << "Could not create the shard " << tmp_filename << std::endl;
+            exit(1);
+        }
+
+        this->offset = 0;
+        this->index.clear();
+        this->num_of_synced = 0;
+        this->num_of_shards++;
+
+    }
+
+    std::string ShardWriter::getShardName(int shard) const {
+
+        char name[32];
+        snprintf(name, 32, "/shard_%06i", shard);
+
+        return this->directory + name;
+
+    }
+
+    void ShardWriter::closeShard() {
+
+        // A tar archive ends with two empty blocks.
+        char end[TAR_BLOCK_SIZE * 2];
+        memset(end, 0, TAR_BLOCK_SIZE * 2);
+        this->append(end, TAR_BLOCK_SIZE * 2);
+        this->flush();
+
+        if (fsync(this->file_descriptor) != 0) {
+            std::cerr << "Could not sync the shard " << this->shard_filename << std::endl;
+            this->failed = true;
+        }
+
+        ::close(this->file_descriptor);
+        this->file_descriptor = -1;
+
+        // Write the index next to it, before the shard gets its final name.
+        std::string index_filename = this->shard_filename.substr(0, this->shard_filename.size() - 4) + ".idx";
+        if (!writeFile(index_filename, this->index.data(), this->index.size() * sizeof(ShardIndexEntry), 0, true)) {
+            std::cerr << "Could not write the index " << index_filename << std::endl;
+            this->failed = true;
+        }
+
+        // Move the shard to its final name, and drop the index kept while it
+        // was open.
+        std::string tmp_filename = this->shard_filename + ".tmp";
+        if (rename(tmp_filename.c_str(), this->shard_filename.c_str()) != 0) {
+            std::cerr << "Could not finalise the shard " << this->shard_filename << std::endl;
+            this->failed = true;
+        }
+
+        unlink((index_filename + ".tmp").c_str());
+
+    }
+
+    uint64_t ShardWriter::addMember(const std::string &name, const void* data, size_t size) {
+
+        // Build a ustar header.
+        char header[TAR_BLOCK_SIZE];
+        memset(header, 0, TAR_BLOCK_SIZE);
+
+        strncpy(header, name.c_str(), 99);                              // Name.
+        snprintf(header + 100, 8, "%07o", 0644);                        // Mode.
+        snprintf(header + 108, 8, "%07o", 0);                           // Owner.
+        snprintf(header + 116, 8, "%07o", 0);                           // Group.
+        snprintf(header + 124, 12, "%011llo", (unsigned long long) size); // Size.
+        snprintf(header + 136, 12, "%011o", 0);                         // Modification time.
+        header[156] = '0';                                              // Regular file.
+        memcpy(header + 257, "ustar", 6);                               // Magic.
+        memcpy(header + 263, "00", 2);                                  // Version.
+
+        // The checksum is computed with its own field filled with spaces.
+        memset(header + 148, ' ', 8);
+        unsigned int checksum = 0;
+        for (int i = 0; i < TAR_BLOCK_SIZE; i++)
+            checksum += (unsigned char) header[i];
+        snprintf(header + 148, 8, "%06o", checksum);
+        header[155] = ' ';
+
+        this->append(header, TAR_BLOCK_SIZE);
+
+        // Write the contents, padded to a whole block.
+        uint64_t data_offset = this->offset;
+        this->append(data, size);
+
+        size_t padding = (TAR_BLOCK_SIZE - size % TAR_BLOCK_SIZE) % TAR_BLOCK_SIZE;
+        char zeros[TAR_BLOCK_SIZE];
+        memset(zeros, 0, padding);
+        this->append(zeros, padding);
+
+        return data_offset;
+
+    }
+
+    void ShardWriter::append(const void* data, size_t size) {
+
+        const char* bytes = (const char*) data;
+
+        // Big chunks skip the buffer.
+        if (size > this->buffer.size()) {
+            this->flush();
+            if (::write(this->file_descriptor, bytes, size) != (ssize_t) size)
+                this->failed = true;
+            this->offset += size;
+            return;
+        }
+
+        if (this->used + size > this->buffer.size())
+            this->flush();
+
+        memcpy(this->buffer.data() + this->used, bytes, size);
+        this->used += size;
+        this->offset += size;
+
+    }
+
+    void ShardWriter::flush() {
+
+        // Write the whole buffer, even if it takes several calls.
+        size_t written = 0;
+        while (written < this->used) {
+
+            ssize_t result = ::write(this->file_descriptor, this->buffer.data() + written, this->used - written);
+            if (result < 0) {
+                std::cerr << "Could not write to the shard " << this->shard_filename << std::endl;
+                this->failed = true;
+                break;
+            }
+
+            written += result;
+
+        }
+
+        this->used = 0;
+
+    }
+
+}  // namespace bgq_opengl
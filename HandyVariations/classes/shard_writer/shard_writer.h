@@ -0,0 +1,231 @@
+/**
+ * @file shard_writer.h
+ * @brief Shard writer class header file.
+ * @version 1.0.0 (2024-03-12)
+ * @date 2024-03-12
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_CLASSES_SHARD_WRITER_H_
+#define BGQ_OPENGL_CLASSES_SHARD_WRITER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "structs/shard_state/shard_state.h"
+
+#define SHARD_WRITER_BUFFER_SIZE (4 << 20)
+#define TAR_BLOCK_SIZE 512
+
+namespace bgq_opengl {
+
+    /**
+     * @brief The position of a sample inside a shard.
+     *
+     * An entry of the index written next to every shard, so that any sample
+     * can be read without scanning the tar file.
+     */
+    struct ShardIndexEntry {
+        uint32_t frame_id;                  /// The id of the sample.
+        uint32_t image_size;                /// The size of the encoded image.
+        uint64_t image_offset;              /// The offset of the encoded image.
+        uint64_t annotation_offset;         /// The offset of the json annotation.
+        uint32_t annotation_size;           /// The size of the json annotation.
+        uint32_t reserved;                  /// Padding.
+    };
+
+    /**
+     * @brief Implementation of a ShardWriter class.
+     *
+     * Implementation of a writer that packs the samples into sequential tar
+     * shards of a fixed amount of samples each. Every sample is stored as an
+     * encoded image and a json annotation sharing the same name, and every
+     * shard gets a binary .idx file with the offsets of its samples. Samples
+     * can be written from several threads.
+     *
+     * @author Borja García Quiroga <garcaqub@tcd.ie>
+     */
+    class ShardWriter {
+
+    public:
+
+        /**
+         * @brief Creates a new writer.
+         *
+         * Creates a new writer on a directory. Shards are created when the
+         * first sample that goes into them is written.
+         *
+         * @param directory The directory of the shards.
+         * @param samples_per_shard The amount of samples in each shard.
+         * @param first_shard The number of the first shard to write.
+         */
+        ShardWriter(const char* directory, int samples_per_shard, int first_shard = 0);
+
+        /**
+         * @brief Destroys the writer.
+         *
+         * Closes the current shard.
+         */
+        ~ShardWriter();
+
+        ShardWriter(const ShardWriter&) = delete;
+        ShardWriter& operator=(const ShardWriter&) = delete;
+
+        /**
+         * @brief Write a sample.
+         *
+         * Append a sample to the current shard, starting a new one if needed.
+         *
+         * @param frame_id The id of the sample.
+         * @param image The encoded image.
+         * @param image_size The size of the encoded image.
+         * @param image_extension The extension of the image, such as jpg.
+         * @param keypoints The keypoints as num_keypoints rows of 3 floats.
+         * @param num_keypoints The amount of keypoints.
+         * @param k_matrix The 3x3 k_matrix in row-major order.
+         */
+        void write(int frame_id, const unsigned char* image, size_t image_size, const char* image_extension,
+                   const float* keypoints, int num_keypoints, const float* k_matrix);
+
+        /**
+         * @brief Get the amount of shards.
+         *
+         * Get the amount of shards started so far, including the ones of
+         * previous runs.
+         *
+         * @returns The amount of shards.
+         */
+        int getNumOfShards() const;
+
+        /**
+         * @brief Get the state of the writer.
+         *
+         * Get the amount of complete shards and the progress of the open one.
+         * Only what was written before the last call to sync() or close() is
+         * on the disk.
+         *
+         * @returns The state of the writer.
+         */
+        ShardState getState() const;
+
+        /**
+         * @brief Make the samples durable.
+         *
+         * Write the samples so far to the disk without finishing the current
+         * shard. Its index is kept in a temporary file next to it, so that
+         * the shard can be reopened from a checkpoint.
+         *
+         * @returns True if every shard was written.
+         */
+        bool sync();
+
+        /**
+         * @brief Go on from a checkpoint.
+         *
+         * Check the complete shards of a checkpoint and reopen the one it
+         * left open, dropping anything written to it afterwards. The writer
+         * must have been created with the complete shards as its first shard.
+         *
+         * @param state The state of the writer at the checkpoint.
+         *
+         * @returns The amount of samples in the shards of the checkpoint, or
+         * -1 if they are missing or do not match it.
+         */
+        int restore(const ShardState &state);
+
+        /**
+         * @brief Close the writer.
+         *
+         * Finish the current shard. Writing more samples afterwards starts a
+         * new shard.
+         *
+         * @returns True if every shard was written.
+         */
+        bool close();
+
+    private:
+
+        /**
+         * @brief Start a new shard.
+         *
+         * Create the temporary file of the next shard.
+         */
+        void openShard();
+
+        /**
+         * @brief Get the name of a shard.
+         *
+         * Get the final name of a shard, without the extension.
+         *
+         * @param shard The number of the shard.
+         *
+         * @returns The name of the shard.
+         */
+        std::string getShardName(int shard) const;
+
+        /**
+         * @brief Finish the current shard.
+         *
+         * Write the end of the archive, move the shard to its final name and
+         * write its index.
+         */
+        void closeShard();
+
+        /**
+         * @brief Append a file to the shard.
+         *
+         * Append a tar header, the contents and the padding of a file.
+         *
+         * @param name The name of the file.
+         * @param data The contents.
+         * @param size The size of the contents.
+         *
+         * @returns The offset of the contents in the shard.
+         */
+        uint64_t addMember(const std::string &name, const void* data, size_t size);
+
+        /**
+         * @brief Append some bytes.
+         *
+         * Append some bytes to the buffer, flushing it if needed.
+         *
+         * @param data The bytes.
+         * @param size The amount of bytes.
+         */
+        void append(const void* data, size_t size);
+
+        /**
+         * @brief Flush the buffer.
+         *
+         * Write the contents of the buffer to the current shard.
+         */
+        void flush();
+
+        std::string directory;              /// The directory of the shards.
+        int samples_per_shard;              /// The amount of samples in each shard.
+        int num_of_shards = 0;              /// The amount of shards started.
+        int file_descriptor = -1;           /// The current shard.
+        std::string shard_filename;         /// The final name of the current shard.
+        uint64_t offset = 0;                /// The size of the current shard so far.
+        std::vector<ShardIndexEntry> index; /// The index of the current shard.
+        size_t num_of_synced = 0;           /// The amount of entries of the index already on the disk.
+        std::vector<char> buffer;           /// The pending output.
+        size_t used = 0;                    /// The amount of bytes used in the buffer.
+        bool failed = false;                /// Whether a write has failed.
+        std::mutex mutex;                   /// Serialises the writes.
+
+    };
+
+}  // namespace bgq_opengl
+
+#endif  //!BGQ_OPENGL_CLASSES_SHARD_WRITER_H_
@@ -0,0 +1,72 @@
+/**
+ * @file tbo.cpp
+ * @brief TBO class implementation file.
+ * @version 1.0.0 (2024-03-19)
+ * @date 2024-03-19
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#include "tbo.h"
+
+#include <cstddef>
+#include <vector>
+
+#include "GL/glew.h"
+#include "glm/glm.hpp"
+
+namespace bgq_opengl {
+
+	TBO::TBO() {
+
+		// Generate the buffer and the texture that reads it.
+		glGenBuffers(1, &this->ID);
+		glGenTextures(1, &this->texture_ID);
+
+	}
+
+	void TBO::bind(GLuint slot) {
+
+		// Bind the texture to the slot.
+		glActiveTexture(GL_TEXTURE0 + slot);
+		glBindTexture(GL_TEXTURE_BUFFER, this->texture_ID);
+
+	}
+
+	void TBO::remove() {
+
+		// Delete the buffer and the texture in OpenGL.
+		glDeleteTextures(1, &this->texture_ID);
+		glDeleteBuffers(1, &this->ID);
+
+	}
+
+	void TBO::update(const std::vector<glm::vec4> &texels) {
+
+		this->update(texels.data(), texels.size());
+
+	}
+
+	void TBO::update(const glm::vec4* texels, size_t num_of_texels) {
+
+		// Orphan the previous storage and fill a new one.
+		GLsizeiptr size = (GLsizeiptr) (num_of_texels * sizeof(glm::vec4));
+		glBindBuffer(GL_TEXTURE_BUFFER, this->ID);
+		glBufferData(GL_TEXTURE_BUFFER, size, nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_TEXTURE_BUFFER, 0, size, texels);
+		glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+		// Point the texture at it.
+		glBindTexture(GL_TEXTURE_BUFFER, this->texture_ID);
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, this->ID);
+		glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+	}
+
+}  // namespace bgq_opengl
@@ -0,0 +1,92 @@
+/**
+ * @file tbo.h
+ * @brief TBO class header file.
+ * @version 1.0.0 (2024-03-19)
+ * @date 2024-03-19
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_CLASS_TBO_H_
+#define BGQ_OPENGL_CLASS_TBO_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "GL/glew.h"
+#include "glm/glm.hpp"
+
+namespace bgq_opengl {
+
+	/**
+	 * @brief Implementation of a TBO class.
+	 *
+	 * Implementation of a texture buffer, a buffer of RGBA32F texels that the
+	 * shaders read with texelFetch. It holds data that is too big for
+	 * uniforms, such as the data of every instance of a draw call.
+	 *
+	 * @author Borja García Quiroga <garcaqub@tcd.ie>
+	 */
+	class TBO {
+
+	public:
+
+		/**
+		 * @brief Constructs a Texture Buffer Object.
+		 *
+		 * Constructs an empty Texture Buffer Object.
+		 */
+		TBO();
+
+		/**
+		 * @brief Binds the TBO.
+		 *
+		 * Binds the texture of the TBO to a texture slot.
+		 *
+		 * @param slot The texture slot.
+		 */
+		void bind(GLuint slot);
+
+		/**
+		 * @brief Removes the TBO.
+		 *
+		 * Removes the buffer and its texture from OpenGL.
+		 */
+		void remove();
+
+		/**
+		 * @brief Updates the contents.
+		 *
+		 * Replace the contents of the buffer. The previous storage is
+		 * orphaned, so this does not wait for draws that still use it.
+		 *
+		 * @param texels The texels.
+		 */
+		void update(const std::vector<glm::vec4> &texels);
+
+		/**
+		 * @brief Updates the contents.
+		 *
+		 * Replace the contents of the buffer with part of an array.
+		 *
+		 * @param texels The first texel.
+		 * @param num_of_texels The amount of texels.
+		 */
+		void update(const glm::vec4* texels, size_t num_of_texels);
+
+	private:
+
+		GLuint ID;				// GL ID of the buffer.
+		GLuint texture_ID;		// GL ID of the texture that reads the buffer.
+
+	};
+
+}  // namespace bgq_opengl
+
+#endif //!BGQ_OPENGL_CLASS_TBO_H_
@@ -0,0 +1,465 @@
+/**
+ * @file tensor_shard_writer.cpp
+ * @brief Tensor shard writer class implementation file.
+ * @version 1.0.0 (2024-03-13)
+ * @date 2024-03-13
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#include "tensor_shard_writer.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace bgq_opengl {
+
+    /**
+     * @brief Write some bytes to a file.
+     *
+     * Write some bytes at a given position of a file, even if it takes several
+     * calls.
+     *
+     * @param file_descriptor The file.
+     * @param data The bytes.
+     * @param size The amount of bytes.
+     * @param offset The position to write them at.
+     *
+     * @returns True if every byte was written.
+     */
+    static bool writeAll(int file_descriptor, const void* data, size_t size, off_t offset) {
+
+        size_t written = 0;
+        while (written < size) {
+
+            ssize_t result = pwrite(file_descriptor, (const char*) data + written, size - written, offset + written);
+            if (result < 0)
+                return false;
+
+            written += result;
+
+        }
+
+        return true;
+
+    }
+
+    /**
+     * @brief Write some bytes to a file and sync it.
+     *
+     * Write some bytes at a given position of a file and make them durable.
+     *
+     * @param filename The name of the file.
+     * @param data The bytes.
+     * @param size The amount of bytes.
+     * @param offset The position to write them at.
+     * @param truncate Whether to drop the previous contents of the file.
+     *
+     * @returns True if the bytes are on the disk.
+     */
+    static bool writeFile(const std::string &filename, const void* data, size_t size, off_t offset, bool truncate) {
+
+        int file_descriptor = open(filename.c_str(), O_WRONLY | O_CREAT | (truncate ? O_TRUNC : 0), 0644);
+        if (file_descriptor < 0)
+            return false;
+
+        bool success = writeAll(file_descriptor, data, size, offset) && fsync(file_descriptor) == 0;
+        ::close(file_descriptor);
+
+        return success;
+
+    }
+
+    TensorShardWriter::TensorShardWriter(const char* directory, const char* prefix, int samples_per_shard,
+                                         const std::vector<int> &sample_shape, TensorType type, int first_shard,
+                                         bool bypass_cache) {
+
+        this->directory = directory;
+        this->prefix = prefix;
+        this->samples_per_shard = samples_per_shard > 0 ? samples_per_shard : 1;
+        this->sample_shape = sample_shape;
+        this->type = type;
+        this->num_of_shards = first_shard;
+        this->bypass_cache = bypass_cache;
+
+        // Get the size of each sample.
+        size_t element_size = (type == TENSOR_UINT8) ? 1 : (type == TENSOR_FLOAT16) ? 2 : 4;
+        this->sample_size = element_size;
+        for (int dimension : sample_shape)
+            this->sample_size *= dimension;
+
+        // Make the staging buffer hold a whole amount of samples, plus a page
+        // for what is left over when only whole pages are written, rounded up
+        // to whole pages.
+        size_t samples_per_chunk = TENSOR_SHARD_STAGING_SIZE / this->sample_size;
+        if (samples_per_chunk < 1)
+            samples_per_chunk = 1;
+
+        this->staging_size = samples_per_chunk * this->sample_size + TENSOR_SHARD_HEADER_SIZE;
+        this->staging_size = (this->staging_size + TENSOR_SHARD_HEADER_SIZE - 1) / TENSOR_SHARD_HEADER_SIZE * TENSOR_SHARD_HEADER_SIZE;
+        this->staging = (unsigned char*) std::aligned_alloc(TENSOR_SHARD_HEADER_SIZE, this->staging_size);
+
+        if (this->staging == nullptr) {
+            std::cerr << "Could not allocate the staging buffer of the tensor shards." << std::endl;
+            exit(1);
+        }
+
+    }
+
+    TensorShardWriter::~TensorShardWriter() {
+
+        this->close();
+        std::free(this->staging);
+
+    }
+
+    void TensorShardWriter::write(int frame_id, const void* sample) {
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        // Move on to a new shard when the current one is full.
+        if (this->file_descriptor >= 0 && (int) this->frame_ids.size() >= this->samples_per_shard)
+            this->closeShard();
+
+        if (this->file_descriptor < 0)
+            this->openShard();
+
+        if (this->staging_used + this->sample_size > this->staging_size)
+            this->flush(false);
+
+        memcpy(this->staging + this->staging_used, sample, this->sample_size);
+        this->staging_used += this->sample_size;
+        this->frame_ids.push_back(frame_id);
+
+    }
+
+    size_t TensorShardWriter::getSampleSize() const {
+
+        return this->sample_size;
+
+    }
+
+    int TensorShardWriter::getNumOfShards() const {
+
+        return this->num_of_shards;
+
+    }
+
+    ShardState TensorShardWriter::getState() const {
+
+        ShardState state;
+        memset(&state, 0, sizeof(ShardState));
+        state.num_of_shards = this->num_of_shards;
+
+        // The open shard is not complete yet.
+        if (this->file_descriptor >= 0) {
+            state.num_of_shards--;
+            state.num_of_samples = (int32_t) this->frame_ids.size();
+            state.offset = this->staging_offset + this->staging_used;
+        }
+
+        return state;
+
+    }
+
+    bool TensorShardWriter::sync() {
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        if (this->file_descriptor < 0)
+            return !this->failed;
+
+        // Write the whole pages, and then the rest without taking it out of
+        // the staging buffer, so that direct writes stay on whole pages.
+        this->flush(false);
+
+        if (this->staging_used > 0) {
+
+            int flags = fcntl(this->file_descriptor, F_GETFL);
+#ifdef O_DIRECT
+            if (this->bypass_cache)
+                fcntl(this->file_descriptor, F_SETFL, flags & ~O_DIRECT);
+#endif
+
+            if (!writeAll(this->file_descriptor, this->staging, this->staging_used, this->staging_offset)) {
+                std::cerr << "Could not write to the shard " << this->shard_filename << std::endl;
+                this->failed = true;
+            }
+
+            fcntl(this->file_descriptor, F_SETFL, flags);
+
+        }
+
+        // Add the ids written since the last sync to the ones of the open
+        // shard.
+        std::string ids_filename = this->getShardName(this->num_of_shards - 1) + ".ids.tmp";
+        size_t num_of_new = this->frame_ids.size() - this->num_of_synced;
+        if (!writeFile(ids_filename, this->frame_ids.data() + this->num_of_synced, num_of_new * sizeof(uint32_t),
+                       (off_t) (this->num_of_synced * sizeof(uint32_t)), this->num_of_synced == 0)) {
+            std::cerr << "Could not write the ids " << ids_filename << std::endl;
+            this->failed = true;
+        }
+
+        if (fsync(this->file_descriptor) != 0) {
+            std::cerr << "Could not sync the shard " << this->shard_filename << std::endl;
+            this->failed = true;
+        }
+
+        if (!this->failed)
+            this->num_of_synced = this->frame_ids.size();
+
+        return !this->failed;
+
+    }
+
+    int TensorShardWriter::restore(const ShardState &state) {
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        if (state.num_of_shards != this->num_of_shards || state.num_of_samples < 0 || state.num_of_samples > this->samples_per_shard ||
+            state.offset != (state.num_of_samples > 0 ? TENSOR_SHARD_HEADER_SIZE + state.num_of_samples * this->sample_size : 0))
+            return -1;
+
+        // Every complete shard must hold as many samples as its ids say.
+        int num_of_samples = 0;
+        for (int i = 0; i < this->num_of_shards; i++) {
+
+            std::ifstream ids_file(this->getShardName(i) + ".ids", std::ios::in | std::ios::binary | std::ios::ate);
+            std::ifstream shard_file(this->getShardName(i) + ".npy", std::ios::in | std::ios::binary | std::ios::ate);
+            if (!ids_file.is_open() || !shard_file.is_open())
+                return -1;
+
+            size_t ids_size = (size_t) ids_file.tellg();
+            size_t num_of_ids = ids_size / sizeof(uint32_t);
+            if (num_of_ids == 0 || ids_size % sizeof(uint32_t) != 0 || num_of_ids > (size_t) this->samples_per_shard ||
+                (size_t) shard_file.tellg() != TENSOR_SHARD_HEADER_SIZE + num_of_ids * this->sample_size)
+                return -1;
+
+            num_of_samples += (int) num_of_ids;
+
+        }
+
+        if (state.num_of_samples == 0)
+            return num_of_samples;
+
+        // The open shard may have been finished after the checkpoint, then it
+        // is reopened from its final name.
+        std::string name = this->getShardName(this->num_of_shards);
+        if (access((name + ".npy.tmp").c_str(), F_OK) != 0) {
+            rename((name + ".npy").c_str(), (name + ".npy.tmp").c_str());
+            rename((name + ".ids").c_str(), (name + ".ids.tmp").c_str());
+        }
+
+        // Keep the samples of the checkpoint.
+        std::vector<uint32_t> frame_ids(state.num_of_samples);
+        std::ifstream ids_file(name + ".ids.tmp", std::ios::in | std::ios::binary);
+        ids_file.read((char*) frame_ids.data(), frame_ids.size() * sizeof(uint32_t));
+        if (!ids_file)
+            return -1;
+
+        // Give the shard its full size again.
+        int file_descriptor = open((name + ".npy.tmp").c_str(), O_RDWR);
+        if (file_descriptor < 0)
+            return -1;
+
+        if (lseek(file_descriptor, 0, SEEK_END) < (off_t) state.offset ||
+            ftruncate(file_descriptor, TENSOR_SHARD_HEADER_SIZE + (off_t) this->samples_per_shard * this->sample_size) != 0) {
+            ::close(file_descriptor);
+            return -1;
+        }
+
+        // Stage the end of the last page again, so that direct writes stay
+        // on whole pages.
+        this->staging_offset = state.offset / TENSOR_SHARD_HEADER_SIZE * TENSOR_SHARD_HEADER_SIZE;
+        this->staging_used = state.offset - this->staging_offset;
+        if (pread(file_descriptor, this->staging, this->staging_used, this->staging_offset) != (ssize_t) this->staging_used) {
+            ::close(file_descriptor);
+            return -1;
+        }
+
+#ifdef O_DIRECT
+        if (this->bypass_cache)
+            fcntl(file_descriptor, F_SETFL, fcntl(file_descriptor, F_GETFL) | O_DIRECT);
+#endif
+
+#ifdef F_NOCACHE
+        if (this->bypass_cache)
+            fcntl(file_descriptor, F_NOCACHE, 1);
+#endif
+
+        this->file_descriptor = file_descriptor;
+        this->shard_filename = name + ".npy";
+        this->frame_ids = frame_ids;
+        this->num_of_synced = frame_ids.size();
+        this->num_of_shards++;
+
+        return num_of_samples + state.num_of_samples;
+
+    }
+
+    bool TensorShardWriter::close() {
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        if (this->file_descriptor >= 0)
+            this->closeShard();
+
+        return !this->failed;
+
+    }
+
+    void TensorShardWriter::openShard() {
+
+        this->shard_filename = this->getShardName(this->num_of_shards) + ".npy";
+
+        // Create the shard with its full size, so the file does not grow on
+        // every write.
+        std::string tmp_filename = this->shard_filename + ".tmp";
+        int flags = O_WRONLY | O_CREAT | O_TRUNC;
+#ifdef O_DIRECT
+        if (this->bypass_cache)
+            flags |= O_DIRECT;
+#endif
+        this->file_descriptor = open(tmp_filename.c_str(), flags, 0644);
+        if (this->file_descriptor < 0 || ftruncate(this->file_descriptor, TENSOR_SHARD_HEADER_SIZE + (off_t) this->samples_per_shard * this->sample_size) != 0) {
+            std::cerr << "Could not create the shard " << tmp_filename << std::endl;
+            exit(1);
+        }
+
+#ifdef F_NOCACHE
+        // macOS has no O_DIRECT, but it can be told not to cache the file.
+        if (this->bypass_cache)
+            fcntl(this->file_descriptor, F_NOCACHE, 1);
+#endif
+
+        this->frame_ids.clear();
+        this->num_of_synced = 0;
+        this->staging_used = 0;
+        this->staging_offset = TENSOR_SHARD_HEADER_SIZE;
+        this->num_of_shards++;
+
+    }
+
+    std::string TensorShardWriter::getShardName(int shard) const {
+
+        char name[64];
+        snprintf(name, 64, "/%s_%06i", this->prefix.c_str(), shard);
+
+        return this->directory + name;
+
+    }
+
+    void TensorShardWriter::closeShard() {
+
+        this->flush(true);
+
+        // Build the .npy header now that the amount of samples is known.
+        static const char* descriptors[] = {"|u1", "<f2", "<f4"};
+
+        std::string shape = std::to_string(this->frame_ids.size()) + ", ";
+        for (int dimension : this->sample_shape)
+            shape += std::to_string(dimension) + ", ";
+
+        std::vector<char> header(TENSOR_SHARD_HEADER_SIZE, ' ');
+        int dict_length = snprintf(header.data() + 10, TENSOR_SHARD_HEADER_SIZE - 10,
+                                   "{'descr': '%s', 'fortran_order': False, 'shape': (%s), }",
+                                   descriptors[this->type], shape.c_str());
+        assert(dict_length > 0 && dict_length < TENSOR_SHARD_HEADER_SIZE - 11);
+        header[10 + dict_length] = ' ';
+        header[TENSOR_SHARD_HEADER_SIZE - 1] = '\n';
+
+        memcpy(header.data(), "\x93NUMPY\x01\x00", 8);
+        header[8] = (char) ((TENSOR_SHARD_HEADER_SIZE - 10) & 0xFF);
+        header[9] = (char) ((TENSOR_SHARD_HEADER_SIZE - 10) >> 8);
+
+        if (pwrite(this->file_descriptor, header.data(), TENSOR_SHARD_HEADER_SIZE, 0) != TENSOR_SHARD_HEADER_SIZE)
+            this->failed = true;
+
+        // Drop the room left for the samples that never came.
+        if (ftruncate(this->file_descriptor, TENSOR_SHARD_HEADER_SIZE + (off_t) this->frame_ids.size() * this->sample_size) != 0)
+            this->failed = true;
+
+        if (fsync(this->file_descriptor) != 0) {
+            std::cerr << "Could not sync the shard " << this->shard_filename << std::endl;
+            this->failed = true;
+        }
+
+        ::close(this->file_descriptor);
+        this->file_descriptor = -1;
+
+        // Write the ids of its samples next to it, before the shard gets its
+        // final name.
+        std::string ids_filename = this->shard_filename.substr(0, this->shard_filename.size() - 4) + ".ids";
+        if (!writeFile(ids_filename, this->frame_ids.data(), this->frame_ids.size() * sizeof(uint32_t), 0, true)) {
+            std::cerr << "Could not write the ids " << ids_filename << std::endl;
+            this->failed = true;
+        }
+
+        // Move the shard to its final name, and drop the ids kept while it
+        // was open.
+        std::string tmp_filename = this->shard_filename + ".tmp";
+        if (rename(tmp_filename.c_str(), this->shard_filename.c_str()) != 0) {
+            std::cerr << "Could not finalise the shard " << this->shard_filename << std::endl;
+            this->failed = true;
+        }
+
+        unlink((ids_filename + ".tmp").c_str());
+
+    }
+
+    void TensorShardWriter::flush(bool last) {
+
+        size_t length = this->staging_used;
+
+#ifdef O_DIRECT
+        // Direct writes must cover whole pages. The end of the shard and the
+        // header are written through the cache instead.
+        if (this->bypass_cache) {
+            if (last)
+                fcntl(this->file_descriptor, F_SETFL, fcntl(this->file_descriptor, F_GETFL) & ~O_DIRECT);
+            else
+                length = length / TENSOR_SHARD_HEADER_SIZE * TENSOR_SHARD_HEADER_SIZE;
+        }
+#endif
+
+        // Write the chunk at its place, even if it takes several calls.
+        size_t written = 0;
+        while (written < length) {
+
+            ssize_t result = pwrite(this->file_descriptor, this->staging + written, length - written,
+                                    this->staging_offset + written);
+            if (result < 0) {
+                std::cerr << "Could not write to the shard " << this->shard_filename << std::endl;
+                this->failed = true;
+                break;
+            }
+
+            written += result;
+
+        }
+
+        // Keep what was left for the next flush.
+        memmove(this->staging, this->staging + length, this->staging_used - length);
+        this->staging_offset += length;
+        this->staging_used -= length;
+
+    }
+
+}  // namespace bgq_opengl
@@ -0,0 +1,221 @@
+/**
+ * @file tensor_shard_writer.h
+ * @brief Tensor shard writer class header file.
+ * @version 1.0.0 (2024-03-13)
+ * @date 2024-03-13
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_CLASSES_TENSOR_SHARD_WRITER_H_
+#define BGQ_OPENGL_CLASSES_TENSOR_SHARD_WRITER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "structs/shard_state/shard_state.h"
+
+#define TENSOR_SHARD_HEADER_SIZE 4096
+#define TENSOR_SHARD_STAGING_SIZE (8 << 20)
+
+namespace bgq_opengl {
+
+    /// The types of the elements of a tensor.
+    enum TensorType {
+        TENSOR_UINT8 = 0,                   /// Unsigned bytes.
+        TENSOR_FLOAT16 = 1,                 /// Half precision floats.
+        TENSOR_FLOAT32 = 2,                 /// Single precision floats.
+    };
+
+    /**
+     * @brief Implementation of a TensorShardWriter class.
+     *
+     * Implementation of a writer that appends fixed-size samples into shards
+     * that are .npy files of shape (samples, ...). The header is padded to a
+     * whole page, so the samples start at an aligned offset, and the samples
+     * are gathered in an aligned staging buffer and written in large chunks.
+     * Every shard is created with its final size and the last one is shrunk
+     * to the samples it holds. The ids of the samples of each shard are
+     * written to a .ids file of little endian uint32 next to it. Samples can be
+     * written from several threads.
+     *
+     * @author Borja García Quiroga <garcaqub@tcd.ie>
+     */
+    class TensorShardWriter {
+
+    public:
+
+        /**
+         * @brief Creates a new writer.
+         *
+         * Creates a new writer on a directory.
+         *
+         * @param directory The directory of the shards.
+         * @param prefix The prefix of the name of the shards.
+         * @param samples_per_shard The amount of samples in each shard.
+         * @param sample_shape The shape of each of the samples.
+         * @param type The type of the elements.
+         * @param first_shard The number of the first shard to write.
+         * @param bypass_cache Whether to write around the page cache.
+         */
+        TensorShardWriter(const char* directory, const char* prefix, int samples_per_shard,
+                          const std::vector<int> &sample_shape, TensorType type, int first_shard = 0,
+                          bool bypass_cache = false);
+
+        /**
+         * @brief Destroys the writer.
+         *
+         * Closes the current shard and frees the staging buffer.
+         */
+        ~TensorShardWriter();
+
+        TensorShardWriter(const TensorShardWriter&) = delete;
+        TensorShardWriter& operator=(const TensorShardWriter&) = delete;
+
+        /**
+         * @brief Write a sample.
+         *
+         * Append a sample to the current shard, starting a new one if needed.
+         *
+         * @param frame_id The id of the sample.
+         * @param sample The getSampleSize() bytes of the sample.
+         */
+        void write(int frame_id, const void* sample);
+
+        /**
+         * @brief Get the size of a sample.
+         *
+         * Get the size of each of the samples.
+         *
+         * @returns The size in bytes.
+         */
+        size_t getSampleSize() const;
+
+        /**
+         * @brief Get the amount of shards.
+         *
+         * Get the amount of shards started so far, including the ones of
+         * previous runs.
+         *
+         * @returns The amount of shards.
+         */
+        int getNumOfShards() const;
+
+        /**
+         * @brief Get the state of the writer.
+         *
+         * Get the amount of complete shards and the progress of the open one.
+         * Only what was written before the last call to sync() or close() is
+         * on the disk.
+         *
+         * @returns The state of the writer.
+         */
+        ShardState getState() const;
+
+        /**
+         * @brief Make the samples durable.
+         *
+         * Write the samples so far to the disk without finishing the current
+         * shard. Its ids are kept in a temporary file next to it, so that the
+         * shard can be reopened from a checkpoint.
+         *
+         * @returns True if every shard was written.
+         */
+        bool sync();
+
+        /**
+         * @brief Go on from a checkpoint.
+         *
+         * Check the complete shards of a checkpoint and reopen the one it
+         * left open, dropping anything written to it afterwards. The writer
+         * must have been created with the complete shards as its first shard.
+         *
+         * @param state The state of the writer at the checkpoint.
+         *
+         * @returns The amount of samples in the shards of the checkpoint, or
+         * -1 if they are missing or do not match it.
+         */
+        int restore(const ShardState &state);
+
+        /**
+         * @brief Close the writer.
+         *
+         * Finish the current shard. Writing more samples afterwards starts a
+         * new shard.
+         *
+         * @returns True if every shard was written.
+         */
+        bool close();
+
+    private:
+
+        /**
+         * @brief Start a new shard.
+         *
+         * Create the temporary file of the next shard with its full size.
+         */
+        void openShard();
+
+        /**
+         * @brief Get the name of a shard.
+         *
+         * Get the final name of a shard, without the extension.
+         *
+         * @param shard The number of the shard.
+         *
+         * @returns The name of the shard.
+         */
+        std::string getShardName(int shard) const;
+
+        /**
+         * @brief Finish the current shard.
+         *
+         * Write the header, shrink the file to the samples it holds, move it
+         * to its final name and write its ids.
+         */
+        void closeShard();
+
+        /**
+         * @brief Flush the staging buffer.
+         *
+         * Write the staging buffer at its position in the current shard. When
+         * bypassing the cache, only whole pages are written unless it is the
+         * last flush of the shard, and the rest is kept for the next one.
+         *
+         * @param last Whether it is the last flush of the shard.
+         */
+        void flush(bool last);
+
+        std::string directory;              /// The directory of the shards.
+        std::string prefix;                 /// The prefix of the name of the shards.
+        int samples_per_shard;              /// The amount of samples in each shard.
+        std::vector<int> sample_shape;      /// The shape of each of the samples.
+        TensorType type;                    /// The type of the elements.
+        size_t sample_size = 0;             /// The size of a sample in bytes.
+        int num_of_shards = 0;              /// The amount of shards started.
+        int file_descriptor = -1;           /// The current shard.
+        std::string shard_filename;         /// The final name of the current shard.
+        std::vector<uint32_t> frame_ids;    /// The ids of the samples of the current shard.
+        size_t num_of_synced = 0;           /// The amount of ids already on the disk.
+        unsigned char* staging = nullptr;   /// The aligned staging buffer.
+        size_t staging_size = 0;            /// The size of the staging buffer.
+        bool bypass_cache = false;          /// Whether to write around the page cache.
+        size_t staging_used = 0;            /// The amount of bytes used in the staging buffer.
+        size_t staging_offset = 0;          /// The position of the staging buffer in the shard.
+        bool failed = false;                /// Whether a write has failed.
+        std::mutex mutex;                   /// Serialises the writes.
+
+    };
+
+}  // namespace bgq_opengl
+
+#endif  //!BGQ_OPENGL_CLASSES_TENSOR_SHARD_WRITER_H_
@@ -0,0 +1,335 @@
+/**
+ * @file variation_sampler.cpp
+ * @brief Variation sampler class implementation file.
+ * @version 1.0.0 (2024-03-02)
+ * @date 2024-03-02
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#include "variation_sampler.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "classes/camera/camera.h"
+#include "classes/light/light.h"
+#include "structs/variation_indices/variation_indices.h"
+
+// The selections of each frame use their own streams, separated from the
+// streams used for the entries of the tables.
+#define SELECTION_STREAM 0x100
+
+namespace bgq_opengl {
+
+    VariationSampler::VariationSampler(uint64_t seed) {
+
+        this->seed = seed;
+
+    }
+
+    uint64_t VariationSampler::getSeed() const {
+
+        return this->seed;
+
+    }
+
+    std::vector<glm::vec3> VariationSampler::getJointAngles(int index) const {
+
+        // The first entry is always the rest pose.
+        if (index == 0)
+            return std::vector<glm::vec3>(NUM_OF_JOINTS, glm::vec3(1.0f));
+
+        // Shorten the calls a bit.
+        const uint64_t s = VAR_JOINT_ANGLES;
+        int d = 0;
+
+        // Create the variation.
+        std::vector<glm::vec3> angles(NUM_OF_JOINTS, glm::vec3(0.0f));
+
+        // Generate the rotation for the appropriate angles.
+        // The ranges are the wrist pronation, flexion and abduction, the thumb
+        // abduction and flexion and then the flexion and abduction of each finger.
+        float wrist_pronation = uniformFloat(s, index, d++, -60.0f, 60.0f);
+        float wrist_flexion = uniformFloat(s, index, d++, -90.0f, 90.0f);
+        float wrist_abduction = uniformFloat(s, index, d++, -30.0f, 30.0f);
+        angles[0] = glm::vec3(wrist_pronation, wrist_flexion, wrist_abduction);
+
+        float thumb_abduction = uniformFloat(s, index, d++, -30.0f, 30.0f);
+        float thumb_flexion = uniformFloat(s, index, d++, -80.0f, 10.0f);
+        angles[1] = glm::vec3(0.0f, thumb_abduction, thumb_flexion / 2.0f);
+        angles[2] = glm::vec3(0.0f, 0.0f, uniformFloat(s, index, d++, -80.0f, 10.0f));
+        angles[3] = glm::vec3(0.0f, 0.0f, uniformFloat(s, index, d++, -80.0f, 10.0f));
+
+        // The four fingers share the same structure.
+        for (int finger = 0; finger < 4; finger++) {
+
+            int base = 4 + finger * 3;
+
+            float flexion = uniformFloat(s, index, d++, -5.0f, 90.0f);
+            float abduction = uniformFloat(s, index, d++, -10.0f, 10.0f);
+            angles[base] = glm::vec3(0.0f, flexion, abduction);
+            angles[base + 1] = glm::vec3(0.0f, uniformFloat(s, index, d++, -5.0f, 90.0f), 0.0f);
+            angles[base + 2] = glm::vec3(0.0f, uniformFloat(s, index, d++, -5.0f, 90.0f), 0.0f);
+
+        }
+
+        return angles;
+
+    }
+
+    glm::vec3 VariationSampler::getArmPosition(int index) const {
+
+        // The first entry is always the origin.
+        if (index == 0)
+            return glm::vec3(0.0f);
+
+        const uint64_t s = VAR_ARM_POSITIONS;
+
+        return glm::vec3(uniformFloat(s, index, 0, -0.3f, 0.3f),
+                         uniformFloat(s, index, 1, -0.3f, 0.5f),
+                         uniformFloat(s, index, 2, -0.4f, 0.4f));
+
+    }
+
+    glm::vec3 VariationSampler::getArmRotation(int index) const {
+
+        // The first entry is always the default orientation.
+        if (index == 0)
+            return glm::vec3(1.0f, 0.0f, 0.0f);
+
+        const uint64_t s = VAR_ARM_ROTATIONS;
+
+        return glm::vec3(uniformFloat(s, index, 0, -90.0f, 90.0f),
+                         uniformFloat(s, index, 1, -90.0f, 90.0f),
+                         uniformFloat(s, index, 2, -90.0f, 90.0f));
+
+    }
+
+    float VariationSampler::getSkinTone(int index) const {
+
+        // The first entry is always the original tone.
+        if (index == 0)
+            return 1.0f;
+
+        return uniformFloat(VAR_SKIN_TONES, index, 0, 0.05f, 2.0f);
+
+    }
+
+    Light VariationSampler::getLight(int index) const {
+
+        // The first entry is always the default light.
+        if (index == 0)
+            return Light(glm::vec3(5.0, 5.0, 5.0), glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), 20.0f);
+
+        const uint64_t s = VAR_LIGHTING;
+
+        glm::vec3 light_pos(uniformFloat(s, index, 0, -5.0f, 5.0f),
+                            uniformFloat(s, index, 1, -5.0f, 5.0f),
+                            uniformFloat(s, index, 2, -5.0f, 5.0f));
+        float light_power = uniformFloat(s, index, 3, 5.0f, 40.0f);
+
+        return Light(light_pos, glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), light_power);
+
+    }
+
+    float VariationSampler::getShininess(int index) const {
+
+        // The first entry is always the default value.
+        if (index == 0)
+            return 1.0f;
+
+        return uniformFloat(VAR_SHININESS, index, 0, 1.0f, 50.0f);
+
+    }
+
+    int VariationSampler::getBackground(int index, int num_images) const {
+
+        // Backgrounds do not have a default, every entry is random.
+        return uniformInt(VAR_BACKGROUNDS, index, 0, num_images);
+
+    }
+
+    uint32_t VariationSampler::getProceduralBackground(int index) const {
+
+        // Use another draw than the images, so both tables are independent.
+        return (uint32_t) (random(VAR_BACKGROUNDS, index, 1) >> 32);
+
+    }
+
+    BackgroundCrop VariationSampler::getMosaicCrop(int index, int num_images) const {
+
+        const uint64_t s = VAR_BACKGROUNDS;
+
+        // Use other draws than the images and the procedural backgrounds.
+        BackgroundCrop crop;
+        crop.image = uniformInt(s, index, 2, num_images);
+        crop.scale = uniformFloat(s, index, 3, 1.0f, 3.0f);
+        crop.offset_x = uniformFloat(s, index, 4, 0.0f, 1.0f);
+        crop.offset_y = uniformFloat(s, index, 5, 0.0f, 1.0f);
+        crop.flip = uniformInt(s, index, 6, 2) == 1;
+        crop.rotation = uniformFloat(s, index, 7, -180.0f, 180.0f);
+
+        return crop;
+
+    }
+
+    Camera VariationSampler::getCamera(int index, int width, int height) const {
+
+        // The first view is always the default camera.
+        if (index == 0)
+            return Camera(glm::vec3(0.0f, 0.3f, 1.5f), glm::vec3(0.0f, 0.0f, -1.0f), 45.0f, 0.1f, 100.0f, width, height);
+
+        const uint64_t s = VAR_CAMERAS;
+
+        // Place the camera around the hand, never straight above or below
+        // it so that the up vector stays valid.
+        float yaw = glm::radians(uniformFloat(s, index, 0, -75.0f, 75.0f));
+        float pitch = glm::radians(uniformFloat(s, index, 1, -30.0f, 50.0f));
+        float distance = uniformFloat(s, index, 2, 1.2f, 2.0f);
+        float fov = uniformFloat(s, index, 3, 35.0f, 60.0f);
+
+        glm::vec3 position = distance * glm::vec3(std::sin(yaw) * std::cos(pitch), std::sin(pitch), std::cos(yaw) * std::cos(pitch));
+
+        // Look roughly at the centre of the scene.
+        glm::vec3 target(uniformFloat(s, index, 4, -0.1f, 0.1f),
+                         uniformFloat(s, index, 5, -0.1f, 0.1f),
+                         uniformFloat(s, index, 6, -0.1f, 0.1f));
+
+        return Camera(position, glm::normalize(target - position), fov, 0.1f, 100.0f, width, height);
+
+    }
+
+    BackgroundCrop VariationSampler::getBackgroundCrop(uint64_t sample_id, int num_of_backgrounds, int num_images) const {
+
+        const uint64_t s = VAR_COMPOSITES;
+
+        BackgroundCrop crop;
+
+        // Select an entry of the backgrounds table, and then crop its image.
+        int entry = uniformInt(SELECTION_STREAM | VAR_COMPOSITES, sample_id, 0, num_of_backgrounds);
+        crop.image = getBackground(entry, num_images);
+        crop.scale = uniformFloat(s, sample_id, 0, 1.0f, 2.0f);
+        crop.offset_x = uniformFloat(s, sample_id, 1, 0.0f, 1.0f);
+        crop.offset_y = uniformFloat(s, sample_id, 2, 0.0f, 1.0f);
+        crop.flip = uniformInt(s, sample_id, 3, 2) == 1;
+
+        return crop;
+
+    }
+
+    Augmentation VariationSampler::getAugmentation(uint64_t sample_id) const {
+
+        const uint64_t s = VAR_AUGMENTATIONS;
+
+        Augmentation augmentation;
+        augmentation.scale = uniformFloat(s, sample_id, 0, 0.8f, 1.25f);
+        augmentation.rotation = uniformFloat(s, sample_id, 1, -30.0f, 30.0f);
+        augmentation.offset_x = uniformFloat(s, sample_id, 2, -0.1f, 0.1f);
+        augmentation.offset_y = uniformFloat(s, sample_id, 3, -0.1f, 0.1f);
+        augmentation.brightness = uniformFloat(s, sample_id, 4, 0.7f, 1.3f);
+        augmentation.contrast = uniformFloat(s, sample_id, 5, 0.7f, 1.3f);
+        augmentation.saturation = uniformFloat(s, sample_id, 6, 0.6f, 1.4f);
+
+        // Only some of the samples are blurred or made noisy.
+        if (uniformFloat(s, sample_id, 7, 0.0f, 1.0f) < 0.3f)
+            augmentation.blur = uniformFloat(s, sample_id, 8, 0.5f, 1.5f);
+
+        if (uniformFloat(s, sample_id, 9, 0.0f, 1.0f) < 0.5f)
+            augmentation.noise = uniformFloat(s, sample_id, 10, 1.0f, 8.0f);
+
+        augmentation.noise_offset = (uint32_t) (random(s, sample_id, 11) >> 32);
+
+        return augmentation;
+
+    }
+
+    SensorEffects VariationSampler::getSensorEffects(uint64_t id) const {
+
+        const uint64_t s = VAR_SENSOR;
+
+        SensorEffects effects;
+        effects.distortion = uniformFloat(s, id, 0, -0.08f, 0.08f);
+        effects.aberration = uniformFloat(s, id, 1, 0.0f, 0.004f);
+        effects.vignetting = uniformFloat(s, id, 2, 0.0f, 0.35f);
+        effects.blur = uniformFloat(s, id, 3, 0.0f, 1.0f);
+        effects.noise = uniformFloat(s, id, 4, 0.0f, 0.03f);
+        effects.seed = (uint32_t) (random(s, id, 5) >> 32);
+
+        return effects;
+
+    }
+
+    VariationIndices VariationSampler::selectVariations(uint64_t frame_id, const VariationIndices &num_of_variations, int appearance_variants) const {
+
+        VariationIndices selected;
+
+        // The pose is selected for the first frame of its run.
+        uint64_t pose_id = (appearance_variants > 1) ? frame_id / appearance_variants * appearance_variants : frame_id;
+
+        // Select an entry of each table.
+        selected.joint_angles = uniformInt(SELECTION_STREAM | VAR_JOINT_ANGLES, pose_id, 0, num_of_variations.joint_angles);
+        selected.arm_position = uniformInt(SELECTION_STREAM | VAR_ARM_POSITIONS, pose_id, 0, num_of_variations.arm_position);
+        selected.arm_rotation = uniformInt(SELECTION_STREAM | VAR_ARM_ROTATIONS, pose_id, 0, num_of_variations.arm_rotation);
+        selected.skin_tone = uniformInt(SELECTION_STREAM | VAR_SKIN_TONES, frame_id, 0, num_of_variations.skin_tone);
+        selected.lighting = uniformInt(SELECTION_STREAM | VAR_LIGHTING, frame_id, 0, num_of_variations.lighting);
+        selected.shininess = uniformInt(SELECTION_STREAM | VAR_SHININESS, frame_id, 0, num_of_variations.shininess);
+        selected.background = uniformInt(SELECTION_STREAM | VAR_BACKGROUNDS, frame_id, 0, num_of_variations.background);
+
+        return selected;
+
+    }
+
+    uint64_t VariationSampler::mix(uint64_t value) {
+
+        // SplitMix64 finaliser.
+        value += 0x9E3779B97F4A7C15ULL;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+
+        return value ^ (value >> 31);
+
+    }
+
+    uint64_t VariationSampler::random(uint64_t stream, uint64_t index, uint64_t draw) const {
+
+        // Fold each component of the counter into the key, so that every
+        // (seed, stream, index, draw) tuple maps to independent bits.
+        uint64_t key = mix(this->seed ^ (stream * 0xD1B54A32D192ED03ULL));
+        key = mix(key ^ index);
+
+        return mix(key ^ draw);
+
+    }
+
+    float VariationSampler::uniformFloat(uint64_t stream, uint64_t index, uint64_t draw, float min, float max) const {
+
+        // Keep the 24 top bits, which is all the precision a float can hold.
+        float unit = (float) (random(stream, index, draw) >> 40) * (1.0f / 16777216.0f);
+
+        return min + (max - min) * unit;
+
+    }
+
+    int VariationSampler::uniformInt(uint64_t stream, uint64_t index, uint64_t draw, int count) const {
+
+        if (count <= 1)
+            return 0;
+
+        // Scale the top 32 bits to the range without a modulo.
+        uint64_t bits = random(stream, index, draw) >> 32;
+
+        return (int) ((bits * (uint64_t) count) >> 32);
+
+    }
+
+}  // namespace bgq_opengl
@@ -0,0 +1,319 @@
+/**
+ * @file variation_sampler.h
+ * @brief Variation sampler class header file.
+ * @version 1.0.0 (2024-03-02)
+ * @date 2024-03-02
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_CLASSES_VARIATION_SAMPLER_H_
+#define BGQ_OPENGL_CLASSES_VARIATION_SAMPLER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "classes/camera/camera.h"
+#include "classes/light/light.h"
+#include "structs/augmentation/augmentation.h"
+#include "structs/background_crop/background_crop.h"
+#include "structs/sensor_effects/sensor_effects.h"
+#include "structs/variation_indices/variation_indices.h"
+
+#define NUM_OF_JOINTS 16
+
+namespace bgq_opengl {
+
+    /**
+     * @brief The variation tables that can be sampled.
+     *
+     * Each table has its own random stream, so that adding draws to one of
+     * them never changes the values of the others.
+     */
+    enum VariationType {
+        VAR_JOINT_ANGLES = 0,
+        VAR_ARM_POSITIONS = 1,
+        VAR_ARM_ROTATIONS = 2,
+        VAR_SKIN_TONES = 3,
+        VAR_LIGHTING = 4,
+        VAR_SHININESS = 5,
+        VAR_BACKGROUNDS = 6,
+        VAR_CAMERAS = 7,
+        VAR_COMPOSITES = 8,
+        VAR_AUGMENTATIONS = 9,
+        VAR_SENSOR = 10
+    };
+
+    /**
+     * @brief Implementation of a VariationSampler class.
+     *
+     * Implementation of a counter-based sampler that derives every entry of
+     * the variation tables, and every per-frame selection, from the dataset
+     * seed on demand. Nothing is precomputed and no state changes after
+     * construction, so any entry or frame can be regenerated independently
+     * from any thread or process.
+     *
+     * @author Borja García Quiroga <garcaqub@tcd.ie>
+     */
+    class VariationSampler {
+
+    public:
+
+        /**
+         * @brief Constructs a VariationSampler.
+         *
+         * Constructs a VariationSampler from the dataset seed.
+         *
+         * @param seed The seed that identifies the whole dataset.
+         */
+        VariationSampler(uint64_t seed);
+
+        /**
+         * @brief Get the seed of the sampler.
+         *
+         * Get the seed of the sampler.
+         *
+         * @returns The seed.
+         */
+        uint64_t getSeed() const;
+
+        /**
+         * @brief Get an entry of the joint angles table.
+         *
+         * Get the rotation of each of the joints for a given entry. Entry 0
+         * is the rest pose.
+         *
+         * @param index The index of the entry.
+         *
+         * @returns A vector containing NUM_OF_JOINTS euler angles in degrees.
+         */
+        std::vector<glm::vec3> getJointAngles(int index) const;
+
+        /**
+         * @brief Get an entry of the arm positions table.
+         *
+         * Get an entry of the arm positions table. Entry 0 is the origin.
+         *
+         * @param index The index of the entry.
+         *
+         * @returns The translation of the arm.
+         */
+        glm::vec3 getArmPosition(int index) const;
+
+        /**
+         * @brief Get an entry of the arm rotations table.
+         *
+         * Get an entry of the arm rotations table. Entry 0 is the default
+         * orientation.
+         *
+         * @param index The index of the entry.
+         *
+         * @returns The euler angles of the arm in degrees.
+         */
+        glm::vec3 getArmRotation(int index) const;
+
+        /**
+         * @brief Get an entry of the skin tones table.
+         *
+         * Get an entry of the skin tones table. Entry 0 is the original tone.
+         *
+         * @param index The index of the entry.
+         *
+         * @returns The skin tone multiplier.
+         */
+        float getSkinTone(int index) const;
+
+        /**
+         * @brief Get an entry of the lighting table.
+         *
+         * Get an entry of the lighting table. Entry 0 is the default light.
+         *
+         * @param index The index of the entry.
+         *
+         * @returns The light.
+         */
+        Light getLight(int index) const;
+
+        /**
+         * @brief Get an entry of the shininess table.
+         *
+         * Get an entry of the shininess table. Entry 0 is the default value.
+         *
+         * @param index The index of the entry.
+         *
+         * @returns The shininess.
+         */
+        float getShininess(int index) const;
+
+        /**
+         * @brief Get an entry of the backgrounds table.
+         *
+         * Get the id of the background image for a given entry.
+         *
+         * @param index The index of the entry.
+         * @param num_images The amount of background images available.
+         *
+         * @returns The id of the background image.
+         */
+        int getBackground(int index, int num_images) const;
+
+        /**
+         * @brief Get an entry of the procedural backgrounds table.
+         *
+         * Get the seed the procedural background shader draws a given entry
+         * with.
+         *
+         * @param index The index of the entry.
+         *
+         * @returns The seed of the background.
+         */
+        uint32_t getProceduralBackground(int index) const;
+
+        /**
+         * @brief Get an entry of the mosaic backgrounds table.
+         *
+         * Get the image of the background mosaic a given entry is cropped
+         * from, and the crop, scale, rotation and flip of it.
+         *
+         * @param index The index of the entry.
+         * @param num_images The amount of images in the mosaic.
+         *
+         * @returns The crop.
+         */
+        BackgroundCrop getMosaicCrop(int index, int num_images) const;
+
+        /**
+         * @brief Get a camera configuration.
+         * Get the camera of a given view. Every sample is rendered from each
+         * of the views. View 0 is the default camera.
+         * @param index The index of the view.
+         * @param width The width of the images.
+         * @param height The height of the images.
+         * @returns The camera.
+         */
+        Camera getCamera(int index, int width, int height) const;
+
+        /**
+         * @brief Get the background crop of a composited sample.
+         *
+         * Get the background a sample is composited over on the CPU, and the
+         * crop, scale and flip of it that is used.
+         *
+         * @param sample_id The id of the sample.
+         * @param num_of_backgrounds The size of the backgrounds table.
+         * @param num_images The amount of background images available.
+         *
+         * @returns The crop.
+         */
+        BackgroundCrop getBackgroundCrop(uint64_t sample_id, int num_of_backgrounds, int num_images) const;
+
+        /**
+         * @brief Get the augmentation of a sample.
+         *
+         * Get how the image of an augmented sample is moved, recoloured,
+         * blurred and made noisy after it has been read back.
+         *
+         * @param sample_id The id of the sample.
+         *
+         * @returns The augmentation.
+         */
+        Augmentation getAugmentation(uint64_t sample_id) const;
+
+        /**
+         * @brief Get the sensor effects of a view.
+         *
+         * Get the strength of the lens and sensor effects that are applied
+         * to the render of a view of a frame on the GPU.
+         *
+         * @param id The id of the view of the frame.
+         *
+         * @returns The sensor effects.
+         */
+        SensorEffects getSensorEffects(uint64_t id) const;
+
+        /**
+         * @brief Select the variations for a frame.
+         *
+         * Select one entry of each table for a given frame. The frames are
+         * grouped in runs of appearance_variants frames that share the pose,
+         * that is, the joint angles and the arm position and rotation, and
+         * only differ in their appearance.
+         *
+         * @param frame_id The id of the frame.
+         * @param num_of_variations The size of each of the tables.
+         * @param appearance_variants The amount of consecutive frames that share a pose.
+         *
+         * @returns The selected index of each table.
+         */
+        VariationIndices selectVariations(uint64_t frame_id, const VariationIndices &num_of_variations, int appearance_variants = 1) const;
+
+    private:
+
+        /**
+         * @brief Mix a 64 bit value.
+         *
+         * Apply the SplitMix64 finaliser to a value.
+         *
+         * @param value The value to mix.
+         *
+         * @returns The mixed value.
+         */
+        static uint64_t mix(uint64_t value);
+
+        /**
+         * @brief Get the random bits for a counter.
+         *
+         * Get 64 random bits for a given stream, index and draw.
+         *
+         * @param stream The random stream.
+         * @param index The index of the entry or frame.
+         * @param draw The number of the draw within the entry.
+         *
+         * @returns The random bits.
+         */
+        uint64_t random(uint64_t stream, uint64_t index, uint64_t draw) const;
+
+        /**
+         * @brief Get a uniformly distributed float.
+         *
+         * Get a uniformly distributed float in [min, max).
+         *
+         * @param stream The random stream.
+         * @param index The index of the entry or frame.
+         * @param draw The number of the draw within the entry.
+         * @param min The lower bound.
+         * @param max The upper bound.
+         *
+         * @returns The random float.
+         */
+        float uniformFloat(uint64_t stream, uint64_t index, uint64_t draw, float min, float max) const;
+
+        /**
+         * @brief Get a uniformly distributed integer.
+         *
+         * Get a uniformly distributed integer in [0, count).
+         *
+         * @param stream The random stream.
+         * @param index The index of the entry or frame.
+         * @param draw The number of the draw within the entry.
+         * @param count The amount of possible values.
+         *
+         * @returns The random integer.
+         */
+        int uniformInt(uint64_t stream, uint64_t index, uint64_t draw, int count) const;
+
+        uint64_t seed;      /// The seed of the dataset.
+
+    };
+
+}  // namespace bgq_opengl
+
+#endif  //!BGQ_OPENGL_CLASSES_VARIATION_SAMPLER_H_
@@ -0,0 +1,417 @@
+/**
+ * @file variation_table.cpp
+ * @brief Variation table class implementation file.
+ * @version 1.0.0 (2024-03-05)
+ * @date 2024-03-05
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#include "variation_table.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/packing.hpp"
+
+#include "classes/camera/camera.h"
+#include "classes/light/light.h"
+#include "classes/variation_sampler/variation_sampler.h"
+#include "structs/augmentation/augmentation.h"
+#include "structs/background_crop/background_crop.h"
+#include "structs/sensor_effects/sensor_effects.h"
+#include "structs/variation_indices/variation_indices.h"
+
+#define TABLE_MAGIC "HVVT"
+#define TABLE_VERSION 2
+#define TABLE_HEADER_SIZE 256
+
+namespace bgq_opengl {
+
+    /// The amount of uint16 in a row of each block.
+    static const int ROW_SIZES[NUM_OF_TABLE_BLOCKS] = {
+        NUM_OF_JOINTS * 3,  // The euler angles of each joint.
+        3,                  // The translation.
+        3,                  // The euler angles.
+        1,                  // The skin tone.
+        3,                  // The position of the light.
+        1,                  // The power of the light.
+        1,                  // The shininess.
+        1,                  // The id of the image.
+        2,                  // The seed.
+        6,                  // The image, scale, offset x and y, flip and rotation.
+        7,                  // The position, direction and vertical field of view in degrees.
+        5,                  // The image, scale, offset x and y and flip.
+        11,                 // Scale, rotation, offset x and y, brightness, contrast, saturation, blur, noise and the noise offset.
+        7                   // Distortion, aberration, vignetting, blur, noise and the seed.
+    };
+
+    /// The header at the start of the file.
+    struct TableHeader {
+        char magic[4];          /// Always TABLE_MAGIC.
+        uint32_t version;       /// The version of the format.
+        uint64_t seed;          /// The seed the tables were derived from.
+        int32_t rows[NUM_OF_TABLE_BLOCKS];    /// The amount of rows of each block.
+        int32_t row_sizes[NUM_OF_TABLE_BLOCKS];   /// The amount of uint16 in each row of each block.
+        uint32_t byte_size;     /// The size of the memory block that follows.
+        int32_t width;          /// The width of the renders.
+        int32_t height;         /// The height of the renders.
+    };
+
+    static_assert(sizeof(TableHeader) <= TABLE_HEADER_SIZE, "The table header does not fit.");
+
+    namespace {
+
+        /// Store a seed as two uint16, low half first.
+        void packSeed(uint32_t seed, uint16_t* output) {
+
+            output[0] = (uint16_t) (seed & 0xFFFF);
+            output[1] = (uint16_t) (seed >> 16);
+
+        }
+
+        /// Store a background crop.
+        void packCrop(const BackgroundCrop &crop, uint16_t* output) {
+
+            output[0] = (uint16_t) crop.image;
+            output[1] = glm::packHalf1x16(crop.scale);
+            output[2] = glm::packHalf1x16(crop.offset_x);
+            output[3] = glm::packHalf1x16(crop.offset_y);
+            output[4] = crop.flip ? 1 : 0;
+
+        }
+
+    }  // namespace
+
+    VariationTable::VariationTable(const VariationSampler &sampler, const VariationIndices &num_of_variations, int num_images, const VariationTableRun &run) {
+
+        // Store the parameters.
+        this->seed = sampler.getSeed();
+        this->run = run;
+
+        // Get the amount of rows of each block, leaving out what the run
+        // does not draw.
+        int composites_per_render = (run.num_of_composites > 0) ? run.num_of_composites : 1;
+
+        this->rows.assign(NUM_OF_TABLE_BLOCKS, 0);
+        this->rows[TABLE_JOINT_ANGLES] = num_of_variations.joint_angles;
+        this->rows[TABLE_ARM_POSITIONS] = num_of_variations.arm_position;
+        this->rows[TABLE_ARM_ROTATIONS] = num_of_variations.arm_rotation;
+        this->rows[TABLE_SKIN_TONES] = num_of_variations.skin_tone;
+        this->rows[TABLE_LIGHT_POSITIONS] = num_of_variations.lighting;
+        this->rows[TABLE_LIGHT_POWERS] = num_of_variations.lighting;
+        this->rows[TABLE_SHININESS] = num_of_variations.shininess;
+        this->rows[TABLE_BACKGROUNDS] = num_of_variations.background;
+        this->rows[TABLE_PROCEDURAL_SEEDS] = run.procedural_backgrounds ? num_of_variations.background : 0;
+        this->rows[TABLE_MOSAIC_CROPS] = (run.mosaic_images > 0) ? num_of_variations.background : 0;
+        this->rows[TABLE_CAMERAS] = run.num_of_views;
+        this->rows[TABLE_COMPOSITES] = run.num_of_renders * run.num_of_composites;
+        this->rows[TABLE_AUGMENTATIONS] = run.num_of_renders * composites_per_render * run.num_of_augmentations;
+        this->rows[TABLE_SENSOR_EFFECTS] = run.sensor_effects ? run.num_of_renders : 0;
+
+        // Get the memory.
+        this->allocate();
+
+        // Fill the joint angles.
+        for (int i = 0; i < this->rows[TABLE_JOINT_ANGLES]; i++) {
+
+            std::vector<glm::vec3> angles = sampler.getJointAngles(i);
+            uint16_t* joints = row(TABLE_JOINT_ANGLES, i);
+
+            for (int j = 0; j < NUM_OF_JOINTS; j++) {
+                joints[j * 3 + 0] = glm::packHalf1x16(angles[j].x);
+                joints[j * 3 + 1] = glm::packHalf1x16(angles[j].y);
+                joints[j * 3 + 2] = glm::packHalf1x16(angles[j].z);
+            }
+
+        }
+
+        // Fill the arm positions.
+        for (int i = 0; i < this->rows[TABLE_ARM_POSITIONS]; i++) {
+
+            glm::vec3 position = sampler.getArmPosition(i);
+            uint16_t* positions = row(TABLE_ARM_POSITIONS, i);
+            positions[0] = glm::packHalf1x16(position.x);
+            positions[1] = glm::packHalf1x16(position.y);
+            positions[2] = glm::packHalf1x16(position.z);
+
+        }
+
+        // Fill the arm rotations.
+        for (int i = 0; i < this->rows[TABLE_ARM_ROTATIONS]; i++) {
+
+            glm::vec3 rotation = sampler.getArmRotation(i);
+            uint16_t* rotations = row(TABLE_ARM_ROTATIONS, i);
+            rotations[0] = glm::packHalf1x16(rotation.x);
+            rotations[1] = glm::packHalf1x16(rotation.y);
+            rotations[2] = glm::packHalf1x16(rotation.z);
+
+        }
+
+        // Fill the skin tones.
+        for (int i = 0; i < this->rows[TABLE_SKIN_TONES]; i++)
+            *row(TABLE_SKIN_TONES, i) = glm::packHalf1x16(sampler.getSkinTone(i));
+
+        // Fill the lights.
+        for (int i = 0; i < this->rows[TABLE_LIGHT_POSITIONS]; i++) {
+
+            Light light = sampler.getLight(i);
+            glm::vec3 position = light.getPosition();
+            uint16_t* light_positions = row(TABLE_LIGHT_POSITIONS, i);
+            light_positions[0] = glm::packHalf1x16(position.x);
+            light_positions[1] = glm::packHalf1x16(position.y);
+            light_positions[2] = glm::packHalf1x16(position.z);
+            *row(TABLE_LIGHT_POWERS, i) = glm::packHalf1x16(light.getPower());
+
+        }
+
+        // Fill the shininess.
+        for (int i = 0; i < this->rows[TABLE_SHININESS]; i++)
+            *row(TABLE_SHININESS, i) = glm::packHalf1x16(sampler.getShininess(i));
+
+        // Fill the backgrounds, in every form the run draws them.
+        for (int i = 0; i < this->rows[TABLE_BACKGROUNDS]; i++)
+            *row(TABLE_BACKGROUNDS, i) = (uint16_t) sampler.getBackground(i, num_images);
+
+        for (int i = 0; i < this->rows[TABLE_PROCEDURAL_SEEDS]; i++)
+            packSeed(sampler.getProceduralBackground(i), row(TABLE_PROCEDURAL_SEEDS, i));
+
+        for (int i = 0; i < this->rows[TABLE_MOSAIC_CROPS]; i++) {
+
+            BackgroundCrop crop = sampler.getMosaicCrop(i, run.mosaic_images);
+            uint16_t* crops = row(TABLE_MOSAIC_CROPS, i);
+            packCrop(crop, crops);
+            crops[5] = glm::packHalf1x16(crop.rotation);
+
+        }
+
+        // Fill the cameras. The field of view is taken back from the
+        // projection, as the camera does not keep it.
+        for (int i = 0; i < this->rows[TABLE_CAMERAS]; i++) {
+
+            Camera camera = sampler.getCamera(i, run.width, run.height);
+            glm::vec3 position = camera.getPosition();
+            glm::vec3 direction = camera.getDirection();
+            float fov = glm::degrees(2.0f * std::atan(1.0f / camera.getProjection()[1][1]));
+
+            uint16_t* cameras = row(TABLE_CAMERAS, i);
+            cameras[0] = glm::packHalf1x16(position.x);
+            cameras[1] = glm::packHalf1x16(position.y);
+            cameras[2] = glm::packHalf1x16(position.z);
+            cameras[3] = glm::packHalf1x16(direction.x);
+            cameras[4] = glm::packHalf1x16(direction.y);
+            cameras[5] = glm::packHalf1x16(direction.z);
+            cameras[6] = glm::packHalf1x16(fov);
+
+        }
+
+        // Fill the backgrounds composited on the CPU, by sample id.
+        for (int i = 0; i < this->rows[TABLE_COMPOSITES]; i++)
+            packCrop(sampler.getBackgroundCrop(i, run.num_of_backgrounds, num_images), row(TABLE_COMPOSITES, i));
+
+        // Fill the augmentations, by sample id.
+        for (int i = 0; i < this->rows[TABLE_AUGMENTATIONS]; i++) {
+
+            Augmentation augmentation = sampler.getAugmentation(i);
+            uint16_t* augmentations = row(TABLE_AUGMENTATIONS, i);
+            augmentations[0] = glm::packHalf1x16(augmentation.scale);
+            augmentations[1] = glm::packHalf1x16(augmentation.rotation);
+            augmentations[2] = glm::packHalf1x16(augmentation.offset_x);
+            augmentations[3] = glm::packHalf1x16(augmentation.offset_y);
+            augmentations[4] = glm::packHalf1x16(augmentation.brightness);
+            augmentations[5] = glm::packHalf1x16(augmentation.contrast);
+            augmentations[6] = glm::packHalf1x16(augmentation.saturation);
+            augmentations[7] = glm::packHalf1x16(augmentation.blur);
+            augmentations[8] = glm::packHalf1x16(augmentation.noise);
+            packSeed(augmentation.noise_offset, augmentations + 9);
+
+        }
+
+        // Fill the sensor effects, by render id. They are all stored, also
+        // the ones that are disabled.
+        for (int i = 0; i < this->rows[TABLE_SENSOR_EFFECTS]; i++) {
+
+            SensorEffects effects = sampler.getSensorEffects(i);
+            uint16_t* sensor = row(TABLE_SENSOR_EFFECTS, i);
+            sensor[0] = glm::packHalf1x16(effects.distortion);
+            sensor[1] = glm::packHalf1x16(effects.aberration);
+            sensor[2] = glm::packHalf1x16(effects.vignetting);
+            sensor[3] = glm::packHalf1x16(effects.blur);
+            sensor[4] = glm::packHalf1x16(effects.noise);
+            packSeed(effects.seed, sensor + 5);
+
+        }
+
+    }
+
+    VariationTable::VariationTable(const char* filename) {
+
+        // Open the file.
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Could not read the variation tables on file " << filename << std::endl;
+            exit(1);
+        }
+
+        // Read and check the header.
+        char header_bytes[TABLE_HEADER_SIZE];
+        file.read(header_bytes, TABLE_HEADER_SIZE);
+
+        TableHeader header;
+        memcpy(&header, header_bytes, sizeof(TableHeader));
+
+        bool valid = file && memcmp(header.magic, TABLE_MAGIC, 4) == 0 && header.version == TABLE_VERSION;
+        for (int i = 0; valid && i < NUM_OF_TABLE_BLOCKS; i++)
+            valid = header.rows[i] >= 0 && header.row_sizes[i] == ROW_SIZES[i];
+
+        if (!valid) {
+            std::cerr << "The file " << filename << " does not contain valid variation tables." << std::endl;
+            exit(1);
+        }
+
+        // Restore the parameters and get the memory.
+        this->seed = header.seed;
+        this->run.width = header.width;
+        this->run.height = header.height;
+        this->rows.assign(header.rows, header.rows + NUM_OF_TABLE_BLOCKS);
+        this->allocate();
+
+        // The memory block is stored as is, so it can be read at once.
+        file.read((char*) this->data, this->byte_size);
+        if (!file || this->byte_size != header.byte_size) {
+            std::cerr << "The variation tables on file " << filename << " are truncated." << std::endl;
+            exit(1);
+        }
+
+    }
+
+    VariationTable::~VariationTable() {
+
+        std::free(this->data);
+
+    }
+
+    uint64_t VariationTable::getSeed() const {
+
+        return this->seed;
+
+    }
+
+    int VariationTable::getNumOfRows(VariationTableBlock block) const {
+
+        return this->rows[block];
+
+    }
+
+    void VariationTable::gatherJointAngles(const std::vector<int> &indices, std::vector<glm::vec3> &angles) const {
+
+        angles.resize(indices.size() * NUM_OF_JOINTS);
+
+        // Each entry is a contiguous run of halves, so this is one streaming
+        // read per entry.
+        for (size_t i = 0; i < indices.size(); i++) {
+
+            assert(indices[i] >= 0 && indices[i] < this->rows[TABLE_JOINT_ANGLES]);
+            const uint16_t* joints = row(TABLE_JOINT_ANGLES, indices[i]);
+
+            for (int j = 0; j < NUM_OF_JOINTS; j++) {
+                angles[i * NUM_OF_JOINTS + j] = glm::vec3(glm::unpackHalf1x16(joints[j * 3 + 0]),
+                                                          glm::unpackHalf1x16(joints[j * 3 + 1]),
+                                                          glm::unpackHalf1x16(joints[j * 3 + 2]));
+            }
+
+        }
+
+    }
+
+    void VariationTable::gatherCrops(VariationTableBlock block, const std::vector<int> &indices, std::vector<BackgroundCrop> &crops) const {
+
+        assert(block == TABLE_MOSAIC_CROPS || block == TABLE_COMPOSITES);
+
+        crops.resize(indices.size());
+
+        for (size_t i = 0; i < indices.size(); i++) {
+
+            assert(indices[i] >= 0 && indices[i] < this->rows[block]);
+            const uint16_t* crop = row(block, indices[i]);
+
+            crops[i].image = crop[0];
+            crops[i].scale = glm::unpackHalf1x16(crop[1]);
+            crops[i].offset_x = glm::unpackHalf1x16(crop[2]);
+            crops[i].offset_y = glm::unpackHalf1x16(crop[3]);
+            crops[i].flip = crop[4] != 0;
+            crops[i].rotation = (block == TABLE_MOSAIC_CROPS) ? glm::unpackHalf1x16(crop[5]) : 0.0f;
+
+        }
+
+    }
+
+    bool VariationTable::save(const char* filename) const {
+
+        // Build the header.
+        char header_bytes[TABLE_HEADER_SIZE];
+        memset(header_bytes, 0, TABLE_HEADER_SIZE);
+
+        TableHeader header;
+        memcpy(header.magic, TABLE_MAGIC, 4);
+        header.version = TABLE_VERSION;
+        header.seed = this->seed;
+        for (int i = 0; i < NUM_OF_TABLE_BLOCKS; i++) {
+            header.rows[i] = this->rows[i];
+            header.row_sizes[i] = ROW_SIZES[i];
+        }
+        header.byte_size = (uint32_t) this->byte_size;
+        header.width = this->run.width;
+        header.height = this->run.height;
+        memcpy(header_bytes, &header, sizeof(TableHeader));
+
+        // Write the header and the block.
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        file.write(header_bytes, TABLE_HEADER_SIZE);
+        file.write((const char*) this->data, this->byte_size);
+        file.close();
+
+        return !file.fail();
+
+    }
+
+    void VariationTable::allocate() {
+
+        // Place the blocks one after the other, each starting on an aligned
+        // offset.
+        this->offsets.resize(NUM_OF_TABLE_BLOCKS);
+        size_t offset = 0;
+        for (int i = 0; i < NUM_OF_TABLE_BLOCKS; i++) {
+            this->offsets[i] = offset;
+            offset += (size_t) this->rows[i] * ROW_SIZES[i] * sizeof(uint16_t);
+            offset = (offset + VARIATION_TABLE_ALIGNMENT - 1) / VARIATION_TABLE_ALIGNMENT * VARIATION_TABLE_ALIGNMENT;
+        }
+
+        // Get the whole block at once. The size is already a multiple of the
+        // alignment, as aligned_alloc requires.
+        this->byte_size = offset > 0 ? offset : VARIATION_TABLE_ALIGNMENT;
+        this->data = (unsigned char*) std::aligned_alloc(VARIATION_TABLE_ALIGNMENT, this->byte_size);
+        memset(this->data, 0, this->byte_size);
+
+    }
+
+    uint16_t* VariationTable::row(int block, size_t row) const {
+
+        return (uint16_t*) (this->data + this->offsets[block]) + row * ROW_SIZES[block];
+
+    }
+
+}  // namespace bgq_opengl
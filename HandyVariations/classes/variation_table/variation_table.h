@@ -0,0 +1,205 @@
+/**
+ * @file variation_table.h
+ * @brief Variation table class header file.
+ * @version 1.0.0 (2024-03-05)
+ * @date 2024-03-05
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_CLASSES_VARIATION_TABLE_H_
+#define BGQ_OPENGL_CLASSES_VARIATION_TABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "classes/variation_sampler/variation_sampler.h"
+#include "structs/background_crop/background_crop.h"
+#include "structs/variation_indices/variation_indices.h"
+
+#define VARIATION_TABLE_ALIGNMENT 64
+
+namespace bgq_opengl {
+
+    /// The blocks that make up the table, one per kind of value.
+    enum VariationTableBlock {
+        TABLE_JOINT_ANGLES = 0,             /// The joint angles table.
+        TABLE_ARM_POSITIONS,                /// The arm positions table.
+        TABLE_ARM_ROTATIONS,                /// The arm rotations table.
+        TABLE_SKIN_TONES,                   /// The skin tones table.
+        TABLE_LIGHT_POSITIONS,              /// The positions of the lighting table.
+        TABLE_LIGHT_POWERS,                 /// The powers of the lighting table.
+        TABLE_SHININESS,                    /// The shininess table.
+        TABLE_BACKGROUNDS,                  /// The backgrounds table.
+        TABLE_PROCEDURAL_SEEDS,             /// The seeds of the procedural backgrounds.
+        TABLE_MOSAIC_CROPS,                 /// The crops of the background mosaic.
+        TABLE_CAMERAS,                      /// The cameras, one per view.
+        TABLE_COMPOSITES,                   /// The backgrounds composited on the CPU, by sample id.
+        TABLE_AUGMENTATIONS,                /// The augmentations, by sample id.
+        TABLE_SENSOR_EFFECTS,               /// The sensor effects, by render id.
+        NUM_OF_TABLE_BLOCKS
+    };
+
+    /// What a run draws from the sampler besides the variation tables.
+    struct VariationTableRun {
+        int width = 0;                      /// The width of the renders.
+        int height = 0;                     /// The height of the renders.
+        int num_of_views = 1;               /// The amount of cameras.
+        int num_of_renders = 0;             /// The amount of renders, frames times views.
+        int num_of_composites = 0;          /// The backgrounds of each render, 0 if they are not composited on the CPU.
+        int num_of_backgrounds = 0;         /// The size of the backgrounds table the composites are drawn with.
+        int num_of_augmentations = 0;       /// The augmentations of each composite, 0 if there are none.
+        bool procedural_backgrounds = false;    /// Whether the backgrounds are procedural.
+        int mosaic_images = 0;              /// The images of the background mosaic, 0 if there is none.
+        bool sensor_effects = false;        /// Whether the sensor effects are applied.
+    };
+
+    /**
+     * @brief Implementation of a VariationTable class.
+     *
+     * Implementation of an exporter of every value a run draws from its
+     * sampler, for when they have to be analysed or kept for
+     * reproducibility. Each kind of value is stored as its own contiguous,
+     * aligned block of rows: angles, positions and other reals as float16,
+     * ids as uint16, and seeds as two uint16 with the low half first. The
+     * rows of the variation tables are their entries, the cameras are one
+     * row per view, the composites, augmentations and sensor effects one row
+     * per id they are drawn with, and the blocks of what the run does not use
+     * are empty.
+     * The whole table lives in a single allocation that is written to and
+     * read from a file as is, after a header with the amount of rows of each
+     * block. Rows are read back a batch at a time, one block after another.
+     *
+     * @author Borja García Quiroga <garcaqub@tcd.ie>
+     */
+    class VariationTable {
+
+    public:
+
+        /**
+         * @brief Materialises the values of a run.
+         *
+         * Materialises the first entries of each of the tables of a sampler,
+         * and everything else the run draws from it.
+         *
+         * @param sampler The sampler the values are derived from.
+         * @param num_of_variations The amount of entries of each table.
+         * @param num_images The amount of background images available.
+         * @param run What else the run draws.
+         */
+        VariationTable(const VariationSampler &sampler, const VariationIndices &num_of_variations, int num_images, const VariationTableRun &run);
+
+        /**
+         * @brief Loads the values from a file.
+         *
+         * Loads the values from a file written by save().
+         *
+         * @param filename The name of the file.
+         */
+        VariationTable(const char* filename);
+
+        /**
+         * @brief Frees the tables.
+         *
+         * Frees the memory block holding the tables.
+         */
+        ~VariationTable();
+
+        VariationTable(const VariationTable&) = delete;
+        VariationTable& operator=(const VariationTable&) = delete;
+
+        /**
+         * @brief Get the seed the values were derived from.
+         *
+         * Get the seed of the sampler the values were derived from.
+         *
+         * @returns The seed.
+         */
+        uint64_t getSeed() const;
+
+        /**
+         * @brief Get the amount of rows of a block.
+         *
+         * Get the amount of rows of a block, 0 if the run does not draw it.
+         *
+         * @param block The block.
+         *
+         * @returns The amount of rows.
+         */
+        int getNumOfRows(VariationTableBlock block) const;
+
+        /**
+         * @brief Get the joint angles of a batch of entries.
+         *
+         * Decode the joint angles of several entries at once into a flat
+         * vector of NUM_OF_JOINTS angles per entry.
+         *
+         * @param indices The indices of the entries.
+         * @param angles Output vector for the angles.
+         */
+        void gatherJointAngles(const std::vector<int> &indices, std::vector<glm::vec3> &angles) const;
+
+        /**
+         * @brief Get the background crops of a batch of rows.
+         *
+         * Decode several rows of the mosaic crops or the composites at once.
+         *
+         * @param block Either TABLE_MOSAIC_CROPS or TABLE_COMPOSITES.
+         * @param indices The indices of the rows.
+         * @param crops Output vector for the crops.
+         */
+        void gatherCrops(VariationTableBlock block, const std::vector<int> &indices, std::vector<BackgroundCrop> &crops) const;
+
+        /**
+         * @brief Save the tables to a file.
+         *
+         * Save the header and the memory block to a single file.
+         *
+         * @param filename The name of the file.
+         *
+         * @returns True if the file was written.
+         */
+        bool save(const char* filename) const;
+
+    private:
+
+        /**
+         * @brief Compute the layout of the blocks.
+         *
+         * Compute the offset of each of the blocks and allocate the memory.
+         */
+        void allocate();
+
+        /**
+         * @brief Get a row of the table.
+         *
+         * Get a pointer to the start of a row of one of the blocks.
+         *
+         * @param block The index of the block.
+         * @param row The index of the row.
+         *
+         * @returns The pointer to the row.
+         */
+        uint16_t* row(int block, size_t row) const;
+
+        uint64_t seed = 0;                  /// The seed the tables were derived from.
+        VariationTableRun run;              /// What else the run draws.
+        std::vector<int> rows;              /// The amount of rows of each block.
+        std::vector<size_t> offsets;        /// The offset of each block in bytes.
+        size_t byte_size = 0;               /// The size of the memory block in bytes.
+        unsigned char* data = nullptr;      /// The aligned memory block.
+
+    };
+
+}  // namespace bgq_opengl
+
+#endif  //!BGQ_OPENGL_CLASSES_VARIATION_TABLE_H_
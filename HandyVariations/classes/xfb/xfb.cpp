@@ -0,0 +1,94 @@
+/**
+ * @file xfb.cpp
+ * @brief XFB class implementation file.
+ * @version 1.0.0 (2024-03-20)
+ * @date 2024-03-20
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#include "xfb.h"
+
+#include "GL/glew.h"
+
+#include "classes/ebo/ebo.h"
+
+namespace bgq_opengl {
+
+	XFB::XFB(GLsizei num_vertices, EBO &ebo) {
+
+		GLsizei stride = XFB_VERTEX_FLOATS * sizeof(GLfloat);
+
+		// Generate the buffer with room for every vertex.
+		glGenBuffers(1, &this->ID);
+		glBindBuffer(GL_ARRAY_BUFFER, this->ID);
+		glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr) num_vertices * stride, nullptr, GL_DYNAMIC_COPY);
+
+		// Read the captured vertices with the same layout as a mesh.
+		glGenVertexArrays(1, &this->vao_ID);
+		glBindVertexArray(this->vao_ID);
+
+		const GLint sizes[6] = {3, 3, 3, 2, 3, 3};
+		GLsizeiptr offset = 0;
+		for (GLuint layout = 0; layout < 6; layout++) {
+
+			glVertexAttribPointer(layout, sizes[layout], GL_FLOAT, GL_FALSE, stride, (void*) (offset * sizeof(GLfloat)));
+			glEnableVertexAttribArray(layout);
+			offset += sizes[layout];
+
+		}
+
+		// The indices are the ones of the mesh.
+		ebo.bind();
+
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	}
+
+	void XFB::begin() {
+
+		// Nothing has to be drawn while capturing.
+		glEnable(GL_RASTERIZER_DISCARD);
+		glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, this->ID);
+		glBeginTransformFeedback(GL_POINTS);
+
+	}
+
+	void XFB::bind() {
+
+		// Bind the VAO.
+		glBindVertexArray(this->vao_ID);
+
+	}
+
+	void XFB::end() {
+
+		glEndTransformFeedback();
+		glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+		glDisable(GL_RASTERIZER_DISCARD);
+
+	}
+
+	void XFB::remove() {
+
+		// Delete the VAO and the buffer in OpenGL.
+		glDeleteVertexArrays(1, &this->vao_ID);
+		glDeleteBuffers(1, &this->ID);
+
+	}
+
+	void XFB::unbind() {
+
+		// Unbind the VAO by binding no VAO.
+		glBindVertexArray(0);
+
+	}
+
+}  // namespace bgq_opengl
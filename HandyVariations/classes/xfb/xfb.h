@@ -0,0 +1,98 @@
+/**
+ * @file xfb.h
+ * @brief XFB class header file.
+ * @version 1.0.0 (2024-03-20)
+ * @date 2024-03-20
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_CLASS_XFB_H_
+#define BGQ_OPENGL_CLASS_XFB_H_
+
+#include "GL/glew.h"
+
+#include "classes/ebo/ebo.h"
+
+// Position, normal, color, UV, tangent and bitangent.
+#define XFB_VERTEX_FLOATS 17
+
+namespace bgq_opengl {
+
+	/**
+	 * @brief Implementation of a XFB class.
+	 *
+	 * Implementation of a transform feedback buffer, a buffer that captures
+	 * the vertices output by a vertex shader, together with a VAO that reads
+	 * them back as the attributes 0 to 5 of the regular vertex layout. It is
+	 * used to skin a pose once and draw it many times.
+	 *
+	 * @author Borja García Quiroga <garcaqub@tcd.ie>
+	 */
+	class XFB {
+
+	public:
+
+		/**
+		 * @brief Constructs a Transform Feedback Buffer.
+		 *
+		 * Constructs a buffer big enough for the vertices of a mesh, and a
+		 * VAO that draws them with the indices of the mesh.
+		 *
+		 * @param num_vertices The amount of vertices.
+		 * @param ebo The indices of the mesh.
+		 */
+		XFB(GLsizei num_vertices, EBO &ebo);
+
+		/**
+		 * @brief Starts capturing.
+		 *
+		 * Starts capturing the vertices of the following draw calls, which
+		 * must draw GL_POINTS. Nothing is rasterised until the capture ends.
+		 */
+		void begin();
+
+		/**
+		 * @brief Binds the XFB.
+		 *
+		 * Binds the VAO that reads the captured vertices.
+		 */
+		void bind();
+
+		/**
+		 * @brief Stops capturing.
+		 *
+		 * Stops capturing and turns the rasteriser back on.
+		 */
+		void end();
+
+		/**
+		 * @brief Removes the XFB.
+		 *
+		 * Removes the buffer and its VAO from OpenGL.
+		 */
+		void remove();
+
+		/**
+		 * @brief Unbinds the XFB.
+		 *
+		 * Unbinds the VAO.
+		 */
+		void unbind();
+
+	private:
+
+		GLuint ID;				// GL ID of the buffer.
+		GLuint vao_ID;			// GL ID of the VAO that reads the buffer.
+
+	};
+
+}  // namespace bgq_opengl
+
+#endif //!BGQ_OPENGL_CLASS_XFB_H_
@@ -25,9 +25,15 @@
 #include <iostream>
 #include <random>
 #include <vector>
+#include <cctype>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
 #include <format>
 #include <fstream>
+#include <sstream>
+#include <utility>
 
 #include "GL/glew.h"
 #include "GLFW/glfw3.h"
@@ -47,8 +53,10 @@
 #include "classes/background/background.h"
 #include "classes/bone/bone.h"
 #include "classes/camera/camera.h"
+#include "classes/checkpoint/checkpoint.h"
 #include "classes/light/light.h"
 #include "classes/object_rigged/object_rigged.h"
+#include "classes/sample_manifest/sample_manifest.h"
 #include "classes/shader/shader.h"
 #include "structs/bounding_box/bounding_box.h"
 
@@ -56,6 +64,34 @@ void clean() {
 
 	// Delete all the shaders.
 	shader->remove();
+    shaderMultiview->remove();
+    shaderSkinning->remove();
+    shaderSkinned->remove();
+    shaderGeometry->remove();
+    shaderLighting->remove();
+    shaderSensor->remove();
+    
+    // Delete the G-buffers.
+    for (bgq_opengl::GBuffer *gbuffer : gbuffers)
+        gbuffer->remove();
+    
+    // Delete the copy of the renders for the sensor effects.
+    if (post_processor != nullptr)
+        post_processor->remove();
+    
+    // Delete the background mosaic.
+    if (mosaic != nullptr)
+        mosaic->remove();
+    
+    // Delete the tiled framebuffer.
+    if (fbo != nullptr)
+        fbo->remove();
+    
+    // Delete the meshes of the hand and of the points.
+    if (hand != nullptr)
+        hand->remove();
+    if (dis_pnt != nullptr)
+        dis_pnt->remove();
     
     // Terminate ImGUI.
     ImGui_ImplGlfw_Shutdown();
@@ -63,129 +99,65 @@ void clean() {
     // Close GL context and any other GLFW resources.
     glfwTerminate();
     
+    // Report the comparison of the codecs, if that is what this run was for.
+    if (benchmark_frames > 0)
+        printCodecBenchmark();
+    
     // Check if we're actually producing the dataset.
     if (!store_dataset)
         return;
-        
-    // Go back one position to remove the last comma printed.
-    long pos = annotations_file.tellp();
-    annotations_file.seekp(pos - 2);
-    annotations_file << "]\n"; // Write the start of the json.
-    annotations_file.close();
     
-    pos = k_matrices_file.tellp();
-    k_matrices_file.seekp(pos - 2);
-    k_matrices_file << "]\n"; // Write the start of the json.
-    k_matrices_file.close();
+    // Wait for the pending writes and stop the writer threads.
+    async_writer->wait();
+    bgq_opengl::AsyncWriterStats stats = async_writer->getStats();
+    std::cout << "WRITES: " << stats.completed << " jobs, max queue depth " << stats.max_queue_depth << ", mean latency " << stats.mean_latency << " ms, max latency " << stats.max_latency << " ms, " << stats.stalls << " stalls" << std::endl;
+    delete async_writer;
+    
+    // Tell the trainer that no more samples are coming.
+    if (sample_stream != nullptr) {
+        std::cout << "STREAM: " << sample_stream->getNumOfWaits() << " samples waited for the trainer, " << sample_stream->getNumOfDropped() << " dropped" << std::endl;
+        sample_stream->close();
+        delete sample_stream;
+    }
+    
+    // The annotations are left untouched when rendering samples again.
+    if (rerender_mode) {
+        manifest->close();
+        return;
+    }
+    
+    // Finish every output, and only then save the last checkpoint, so that
+    // an interrupted run can be resumed and a finished one extended. If any
+    // of them failed, the previous checkpoint is kept.
+    if (closeOutputs())
+        saveCheckpoint();
+    else
+        std::cerr << "Could not finalise the outputs, keeping the previous checkpoint." << std::endl;
+    
+    delete shard_writer;
+    delete tensor_writer;
+    delete heatmap_writer;
+    delete heatmap_renderer;
+    delete annotations_store;
+    delete k_matrices_store;
+    
+    for (bgq_opengl::OutputLevel &level : output_levels) {
+        delete level.shard_writer;
+        delete level.tensor_writer;
+        delete level.annotations_store;
+        delete level.k_matrices_store;
+    }
+    
+    delete annotations_file;
+    delete k_matrices_file;
 
 }
 
 void calculateKeypoints() {
     
-    // Init the keypoints.
-    keypoints = std::vector<glm::vec3>(21, glm::vec3(0.0f, 0.0f, 0.0f));
-        
-    // Get the bones.
-    std::vector<bgq_opengl::Bone> bones = hand->getBones();
-    
-    // Get the vertices.
-    std::vector<bgq_opengl::Vertex> vertices = hand->getMeshes()[0].getVertices();
+    // Skin the reference vertices of the keypoints like the shaders do.
+    bgq_opengl::Generator::calculateKeypoints(*hand, keypoints);
     
-    // For each bone
-    for (unsigned int i = 0; i < key_mapping.size(); i++) {
-        
-        glm::vec4 aux_pnt = glm::vec4(keypoints[i], 1.0f);
-        
-        // Apply the inverse of the offset to this point to pass it from bone
-        // to world point, as all bone centers are in the 0,0,0 relatively to
-        // themselves (duh).
-        aux_pnt = glm::inverse(bones[key_mapping[i]].getOffset()) * aux_pnt;
-        
-        // Get the initial value for each.
-        // Check if it is one of the cases that needs further reconstruction.
-        switch (i) {
-                
-            case 4:
-                aux_pnt += glm::vec4(-2.712357f, 10.171295f, 18.986443f, 0.0f);
-                break;
-
-            case 8:
-                aux_pnt += glm::vec4(-0.000015f, 8.476074f, 12.544624f, 0.0f);
-                break;
-                
-            case 12:
-                aux_pnt += glm::vec4(1.017120f, 10.171303f, 11.527489f, 0.0f);
-                break;
-                
-            case 16:
-                aux_pnt += glm::vec4(2.034241f, 12.544601f, 10.510353f, 0.0f);
-                break;
-                
-            case 20:
-                aux_pnt += glm::vec4(0.678085f, 10.171295f, 7.119926f, 0.0f);
-                break;
-                
-            default:
-                break;
-                
-        }
-
-        // We now retrieve the closest vertex.
-        bgq_opengl::Vertex closest = vertices[keypoint_bone_map[i]];
-        
-        // Now we apply to it the same logic as in the shader.
-        
-        // Init the value of the variables to 0 to add the right values to them.
-        glm::vec4 interpol_pnt = glm::vec4(0.0, 0.0, 0.0, 0.0);
-
-        // Init the total sums of weights to normalise them at the end.
-        float accum_weight = 0.0f;
-        
-        // Iterate through the influencing bones.
-        for (unsigned int j = 0; j < MAX_BONE_INFLUENCE; j++) {
-            
-            // If this bone is -1, it is not initialised. Don't use it.
-            if(closest.bone_ids[j] <= -1)
-                continue;
-            
-            // Check that this bone is in the usable range.
-            if(closest.bone_ids[j] >= bones.size())
-                continue;
-            
-            // Apply the bone transforms to obtain the component points.
-            glm::vec4 partial_pnt = bones[closest.bone_ids[j]].getTransformMatrix() * aux_pnt;
-
-            // Add a pondered version of this point.
-            interpol_pnt += partial_pnt * closest.bone_weights[j];
-
-            // Add this weight to the weight accumulator to normalise the
-            // pondered intermediate point.
-            accum_weight += closest.bone_weights[j];
-            
-        }
-        
-        // If the accum weight is 0, we understand that no bones have been
-        // applied.
-        if (accum_weight == 0.0) {
-            
-            // Set the original point as the final point.
-            interpol_pnt = aux_pnt;
-
-        } else {
-            
-            // Normalise the boneVertex;
-            interpol_pnt /= accum_weight;
-
-        }
-        
-        // Then, apply the very same transformations we applied to the hand.
-        aux_pnt = hand->getMeshes()[0].getTransformMat() * interpol_pnt;
-        
-        // Put that back in the keypoint.
-        keypoints[i] = glm::vec3(aux_pnt);
-        
-    }
-            
 }
 
 void displayElements() {
@@ -199,18 +171,61 @@ void displayElements() {
     // Clean the back buffer and depth buffer
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     
+    // Draw the scene.
+    drawSample();
+    
+    // Pass it through the lens and the sensor. A frame without the tiled
+    // framebuffer has a single view.
+    if (post_processor != nullptr)
+        applySensorEffects(frame_id * num_of_camera_params);
+    
+    // Poll and handle events.
+    glfwPollEvents();
+    
+    // Swap the buffers to display it.
+    glfwSwapBuffers(window);
+        
+}
+
+void drawBackground() {
+    
+    // When compositing, the backgrounds are added on the CPU.
+    if (compositor != nullptr)
+        return;
+    
+    // Draw the procedural background from its seed, without any file.
+    if (background_mode == BACKGROUND_PROCEDURAL) {
+        
+        shaderProcedural->activate();
+        shaderProcedural->passInt("seed", (int) sampler->getProceduralBackground(current_variation.background));
+        shaderProcedural->passMat("cropTransform", glm::mat3(1.0f));
+        backbox->draw(*shaderProcedural, *camera);
+        
+        return;
+        
+    }
+    
+    // Crop the background out of the mosaic, which is already in the GPU.
+    if (background_mode == BACKGROUND_MOSAIC) {
+        
+        bgq_opengl::BackgroundCrop crop = sampler->getMosaicCrop(current_variation.background, mosaic->getNumOfImages());
+        
+        shaderBck->activate();
+        mosaic->bind(crop.image, 4);
+        shaderBck->passInt("image", 4);
+        shaderBck->passMat("cropTransform", mosaic->getCropTransform(crop));
+        backbox->draw(*shaderBck, *camera);
+        
+        return;
+        
+    }
+    
     // Load the textures.
     if (num_of_backgrounds > 1) {
         
         // Get the id for the background.
-        std::uniform_int_distribution<int> var_shine(0, num_of_backgrounds - 1);
-        int sel_var_back = var_shine(gen);
-        int backgr_id = background_indices[sel_var_back];
-        
-        // Get the name with the right amount of zeros.
-        std::string bg_filename = "000000000000" + std::to_string(backgr_id);
-        bg_filename = bg_filename.substr(bg_filename.size() - 12);
-        bg_filename = backgrounds_path + "rdm_bg_" + bg_filename + ".jpg";
+        int backgr_id = sampler->getBackground(current_variation.background, BACKGROUND_POOL_SIZE);
+        std::string bg_filename = getBackgroundFilename(backgr_id);
                         
         // Create a new texture from this image.
         bgq_opengl::Texture back_text(bg_filename.c_str(), "image", 4);
@@ -218,6 +233,7 @@ void displayElements() {
         // Draw the background.
         shaderBck->activate();
         shaderBck->passTexture(back_text);
+        shaderBck->passMat("cropTransform", glm::mat3(1.0f));
         backbox->draw(*shaderBck, *camera);
         
         // Empty texture
@@ -225,26 +241,121 @@ void displayElements() {
                 
     }
     
-    // Pass the parameters to the shaders.
-    shader->activate();
+}
+
+std::string getBackgroundFilename(int backgr_id) {
+    
+    return bgq_opengl::Generator::getBackgroundFilename(backgrounds_path, backgr_id);
+    
+}
+
+int getSamplesPerFrame() {
+    
+    return num_of_camera_params * num_of_composites * getAugmentationsPerRender();
+    
+}
+
+int getAugmentationsPerRender() {
+    
+    return std::max(num_of_augmentations, 1);
+    
+}
+
+int getOutputHeight(int output_width) {
+    
+    return std::max((int) std::lround((double) output_width * window_height / window_width), 1);
+    
+}
+
+void drawDeferredHand() {
+    
+    // The cameras are kept in the order of the views.
+    int view = (int) (camera - cameras.data());
+    glm::ivec3 pose(current_variation.joint_angles, current_variation.arm_position, current_variation.arm_rotation);
+    
+    // Rasterise the pose only if the G-buffer of this view does not have it.
+    if (gbuffer_poses[view] != pose) {
+        
+        if (current_variation.joint_angles != skinned_joint_angles) {
+            hand->skin(*shaderSkinning);
+            skinned_joint_angles = current_variation.joint_angles;
+        }
+        
+        // Nothing is lit here, but passing the camera needs a light.
+        shaderGeometry->activate();
+        shaderGeometry->passLight(sampler->getLight(current_variation.lighting));
+        
+        gbuffers[view]->bind();
+        hand->drawSkinned(*shaderGeometry, *camera);
+        gbuffers[view]->unbind();
+        
+        gbuffer_poses[view] = pose;
+        
+    }
     
-    // Selects the light to pass.
-    std::uniform_int_distribution<int> var_lights(0, num_of_lighting - 1);
-    int sel_var_light = var_lights(gen);
-    shader->passLight(light_variations[sel_var_light]);
+    // Pass the parameters of this sample to the lighting pass.
+    shaderLighting->activate();
+    shaderLighting->passLight(sampler->getLight(current_variation.lighting));
+    shaderLighting->passCamera(*camera);
+    shaderLighting->passMat("inverseProjection", glm::inverse(camera->getProjection()));
+    shaderLighting->passFloat("skinTone", sampler->getSkinTone(current_variation.skin_tone));
+    shaderLighting->passFloat("shininess", sampler->getShininess(current_variation.shininess));
+    
+    // Pass the G-buffer.
+    gbuffers[view]->bindTextures(GBUFFER_FIRST_SLOT);
+    shaderLighting->passInt("gNormal", GBUFFER_FIRST_SLOT);
+    shaderLighting->passInt("gAlbedo", GBUFFER_FIRST_SLOT + 1);
+    shaderLighting->passInt("gDepth", GBUFFER_FIRST_SLOT + 2);
+    
+    // Light the hand over the background. The depth of the hand is written
+    // by the shader, so nothing has to be tested.
+    glDepthFunc(GL_ALWAYS);
+    gbuffers[view]->drawFullscreen();
+    glDepthFunc(GL_LESS);
     
-    // Select the skin_tone.
-    std::uniform_int_distribution<int> var_skin_tone(0, num_of_skin_tones - 1);
-    int sel_var_skin_tone = var_skin_tone(gen);
-    shader->passFloat("skinTone", skin_tones[sel_var_skin_tone]);
+}
+
+void drawSample() {
     
-    // Select the shininess.
-    std::uniform_int_distribution<int> var_shine(0, num_of_shininess - 1);
-    int sel_var_shine = var_shine(gen);
-    shader->passFloat("shininess", shine_variations[sel_var_shine]);
+    // Draw the background.
+    drawBackground();
     
-    // Draw the hand.
-    hand->draw(*shader, *camera);
+    // Light the hand from its G-buffer.
+    if (deferred_shading) {
+        
+        drawDeferredHand();
+        
+    } else {
+        
+        // When the pose is drawn several times, skin it only once and then draw
+        // it as many times as needed without the bones.
+        bool skin_cache = appearance_variants > 1 || num_of_camera_params > 1;
+        bgq_opengl::Shader *hand_shader = skin_cache ? shaderSkinned : shader;
+        
+        if (skin_cache && current_variation.joint_angles != skinned_joint_angles) {
+            hand->skin(*shaderSkinning);
+            skinned_joint_angles = current_variation.joint_angles;
+        }
+        
+        // Pass the parameters to the shaders.
+        hand_shader->activate();
+        
+        // Pass the selected light.
+        hand_shader->passLight(sampler->getLight(current_variation.lighting));
+        
+        // Pass the selected skin tone.
+        hand_shader->passFloat("skinTone", sampler->getSkinTone(current_variation.skin_tone));
+        
+        // Pass the selected shininess.
+        hand_shader->passFloat("shininess", sampler->getShininess(current_variation.shininess));
+        
+        // Draw the hand.
+        if (skin_cache)
+            hand->drawSkinned(*hand_shader, *camera);
+        else
+            hand->draw(*hand_shader, *camera);
+        
+    }
     
     // Check if we're actually producing the dataset.
     if (!store_dataset) {
@@ -261,12 +372,51 @@ void displayElements() {
         
     }
     
-    // Poll and handle events.
-    glfwPollEvents();
+}
+
+bgq_opengl::SensorEffects getSensorEffects(int id) {
+    
+    bgq_opengl::SensorEffects effects = sampler->getSensorEffects(id);
+    
+    // Leave out the effects that are not enabled, without changing the
+    // others.
+    if (!(sensor_effects & SENSOR_NOISE))
+        effects.noise = 0.0f;
+    if (!(sensor_effects & SENSOR_VIGNETTING))
+        effects.vignetting = 0.0f;
+    if (!(sensor_effects & SENSOR_ABERRATION))
+        effects.aberration = 0.0f;
+    if (!(sensor_effects & SENSOR_DISTORTION))
+        effects.distortion = 0.0f;
+    if (!(sensor_effects & SENSOR_BLUR))
+        effects.blur = 0.0f;
+    
+    return effects;
+    
+}
+
+void applySensorEffects(int id) {
+    
+    bgq_opengl::SensorEffects effects = getSensorEffects(id);
+    
+    // Copy the render out of the viewport.
+    post_processor->capture();
+    
+    // Pass the parameters of this view to the shader.
+    shaderSensor->activate();
+    post_processor->bindTexture(SENSOR_IMAGE_SLOT);
+    shaderSensor->passInt("image", SENSOR_IMAGE_SLOT);
+    shaderSensor->passVec("imageSize", post_processor->getSize());
+    shaderSensor->passFloat("distortion", effects.distortion);
+    shaderSensor->passFloat("aberration", effects.aberration);
+    shaderSensor->passFloat("vignetting", effects.vignetting);
+    shaderSensor->passFloat("blur", effects.blur);
+    shaderSensor->passFloat("noise", effects.noise);
+    shaderSensor->passInt("seed", (int) effects.seed);
+    
+    // Draw it back over the viewport through the lens and the sensor.
+    post_processor->drawFullscreen();
     
-    // Swap the buffers to display it.
-    glfwSwapBuffers(window);
-        
 }
 
 void displayInterface() {
@@ -290,7 +440,7 @@ void displayInterface() {
     ImGui::SetNextWindowSize(io.DisplaySize);
     
     // Begin the new widget.
-    ImGui::Begin("Dataset parameters", 0, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoCollapse);
+    ImGui::Begin("Dataset parameters", 0, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse);
     
     // Check if the process is running.
     // If it is, the form will be disabled.
@@ -308,6 +458,9 @@ void displayInterface() {
     if (dataset_size < 1) dataset_size = 1;
     ImGui::InputInt("Dataset size", &dataset_size);
     
+    // Get the seed. Leaving it at 0 draws a new one.
+    ImGui::InputScalar("Seed (0 = random)", ImGuiDataType_U64, &dataset_seed);
+    
     ImGui::Dummy(ImVec2(0.0f, 20.0f));
     
     // Get the number of variations.
@@ -330,6 +483,68 @@ void displayInterface() {
     ImGui::Dummy(ImVec2(0.0f, 20.0f));
     ImGui::Checkbox("Store the resulting dataset", &store_dataset);
     
+    // The rest of the options are folded, so that the window keeps its size.
+    ImGui::Dummy(ImVec2(0.0f, 20.0f));
+    
+    // Get how each pose is varied further.
+    if (ImGui::CollapsingHeader("Backgrounds and views")) {
+        ImGui::Combo("Background type", &background_mode, "Images\0Procedural\0Mosaic crops\0");
+        if (mosaic_images < 1) mosaic_images = 1;
+        ImGui::InputInt("Mosaic source images", &mosaic_images);
+        ImGui::SliderInt("Camera views", &num_of_camera_params, 1, MAX_INSTANCE_VIEWS);
+        if (appearance_variants < 1) appearance_variants = 1;
+        ImGui::InputInt("Appearance variants per pose", &appearance_variants);
+        if (num_of_composites < 1) num_of_composites = 1;
+        ImGui::InputInt("Backgrounds per render", &num_of_composites);
+        if (num_of_augmentations < 0) num_of_augmentations = 0;
+        ImGui::InputInt("Augmentations per render (0 = off)", &num_of_augmentations);
+    }
+    
+    // Get the way the samples are stored.
+    if (ImGui::CollapsingHeader("Output")) {
+        ImGui::InputText("Smaller copies (e.g. 128,224)", &output_sizes);
+        ImGui::Combo("Resampling filter", &resample_filter, "Box\0Lanczos\0");
+        ImGui::Checkbox("Export the variation tables", &export_variation_tables);
+        ImGui::Checkbox("Store the annotations as json too", &store_json_annotations);
+        ImGui::Combo("Output format", &output_format, "Loose image files\0Tar shards\0Raw tensor shards\0Shared-memory stream\0");
+        ImGui::Combo("Image codec", &image_codec, "JPEG\0PNG\0QOI\0PPM\0");
+        ImGui::SliderInt("PNG compression level", &png_compression_level, 0, 9);
+        int png_filter_item = png_filter + 1;
+        ImGui::Combo("PNG filter", &png_filter_item, "Best per row\0None\0Sub\0Up\0Average\0Paeth\0");
+        png_filter = png_filter_item - 1;
+        if (samples_per_shard < 1) samples_per_shard = 1;
+        ImGui::InputInt("Samples per shard", &samples_per_shard);
+        ImGui::Combo("Tensor layout", &tensor_layout, "NHWC\0NCHW\0");
+        if (heatmap_size < 0) heatmap_size = 0;
+        ImGui::InputInt("Heatmap size (0 = off)", &heatmap_size);
+        ImGui::Combo("Heatmap type", &heatmap_type, "uint8\0float16\0");
+        ImGui::InputText("Stream name", &stream_name);
+        if (stream_slots < 1) stream_slots = 1;
+        ImGui::InputInt("Stream slots", &stream_slots);
+        if (checkpoint_interval < 1) checkpoint_interval = 1;
+        ImGui::InputInt("Checkpoint every", &checkpoint_interval);
+        if (num_of_writer_threads < 1) num_of_writer_threads = 1;
+        ImGui::InputInt("Writer threads", &num_of_writer_threads);
+        ImGui::Checkbox("Bypass the page cache for tensor shards", &bypass_page_cache);
+    }
+    
+    // Get how the renders are drawn.
+    if (ImGui::CollapsingHeader("Rendering")) {
+        if (batch_size < 1) batch_size = 1;
+        ImGui::InputInt("Samples per draw pass", &batch_size);
+        ImGui::Checkbox("Draw the hands of a pass at once", &instanced_rendering);
+        ImGui::Checkbox("Relight each pose from a G-buffer", &deferred_shading);
+        ImGui::Text("Sensor effects, applied on the GPU:");
+        ImGui::CheckboxFlags("Noise", &sensor_effects, SENSOR_NOISE);
+        ImGui::SameLine();
+        ImGui::CheckboxFlags("Vignetting", &sensor_effects, SENSOR_VIGNETTING);
+        ImGui::SameLine();
+        ImGui::CheckboxFlags("Aberration", &sensor_effects, SENSOR_ABERRATION);
+        ImGui::CheckboxFlags("Distortion", &sensor_effects, SENSOR_DISTORTION);
+        ImGui::SameLine();
+        ImGui::CheckboxFlags("Blur", &sensor_effects, SENSOR_BLUR);
+    }
+    
     // Set the button to start the process.
     ImGui::Dummy(ImVec2(0.0f, 20.0f));
     if (ImGui::Button("Start dataset generation")) {
@@ -343,7 +558,18 @@ void displayInterface() {
     ImGui::Dummy(ImVec2(0.0f, 20.0f));
 
     // Display the progress bar.
-    ImGui::ProgressBar((float) frame_count / dataset_size);
+    int num_of_frames = rerender_mode ? (int) rerender_frames.size() : dataset_size;
+    ImGui::ProgressBar((float) frame_count / num_of_frames);
+    
+    // Display the state of the writes.
+    if (async_writer != nullptr) {
+        bgq_opengl::AsyncWriterStats stats = async_writer->getStats();
+        ImGui::Text("Write queue: %i (max %i), latency: %.1f ms (max %.1f ms)", stats.queue_depth, stats.max_queue_depth, stats.mean_latency, stats.max_latency);
+    }
+    
+    // And how often the trainer held the stream back.
+    if (sample_stream != nullptr)
+        ImGui::Text("Samples that waited for the trainer: %li", sample_stream->getNumOfWaits());
 
     // Finish the widget.
     ImGui::End();
@@ -389,18 +615,54 @@ void initElements() {
      
     // Init the shader.
     shader = new bgq_opengl::Shader("blinn_phong_normal.vert", "blinn_phong_normal.frag");
+    shaderMultiview = new bgq_opengl::Shader("blinn_phong_multiview.vert", "blinn_phong_multiview.geom", "blinn_phong_normal.frag");
+    shaderSkinning = new bgq_opengl::Shader("skinning.vert", nullptr, nullptr, {"skinnedPosition", "skinnedNormal", "skinnedColor", "skinnedUV", "skinnedTangent", "skinnedBitangent"});
+    shaderSkinned = new bgq_opengl::Shader("blinn_phong_skinned.vert", "blinn_phong_normal.frag");
+    shaderGeometry = new bgq_opengl::Shader("blinn_phong_skinned.vert", "gbuffer.frag");
+    shaderLighting = new bgq_opengl::Shader("deferred.vert", "deferred_lighting.frag");
     shaderPnt = new bgq_opengl::Shader("aux_pnt.vert", "aux_pnt.frag");
     shaderBck = new bgq_opengl::Shader("background.vert", "background.frag");
+    shaderProcedural = new bgq_opengl::Shader("background.vert", "procedural_background.frag");
+    shaderSensor = new bgq_opengl::Shader("deferred.vert", "sensor_effects.frag");
+    
+    // The sensor effects need the background under the hand, so they are
+    // left out when compositing on the CPU.
+    if (store_dataset && sensor_effects != 0) {
+        if (compositor == nullptr)
+            post_processor = new bgq_opengl::PostProcessor();
+        else
+            std::cerr << "The sensor effects are not applied when compositing over several backgrounds." << std::endl;
+    }
     
     // Init the hand model.
     hand = new bgq_opengl::ObjectRigged("hand.fbx");
     
-    // Creates the first camera object
-    camera = new bgq_opengl::Camera(glm::vec3(0.0f, 0.3f, 1.5f), glm::vec3(0.0f, 0.0f, -1.0f), 45.0f, 0.1f, 100.0f, window_width, window_height);
+    // Create the camera of each view. The first one is the default camera.
+    cameras.clear();
+    for (int view = 0; view < num_of_camera_params; view++)
+        cameras.push_back(sampler->getCamera(view, window_width, window_height));
+    
+    camera = &cameras[0];
+    
+    // Create the G-buffer of each view, still without any pose in it.
+    if (deferred_shading) {
+        for (int view = 0; view < num_of_camera_params; view++) {
+            gbuffers.push_back(new bgq_opengl::GBuffer(window_width, window_height));
+            gbuffer_poses.push_back(glm::ivec3(-1));
+        }
+    }
     
     // Init the background that will hold the textures.
     backbox = new bgq_opengl::Background();
     
+    // Load the images of the mosaic once, they stay in the GPU.
+    if (background_mode == BACKGROUND_MOSAIC) {
+        std::vector<std::string> mosaic_files;
+        for (int i = 0; i < mosaic_images; i++)
+            mosaic_files.push_back(getBackgroundFilename(sampler->getBackground(i, BACKGROUND_POOL_SIZE)));
+        mosaic = new bgq_opengl::BackgroundMosaic(mosaic_files);
+    }
+    
 }
 
 void initInterface() {
@@ -515,7 +777,7 @@ void initRendererWindow() {
     GLFWmonitor* monitor = glfwGetPrimaryMonitor();
     float xscale, yscale;
     glfwGetMonitorContentScale(monitor, &xscale, &yscale);
-    window = glfwCreateWindow(window_width / xscale, window_width / yscale, "Current image", NULL, NULL);
+    window = glfwCreateWindow(window_width / xscale, window_height / yscale, "Current image", NULL, NULL);
     
     if (!window) {
         std::cerr << "Error 121-1001 - Failed to create the window." << std::endl;
@@ -541,159 +803,116 @@ void initRendererWindow() {
 
 void initVariations() {
     
-    // Init the variations to just one value.
-    arm_positions.push_back(glm::vec3(0.0f));
-    arm_rotations.push_back(glm::vec4(1.0f, 0.0f, 0.0f, 0.0f));
-    joint_angles.push_back(std::vector<glm::vec3>(16, glm::vec3(1.0f)));
-    skin_tones.push_back(1.0f);
-    light_variations.push_back(bgq_opengl::Light(glm::vec3(5.0, 5.0, 5.0), glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), 20.0f));
-    shine_variations.push_back(1.0f);
-    
-    // Create the buffer.
     char buffer[256];
-    snprintf(buffer, 256, "%i_%i_%i_%i_%i_%i_%i_%i_%i", num_of_joint_angles, num_of_arm_positions, num_of_arm_rotations, num_of_skin_tones, num_of_lighting, num_of_shininess, num_of_backgrounds, num_of_camera_params, dataset_size);
+    bool continue_dataset = resume_mode || append_count > 0;
     
-    // Build the slug from the dataset parameters.
-    dataset_id = std::string(buffer);
-    
-    // Print it to be aware of the destination.
-    std::cout << "CURRENT DATASET: " << dataset_id << std::endl;
+    // When continuing a dataset, every parameter of the run and its progress
+    // come from its last checkpoint.
+    bgq_opengl::CheckpointState checkpoint = bgq_opengl::Checkpoint::create();
+    if (continue_dataset)
+        restoreCheckpoint(checkpoint);
     
-    // Init the variations themselves.
-    if (num_of_joint_angles > 1) {
-        
-        // We will use a uniform distribution, as it makes sense for this kind of problem.
-        std::uniform_real_distribution<float> finger_flexion(-5.0f, 90.0f);
-        std::uniform_real_distribution<float> finger_abduction(-10.0f, 10.0f);
-        std::uniform_real_distribution<float> thumb_flexion(-80.0f, 10.0f);
-        std::uniform_real_distribution<float> thumb_abduction(-30.0f, 30.0f);
-        std::uniform_real_distribution<float> wrist_flexion(-90.0f, 90.0f);
-        std::uniform_real_distribution<float> wrist_abduction(-30.0f, 30.0f);
-        std::uniform_real_distribution<float> wrist_pronation(-60.0f, 60.0f);
-        
-        // Do as many variations as specified.
-        for (unsigned int i = 1; i < num_of_joint_angles; i++) {
-            
-            // Create the variations.
-            std::vector<glm::vec3> new_joint_angle(16, glm::vec3(0.0f));
-            
-            // Generate the rotation for the appropriate angles.
-            new_joint_angle[0] = glm::vec3(wrist_pronation(gen), wrist_flexion(gen), wrist_abduction(gen));
-            new_joint_angle[1] = glm::vec3(0.0f, thumb_abduction(gen), thumb_flexion(gen) / 2.0f);
-            new_joint_angle[2] = glm::vec3(0.0f, 0.0f, thumb_flexion(gen));
-            new_joint_angle[3] = glm::vec3(0.0f, 0.0f, thumb_flexion(gen));
-            new_joint_angle[4] = glm::vec3(0.0f, finger_flexion(gen), finger_abduction(gen));
-            new_joint_angle[5] = glm::vec3(0.0f, finger_flexion(gen), 0.0f);
-            new_joint_angle[6] = glm::vec3(0.0f, finger_flexion(gen), 0.0f);
-            new_joint_angle[7] = glm::vec3(0.0f, finger_flexion(gen), finger_abduction(gen));
-            new_joint_angle[8] = glm::vec3(0.0f, finger_flexion(gen), 0.0f);
-            new_joint_angle[9] = glm::vec3(0.0f, finger_flexion(gen), 0.0f);
-            new_joint_angle[10] = glm::vec3(0.0f, finger_flexion(gen), finger_abduction(gen));
-            new_joint_angle[11] = glm::vec3(0.0f, finger_flexion(gen), 0.0f);
-            new_joint_angle[12] = glm::vec3(0.0f, finger_flexion(gen), 0.0f);
-            new_joint_angle[13] = glm::vec3(0.0f, finger_flexion(gen), finger_abduction(gen));
-            new_joint_angle[14] = glm::vec3(0.0f, finger_flexion(gen), 0.0f);
-            new_joint_angle[15] = glm::vec3(0.0f, finger_flexion(gen), 0.0f);
-            
-            // Push this new configuration into the list.
-            joint_angles.push_back(new_joint_angle);
-            
-        }
+    // When rendering samples again, every parameter of the run comes from the
+    // manifest of the dataset.
+    if (rerender_mode) {
         
-    }
-    
-    // Init the variations themselves.
-    if (num_of_arm_positions > 1) {
+        snprintf(buffer, 256, "%s%s/training_manifest.bin", dataset_path.c_str(), dataset_id.c_str());
+        manifest = new bgq_opengl::SampleManifest(buffer);
         
-        // We will use a uniform distribution, as it makes sense for this kind of problem.
-        std::uniform_real_distribution<float> dist_x(-0.3, 0.3);
-        std::uniform_real_distribution<float> dist_y(-0.3, 0.5);
-        std::uniform_real_distribution<float> dist_z(-0.4, 0.4);
+        bgq_opengl::ManifestHeader header = manifest->getHeader();
+        dataset_seed = header.seed;
+        num_of_joint_angles = header.num_of_variations[0];
+        num_of_arm_positions = header.num_of_variations[1];
+        num_of_arm_rotations = header.num_of_variations[2];
+        num_of_skin_tones = header.num_of_variations[3];
+        num_of_lighting = header.num_of_variations[4];
+        num_of_shininess = header.num_of_variations[5];
+        num_of_backgrounds = header.num_of_variations[6];
+        num_of_camera_params = header.num_of_camera_params;
+        num_of_composites = header.num_of_composites;
+        dataset_size = header.dataset_size;
+        window_width = header.window_width;
+        window_height = header.window_height;
+        image_codec = header.image_codec;
+        background_mode = header.background_mode;
+        mosaic_images = header.mosaic_images;
+        resample_filter = header.resample_filter;
+        num_of_augmentations = header.num_of_augmentations;
+        sensor_effects = header.sensor_effects;
+        heatmap_size = header.heatmap_size;
+        heatmap_type = header.heatmap_type;
         
-        // Do as many variations as specified.
-        for (unsigned int i = 1; i < num_of_arm_positions; i++) {
-            
-            arm_positions.push_back(glm::vec3(dist_x(gen), dist_y(gen), dist_z(gen)));
-            
+        for (int i = 0; i < MAX_OUTPUT_LEVELS && header.output_widths[i] > 0; i++)
+            output_widths.push_back(header.output_widths[i]);
+        
+        // The samples are written again as loose files, which the readers of
+        // shards never see and a stream does not keep.
+        if (header.output_format != OUTPUT_LOOSE_FILES) {
+            std::cerr << "Only datasets stored as loose image files can be rendered again, " << dataset_path << dataset_id << " is stored as shards or was streamed." << std::endl;
+            exit(1);
         }
         
     }
     
-    // Init the variations themselves.
-    if (num_of_arm_rotations > 1) {
-        
-        // We will use a uniform distribution, as it makes sense for this kind of problem.
-        std::uniform_real_distribution<float> dist_angle(-90.0f, 90.0f);
-        
-        // Do as many variations as specified.
-        for (unsigned int i = 1; i < num_of_arm_rotations; i++) {
-
-            arm_rotations.push_back(glm::vec3(dist_angle(gen), dist_angle(gen), dist_angle(gen)));
-            
-        }
-        
+    // Get the smaller copies of a new dataset.
+    if (!rerender_mode && !continue_dataset && !parseOutputSizes(output_sizes, output_widths)) {
+        std::cerr << "Invalid list of output sizes, at most " << MAX_OUTPUT_LEVELS << " are allowed: " << output_sizes << std::endl;
+        exit(1);
     }
     
-    // Init the skin tones.
-    if (num_of_skin_tones > 1) {
-        
-        // We will use a uniform distribution, as it makes sense for this kind of problem.
-        std::uniform_real_distribution<float> dist_skin(0.05f, 2.0f);
-        
-        // Do as many variations as specified.
-        for (unsigned int i = 1; i < num_of_skin_tones; i++) {
-
-            skin_tones.push_back(dist_skin(gen));
-            
-        }
-        
+    // Draw a seed for the dataset unless one has been specified.
+    if (dataset_seed == 0)
+        dataset_seed = ((uint64_t) rd() << 32) | rd();
+    
+    // Create the sampler. All the variations are derived from the seed on
+    // demand, so there are no tables to build here.
+    sampler = new bgq_opengl::VariationSampler(dataset_seed);
+    
+    // Store the size of each of the tables.
+    num_of_variations.joint_angles = num_of_joint_angles;
+    num_of_variations.arm_position = num_of_arm_positions;
+    num_of_variations.arm_rotation = num_of_arm_rotations;
+    num_of_variations.skin_tone = num_of_skin_tones;
+    num_of_variations.lighting = num_of_lighting;
+    num_of_variations.shininess = num_of_shininess;
+    num_of_variations.background = num_of_backgrounds;
+    
+    // Build the slug from the dataset parameters, unless we are working on
+    // an existing dataset.
+    if (!rerender_mode && !continue_dataset) {
+        snprintf(buffer, 256, "%i_%i_%i_%i_%i_%i_%i_%i_%i", num_of_joint_angles, num_of_arm_positions, num_of_arm_rotations, num_of_skin_tones, num_of_lighting, num_of_shininess, num_of_backgrounds, num_of_camera_params, dataset_size);
+        dataset_id = std::string(buffer);
     }
     
-    // Init the lighting.
-    if (num_of_lighting > 1) {
+    // Print it to be aware of the destination.
+    std::cout << "CURRENT DATASET: " << dataset_id << std::endl;
+    std::cout << "DATASET SEED: " << dataset_seed << std::endl;
+    
+    // Keep only the samples that the manifest knows about.
+    if (rerender_mode) {
         
-        // We will use a uniform distribution, as it makes sense for this kind of problem.
-        std::uniform_real_distribution<float> dist_light_pos(-5.0f, 5.0f);
-        std::uniform_real_distribution<float> dist_light_intensity(5.0, 40.0f);
-
-        // Do as many variations as specified.
-        for (unsigned int i = 1; i < num_of_lighting; i++) {
-
-            glm::vec3 light_pos(dist_light_pos(gen), dist_light_pos(gen), dist_light_pos(gen));
-            light_variations.push_back(bgq_opengl::Light(light_pos, glm::vec4(1.0f, 1.0f, 1.0f, 1.0f),
-                                                         dist_light_intensity(gen)));
-            
-        }
+        std::vector<int> recorded_frames;
+        bgq_opengl::VariationIndices indices;
         
-    }
-    
-    // Init the skin tones.
-    if (num_of_shininess > 1) {
+        for (int id : rerender_frames) {
+            if (manifest->read(id, indices))
+                recorded_frames.push_back(id);
+            else
+                std::cerr << "Sample " << id << " is not in the manifest, skipping it." << std::endl;
+        }
         
-        // We will use a uniform distribution, as it makes sense for this kind of problem.
-        std::uniform_real_distribution<float> dist_shin(1.0f, 50.0f);
+        rerender_frames = recorded_frames;
         
-        // Do as many variations as specified.
-        for (unsigned int i = 1; i < num_of_shininess; i++) {
-
-            shine_variations.push_back(dist_shin(gen));
-            
+        if (rerender_frames.empty()) {
+            std::cerr << "None of the samples can be rendered again." << std::endl;
+            exit(1);
         }
         
-    }
-    
-    // Init the skin tones.
-    if (num_of_backgrounds > 1) {
+        std::cout << "RENDERING AGAIN: " << rerender_frames.size() << " samples" << std::endl;
         
-        // We will use a uniform distribution, as it makes sense for this kind of problem.
-        std::uniform_int_distribution<int> get_image(0, 14042);
+        initOutputLevels(checkpoint, continue_dataset);
         
-        // Do as many variations as specified.
-        for (unsigned int i = 0; i < num_of_backgrounds; i++) {
-
-            background_indices.push_back(get_image(gen));
-            
-        }
+        return;
         
     }
       
@@ -711,158 +930,1342 @@ void initVariations() {
     snprintf(buffer, 256, "mkdir -p %s%s/training/rgb", dataset_path.c_str(), dataset_id.c_str());
     system(buffer);
     
-    // Create the file for the annotations.
-    snprintf(buffer, 256, "%s%s/training_xyz.json", dataset_path.c_str(), dataset_id.c_str());
-    annotations_file.open(buffer, std::ofstream::out | std::ofstream::trunc);
-    annotations_file << "["; // Write the start of the json.
-    
-    // Create the file for the k_matrices.
-    snprintf(buffer, 256, "%s%s/training_K.json", dataset_path.c_str(), dataset_id.c_str());
-    k_matrices_file.open(buffer, std::ofstream::out | std::ofstream::trunc);
-    k_matrices_file << "["; // Write the start of the json.
-
-}
-
-void saveImage(char* filepath, GLFWwindow* save_window) {
-    
-    // Get the information from the window.
-    int img_width, img_height;
-    glfwGetFramebufferSize(save_window, &img_width, &img_height);
-    GLsizei img_channels = 3;
-    
-    // Calculate the strides of the image.
-    GLsizei stride = img_channels * img_width;
-    stride += (stride % 4) ? (4 - stride % 4) : 0;
- 
-    // The buffer that will be used for the image.
-    GLsizei buffer_size = stride * img_height;
-    std::vector<char> img_buffer(buffer_size);
- 
-    // Read the pixels into the buffer.
-    glPixelStorei(GL_PACK_ALIGNMENT, 4);
-    glReadBuffer(GL_FRONT);
-    glReadPixels(0, 0, img_width, img_height, GL_RGB, GL_UNSIGNED_BYTE, img_buffer.data());
- 
-    // Write the buffer into the file.
-    stbi_flip_vertically_on_write(true);
-    stbi_write_png(filepath, img_width, img_height, img_channels, img_buffer.data(), stride);
-
-}
-
-void storeDataToDataset() {
+    // Prepare the shards, if the images go into them.
+    if (output_format == OUTPUT_TAR_SHARDS) {
         
-    // Store the image.
-    char file_path[256];
-    snprintf(file_path, 256, "%s%s/training/rgb/tmp_%08i.png", dataset_path.c_str(), dataset_id.c_str(), frame_count);
-    saveImage(file_path, window);
-    
-    // Convert the image to jpg.
-    char buffer[512];
-    snprintf(buffer, 512, "sips -s format jpeg %s%s/training/rgb/tmp_%08i.png --out %s%s/training/rgb/%08i.jpg", dataset_path.c_str(), dataset_id.c_str(), frame_count, dataset_path.c_str(), dataset_id.c_str(), frame_count);
-    system(buffer);
-    
-    // Delete the tmp png.
-    snprintf(buffer, 512, "rm %s%s/training/rgb/tmp_%08i.png", dataset_path.c_str(), dataset_id.c_str(), frame_count);
-    system(buffer);
-    
-    // Now we're gonna calculate, for each keypoints, their coordinates and matrixes.
-    glm::mat4 mvp_matrix = camera->getProjection() * camera->getView();
-    
-    // For each keypoint, do that.
-    annotations_file << "[";
-    for (unsigned int i = 0; i < keypoints.size(); i++) {
+        snprintf(buffer, 256, "mkdir -p %s%s/training/shards", dataset_path.c_str(), dataset_id.c_str());
+        system(buffer);
+        
+        snprintf(buffer, 256, "%s%s/training/shards", dataset_path.c_str(), dataset_id.c_str());
+        shard_writer = new bgq_opengl::ShardWriter(buffer, samples_per_shard, checkpoint.images.num_of_shards);
+        if (continue_dataset)
+            checkShards(shard_writer->restore(checkpoint.images), checkpoint, buffer);
         
-        // Calculate its homogeneous coordinates.
-        glm::vec4 homogeneous_keypoint = mvp_matrix * glm::vec4(keypoints[i], 1.0f);
+    }
+    
+    // Prepare the tensor shards, if the images go into them.
+    if (output_format == OUTPUT_TENSOR_SHARDS) {
         
-        // Transform to clipping space.
-        glm::vec3 clip_keypoint = glm::vec3(homogeneous_keypoint) / homogeneous_keypoint.w;
+        snprintf(buffer, 256, "mkdir -p %s%s/training/tensors", dataset_path.c_str(), dataset_id.c_str());
+        system(buffer);
         
-        // Transform them to pixel coordinates.
-        glm::vec3 annotation;
-        annotation.x = (clip_keypoint.x + 1.0f) / 2.0f * window_width;
-        annotation.y = (-clip_keypoint.y + 1.0f) / 2.0f * window_height;
-        annotation.z = 1.0f;
+        std::vector<int> shape = {window_height, window_width, 3};
+        if (tensor_layout == TENSOR_NCHW)
+            shape = {3, window_height, window_width};
         
-        // Put these contents into a buffer and print them.
-        snprintf(buffer, 512, "[%f, %f, %f], ", annotation.x, annotation.y, annotation.z);
-        annotations_file << std::string(buffer);
+        snprintf(buffer, 256, "%s%s/training/tensors", dataset_path.c_str(), dataset_id.c_str());
+        tensor_writer = new bgq_opengl::TensorShardWriter(buffer, "rgb", samples_per_shard, shape, bgq_opengl::TENSOR_UINT8, checkpoint.images.num_of_shards, bypass_page_cache);
+        if (continue_dataset)
+            checkShards(tensor_writer->restore(checkpoint.images), checkpoint, buffer);
         
     }
     
-    // Go back one position to remove the last comma printed.
-    long pos = annotations_file.tellp();
-    annotations_file.seekp(pos - 2);
-    annotations_file << "], ";
-    
-    // Do the same for the k_matrices.
-    k_matrices_file << "[[1.0, 0.0, 0.0], [0.0, 1.0, 0.0], [0.0, 0.0, 1.0]], ";
-
-}
-
-void updateScene() {
-    
-    glfwMakeContextCurrent(window);
+    // Open the stream, if the samples go straight to a trainer. Samples
+    // rendered again are written as loose files, like in any other format.
+    bool streaming = output_format == OUTPUT_SHARED_MEMORY && !rerender_mode;
+    if (streaming) {
         
-    // Reset the transformations to not apply them on top.
-    hand->resetTransforms();
-    
-    // Obtain the original bounding box of the hand.
-    bgq_opengl::BoundingBox bb = hand->getBoundingBox();
-    
-    // Obtain the center and sizes of the bounding box.
-    glm::vec3 center = (bb.min + bb.max) * 0.5f;
-    glm::vec3 size = (bb.max - bb.min);
-    float size_max = std::max(std::max(size.x, size.y), size.z);
-    float scaling_factor = 1.0f / size_max;
-    
-    // Move the hand to center it.
-    hand->translate(-center.x, -center.y, -center.z);
-    
-    // Scale it to normalise its displacements.
-    hand->scale(scaling_factor, scaling_factor, scaling_factor);
-
-    // Rotate it to obtain the right configuration.
-    hand->rotate(1.0f, 0.0f, 0.0f, -90.0f);
+        sample_stream = new bgq_opengl::SampleStream(stream_name.c_str(), stream_slots, window_width, window_height, NUM_OF_KEYPOINTS, heatmap_size, heatmap_type);
+        
+        std::cout << "STREAM: " << stream_name << ", " << stream_slots << " slots" << std::endl;
+        
+    }
     
-    // Select and apply orientation.
-    std::uniform_int_distribution<int> var_orientation(0, num_of_arm_rotations - 1);
-    int sel_var_orientation = var_orientation(gen);
+    // Prepare the heatmap shards, whatever the format of the images. They get
+    // the same samples as the images, so they have as many shards. When
+    // streaming, the heatmaps go with the samples instead.
+    if (heatmap_size > 0) {
+        
+        heatmap_renderer = new bgq_opengl::HeatmapRenderer(NUM_OF_KEYPOINTS, heatmap_size, window_width, window_height, HEATMAP_SIGMA, HEATMAP_RADIUS, (bgq_opengl::TensorType) heatmap_type);
+        
+        if (!streaming) {
+            
+            snprintf(buffer, 256, "mkdir -p %s%s/training/heatmaps", dataset_path.c_str(), dataset_id.c_str());
+            system(buffer);
+            
+            snprintf(buffer, 256, "%s%s/training/heatmaps", dataset_path.c_str(), dataset_id.c_str());
+            heatmap_writer = new bgq_opengl::TensorShardWriter(buffer, "heatmaps", samples_per_shard, heatmap_renderer->getShape(), (bgq_opengl::TensorType) heatmap_type, checkpoint.heatmaps.num_of_shards, bypass_page_cache);
+            if (continue_dataset)
+                checkShards(heatmap_writer->restore(checkpoint.heatmaps), checkpoint, buffer);
+            
+        }
+        
+        std::cout << "HEATMAPS: " << heatmap_size << "x" << heatmap_size << " (" << bgq_opengl::HeatmapRenderer::getInstructionSet() << ")" << std::endl;
+        
+    }
     
-    // Rotate the hand.
-    hand->rotate(1.0, 0.0, 0.0, arm_rotations[sel_var_orientation].x);
-    hand->rotate(0.0, 1.0, 0.0, arm_rotations[sel_var_orientation].y);
-    hand->rotate(0.0, 0.0, 1.0, arm_rotations[sel_var_orientation].z);
-
-    // Select and apply position.
-    std::uniform_int_distribution<int> var_position(0, num_of_arm_positions - 1);
-    int sel_var_position = var_position(gen);
+    // Materialise and export the variation tables if requested.
+    if (export_variation_tables) {
+        
+        // Along with the tables, export whatever else this run will draw,
+        // as it is decided when the run starts.
+        bgq_opengl::VariationTableRun run;
+        run.width = window_width;
+        run.height = window_height;
+        run.num_of_views = num_of_camera_params;
+        run.num_of_renders = dataset_size * num_of_camera_params;
+        run.num_of_composites = (store_dataset && num_of_composites > 1) ? num_of_composites : 0;
+        run.num_of_backgrounds = num_of_backgrounds;
+        run.num_of_augmentations = store_dataset ? num_of_augmentations : 0;
+        run.procedural_backgrounds = (background_mode == BACKGROUND_PROCEDURAL);
+        run.mosaic_images = (background_mode == BACKGROUND_MOSAIC) ? mosaic_images : 0;
+        run.sensor_effects = store_dataset && sensor_effects != 0 && run.num_of_composites == 0;
         
-    // Move the hand to center it.
-    hand->translate(arm_positions[sel_var_position].x, arm_positions[sel_var_position].y, arm_positions[sel_var_position].z);
+        bgq_opengl::VariationTable table(*sampler, num_of_variations, BACKGROUND_POOL_SIZE, run);
+        
+        snprintf(buffer, 256, "%s%s/variation_tables.bin", dataset_path.c_str(), dataset_id.c_str());
+        if (!table.save(buffer))
+            std::cerr << "Could not export the variation tables to " << buffer << std::endl;
+        else
+            checkVariationTables(buffer, run);
+        
+    }
     
-    // Reset the joints.
-    hand->resetBones();
+    // Create the arrays for the annotations and the k_matrices. Every view of
+    // every frame has its own fixed slot in them. The samples of a dataset that is being
+    // continued are kept.
+    snprintf(buffer, 256, "%s%s/training_xyz.npy", dataset_path.c_str(), dataset_id.c_str());
+    annotations_store = new bgq_opengl::AnnotationStore(buffer, dataset_size * getSamplesPerFrame(), NUM_OF_KEYPOINTS, 3, continue_dataset);
     
-    // Select and apply joint angles.
-    std::uniform_int_distribution<int> var_joint_angles(0, num_of_joint_angles - 1);
-    int sel_var_joint_angles = var_joint_angles(gen);
+    snprintf(buffer, 256, "%s%s/training_K.npy", dataset_path.c_str(), dataset_id.c_str());
+    k_matrices_store = new bgq_opengl::AnnotationStore(buffer, dataset_size * getSamplesPerFrame(), 3, 3, continue_dataset);
     
-    // Iterate through the relevant bones mapped in the variable.
-    for (int i = (int) name_joint_mapping.size() - 1; i >= 0; i--) {
+    // Create the json files too, if requested.
+    if (store_json_annotations) {
+        
+        // Create the file for the annotations.
+        snprintf(buffer, 256, "%s%s/training_xyz.json", dataset_path.c_str(), dataset_id.c_str());
+        if (continue_dataset)
+            annotations_file = new bgq_opengl::AnnotationWriter(buffer, checkpoint.annotations_json_size);
+        else
+            annotations_file = new bgq_opengl::AnnotationWriter(buffer);
         
-        hand->rotateBone(name_joint_mapping[i], 1.0f, 0.0f, 0.0f, joint_angles[sel_var_joint_angles][i].x);
-        hand->rotateBone(name_joint_mapping[i], 0.0f, 1.0f, 0.0f, joint_angles[sel_var_joint_angles][i].y);
-        hand->rotateBone(name_joint_mapping[i], 0.0f, 0.0f, 1.0f, joint_angles[sel_var_joint_angles][i].z);
+        // Create the file for the k_matrices.
+        snprintf(buffer, 256, "%s%s/training_K.json", dataset_path.c_str(), dataset_id.c_str());
+        if (continue_dataset)
+            k_matrices_file = new bgq_opengl::AnnotationWriter(buffer, checkpoint.k_matrices_json_size);
+        else
+            k_matrices_file = new bgq_opengl::AnnotationWriter(buffer);
         
     }
     
+    // Prepare the smaller copies of the images.
+    initOutputLevels(checkpoint, continue_dataset);
+    
+    // Create the manifest, recording everything needed to render any of the
+    // samples again.
+    bgq_opengl::ManifestHeader header = bgq_opengl::SampleManifest::createHeader();
+    header.seed = dataset_seed;
+    header.num_of_variations[0] = num_of_joint_angles;
+    header.num_of_variations[1] = num_of_arm_positions;
+    header.num_of_variations[2] = num_of_arm_rotations;
+    header.num_of_variations[3] = num_of_skin_tones;
+    header.num_of_variations[4] = num_of_lighting;
+    header.num_of_variations[5] = num_of_shininess;
+    header.num_of_variations[6] = num_of_backgrounds;
+    header.num_of_camera_params = num_of_camera_params;
+    header.num_of_composites = num_of_composites;
+    header.background_mode = background_mode;
+    header.mosaic_images = mosaic_images;
+    header.resample_filter = resample_filter;
+    header.num_of_augmentations = num_of_augmentations;
+    header.sensor_effects = sensor_effects;
+    header.heatmap_size = heatmap_size;
+    header.heatmap_type = heatmap_type;
+    header.output_format = output_format;
+    for (size_t i = 0; i < output_widths.size(); i++)
+        header.output_widths[i] = output_widths[i];
+    header.dataset_size = dataset_size;
+    header.window_width = window_width;
+    header.window_height = window_height;
+    header.image_codec = image_codec;
+    
+    snprintf(buffer, 256, "%s%s/training_manifest.bin", dataset_path.c_str(), dataset_id.c_str());
+    if (continue_dataset) {
+        manifest = new bgq_opengl::SampleManifest(buffer);
+        manifest->setHeader(header);
+    } else {
+        manifest = new bgq_opengl::SampleManifest(buffer, header);
+    }
+
 }
 
-int main(int argc, char** argv) {
-    
-    // Initialise the environment.
-    initInterface();
+void checkVariationTables(const char* filename, const bgq_opengl::VariationTableRun &run) {
+    
+    // Read the tables back and compare the first batch of frames with what
+    // the renderer draws for them. The values are stored as halves, so they
+    // only match up to their precision.
+    bgq_opengl::VariationTable table(filename);
+    int num_of_frames = std::min(std::max(batch_size, 1), dataset_size);
+    bool matches = table.getSeed() == dataset_seed;
+    
+    // The poses of the frames.
+    std::vector<int> poses;
+    for (int i = 0; i < num_of_frames; i++)
+        poses.push_back(sampler->selectVariations(i, num_of_variations, appearance_variants).joint_angles);
+    
+    std::vector<glm::vec3> angles;
+    table.gatherJointAngles(poses, angles);
+    
+    for (int i = 0; i < num_of_frames; i++) {
+        std::vector<glm::vec3> expected = sampler->getJointAngles(poses[i]);
+        for (int j = 0; j < NUM_OF_JOINTS * 3; j++) {
+            float angle = angles[i * NUM_OF_JOINTS + j / 3][j % 3];
+            matches = matches && std::abs(angle - expected[j / 3][j % 3]) <= std::abs(expected[j / 3][j % 3]) / 1024.0f + 0.0001f;
+        }
+    }
+    
+    // And the backgrounds composited over each of their samples.
+    if (run.num_of_composites > 0 && table.getNumOfRows(bgq_opengl::TABLE_COMPOSITES) != run.num_of_renders * run.num_of_composites) {
+        
+        matches = false;
+        
+    } else if (run.num_of_composites > 0) {
+        
+        std::vector<int> samples;
+        for (int i = 0; i < num_of_frames * run.num_of_views * run.num_of_composites; i++)
+            samples.push_back(i);
+        
+        std::vector<bgq_opengl::BackgroundCrop> crops;
+        table.gatherCrops(bgq_opengl::TABLE_COMPOSITES, samples, crops);
+        
+        for (size_t i = 0; i < samples.size(); i++) {
+            bgq_opengl::BackgroundCrop expected = sampler->getBackgroundCrop(samples[i], num_of_backgrounds, BACKGROUND_POOL_SIZE);
+            matches = matches && crops[i].image == expected.image && crops[i].flip == expected.flip &&
+                      std::abs(crops[i].scale - expected.scale) <= expected.scale / 1024.0f &&
+                      std::abs(crops[i].offset_x - expected.offset_x) <= 1.0f / 1024.0f &&
+                      std::abs(crops[i].offset_y - expected.offset_y) <= 1.0f / 1024.0f;
+        }
+        
+    }
+    
+    if (!matches)
+        std::cerr << "The variation tables exported to " << filename << " do not match the run." << std::endl;
+    
+}
+
+void restoreCheckpoint(bgq_opengl::CheckpointState &checkpoint) {
+    
+    char buffer[256];
+    
+    // Load the checkpoint.
+    snprintf(buffer, 256, "%s%s/checkpoint.bin", dataset_path.c_str(), dataset_id.c_str());
+    if (!bgq_opengl::Checkpoint::load(buffer, checkpoint)) {
+        std::cerr << "Could not load a valid checkpoint from " << buffer << std::endl;
+        exit(1);
+    }
+    
+    // Restore the parameters of the run.
+    dataset_seed = checkpoint.seed;
+    num_of_joint_angles = checkpoint.num_of_variations[0];
+    num_of_arm_positions = checkpoint.num_of_variations[1];
+    num_of_arm_rotations = checkpoint.num_of_variations[2];
+    num_of_skin_tones = checkpoint.num_of_variations[3];
+    num_of_lighting = checkpoint.num_of_variations[4];
+    num_of_shininess = checkpoint.num_of_variations[5];
+    num_of_backgrounds = checkpoint.num_of_variations[6];
+    num_of_camera_params = checkpoint.num_of_camera_params;
+    appearance_variants = checkpoint.appearance_variants;
+    num_of_composites = checkpoint.num_of_composites;
+    dataset_size = checkpoint.dataset_size;
+    window_width = checkpoint.window_width;
+    window_height = checkpoint.window_height;
+    output_format = checkpoint.output_format;
+    tensor_layout = checkpoint.tensor_layout;
+    samples_per_shard = checkpoint.samples_per_shard;
+    store_json_annotations = checkpoint.store_json_annotations != 0;
+    resample_filter = checkpoint.resample_filter;
+    num_of_augmentations = checkpoint.num_of_augmentations;
+    sensor_effects = checkpoint.sensor_effects;
+    heatmap_size = checkpoint.heatmap_size;
+    heatmap_type = checkpoint.heatmap_type;
+    
+    for (int i = 0; i < MAX_OUTPUT_LEVELS && checkpoint.output_widths[i] > 0; i++)
+        output_widths.push_back(checkpoint.output_widths[i]);
+    
+    // Check that the outputs of the checkpoint are all there.
+    snprintf(buffer, 256, "%s%s/training_manifest.bin", dataset_path.c_str(), dataset_id.c_str());
+    bgq_opengl::SampleManifest existing_manifest(buffer);
+    bgq_opengl::ManifestHeader header = existing_manifest.getHeader();
+    existing_manifest.close();
+    image_codec = header.image_codec;
+    background_mode = header.background_mode;
+    mosaic_images = header.mosaic_images;
+    
+    if (header.seed != checkpoint.seed || header.dataset_size != checkpoint.dataset_size) {
+        std::cerr << "The manifest does not match the checkpoint." << std::endl;
+        exit(1);
+    }
+    
+    // The arrays must hold the annotations of every sample of the checkpoint,
+    // in the dataset and in every level of the output pyramid. The shards
+    // are checked when their writers are created.
+    size_t num_of_samples = (size_t) checkpoint.frame_count * getSamplesPerFrame();
+    
+    std::vector<std::string> directories = {""};
+    for (int output_width : output_widths) {
+        snprintf(buffer, 256, "/%ix%i", output_width, getOutputHeight(output_width));
+        directories.push_back(buffer);
+    }
+    
+    std::vector<std::pair<std::string, size_t>> arrays;
+    for (const std::string &directory : directories) {
+        arrays.push_back({directory + "/training_xyz.npy", NUM_OF_KEYPOINTS * 3});
+        arrays.push_back({directory + "/training_K.npy", 9});
+    }
+    
+    for (const std::pair<std::string, size_t> &array : arrays) {
+        std::error_code error;
+        uintmax_t size = std::filesystem::file_size(dataset_path + dataset_id + array.first, error);
+        if (error || size < ANNOTATION_STORE_HEADER_SIZE + num_of_samples * array.second * sizeof(float)) {
+            std::cerr << "The output " << array.first << " does not hold every sample of the checkpoint." << std::endl;
+            exit(1);
+        }
+    }
+    
+    // And the last loose image must be there.
+    if (output_format == OUTPUT_LOOSE_FILES && checkpoint.frame_count > 0) {
+        snprintf(buffer, 256, "/training/rgb/%08i.%s", (int) num_of_samples - 1, bgq_opengl::ImageEncoder::getExtension(image_codec));
+        if (!std::filesystem::exists(dataset_path + dataset_id + buffer)) {
+            std::cerr << "The output " << buffer << " of the checkpoint is missing." << std::endl;
+            exit(1);
+        }
+    }
+    
+    // Continue from the last frame that was completely written.
+    if (resume_mode) {
+        
+        if (checkpoint.finished) {
+            std::cout << "The dataset is already complete." << std::endl;
+            exit(0);
+        }
+        
+        frame_count = checkpoint.frame_count;
+        
+    } else {
+        
+        if (!checkpoint.finished) {
+            std::cerr << "The dataset is unfinished, resume it before extending it." << std::endl;
+            exit(1);
+        }
+        
+        frame_count = dataset_size;
+        dataset_size += append_count;
+        
+    }
+    
+    std::cout << "CONTINUING FROM FRAME: " << frame_count << std::endl;
+    
+}
+
+void checkShards(int num_of_samples, const bgq_opengl::CheckpointState &checkpoint, const char* directory) {
+    
+    if (num_of_samples != checkpoint.frame_count * getSamplesPerFrame()) {
+        std::cerr << "The shards in " << directory << " do not match the checkpoint." << std::endl;
+        exit(1);
+    }
+    
+}
+
+bool syncOutputs() {
+    
+    // Every output is synced even if one fails, but any failure means the
+    // checkpoint would point past what is on the disk.
+    bool success = true;
+    
+    if (!manifest->sync())
+        success = false;
+    
+    if (!annotations_store->sync())
+        success = false;
+    
+    if (!k_matrices_store->sync())
+        success = false;
+    
+    if (store_json_annotations && !annotations_file->sync())
+        success = false;
+    
+    if (store_json_annotations && !k_matrices_file->sync())
+        success = false;
+    
+    // The open shards are kept open, so their size does not depend on how
+    // often the checkpoints are saved.
+    if (shard_writer != nullptr && !shard_writer->sync())
+        success = false;
+    
+    if (tensor_writer != nullptr && !tensor_writer->sync())
+        success = false;
+    
+    if (heatmap_writer != nullptr && !heatmap_writer->sync())
+        success = false;
+    
+    for (bgq_opengl::OutputLevel &level : output_levels) {
+        
+        if (!level.annotations_store->sync())
+            success = false;
+        
+        if (!level.k_matrices_store->sync())
+            success = false;
+        
+        if (level.shard_writer != nullptr && !level.shard_writer->sync())
+            success = false;
+        
+        if (level.tensor_writer != nullptr && !level.tensor_writer->sync())
+            success = false;
+        
+    }
+    
+    return success;
+    
+}
+
+bool closeOutputs() {
+    
+    bool success = true;
+    
+    // Close the manifest.
+    if (!manifest->sync()) {
+        std::cerr << "Could not sync the manifest." << std::endl;
+        success = false;
+    }
+    manifest->close();
+    
+    // Finish the last shard.
+    if (shard_writer != nullptr && !shard_writer->close()) {
+        std::cerr << "Could not finalise the shards." << std::endl;
+        success = false;
+    }
+    
+    // Finish the last tensor shard.
+    if (tensor_writer != nullptr && !tensor_writer->close()) {
+        std::cerr << "Could not finalise the tensor shards." << std::endl;
+        success = false;
+    }
+    
+    // And the last heatmap shard.
+    if (heatmap_writer != nullptr && !heatmap_writer->close()) {
+        std::cerr << "Could not finalise the heatmap shards." << std::endl;
+        success = false;
+    }
+    
+    // Sync the binary arrays.
+    if (!annotations_store->close()) {
+        std::cerr << "Could not sync the annotations store." << std::endl;
+        success = false;
+    }
+    
+    if (!k_matrices_store->close()) {
+        std::cerr << "Could not sync the k_matrices store." << std::endl;
+        success = false;
+    }
+    
+    // Finish the levels of the output pyramid.
+    for (bgq_opengl::OutputLevel &level : output_levels) {
+        
+        if (level.shard_writer != nullptr && !level.shard_writer->close()) {
+            std::cerr << "Could not finalise the shards of " << level.directory << std::endl;
+            success = false;
+        }
+        
+        if (level.tensor_writer != nullptr && !level.tensor_writer->close()) {
+            std::cerr << "Could not finalise the tensor shards of " << level.directory << std::endl;
+            success = false;
+        }
+        
+        if (!level.annotations_store->close() || !level.k_matrices_store->close()) {
+            std::cerr << "Could not sync the annotations of " << level.directory << std::endl;
+            success = false;
+        }
+        
+    }
+    
+    // Check if the json files are being produced too.
+    if (!store_json_annotations)
+        return success;
+    
+    // Close the arrays and move the files to their final names.
+    if (!annotations_file->close()) {
+        std::cerr << "Could not finalise the annotations file." << std::endl;
+        success = false;
+    }
+    
+    if (!k_matrices_file->close()) {
+        std::cerr << "Could not finalise the k_matrices file." << std::endl;
+        success = false;
+    }
+    
+    return success;
+    
+}
+
+void saveCheckpoint() {
+    
+    bgq_opengl::CheckpointState checkpoint = bgq_opengl::Checkpoint::create();
+    
+    // Store where every shard writer is, so that the shards they left open
+    // can be reopened.
+    if (shard_writer != nullptr)
+        checkpoint.images = shard_writer->getState();
+    
+    if (tensor_writer != nullptr)
+        checkpoint.images = tensor_writer->getState();
+    
+    if (heatmap_writer != nullptr)
+        checkpoint.heatmaps = heatmap_writer->getState();
+    
+    for (size_t i = 0; i < output_levels.size(); i++) {
+        
+        if (output_levels[i].shard_writer != nullptr)
+            checkpoint.output_levels[i] = output_levels[i].shard_writer->getState();
+        
+        if (output_levels[i].tensor_writer != nullptr)
+            checkpoint.output_levels[i] = output_levels[i].tensor_writer->getState();
+        
+    }
+    
+    // Store the state of the run.
+    checkpoint.seed = dataset_seed;
+    checkpoint.frame_count = frame_count;
+    checkpoint.dataset_size = dataset_size;
+    checkpoint.num_of_variations[0] = num_of_joint_angles;
+    checkpoint.num_of_variations[1] = num_of_arm_positions;
+    checkpoint.num_of_variations[2] = num_of_arm_rotations;
+    checkpoint.num_of_variations[3] = num_of_skin_tones;
+    checkpoint.num_of_variations[4] = num_of_lighting;
+    checkpoint.num_of_variations[5] = num_of_shininess;
+    checkpoint.num_of_variations[6] = num_of_backgrounds;
+    checkpoint.num_of_camera_params = num_of_camera_params;
+    checkpoint.appearance_variants = appearance_variants;
+    checkpoint.num_of_composites = num_of_composites;
+    checkpoint.window_width = window_width;
+    checkpoint.window_height = window_height;
+    checkpoint.output_format = output_format;
+    checkpoint.tensor_layout = tensor_layout;
+    checkpoint.samples_per_shard = samples_per_shard;
+    checkpoint.store_json_annotations = store_json_annotations;
+    checkpoint.resample_filter = resample_filter;
+    checkpoint.num_of_augmentations = num_of_augmentations;
+    checkpoint.sensor_effects = sensor_effects;
+    checkpoint.heatmap_size = heatmap_size;
+    checkpoint.heatmap_type = heatmap_type;
+    for (size_t i = 0; i < output_widths.size(); i++)
+        checkpoint.output_widths[i] = output_widths[i];
+    checkpoint.finished = frame_count >= dataset_size;
+    
+    if (store_json_annotations) {
+        checkpoint.annotations_json_size = annotations_file->getSize();
+        checkpoint.k_matrices_json_size = k_matrices_file->getSize();
+    }
+    
+    char buffer[256];
+    snprintf(buffer, 256, "%s%s/checkpoint.bin", dataset_path.c_str(), dataset_id.c_str());
+    if (!bgq_opengl::Checkpoint::save(buffer, checkpoint))
+        std::cerr << "Could not save the checkpoint to " << buffer << std::endl;
+    
+}
+
+void initOutputLevels(const bgq_opengl::CheckpointState &checkpoint, bool continue_dataset) {
+    
+    char buffer[256];
+    
+    // The stream only carries the images at the size they are rendered at.
+    if (sample_stream != nullptr) {
+        if (!output_widths.empty())
+            std::cerr << "The smaller copies are not streamed, ignoring them." << std::endl;
+        output_widths.clear();
+        return;
+    }
+    
+    for (int output_width : output_widths) {
+        
+        // Every level is a dataset of its own, next to the training dir.
+        bgq_opengl::OutputLevel level;
+        level.width = output_width;
+        level.height = getOutputHeight(output_width);
+        snprintf(buffer, 256, "%s%s/%ix%i", dataset_path.c_str(), dataset_id.c_str(), level.width, level.height);
+        level.directory = buffer;
+        level.resampler = new bgq_opengl::Resampler(window_width, window_height, level.width, level.height, (bgq_opengl::ResampleFilter) resample_filter);
+        
+        std::cout << "SMALLER COPIES: " << level.width << "x" << level.height << std::endl;
+        
+        // Samples rendered again only overwrite their images.
+        if (rerender_mode) {
+            output_levels.push_back(level);
+            continue;
+        }
+        
+        snprintf(buffer, 256, "mkdir -p %s/training/rgb", level.directory.c_str());
+        system(buffer);
+        
+        // The checkpoint keeps the shards of the levels in the same order.
+        const bgq_opengl::ShardState &level_shards = checkpoint.output_levels[output_levels.size()];
+        
+        if (output_format == OUTPUT_TAR_SHARDS) {
+            
+            snprintf(buffer, 256, "mkdir -p %s/training/shards", level.directory.c_str());
+            system(buffer);
+            
+            snprintf(buffer, 256, "%s/training/shards", level.directory.c_str());
+            level.shard_writer = new bgq_opengl::ShardWriter(buffer, samples_per_shard, level_shards.num_of_shards);
+            if (continue_dataset)
+                checkShards(level.shard_writer->restore(level_shards), checkpoint, buffer);
+            
+        }
+        
+        if (output_format == OUTPUT_TENSOR_SHARDS) {
+            
+            snprintf(buffer, 256, "mkdir -p %s/training/tensors", level.directory.c_str());
+            system(buffer);
+            
+            std::vector<int> shape = {level.height, level.width, 3};
+            if (tensor_layout == TENSOR_NCHW)
+                shape = {3, level.height, level.width};
+            
+            snprintf(buffer, 256, "%s/training/tensors", level.directory.c_str());
+            level.tensor_writer = new bgq_opengl::TensorShardWriter(buffer, "rgb", samples_per_shard, shape, bgq_opengl::TENSOR_UINT8, level_shards.num_of_shards, bypass_page_cache);
+            if (continue_dataset)
+                checkShards(level.tensor_writer->restore(level_shards), checkpoint, buffer);
+            
+        }
+        
+        // The keypoints are scaled to the level, the k_matrices are the same.
+        snprintf(buffer, 256, "%s/training_xyz.npy", level.directory.c_str());
+        level.annotations_store = new bgq_opengl::AnnotationStore(buffer, dataset_size * getSamplesPerFrame(), NUM_OF_KEYPOINTS, 3, continue_dataset);
+        
+        snprintf(buffer, 256, "%s/training_K.npy", level.directory.c_str());
+        level.k_matrices_store = new bgq_opengl::AnnotationStore(buffer, dataset_size * getSamplesPerFrame(), 3, 3, continue_dataset);
+        
+        output_levels.push_back(level);
+        
+    }
+    
+}
+
+void setDatasetDirectory(std::string dataset_dir) {
+    
+    // Drop the trailing slashes.
+    while (dataset_dir.size() > 1 && dataset_dir.back() == '/')
+        dataset_dir.pop_back();
+    
+    // Split the directory into the output dir and the dataset id.
+    size_t slash = dataset_dir.find_last_of('/');
+    dataset_path = (slash == std::string::npos) ? "" : dataset_dir.substr(0, slash + 1);
+    dataset_id = dataset_dir.substr(slash + 1);
+    
+}
+
+void parseArguments(int argc, char** argv) {
+    
+    for (int i = 1; i < argc; i++) {
+        
+        std::string argument = argv[i];
+        
+        if (argument == "--rerender") {
+            
+            // Both the dataset and the ids are needed.
+            if (i + 2 >= argc) {
+                std::cerr << "Usage: " << argv[0] << " --rerender <dataset_dir> <frame_ids>" << std::endl;
+                exit(1);
+            }
+            
+            // Get the dataset.
+            setDatasetDirectory(argv[++i]);
+            
+            // Get the samples to render.
+            if (!parseFrameList(argv[++i], rerender_frames)) {
+                std::cerr << "Invalid list of frame ids: " << argv[i] << std::endl;
+                exit(1);
+            }
+            
+            // Start straight away, without waiting for the form.
+            rerender_mode = true;
+            store_dataset = true;
+            export_variation_tables = false;
+            process_running = true;
+            
+        } else if (argument == "--resume" || argument == "--append") {
+            
+            bool append = argument == "--append";
+            
+            // Appending also needs the amount of frames.
+            if (i + (append ? 2 : 1) >= argc) {
+                std::cerr << "Usage: " << argv[0] << " --resume <dataset_dir>" << std::endl;
+                std::cerr << "       " << argv[0] << " --append <dataset_dir> <count>" << std::endl;
+                exit(1);
+            }
+            
+            // Get the dataset.
+            setDatasetDirectory(argv[++i]);
+            
+            if (append) {
+                append_count = atoi(argv[++i]);
+                if (append_count < 1) {
+                    std::cerr << "Invalid amount of frames to append: " << argv[i] << std::endl;
+                    exit(1);
+                }
+            } else {
+                resume_mode = true;
+            }
+            
+            // Start straight away, without waiting for the form.
+            store_dataset = true;
+            export_variation_tables = false;
+            process_running = true;
+            
+        } else if (argument == "--stream") {
+            
+            // The name of the stream is needed.
+            if (i + 1 >= argc) {
+                std::cerr << "Usage: " << argv[0] << " --stream <name>" << std::endl;
+                exit(1);
+            }
+            
+            // Shared memory objects are named with a leading slash.
+            stream_name = argv[++i];
+            if (stream_name[0] != '/')
+                stream_name = "/" + stream_name;
+            
+            // Start straight away, without waiting for the form, so that a
+            // trainer can launch the generator itself.
+            output_format = OUTPUT_SHARED_MEMORY;
+            store_dataset = true;
+            export_variation_tables = false;
+            process_running = true;
+            
+        } else if (argument == "--benchmark-codecs") {
+            
+            // The amount of frames is needed.
+            if (i + 1 >= argc) {
+                std::cerr << "Usage: " << argv[0] << " --benchmark-codecs <count>" << std::endl;
+                exit(1);
+            }
+            
+            benchmark_frames = atoi(argv[++i]);
+            if (benchmark_frames < 1) {
+                std::cerr << "Invalid amount of frames to benchmark: " << argv[i] << std::endl;
+                exit(1);
+            }
+            
+            // Render the frames without storing anything, and start straight
+            // away, without waiting for the form.
+            dataset_size = benchmark_frames;
+            store_dataset = false;
+            export_variation_tables = false;
+            process_running = true;
+            
+        } else {
+            
+            std::cerr << "Ignoring unknown argument " << argument << std::endl;
+            
+        }
+        
+    }
+    
+}
+
+bool parseFrameList(const std::string &list, std::vector<int> &frames) {
+    
+    std::string ids = list;
+    
+    // Read the ids from a file if requested.
+    if (!ids.empty() && ids[0] == '@') {
+        
+        std::ifstream ids_file(ids.substr(1));
+        if (!ids_file.is_open())
+            return false;
+        
+        std::stringstream contents;
+        contents << ids_file.rdbuf();
+        ids = contents.str();
+        
+        // Accept ids separated by new lines or spaces too.
+        std::replace_if(ids.begin(), ids.end(), [](char c) { return std::isspace((unsigned char) c); }, ',');
+        
+    }
+    
+    // Go through every id or range of ids.
+    std::stringstream stream(ids);
+    std::string token;
+    while (std::getline(stream, token, ',')) {
+        
+        if (token.empty())
+            continue;
+        
+        char* end;
+        long first = strtol(token.c_str(), &end, 10);
+        long last = first;
+        
+        if (*end == '-')
+            last = strtol(end + 1, &end, 10);
+        
+        if (*end != '\0' || first < 0 || last < first)
+            return false;
+        
+        for (long id = first; id <= last; id++)
+            frames.push_back((int) id);
+        
+    }
+    
+    // Render every sample once and in order.
+    std::sort(frames.begin(), frames.end());
+    frames.erase(std::unique(frames.begin(), frames.end()), frames.end());
+    
+    return !frames.empty();
+    
+}
+
+bool parseOutputSizes(const std::string &list, std::vector<int> &widths) {
+    
+    widths.clear();
+    
+    std::stringstream stream(list);
+    std::string token;
+    while (std::getline(stream, token, ',')) {
+        
+        // Allow spaces around the sizes.
+        token.erase(std::remove_if(token.begin(), token.end(), [](char c) { return std::isspace((unsigned char) c); }), token.end());
+        if (token.empty())
+            continue;
+        
+        char* end;
+        long width = strtol(token.c_str(), &end, 10);
+        
+        if (*end != '\0' || width < 1)
+            return false;
+        
+        widths.push_back((int) width);
+        
+    }
+    
+    return widths.size() <= MAX_OUTPUT_LEVELS;
+    
+}
+
+void selectVariations() {
+    
+    // Get the id of the sample rendered in this frame.
+    frame_id = rerender_mode ? rerender_frames[frame_count] : frame_count;
+    
+    // Use exactly the variations that were recorded for this sample.
+    if (rerender_mode) {
+        manifest->read(frame_id, current_variation);
+        return;
+    }
+    
+    // The selection only depends on the seed, the frame and the amount of
+    // frames that share each pose, so any frame can be regenerated on its own.
+    current_variation = sampler->selectVariations(frame_id, num_of_variations, appearance_variants);
+    
+}
+
+void readPixels(GLFWwindow* save_window, std::vector<unsigned char> &pixels, int &img_width, int &img_height) {
+    
+    // Get the information from the window.
+    glfwGetFramebufferSize(save_window, &img_width, &img_height);
+    
+    // Read the pixels without any padding between rows.
+    pixels.resize((size_t) img_width * img_height * 3);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadBuffer(GL_FRONT);
+    glReadPixels(0, 0, img_width, img_height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+    
+}
+
+void packPixels(const std::vector<unsigned char> &pixels, int img_width, int img_height, int layout, std::vector<unsigned char> &tensor) {
+    
+    tensor.resize((size_t) img_width * img_height * 3);
+    size_t row_size = (size_t) img_width * 3;
+    size_t plane_size = (size_t) img_width * img_height;
+    
+    for (int y = 0; y < img_height; y++) {
+        
+        // OpenGL gives the rows bottom to top.
+        const unsigned char* row = pixels.data() + (img_height - 1 - y) * row_size;
+        
+        if (layout == TENSOR_NHWC) {
+            memcpy(tensor.data() + y * row_size, row, row_size);
+            continue;
+        }
+        
+        // Split the channels into planes.
+        for (int x = 0; x < img_width; x++)
+            for (int c = 0; c < 3; c++)
+                tensor[c * plane_size + (size_t) y * img_width + x] = row[x * 3 + c];
+        
+    }
+    
+}
+
+void benchmarkCodecs() {
+    
+    // Compare the fast settings of each codec with the default ones.
+    if (codec_benchmarks.empty()) {
+        codec_benchmarks.push_back({"JPEG q" + std::to_string(JPEG_QUALITY), bgq_opengl::CODEC_JPEG});
+        codec_benchmarks.push_back({"PNG level 1", bgq_opengl::CODEC_PNG, 1, -1});
+        codec_benchmarks.push_back({"PNG level 1, up filter", bgq_opengl::CODEC_PNG, 1, 2});
+        codec_benchmarks.push_back({"PNG level 8", bgq_opengl::CODEC_PNG, 8, -1});
+        codec_benchmarks.push_back({"QOI", bgq_opengl::CODEC_QOI});
+        codec_benchmarks.push_back({"PPM", bgq_opengl::CODEC_PPM});
+    }
+    
+    std::vector<unsigned char> pixels, image;
+    int img_width, img_height;
+    readPixels(window, pixels, img_width, img_height);
+    
+    for (bgq_opengl::CodecBenchmark &benchmark : codec_benchmarks) {
+        
+        // The png settings are global, so each encoder is created right
+        // before it is used.
+        bgq_opengl::ImageEncoder encoder((bgq_opengl::ImageCodec) benchmark.codec, JPEG_QUALITY, benchmark.png_compression_level, benchmark.png_filter);
+        
+        auto start = std::chrono::steady_clock::now();
+        encoder.encode(pixels, img_width, img_height, image);
+        auto end = std::chrono::steady_clock::now();
+        
+        benchmark.seconds += std::chrono::duration<double>(end - start).count();
+        benchmark.raw_bytes += pixels.size();
+        benchmark.encoded_bytes += image.size();
+        
+    }
+    
+}
+
+void printCodecBenchmark() {
+    
+    std::cout << "CODEC BENCHMARK: " << frame_count << " frames of " << window_width << "x" << window_height << std::endl;
+    
+    for (const bgq_opengl::CodecBenchmark &benchmark : codec_benchmarks) {
+        
+        double speed = (benchmark.seconds > 0.0) ? benchmark.raw_bytes / benchmark.seconds / 1e6 : 0.0;
+        double ratio = (benchmark.raw_bytes > 0) ? (double) benchmark.encoded_bytes / benchmark.raw_bytes : 0.0;
+        
+        char line[128];
+        snprintf(line, 128, "%-24s %10.1f MB/s %8.3f size ratio", benchmark.name.c_str(), speed, ratio);
+        std::cout << line << std::endl;
+        
+    }
+    
+}
+
+void writeOutput(const std::vector<unsigned char> &pixels, int img_width, int img_height, int id, const std::vector<float> &annotations, const std::string &directory, bgq_opengl::ShardWriter *shards, bgq_opengl::TensorShardWriter *tensors) {
+    
+    // The k_matrices are always the identity.
+    const float k_matrix[9] = {1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+    
+    // Store the image. Rendering samples again always produces loose files.
+    if (output_format == OUTPUT_TAR_SHARDS && !rerender_mode) {
+        
+        // Encode the image in memory and append it to a shard together with
+        // its annotation.
+        thread_local std::vector<unsigned char> image;
+        image_encoder->encode(pixels, img_width, img_height, image);
+        shards->write(id, image.data(), image.size(), bgq_opengl::ImageEncoder::getExtension(image_codec), annotations.data(), (int) annotations.size() / 3, k_matrix);
+        
+    } else if (output_format == OUTPUT_TENSOR_SHARDS && !rerender_mode) {
+        
+        // Append the raw pixels, without encoding them at all.
+        thread_local std::vector<unsigned char> tensor;
+        packPixels(pixels, img_width, img_height, tensor_layout, tensor);
+        tensors->write(id, tensor.data());
+        
+    } else {
+        
+        char file_path[256];
+        snprintf(file_path, 256, "%s/training/rgb/%08i.%s", directory.c_str(), id, bgq_opengl::ImageEncoder::getExtension(image_codec));
+        
+        // Encode the image in memory and write it in one go.
+        thread_local std::vector<unsigned char> image;
+        image_encoder->encode(pixels, img_width, img_height, image);
+        
+        std::ofstream file(file_path, std::ios::out | std::ios::binary | std::ios::trunc);
+        file.write((const char*) image.data(), image.size());
+        if (!file)
+            std::cerr << "Could not write the image " << file_path << std::endl;
+        
+    }
+    
+}
+
+void writeImage(const std::vector<unsigned char> &pixels, int img_width, int img_height, int id, const std::vector<float> &annotations) {
+    
+    // Hand the sample to the trainer instead, if it is streamed.
+    if (sample_stream != nullptr) {
+        streamSample(pixels, img_width, img_height, id, annotations);
+        return;
+    }
+    
+    // Write the image as it was rendered.
+    writeOutput(pixels, img_width, img_height, id, annotations, dataset_path + dataset_id, shard_writer, tensor_writer);
+    
+    // And the heatmaps the trainer learns its keypoints from.
+    if (heatmap_writer != nullptr)
+        writeHeatmaps(id, annotations);
+    
+    // Then a filtered copy of it at each of the smaller sizes, with its
+    // keypoints scaled to it.
+    thread_local std::vector<unsigned char> level_pixels;
+    thread_local std::vector<float> level_annotations;
+    for (const bgq_opengl::OutputLevel &level : output_levels) {
+        
+        level.resampler->resample(pixels, level_pixels);
+        scaleAnnotations(annotations, level, level_annotations);
+        writeOutput(level_pixels, level.width, level.height, id, level_annotations, level.directory, level.shard_writer, level.tensor_writer);
+        
+    }
+    
+}
+
+void writeHeatmaps(int id, const std::vector<float> &annotations) {
+    
+    thread_local std::vector<unsigned char> heatmaps;
+    heatmaps.resize(heatmap_renderer->getSampleSize());
+    
+    heatmap_renderer->render(annotations, heatmaps.data());
+    heatmap_writer->write(id, heatmaps.data());
+    
+}
+
+void streamSample(const std::vector<unsigned char> &pixels, int img_width, int img_height, int id, const std::vector<float> &annotations) {
+    
+    // Get the rows top first, like every other output.
+    thread_local std::vector<unsigned char> image;
+    packPixels(pixels, img_width, img_height, TENSOR_NHWC, image);
+    
+    // Render the heatmaps into the sample too.
+    thread_local std::vector<unsigned char> heatmaps;
+    if (heatmap_renderer != nullptr) {
+        heatmaps.resize(heatmap_renderer->getSampleSize());
+        heatmap_renderer->render(annotations, heatmaps.data());
+    }
+    
+    // Wait for a free slot and publish it.
+    sample_stream->publish(id, image.data(), annotations, (heatmap_renderer != nullptr) ? heatmaps.data() : nullptr);
+    
+}
+
+void writeRender(const std::vector<unsigned char> &pixels, int img_width, int img_height, int id, const std::vector<float> &annotations) {
+    
+    if (compositor == nullptr) {
+        writeAugmented(pixels, img_width, img_height, id, annotations);
+        return;
+    }
+    
+    // Composite the hand over each of its backgrounds. The hand is the same
+    // in all of them, and so are its keypoints.
+    thread_local std::vector<unsigned char> sample_pixels;
+    for (int composite = 0; composite < num_of_composites; composite++) {
+        
+        int sample_id = id * num_of_composites + composite;
+        bgq_opengl::BackgroundCrop crop = sampler->getBackgroundCrop(sample_id, num_of_backgrounds, BACKGROUND_POOL_SIZE);
+        
+        compositor->composite(pixels, getBackgroundFilename(crop.image).c_str(), crop, sample_pixels);
+        writeAugmented(sample_pixels, img_width, img_height, sample_id, annotations);
+        
+    }
+    
+}
+
+void writeAugmented(const std::vector<unsigned char> &pixels, int img_width, int img_height, int id, const std::vector<float> &annotations) {
+    
+    if (augmenter == nullptr) {
+        writeImage(pixels, img_width, img_height, id, annotations);
+        return;
+    }
+    
+    // Augment the render several times, moving its keypoints with it.
+    thread_local std::vector<unsigned char> sample_pixels;
+    thread_local std::vector<float> sample_annotations;
+    for (int index = 0; index < num_of_augmentations; index++) {
+        
+        int sample_id = id * num_of_augmentations + index;
+        bgq_opengl::Augmentation augmentation = sampler->getAugmentation(sample_id);
+        
+        augmenter->augment(pixels, augmentation, sample_pixels);
+        augmenter->transformKeypoints(annotations, augmentation, sample_annotations);
+        writeImage(sample_pixels, img_width, img_height, sample_id, sample_annotations);
+        
+    }
+    
+}
+
+void renderBatch() {
+    
+    glfwMakeContextCurrent(window);
+    
+    // Draw into the tiles. Each tile has the size of the window, so the
+    // projection of the camera and the keypoints in pixels stay relative to
+    // the tile.
+    fbo->bind();
+    
+    // When compositing, the hand is drawn over nothing, and the transparent
+    // black around it leaves the colours premultiplied by the alpha.
+    if (compositor != nullptr)
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    else
+        glClearColor(1.0f, 0.0f, 1.0f, 1.0f);
+    
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    
+    int num_of_frames = rerender_mode ? (int) rerender_frames.size() : dataset_size;
+    int num_of_samples = std::min(batch_size, num_of_frames - frame_count);
+    bool multiview = num_of_camera_params > 1;
+    
+    // The hands lit from a G-buffer are drawn one at a time.
+    bool instanced = instanced_rendering && !deferred_shading;
+    
+    for (int sample = 0; sample < num_of_samples; sample++) {
+        
+        // Render the sample, exactly as it would be on its own.
+        selectVariations();
+        updateScene();
+        calculateKeypoints();
+        
+        // The views of a sample go into consecutive tiles.
+        int first_tile = sample * num_of_camera_params;
+        
+        for (int view = 0; view < num_of_camera_params; view++) {
+            
+            camera = &cameras[view];
+            fbo->setTileViewport(first_tile + view);
+            
+            // The hand is left for the instanced draw call.
+            if (instanced)
+                drawBackground();
+            else
+                drawSample();
+            
+        }
+        
+        camera = &cameras[0];
+        
+        // Keep the pose of the hand for the instanced draw call. With several
+        // views, it is kept in world space and the views are applied when
+        // drawing it.
+        if (instanced) {
+            glm::mat4 view_matrix = multiview ? glm::mat4(1.0f) : camera->getView();
+            hand->addInstance(view_matrix, sampler->getLight(current_variation.lighting), sampler->getSkinTone(current_variation.skin_tone), sampler->getShininess(current_variation.shininess), fbo->getTileRect(first_tile));
+        }
+        
+        // Store everything but the images.
+        storeDataToDataset();
+        
+        frame_count++;
+        
+    }
+    
+    // Draw every hand of the batch at once, each view into its own tile.
+    if (instanced) {
+        
+        glm::vec2 framebuffer_size(fbo->getWidth(), fbo->getHeight());
+        glViewport(0, 0, fbo->getWidth(), fbo->getHeight());
+        
+        if (multiview)
+            hand->drawInstances(*shaderMultiview, cameras, framebuffer_size, fbo->getColumns());
+        else
+            hand->drawInstances(*shader, *camera, framebuffer_size);
+        
+    }
+    
+    // Pass each tile through the lens and the sensor, once every hand of the
+    // batch is in it.
+    if (post_processor != nullptr) {
+        for (int tile = 0; tile < (int) batch_samples.size(); tile++) {
+            fbo->setTileViewport(tile);
+            applySensorEffects(batch_samples[tile].frame_id);
+        }
+    }
+    
+    // Read the whole batch at once and let a writer cut it into the images.
+    std::vector<unsigned char> pixels = async_writer->acquireBuffer();
+    fbo->readPixels(pixels);
+    
+    std::vector<bgq_opengl::BatchSample> samples;
+    samples.swap(batch_samples);
+    
+    async_writer->submit(std::move(pixels), [=](std::vector<unsigned char> &pixels) {
+        thread_local std::vector<unsigned char> tile_pixels;
+        for (int tile = 0; tile < (int) samples.size(); tile++) {
+            fbo->getTile(pixels, tile, tile_pixels);
+            writeRender(tile_pixels, window_width, window_height, samples[tile].frame_id, samples[tile].annotations);
+        }
+    });
+    
+    // Show the first view of the first sample of the batch in the window.
+    fbo->blitTile(0);
+    glViewport(0, 0, window_width, window_height);
+    
+    // Poll and handle events.
+    glfwPollEvents();
+    
+    // Swap the buffers to display it.
+    glfwSwapBuffers(window);
+    
+}
+
+void projectKeypoints(bgq_opengl::Camera &view_camera, std::vector<float> &annotations) {
+    
+    bgq_opengl::Generator::projectKeypoints(view_camera, keypoints, window_width, window_height, annotations);
+    
+}
+
+void scaleAnnotations(const std::vector<float> &annotations, const bgq_opengl::OutputLevel &level, std::vector<float> &scaled) {
+    
+    float scale_x = (float) level.width / window_width;
+    float scale_y = (float) level.height / window_height;
+    
+    // The pixel coordinates start at the corner of the image, so the scale
+    // is all there is to it.
+    scaled.resize(annotations.size());
+    for (size_t i = 0; i + 2 < annotations.size(); i += 3) {
+        scaled[i] = annotations[i] * scale_x;
+        scaled[i + 1] = annotations[i + 1] * scale_y;
+        scaled[i + 2] = annotations[i + 2];
+    }
+    
+}
+
+void distortKeypoints(const bgq_opengl::SensorEffects &effects, std::vector<float> &annotations) {
+    
+    if (effects.distortion == 0.0f)
+        return;
+    
+    glm::vec2 center(window_width * 0.5f, window_height * 0.5f);
+    float corner2 = glm::dot(center, center);
+    
+    for (size_t i = 0; i + 2 < annotations.size(); i += 3) {
+        
+        // Each pixel shows the render from further out or in, so look for the
+        // pixel that shows the keypoint. A few iterations are enough for the
+        // small distortions of a lens.
+        glm::vec2 source = glm::vec2(annotations[i], annotations[i + 1]) - center;
+        glm::vec2 position = source;
+        for (int iteration = 0; iteration < 10; iteration++)
+            position = source / (1.0f + effects.distortion * glm::dot(position, position) / corner2);
+        
+        annotations[i] = center.x + position.x;
+        annotations[i + 1] = center.y + position.y;
+        
+    }
+    
+}
+
+void storeDataToDataset() {
+    
+    // The k_matrices are always the identity.
+    const float k_matrix[9] = {1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+    
+    // Every view of the frame is a sample of its own, annotated from the same
+    // keypoints.
+    for (int view = 0; view < num_of_camera_params; view++) {
+        
+        int id = frame_id * num_of_camera_params + view;
+        
+        std::vector<float> annotations, sample_annotations, level_annotations;
+        projectKeypoints(cameras[view], annotations);
+        
+        // The lens moves the keypoints like the rest of the image.
+        if (post_processor != nullptr)
+            distortKeypoints(getSensorEffects(id), annotations);
+        
+        // When rendering in batches, the image is still in its tile, so keep
+        // what is needed to write it once the batch is read back.
+        if (fbo != nullptr) {
+            
+            batch_samples.push_back({id, annotations});
+            
+        } else {
+            
+            // Read the pixels into a buffer from the pool. Everything else
+            // happens on the writer threads, so the render loop does not
+            // wait for the disk. Several views always go through the tiled
+            // framebuffer, so this is the only view.
+            std::vector<unsigned char> pixels = async_writer->acquireBuffer();
+            int img_width, img_height;
+            readPixels(window, pixels, img_width, img_height);
+            
+            // The tensor shards and the resamplers need the exact size.
+            bool exact_size = (output_format == OUTPUT_TENSOR_SHARDS && !rerender_mode) || !output_levels.empty() || sample_stream != nullptr;
+            if (exact_size && (img_width != window_width || img_height != window_height)) {
+                std::cerr << "The framebuffer is " << img_width << "x" << img_height << " instead of " << window_width << "x" << window_height << std::endl;
+                exit(1);
+            }
+            
+            async_writer->submit(std::move(pixels), [=](std::vector<unsigned char> &pixels) {
+                writeRender(pixels, img_width, img_height, id, annotations);
+            });
+            
+        }
+        
+        // The annotations are already there when rendering samples again.
+        if (rerender_mode)
+            continue;
+        
+        // Every background the view is composited over, and every
+        // augmentation of it, is a sample.
+        int samples_per_view = num_of_composites * getAugmentationsPerRender();
+        for (int sample = 0; sample < samples_per_view; sample++) {
+            
+            int sample_id = id * samples_per_view + sample;
+            
+            // Move the keypoints like the image of the sample.
+            if (augmenter != nullptr)
+                augmenter->transformKeypoints(annotations, sampler->getAugmentation(sample_id), sample_annotations);
+            else
+                sample_annotations = annotations;
+            
+            // Write the keypoints to the slot of this sample.
+            annotations_store->write(sample_id, sample_annotations.data());
+            
+            // Do the same for the k_matrices.
+            k_matrices_store->write(sample_id, k_matrix);
+            
+            // And for the smaller copies, with the keypoints scaled to them.
+            for (bgq_opengl::OutputLevel &level : output_levels) {
+                scaleAnnotations(sample_annotations, level, level_annotations);
+                level.annotations_store->write(sample_id, level_annotations.data());
+                level.k_matrices_store->write(sample_id, k_matrix);
+            }
+            
+            // Append them to the json files too.
+            if (store_json_annotations) {
+                annotations_file->writeMatrix(sample_annotations.data(), (int) keypoints.size(), 3);
+                k_matrices_file->writeMatrix(k_matrix, 3, 3);
+            }
+            
+        }
+        
+    }
+    
+    // The manifest is already there when rendering samples again.
+    if (rerender_mode)
+        return;
+    
+    // Record the variations that produced every view of this frame, and the
+    // seed of its procedural background if there is one.
+    uint32_t background_seed = 0;
+    if (background_mode == BACKGROUND_PROCEDURAL && compositor == nullptr)
+        background_seed = sampler->getProceduralBackground(current_variation.background);
+    
+    manifest->write(frame_id, current_variation, background_seed);
+
+}
+
+void updateScene() {
+    
+    glfwMakeContextCurrent(window);
+    
+    // Pose the hand with the selected arm transform and joint angles.
+    bgq_opengl::Generator::poseHand(*hand, sampler->getJointAngles(current_variation.joint_angles), sampler->getArmPosition(current_variation.arm_position), sampler->getArmRotation(current_variation.arm_rotation));
+    
+}
+
+int main(int argc, char** argv) {
+    
+    // Read the options of this run.
+    parseArguments(argc, argv);
+    
+    // Initialise the environment.
+    initInterface();
     
     // Main loop.
     while(!glfwWindowShouldClose(interface_window)) {
@@ -879,38 +2282,89 @@ int main(int argc, char** argv) {
     // Init the variations.
     initVariations();
     
+    // Start the threads that encode and write the outputs.
+    image_encoder = new bgq_opengl::ImageEncoder((bgq_opengl::ImageCodec) image_codec, JPEG_QUALITY, png_compression_level, png_filter);
+    async_writer = new bgq_opengl::AsyncWriter(num_of_writer_threads);
+    
+    // Composite each render over several backgrounds on the CPU.
+    if (store_dataset && num_of_composites > 1) {
+        compositor = new bgq_opengl::Compositor(window_width, window_height);
+        std::cout << "COMPOSITING: " << num_of_composites << " backgrounds per render (" << bgq_opengl::Compositor::getInstructionSet() << ")" << std::endl;
+    }
+    
+    // Augment each render into several samples on the CPU.
+    if (store_dataset && num_of_augmentations > 0) {
+        augmenter = new bgq_opengl::Augmenter(window_width, window_height);
+        std::cout << "AUGMENTING: " << num_of_augmentations << " samples per render (" << bgq_opengl::Augmenter::getInstructionSet() << ")" << std::endl;
+    }
+    
     // Init the renderer window.
     initRendererWindow();
     
     // Initialise the objects and elements.
     initElements();
     
+    // Create the tiled framebuffer if several samples or views are rendered
+    // per pass, or if the hands need their alpha to be composited.
+    if (store_dataset && (batch_size > 1 || num_of_camera_params > 1 || compositor != nullptr))
+        fbo = new bgq_opengl::FBO(window_width, window_height, batch_size * num_of_camera_params, compositor != nullptr);
+    
 	// Main loop.
     while(!glfwWindowShouldClose(window) && !glfwWindowShouldClose(interface_window)) {
-
-        // Apply the alterations and update the scene.
-        updateScene();
         
-        // Obtain the corresponding keypoints.
-        calculateKeypoints();
-        
-        // Display the scene.
-        displayElements();
+        int previous_frame_count = frame_count;
         
-        // Check if we're actually producing the dataset.
-        if (store_dataset) {
-            // Store the generated data.
-            storeDataToDataset();
+        if (fbo != nullptr) {
+            
+            // Render, store and count a whole batch of samples.
+            renderBatch();
+            
+        } else {
+            
+            // Select the variations of this frame.
+            selectVariations();
+            
+            // Apply the alterations and update the scene.
+            updateScene();
+            
+            // Obtain the corresponding keypoints.
+            calculateKeypoints();
+            
+            // Display the scene.
+            displayElements();
+            
+            // Check if we're actually producing the dataset.
+            if (store_dataset) {
+                // Store the generated data.
+                storeDataToDataset();
+            } else if (benchmark_frames > 0) {
+                // Compare the codecs on the generated image.
+                benchmarkCodecs();
+            }
+            
+            // Increment the frame count.
+            frame_count++;
+            
         }
         
         // Make the things to print everything.
         displayInterface();
         
-        // Increment the frame count.
-        frame_count++;
+        // Save a checkpoint every now and then, between batches, but only
+        // once everything before it is on the disk.
+        if (store_dataset && !rerender_mode && frame_count / checkpoint_interval > previous_frame_count / checkpoint_interval && frame_count < dataset_size) {
+            
+            async_writer->wait();
+            
+            if (syncOutputs())
+                saveCheckpoint();
+            else
+                std::cerr << "Could not sync the outputs, skipping the checkpoint." << std::endl;
+            
+        }
         
         // If we've done enough frames, exit the loop.
-        if (frame_count >= dataset_size)
+        if (frame_count >= (rerender_mode ? (int) rerender_frames.size() : dataset_size))
             break;
         
     }
@@ -18,9 +18,15 @@
 
 #define WINDOW_NAME "HandyVariations"
 #define NORM_SIZE 1.0
-#define MAX_BONE_INFLUENCE 4
 #define INTERFACE_WIDTH 450
-#define INTERFACE_HEIGHT 630
+#define INTERFACE_HEIGHT 720
+#define BACKGROUND_POOL_SIZE 14043
+#define JPEG_QUALITY 95
+#define GBUFFER_FIRST_SLOT 6
+#define MAX_OUTPUT_LEVELS 4
+#define SENSOR_IMAGE_SLOT 9
+#define HEATMAP_SIGMA 3.0f
+#define HEATMAP_RADIUS 25
 
 #include <vector>
 #include <string>
@@ -31,11 +37,66 @@
 #include "GL/glew.h"
 #include "GLFW/glfw3.h"
 
+#include "classes/annotation_store/annotation_store.h"
+#include "classes/annotation_writer/annotation_writer.h"
+#include "classes/async_writer/async_writer.h"
+#include "classes/augmenter/augmenter.h"
 #include "classes/background/background.h"
+#include "classes/background_mosaic/background_mosaic.h"
 #include "classes/camera/camera.h"
+#include "classes/checkpoint/checkpoint.h"
+#include "classes/compositor/compositor.h"
+#include "classes/fbo/fbo.h"
+#include "classes/gbuffer/gbuffer.h"
+#include "classes/generator/generator.h"
+#include "classes/heatmap_renderer/heatmap_renderer.h"
+#include "classes/image_encoder/image_encoder.h"
 #include "classes/object_rigged/object_rigged.h"
+#include "classes/post_processor/post_processor.h"
+#include "classes/resampler/resampler.h"
+#include "classes/sample_manifest/sample_manifest.h"
+#include "classes/sample_stream/sample_stream.h"
+#include "classes/shard_writer/shard_writer.h"
+#include "classes/tensor_shard_writer/tensor_shard_writer.h"
 #include "classes/shader/shader.h"
 #include "classes/texture/texture.h"
+#include "classes/variation_sampler/variation_sampler.h"
+#include "classes/variation_table/variation_table.h"
+#include "structs/batch_sample/batch_sample.h"
+#include "structs/codec_benchmark/codec_benchmark.h"
+#include "structs/output_level/output_level.h"
+#include "structs/sensor_effects/sensor_effects.h"
+#include "structs/variation_indices/variation_indices.h"
+
+/// The ways the images of the dataset can be stored.
+enum OutputFormat {
+    OUTPUT_LOOSE_FILES = 0,             /// One image file per sample in training/rgb.
+    OUTPUT_TAR_SHARDS = 1,              /// Tar shards of image files and json annotations in training/shards.
+    OUTPUT_TENSOR_SHARDS = 2,           /// Raw RGB8 .npy shards in training/tensors.
+    OUTPUT_SHARED_MEMORY = 3,           /// A shared-memory ring a trainer reads the samples from.
+};
+
+/// The ways the pixels of the tensor shards can be laid out.
+enum TensorLayout {
+    TENSOR_NHWC = 0,                    /// Rows of interleaved RGB pixels.
+    TENSOR_NCHW = 1,                    /// One plane per channel.
+};
+
+/// The ways the backgrounds can be drawn.
+enum BackgroundMode {
+    BACKGROUND_IMAGES = 0,              /// Photographs loaded from the backgrounds dir.
+    BACKGROUND_PROCEDURAL = 1,          /// Noise, gradients and shapes drawn from a seed, without any file.
+    BACKGROUND_MOSAIC = 2,              /// Random crops of a few images that stay in the GPU.
+};
+
+/// The effects of the lens and the sensor that can be applied to the renders.
+enum SensorEffect {
+    SENSOR_NOISE = 1,                   /// Gaussian noise per pixel and channel.
+    SENSOR_VIGNETTING = 2,              /// Darker corners.
+    SENSOR_ABERRATION = 4,              /// Red and blue magnified a bit differently than green.
+    SENSOR_DISTORTION = 8,              /// Radial distortion, which moves the keypoints too.
+    SENSOR_BLUR = 16,                   /// A soft image, like a cheap lens or a strong compression.
+};
 
 /*
 *****************************************
@@ -45,7 +106,28 @@
 
 int window_width = 224;
 int window_height = 224;
+std::string output_sizes = "";
+int resample_filter = bgq_opengl::RESAMPLE_LANCZOS;
 bool store_dataset = true;
+bool export_variation_tables = false;
+bool store_json_annotations = true;
+int output_format = OUTPUT_LOOSE_FILES;
+int image_codec = bgq_opengl::CODEC_JPEG;
+int png_compression_level = 8;
+int png_filter = -1;
+int samples_per_shard = 1000;
+int tensor_layout = TENSOR_NHWC;
+int heatmap_size = 0;
+int heatmap_type = bgq_opengl::TENSOR_UINT8;
+std::string stream_name = "/handy_variations";
+int stream_slots = 64;
+int checkpoint_interval = 1000;
+int num_of_writer_threads = 4;
+bool bypass_page_cache = false;
+int batch_size = 1;
+bool instanced_rendering = true;
+bool deferred_shading = false;
+int sensor_effects = 0;
 int num_of_joint_angles = 31000;
 int num_of_arm_positions = 31000;
 int num_of_arm_rotations = 31000;
@@ -53,56 +135,80 @@ int num_of_skin_tones = 31000;
 int num_of_lighting = 31000;
 int num_of_shininess = 31000;
 int num_of_backgrounds = 15000;
+int background_mode = BACKGROUND_IMAGES;
+int mosaic_images = 64;
 int num_of_camera_params = 1;
+int appearance_variants = 1;
+int num_of_composites = 1;
+int num_of_augmentations = 0;
 int dataset_size = 100000;
+uint64_t dataset_seed = 0;
 bool process_running = false;
 std::string dataset_path = "...";
 std::string backgrounds_path = "...";
 
-bgq_opengl::Camera *camera;             /// The camera.
+std::vector<bgq_opengl::Camera> cameras;    /// The camera of each of the views.
+bgq_opengl::Camera *camera;             /// The camera of the view being drawn.
 bgq_opengl::Shader *shader;             /// The main program shader.
+bgq_opengl::Shader *shaderMultiview;    /// The shaders that draw every view of the instances at once.
+bgq_opengl::Shader *shaderSkinning;     /// The shader that skins the hand once into its cache.
+bgq_opengl::Shader *shaderSkinned;      /// The shaders that draw the cached skinned hand.
+bgq_opengl::Shader *shaderGeometry;     /// The shaders that rasterise the cached skinned hand into a G-buffer.
+bgq_opengl::Shader *shaderLighting;     /// The shaders that light a G-buffer.
 bgq_opengl::Shader *shaderPnt;          /// The shaders for the auxiliary control points.
 bgq_opengl::Shader *shaderBck;          /// The shaders for the background.
+bgq_opengl::Shader *shaderProcedural;   /// The shaders for the procedural background.
+bgq_opengl::Shader *shaderSensor;       /// The shaders that apply the sensor effects.
+bgq_opengl::PostProcessor *post_processor = nullptr;    /// Applies the sensor effects to the renders.
 bgq_opengl::Background *backbox;        /// The background.
+bgq_opengl::BackgroundMosaic *mosaic = nullptr;     /// The images the mosaic backgrounds are cropped from.
 GLFWwindow *window = 0;                 /// Window ID.
 GLFWwindow *interface_window = 0;       /// Interface window ID.
 int frame_count = 0;                    /// The frame count of the system.
-std::random_device rd;                  /// Randomness device.
-std::mt19937 gen(rd());                 /// Randomness generator.
+int frame_id = 0;                       /// The id of the sample being rendered.
+std::random_device rd;                  /// Randomness device used to seed new datasets.
 
 bgq_opengl::ObjectRigged *dis_pnt;      /// The object used to display points.
 bgq_opengl::ObjectRigged *hand;         /// The hand that will be used for generating the dataset.
 std::vector<glm::vec3> keypoints;       /// The keypoints of the hand.
+int skinned_joint_angles = -1;          /// The joint angles the cached skinned hand has, -1 if none.
+std::vector<bgq_opengl::GBuffer*> gbuffers;     /// The G-buffer of each of the views.
+std::vector<glm::ivec3> gbuffer_poses;  /// The joint angles, arm position and arm rotation in each G-buffer, -1 if none.
 
 std::string dataset_id = "";            /// The slug that identifies the dataset.
-std::ofstream annotations_file;         /// The file containing the final annotations.
-std::ofstream k_matrices_file;          /// The file containing the k_matrices.
+bgq_opengl::AnnotationWriter *annotations_file = nullptr;   /// The file containing the final annotations.
+bgq_opengl::AnnotationWriter *k_matrices_file = nullptr;    /// The file containing the k_matrices.
+bgq_opengl::AnnotationStore *annotations_store = nullptr;   /// The .npy array containing the final annotations.
+bgq_opengl::AnnotationStore *k_matrices_store = nullptr;    /// The .npy array containing the k_matrices.
+bgq_opengl::SampleManifest *manifest = nullptr;     /// Records the variations of each sample.
+bgq_opengl::ShardWriter *shard_writer = nullptr;    /// Packs the samples into shards.
+bgq_opengl::TensorShardWriter *tensor_writer = nullptr;     /// Packs the raw images into tensor shards.
+bgq_opengl::HeatmapRenderer *heatmap_renderer = nullptr;    /// Renders the training heatmaps of the keypoints.
+bgq_opengl::TensorShardWriter *heatmap_writer = nullptr;    /// Packs the heatmaps into tensor shards.
+bgq_opengl::SampleStream *sample_stream = nullptr;          /// Hands the samples to a trainer through shared memory.
+bgq_opengl::AsyncWriter *async_writer = nullptr;            /// Encodes and writes the images off the render loop.
+bgq_opengl::ImageEncoder *image_encoder = nullptr;          /// Encodes the images of the dataset.
+bgq_opengl::Compositor *compositor = nullptr;               /// Composites the hands over the backgrounds on the CPU.
+bgq_opengl::Augmenter *augmenter = nullptr;                 /// Augments the samples on the CPU.
+bgq_opengl::FBO *fbo = nullptr;                             /// The tiled framebuffer the batches are rendered into.
+std::vector<bgq_opengl::BatchSample> batch_samples;         /// The samples of the batch being rendered.
+std::vector<int> output_widths;                             /// The widths of the smaller copies of the images.
+std::vector<bgq_opengl::OutputLevel> output_levels;         /// Writes the smaller copies of the images.
+
+bool rerender_mode = false;             /// Whether only some samples of an existing dataset are rendered again.
+std::vector<int> rerender_frames;       /// The ids of the samples that will be rendered again.
+bool resume_mode = false;               /// Whether an unfinished dataset is continued.
+int append_count = 0;                   /// The amount of frames added to a finished dataset.
+int benchmark_frames = 0;               /// The amount of frames the codecs are compared on, 0 to generate a dataset.
+std::vector<bgq_opengl::CodecBenchmark> codec_benchmarks;  /// The results of the comparison of the codecs.
 
-std::vector<glm::vec3> arm_positions;               /// The list containingthe different arm positions.
-std::vector<glm::vec3> arm_rotations;               /// The list containing the different arm rotations.
-std::vector<std::vector<glm::vec3> > joint_angles;  /// The list containing the different joint rotations.
-std::vector<float> skin_tones;                      /// The list containing the skin tone multipliers.
-std::vector<bgq_opengl::Light> light_variations;    /// The list containing the light parameters.
-std::vector<float> shine_variations;                /// The list containing the shininess variations.
-std::vector<int> background_indices;                /// The list containing the shininess variations.
+bgq_opengl::VariationSampler *sampler;              /// Derives the variations from the dataset seed.
+bgq_opengl::VariationIndices num_of_variations;     /// The size of each of the variation tables.
+bgq_opengl::VariationIndices current_variation;     /// The variations selected for the current frame.
 
 /// Specifies the background color.
 const glm::vec4 background(40 / 255.0, 40 / 255.0, 40 / 255.0, 1.0);
 
-/// Maps each keypoint to its reference bone.
-const std::vector<int> key_mapping = {1, 2, 3, 4, 4, 6, 7, 14, 14, 9, 15, 18, 18,
-    11, 16, 19, 19, 13, 17, 20, 20};
-
-/// Maps the keypoints to their reference vertex in the mesh.
-std::vector<int> keypoint_bone_map = {36563, 30249, 53106, 790, 528, 28613, 20338,
-    21906, 17825, 38509, 25734, 24593, 23377, 28657, 9382, 10482, 6617, 60805,
-    15913, 16162, 12608};
-
-/// Maps indices to bones.
-const std::vector<std::string> name_joint_mapping = {"Bone037", "Bone038", "Bone039",
-    "Bone040", "Bone043", "Bone044", "Bone045", "Bone048", "Bone049", "Bone050",
-    "Bone053", "Bone054", "Bone055", "Bone058", "Bone059", "Bone060"};
-
 /**
  * @brief Clean everything to end the program.
  *
@@ -124,6 +230,110 @@ void calculateKeypoints();
  */
 void displayElements();
 
+/**
+ * @brief Draw the background of the current sample.
+ *
+ * Draw the background of the current sample into the current framebuffer and
+ * viewport.
+ */
+void drawBackground();
+
+/**
+ * @brief Get the file of a background image.
+ *
+ * Get the path of the background image with a given id.
+ *
+ * @param backgr_id The id of the background image.
+ *
+ * @returns The path of the image.
+ */
+std::string getBackgroundFilename(int backgr_id);
+
+/**
+ * @brief Get the amount of samples of a frame.
+ *
+ * Get the amount of samples each frame produces, one per view, background
+ * it is composited over and augmentation.
+ *
+ * @returns The amount of samples.
+ */
+int getSamplesPerFrame();
+
+/**
+ * @brief Get the amount of augmentations of a render.
+ *
+ * Get the amount of samples each composited render gives, 1 if they are not
+ * augmented.
+ *
+ * @returns The amount of augmentations.
+ */
+int getAugmentationsPerRender();
+
+/**
+ * @brief Get the height of a level of the output pyramid.
+ *
+ * Get the height of the smaller copies of the images with a given width,
+ * keeping the aspect ratio of the render.
+ *
+ * @param output_width The width of the copies.
+ *
+ * @returns The height of the copies.
+ */
+int getOutputHeight(int output_width);
+
+/**
+ * @brief Draw the hand of the current sample from a G-buffer.
+ *
+ * Draw the hand of the current sample by lighting the G-buffer of the current
+ * view with a fullscreen pass. The pose is only rasterised into the G-buffer
+ * when it is not already there, so the samples that share a pose and a view
+ * only differ in the lighting pass.
+ */
+void drawDeferredHand();
+
+/**
+ * @brief Draw the current sample.
+ *
+ * Draw the background, the hand and the control points of the current sample
+ * into the current framebuffer and viewport. When the pose is shared by
+ * several appearance variants or views, the hand is skinned once and drawn
+ * from its cache. With deferred shading, it is lit from a G-buffer instead.
+ */
+void drawSample();
+
+/**
+ * @brief Get the sensor effects of a view.
+ *
+ * Get the sensor effects of a view of a frame from the seed, leaving out the
+ * ones that are not enabled.
+ *
+ * @param id The id of the view of the frame.
+ *
+ * @returns The sensor effects.
+ */
+bgq_opengl::SensorEffects getSensorEffects(int id);
+
+/**
+ * @brief Apply the sensor effects.
+ *
+ * Apply the sensor effects of a view of a frame to what has been drawn in
+ * the current viewport, before it is read back.
+ *
+ * @param id The id of the view of the frame.
+ */
+void applySensorEffects(int id);
+
+/**
+ * @brief Render a batch of samples.
+ *
+ * Render the next samples, each view of each of them into its own tile of the
+ * tiled framebuffer, read them all back at once and hand them to the writers.
+ * With instanced rendering, all the hands of the batch are drawn with a
+ * single draw call, and the views of each hand are drawn from a single
+ * skinning of it.
+ */
+void renderBatch();
+
 /**
  * @brief Display the GUI.
  *
@@ -170,19 +380,313 @@ void initRendererWindow();
 void initVariations();
 
 /**
- * @brief Save the buffer to an image.
+ * @brief Init the levels of the output pyramid.
+ *
+ * Create the resampler of each of the smaller copies of the images and,
+ * unless samples are being rendered again, the directory and the writers of
+ * each of them.
+ *
+ * @param checkpoint The checkpoint the dataset is continued from.
+ * @param continue_dataset Whether an existing dataset is continued.
+ */
+void initOutputLevels(const bgq_opengl::CheckpointState &checkpoint, bool continue_dataset);
+
+/**
+ * @brief Select the variations of the current frame.
+ *
+ * Derive the variations that will be used in the current frame from the
+ * dataset seed and the frame id, or read them from the manifest when
+ * rendering samples again.
+ */
+void selectVariations();
+
+/**
+ * @brief Parse the command line arguments.
  *
- * Save the frame buffer to an image.
+ * Parse the command line arguments. Running with
+ * --rerender <dataset_dir> <frame_ids> renders again the given samples of an
+ * existing dataset from its manifest, and only rewrites their images. The ids
+ * are a comma separated list of ids and ranges, such as 0,7,100-199, or
+ * @file to read them from a file. Every view of the frames is rendered again.
+ * Only datasets stored as loose image files can be rendered again.
+ * Running with --resume <dataset_dir>
+ * continues an unfinished dataset from its last checkpoint, and
+ * --append <dataset_dir> <count> adds count frames to a finished one.
+ *
+ * @param argc The amount of arguments.
+ * @param argv The arguments.
+ */
+void parseArguments(int argc, char** argv);
+
+/**
+ * @brief Check the exported variation tables.
+ *
+ * Read the exported variation tables back and check that they hold what the
+ * run draws for its first batch of frames.
+ *
+ * @param filename The name of the file of the tables.
+ * @param run What else the run draws.
+ */
+void checkVariationTables(const char* filename, const bgq_opengl::VariationTableRun &run);
+
+/**
+ * @brief Restore the run from a checkpoint.
+ *
+ * Restore the parameters and the progress of the run from the checkpoint of
+ * the dataset and check that its outputs are all there.
+ *
+ * @param checkpoint Output variable for the checkpoint.
+ */
+void restoreCheckpoint(bgq_opengl::CheckpointState &checkpoint);
+
+/**
+ * @brief Check the shards of a checkpoint.
+ *
+ * Check that the shards a writer found hold every sample of the checkpoint,
+ * exiting otherwise.
+ *
+ * @param num_of_samples The amount of samples in the shards, -1 if they do not match the checkpoint.
+ * @param checkpoint The checkpoint.
+ * @param directory The directory of the shards.
+ */
+void checkShards(int num_of_samples, const bgq_opengl::CheckpointState &checkpoint, const char* directory);
+
+/**
+ * @brief Sync the outputs.
+ *
+ * Make everything written so far durable, keeping the open shards open.
+ *
+ * @returns True if every output was synced.
+ */
+bool syncOutputs();
+
+/**
+ * @brief Close the outputs.
+ *
+ * Finish the shards, the arrays and the json files.
+ *
+ * @returns True if every output was finished.
+ */
+bool closeOutputs();
+
+/**
+ * @brief Save a checkpoint of the run.
+ *
+ * Save a checkpoint from which the run can be resumed. It must only be saved
+ * once the outputs have been synced or closed.
+ */
+void saveCheckpoint();
+
+/**
+ * @brief Set the directory of an existing dataset.
+ *
+ * Split the directory of an existing dataset into the output dir and the
+ * dataset id.
+ *
+ * @param dataset_dir The directory of the dataset.
+ */
+void setDatasetDirectory(std::string dataset_dir);
+
+/**
+ * @brief Parse a list of frame ids.
+ *
+ * Parse a comma separated list of frame ids and ranges of frame ids.
+ *
+ * @param list The list of ids.
+ * @param frames Output vector for the ids.
+ *
+ * @returns True if the list is valid.
+ */
+bool parseFrameList(const std::string &list, std::vector<int> &frames);
+
+/**
+ * @brief Parse a list of output sizes.
+ *
+ * Parse the widths of the smaller copies of the images, separated by commas,
+ * such as "128,224,256". An empty list is valid and gives no copies.
+ *
+ * @param list The list.
+ * @param widths Output vector for the widths.
+ *
+ * @returns True if the list is valid.
+ */
+bool parseOutputSizes(const std::string &list, std::vector<int> &widths);
+
+/**
+ * @brief Read the pixels of a window.
+ *
+ * Read the front buffer of a window as tightly packed RGB8 pixels, bottom row
+ * first.
  *
- * @param filepath The name of the resulting image.
  * @param save_window The opengl window.
+ * @param pixels Output vector for the pixels.
+ * @param img_width Output variable for the width of the image.
+ * @param img_height Output variable for the height of the image.
+ */
+void readPixels(GLFWwindow* save_window, std::vector<unsigned char> &pixels, int &img_width, int &img_height);
+
+/**
+ * @brief Pack some pixels as a tensor.
+ *
+ * Reorder some pixels read by readPixels so that the rows go top to bottom,
+ * in the given layout.
+ *
+ * @param pixels The pixels.
+ * @param img_width The width of the image.
+ * @param img_height The height of the image.
+ * @param layout The layout of the tensor.
+ * @param tensor Output vector for the tensor.
+ */
+void packPixels(const std::vector<unsigned char> &pixels, int img_width, int img_height, int layout, std::vector<unsigned char> &tensor);
+
+/**
+ * @brief Benchmark the codecs on the current frame.
+ *
+ * Encode the current frame with each of the codecs being compared and add the
+ * time and size to their results.
+ */
+void benchmarkCodecs();
+
+/**
+ * @brief Print the results of the codec benchmark.
+ *
+ * Print the encoding speed and the size ratio of each of the codecs.
+ */
+void printCodecBenchmark();
+
+/**
+ * @brief Write an image to an output.
+ *
+ * Encode an image and write it in the output format of the run, to the
+ * dataset or to one of the levels of the output pyramid.
+ *
+ * @param pixels The pixels, bottom row first.
+ * @param img_width The width of the image.
+ * @param img_height The height of the image.
+ * @param id The id of the sample.
+ * @param annotations The keypoints of the sample, in pixels of this image.
+ * @param directory The directory of the output.
+ * @param shards The shard writer of the output, if any.
+ * @param tensors The tensor shard writer of the output, if any.
+ */
+void writeOutput(const std::vector<unsigned char> &pixels, int img_width, int img_height, int id, const std::vector<float> &annotations, const std::string &directory, bgq_opengl::ShardWriter *shards, bgq_opengl::TensorShardWriter *tensors);
+
+/**
+ * @brief Write the image of a sample.
+ *
+ * Encode the image of a sample and write it in the output format of the run,
+ * together with a resampled copy for each level of the output pyramid.
+ * It is called from the writer threads.
+ *
+ * @param pixels The pixels, bottom row first.
+ * @param img_width The width of the image.
+ * @param img_height The height of the image.
+ * @param id The id of the sample.
+ * @param annotations The keypoints of the sample.
+ */
+void writeImage(const std::vector<unsigned char> &pixels, int img_width, int img_height, int id, const std::vector<float> &annotations);
+
+/**
+ * @brief Write the heatmaps of a sample.
+ *
+ * Render the training heatmaps of the keypoints of a sample and append them
+ * to the heatmap shards. It is called from the writer threads.
+ *
+ * @param id The id of the sample.
+ * @param annotations The keypoints of the sample, in pixels of the image.
+ */
+void writeHeatmaps(int id, const std::vector<float> &annotations);
+
+/**
+ * @brief Stream a sample.
+ *
+ * Publish the image, keypoints and heatmaps of a sample to the shared-memory
+ * ring instead of writing them. It is called from the writer threads, and
+ * waits while the trainer is a whole ring behind.
+ *
+ * @param pixels The pixels, bottom row first.
+ * @param img_width The width of the image.
+ * @param img_height The height of the image.
+ * @param id The id of the sample.
+ * @param annotations The keypoints of the sample, in pixels of the image.
+ */
+void streamSample(const std::vector<unsigned char> &pixels, int img_width, int img_height, int id, const std::vector<float> &annotations);
+
+/**
+ * @brief Write the samples of a render.
+ *
+ * Write the image of a view of a frame. When compositing, the hand has been
+ * rendered with premultiplied alpha and is composited over num_of_composites
+ * backgrounds, giving the renders id * num_of_composites to
+ * id * num_of_composites + num_of_composites - 1. Otherwise, it is the only
+ * render, with the id of the view. Each render is then augmented. It is
+ * thread safe.
+ *
+ * @param pixels The pixels of the render, bottom row first.
+ * @param img_width The width of the image.
+ * @param img_height The height of the image.
+ * @param id The id of the view of the frame.
+ * @param annotations The keypoints of the samples, three values each.
+ */
+void writeRender(const std::vector<unsigned char> &pixels, int img_width, int img_height, int id, const std::vector<float> &annotations);
+
+/**
+ * @brief Write the augmentations of a render.
+ *
+ * Write the samples of a composited render. When augmenting, it gives the
+ * samples id * num_of_augmentations to
+ * id * num_of_augmentations + num_of_augmentations - 1, each with its
+ * keypoints moved like its image. Otherwise, the render is the sample. It is
+ * thread safe.
+ *
+ * @param pixels The pixels of the render, bottom row first.
+ * @param img_width The width of the image.
+ * @param img_height The height of the image.
+ * @param id The id of the composited render.
+ * @param annotations The keypoints of the render, three values each.
+ */
+void writeAugmented(const std::vector<unsigned char> &pixels, int img_width, int img_height, int id, const std::vector<float> &annotations);
+
+/**
+ * @brief Project the keypoints into a view.
+ *
+ * Project the keypoints of the current frame into the image of a camera.
+ *
+ * @param view_camera The camera of the view.
+ * @param annotations Output vector for the keypoints in pixels, three values each.
+ */
+void projectKeypoints(bgq_opengl::Camera &view_camera, std::vector<float> &annotations);
+
+/**
+ * @brief Distort the keypoints.
+ *
+ * Move the keypoints, in pixels, to where the lens distortion of the sensor
+ * effects shows them.
+ *
+ * @param effects The sensor effects.
+ * @param annotations The x, y and z of each keypoint.
+ */
+void distortKeypoints(const bgq_opengl::SensorEffects &effects, std::vector<float> &annotations);
+
+/**
+ * @brief Scale the keypoints to a level of the output pyramid.
+ *
+ * Scale the keypoints of a sample, in pixels of the render, to pixels of the
+ * smaller copy of its image.
+ *
+ * @param annotations The keypoints in pixels of the render.
+ * @param level The level of the output pyramid.
+ * @param scaled Output vector for the keypoints in pixels of the level.
  */
-void saveImage(char* filepath, GLFWwindow* save_window);
+void scaleAnnotations(const std::vector<float> &annotations, const bgq_opengl::OutputLevel &level, std::vector<float> &scaled);
 
 /**
  * @brief Store the data to the dataset folder.
  *
- * Store the image and keypoints to the dataset.
+ * Store the image and keypoints of each of the views of the current frame to
+ * the dataset. View v of frame f composited over background c is sample
+ * (f * num_of_camera_params + v) * num_of_composites + c. When rendering in
+ * batches, the images are written once the whole batch has been read back.
  */
 void storeDataToDataset();
 
@@ -0,0 +1,184 @@
+/**
+ * @file bindings.cpp
+ * @brief Python bindings of the generator.
+ * @version 1.0.0 (2024-03-24)
+ * @date 2024-03-24
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/type_ptr.hpp"
+
+#include "classes/generator/generator.h"
+#include "classes/light/light.h"
+#include "classes/variation_sampler/variation_sampler.h"
+#include "structs/render_params/render_params.h"
+
+namespace py = pybind11;
+
+namespace {
+
+    /// A parameter of the batch, as a C-contiguous array of floats.
+    struct Param {
+        py::array_t<float, py::array::c_style | py::array::forcecast> values;   /// The values of every sample.
+        py::ssize_t row_size = 0;           /// The amount of values of each sample.
+        bool given = false;                 /// Whether the batch has the parameter.
+
+        /// Get the values of a sample.
+        const float* row(py::ssize_t sample) const {
+            return this->values.data() + sample * this->row_size;
+        }
+    };
+
+    /**
+     * @brief Get a parameter of a batch.
+     *
+     * Get a parameter from the dict of a batch, checking that it has a row of
+     * the expected size for each sample.
+     *
+     * @param params The dict of the batch.
+     * @param name The name of the parameter.
+     * @param num_of_samples The amount of samples, or -1 to take it from this parameter.
+     * @param row_size The amount of values of each sample.
+     *
+     * @returns The parameter, which may not be given.
+     */
+    Param getParam(const py::dict &params, const char* name, py::ssize_t &num_of_samples, py::ssize_t row_size) {
+
+        Param param;
+        param.row_size = row_size;
+        if (!params.contains(name))
+            return param;
+
+        param.values = decltype(param.values)::ensure(py::object(params[name]));
+        if (!param.values)
+            throw std::invalid_argument(std::string("The parameter ") + name + " is not an array of numbers.");
+
+        if (num_of_samples < 0)
+            num_of_samples = (param.values.ndim() > 0) ? param.values.shape(0) : 0;
+
+        if (param.values.ndim() == 0 || param.values.shape(0) != num_of_samples || param.values.size() != num_of_samples * row_size)
+            throw std::invalid_argument(std::string("The parameter ") + name + " needs " + std::to_string(row_size) + " values per sample.");
+
+        param.given = true;
+        return param;
+
+    }
+
+    /**
+     * @brief Get the parameters of a batch.
+     *
+     * Turn the dict of a batch into the parameters of each of its samples.
+     * Every parameter that is left out takes the value of the entry 0 of its
+     * variation table.
+     *
+     * @param params The dict of the batch.
+     *
+     * @returns The parameters of each sample.
+     */
+    std::vector<bgq_opengl::RenderParams> getBatch(const py::dict &params) {
+
+        py::ssize_t n = -1;
+        Param joint_angles = getParam(params, "joint_angles", n, NUM_OF_JOINTS * 3);
+        Param arm_position = getParam(params, "arm_position", n, 3);
+        Param arm_rotation = getParam(params, "arm_rotation", n, 3);
+        Param skin_tone = getParam(params, "skin_tone", n, 1);
+        Param shininess = getParam(params, "shininess", n, 1);
+        Param light_position = getParam(params, "light_position", n, 3);
+        Param light_color = getParam(params, "light_color", n, 4);
+        Param light_power = getParam(params, "light_power", n, 1);
+        Param background = getParam(params, "background", n, 1);
+
+        if (n < 0)
+            throw std::invalid_argument("The batch has no parameters, so its size is unknown.");
+
+        std::vector<bgq_opengl::RenderParams> batch(n);
+        for (py::ssize_t i = 0; i < n; i++) {
+
+            bgq_opengl::RenderParams &sample = batch[i];
+
+            if (joint_angles.given) {
+                const float* angles = joint_angles.row(i);
+                for (int joint = 0; joint < NUM_OF_JOINTS; joint++)
+                    sample.joint_angles.push_back(glm::vec3(angles[joint * 3], angles[joint * 3 + 1], angles[joint * 3 + 2]));
+            }
+
+            if (arm_position.given)
+                sample.arm_position = glm::make_vec3(arm_position.row(i));
+            if (arm_rotation.given)
+                sample.arm_rotation = glm::make_vec3(arm_rotation.row(i));
+            if (skin_tone.given)
+                sample.skin_tone = *skin_tone.row(i);
+            if (shininess.given)
+                sample.shininess = *shininess.row(i);
+            if (background.given)
+                sample.background = (int) *background.row(i);
+
+            // The light is replaced as a whole, keeping whatever is left out.
+            if (light_position.given || light_color.given || light_power.given) {
+                glm::vec3 position = light_position.given ? glm::make_vec3(light_position.row(i)) : sample.light.getPosition();
+                glm::vec4 color = light_color.given ? glm::make_vec4(light_color.row(i)) : sample.light.getColor();
+                float power = light_power.given ? *light_power.row(i) : sample.light.getPower();
+                sample.light = bgq_opengl::Light(position, color, power);
+            }
+
+        }
+
+        return batch;
+
+    }
+
+}  // namespace
+
+PYBIND11_MODULE(handy_variations, module) {
+
+    module.doc() = "Renders HandyVariations samples from their parameters, in process.";
+
+    module.attr("NUM_OF_JOINTS") = NUM_OF_JOINTS;
+    module.attr("NUM_OF_KEYPOINTS") = NUM_OF_KEYPOINTS;
+
+    py::class_<bgq_opengl::Generator>(module, "Generator")
+        .def(py::init<int, int, int, const std::string&, const std::string&>(),
+             py::arg("width") = 224, py::arg("height") = 224, py::arg("max_batch_size") = 64,
+             py::arg("resources_dir") = ".", py::arg("backgrounds_path") = "")
+        .def("render", [](py::object self, const py::dict &params) {
+
+            bgq_opengl::Generator &generator = self.cast<bgq_opengl::Generator&>();
+
+            std::vector<bgq_opengl::RenderParams> batch = getBatch(params);
+            if ((int) batch.size() > generator.getMaxBatchSize())
+                throw std::invalid_argument("The batch is larger than max_batch_size.");
+
+            generator.render(batch);
+
+            // Hand out the buffers of the generator as they are. They never
+            // move, so the arrays keep the generator alive and stay valid,
+            // but the next batch overwrites them.
+            py::ssize_t n = (py::ssize_t) batch.size();
+            py::array_t<uint8_t> images({n, (py::ssize_t) generator.getHeight(), (py::ssize_t) generator.getWidth(), (py::ssize_t) 3},
+                                        generator.getImages().data(), self);
+            py::array_t<float> keypoints({n, (py::ssize_t) NUM_OF_KEYPOINTS, (py::ssize_t) 3},
+                                         generator.getKeypoints().data(), self);
+
+            return py::make_tuple(images, keypoints);
+
+        }, py::arg("params"))
+        .def_property_readonly("width", &bgq_opengl::Generator::getWidth)
+        .def_property_readonly("height", &bgq_opengl::Generator::getHeight)
+        .def_property_readonly("max_batch_size", &bgq_opengl::Generator::getMaxBatchSize);
+
+}
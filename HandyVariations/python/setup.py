@@ -0,0 +1,85 @@
+##############################################################################
+#                                                                            #
+# Copyright (c) Borja García Quiroga, All Rights Reserved.                   #
+#                                                                            #
+# The information and material provided below was developed as partial      #
+# requirements for the MSc in Computer Science at Trinity College Dublin,    #
+# Ireland.                                                                   #
+#                                                                            #
+##############################################################################
+
+'''
+Builds the generator as a Python module, to render samples from their
+parameters without running the application. It needs pybind11, GLEW, GLFW,
+assimp and glm. If they are not where the compiler looks, point DEPS_PREFIX
+to them (e.g. DEPS_PREFIX=$(brew --prefix)).
+
+    pip install pybind11
+    python setup.py build_ext --inplace
+
+The generator loads hand.fbx, its textures and the shaders from the
+resources_dir it is given, like the application does from its working
+directory.
+
+    import numpy as np
+    import handy_variations
+
+    generator = handy_variations.Generator(224, 224, 64, resources_dir="...")
+    images, keypoints = generator.render({
+        "joint_angles": np.zeros((64, handy_variations.NUM_OF_JOINTS, 3)),
+        "arm_rotation": np.random.uniform(-30, 30, (64, 3)),
+        "background": np.full(64, -1),
+    })
+
+The arrays view the buffers of the generator, so copy them before the next
+call to render if they are kept.
+'''
+
+import os
+import sys
+from setuptools import setup
+from pybind11.setup_helpers import Pybind11Extension, build_ext
+
+HANDY_VARIATIONS = ".."
+
+# Everything the generator draws with, and nothing of the application.
+CLASSES = [
+    "background", "bone", "camera", "cubemap", "ebo", "fbo", "generator",
+    "light", "mesh", "object_rigged", "shader", "tbo", "texture", "vao",
+    "variation_sampler", "vbo", "xfb",
+]
+
+sources = ["bindings.cpp"]
+for name in CLASSES:
+    sources.append(os.path.join(HANDY_VARIATIONS, "classes", name, name + ".cpp"))
+
+include_dirs = [HANDY_VARIATIONS]
+library_dirs = []
+libraries = ["GLEW", "glfw", "assimp"]
+extra_link_args = []
+
+deps_prefix = os.environ.get("DEPS_PREFIX")
+if deps_prefix:
+    include_dirs.append(os.path.join(deps_prefix, "include"))
+    library_dirs.append(os.path.join(deps_prefix, "lib"))
+
+if sys.platform == "darwin":
+    extra_link_args += ["-framework", "OpenGL"]
+else:
+    libraries.append("GL")
+
+extension = Pybind11Extension(
+    "handy_variations",
+    sources,
+    include_dirs=include_dirs,
+    library_dirs=library_dirs,
+    libraries=libraries,
+    extra_link_args=extra_link_args,
+    cxx_std=20,
+)
+
+setup(
+    name="handy_variations",
+    ext_modules=[extension],
+    cmdclass={"build_ext": build_ext},
+)
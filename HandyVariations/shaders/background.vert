@@ -4,6 +4,7 @@ layout (location = 0) in vec3 inVertex;    // Vertex.
 
 uniform mat4 View;            // Imports the View matrix.
 uniform mat4 Projection;    // Imports the projection matrix.
+uniform mat3 cropTransform;   // Moves the coordinates into the crop of the image.
 
 out vec2 texCoords;
 
@@ -20,6 +21,9 @@ void main() {
     texCoords.x = (texCoords.x / 1.6 + 1.0) / 2.0;
     texCoords.y = (texCoords.y + 1.0) / 2.0;
     
+    // Crop the image.
+    texCoords = vec2(cropTransform * vec3(texCoords, 1.0));
+    
     // We have to make Z == W so that it's always in the back.
     gl_Position = vec4(newPosition.x, newPosition.y, newPosition.w, newPosition.w);
 
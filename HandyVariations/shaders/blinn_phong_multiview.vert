@@ -0,0 +1,124 @@
+#version 330 core
+
+layout (location = 0) in vec3 inVertex; // Vertex.
+layout (location = 1) in vec3 inNormal; // Normal (not necessarily normalized).
+layout (location = 2) in vec3 inColor;  // Color (not necessarily normalized).
+layout (location = 3) in vec2 inUV;     // UV coordinates.
+layout (location = 4) in vec3 inTang;   // The tangent vector.
+layout (location = 5) in vec3 inBitang; // The bitangent vector.
+layout (location = 6) in ivec4 inBoneId;// The bone IDs.
+layout (location = 7) in vec4 inWeights;// The bone weights.
+
+const int MAX_BONES = 100;
+const int MAX_BONE_INFLUENCE = 4;
+
+// Everything that changes between samples is read from the instance data,
+// which has been added in world space: the model and normal matrices, the
+// light, the skin tone and shininess, the tile of the first view and the bone
+// palette. The geometry shader moves it into each of the views.
+const int INSTANCE_HEADER_TEXELS = 12;
+uniform samplerBuffer instanceData;     // The data of every instance.
+uniform int instanceStride;             // The amount of texels of each instance.
+
+out vec3 worldPosition;                 // Passes the skinned vertex to the geometry shader.
+out vec3 worldNormal;                   // Passes the normal to the geometry shader.
+out vec3 worldColor;                    // Passes the color to the geometry shader.
+out vec2 worldUV;                       // Passes the UV coordinates to the geometry shader.
+out vec3 worldTangent;                  // The vertex tangent.
+out vec3 worldBitangent;                // The vertex bitangent.
+flat out vec4 worldLightColor;          // Passes the light color to the geometry shader.
+flat out vec4 worldLight;               // Passes the light position and power to the geometry shader.
+flat out vec2 worldMaterial;            // Passes the skin tone and shininess to the geometry shader.
+flat out vec4 worldTile;                // Passes the tile of the first view to the geometry shader.
+
+// Read a matrix from the instance data.
+mat4 fetchMatrix(int texel) {
+
+    int base = gl_InstanceID * instanceStride + texel;
+    return mat4(texelFetch(instanceData, base), texelFetch(instanceData, base + 1),
+                texelFetch(instanceData, base + 2), texelFetch(instanceData, base + 3));
+
+}
+
+void main() {
+
+    // Init the value of the variables to 0 to add the right values to them.
+    vec4 interpolPosition = vec4(0.0, 0.0, 0.0, 0.0);
+    vec3 interpolNormal = vec3(0.0, 0.0, 0.0);
+    vec3 interpolTangent = vec3(0.0, 0.0, 0.0);
+    vec3 interpolBitangent = vec3(0.0, 0.0, 0.0);
+
+    // Init the total sums of weights to normalise them at the end.
+    float accumWeight = 0.0;
+
+    // Iterate through the influencing bones.
+    for(int i = 0; i < MAX_BONE_INFLUENCE; i++) {
+
+        // If this bone is -1, it is not initialised. Don't use it.
+        if(inBoneId[i] <= -1)
+            continue;
+
+        // Check that this bone is in the usable range.
+        if(inBoneId[i] >= MAX_BONES)
+            continue;
+
+        // Apply the bone transforms to obtain the component points.
+        mat4 bone = fetchMatrix(INSTANCE_HEADER_TEXELS + inBoneId[i] * 4);
+        vec4 partialPosition = bone * vec4(inVertex, 1.0);
+        vec3 partialNormal = mat3(bone) * inNormal;
+        vec3 partialTangent = mat3(bone) * inTang;
+        vec3 partialBitangent = mat3(bone) * inBitang;
+
+        // Add a pondered version of this point.
+        interpolPosition += partialPosition * inWeights[i];
+        interpolNormal += partialNormal * inWeights[i];
+        interpolTangent += partialTangent * inWeights[i];
+        interpolBitangent += partialBitangent * inWeights[i];
+
+        // Add this weight to the weight accumulator to normalise the
+        // pondered intermediate point.
+        accumWeight += inWeights[i];
+
+    }
+
+    // If the accum weight is 0, we understand that no bones have been
+    // applied.
+    if (accumWeight == 0.0) {
+
+        // Set the original point as the final point.
+        interpolPosition = vec4(inVertex, 1.0);
+        interpolNormal = inNormal;
+        interpolTangent = inTang;
+        interpolBitangent = inBitang;
+
+    } else {
+
+        // Normalise the boneVertex;
+        interpolPosition /= accumWeight;
+        interpolNormal /= accumWeight;
+        interpolTangent /= accumWeight;
+        interpolBitangent /= accumWeight;
+
+    }
+
+    // Get the parameters of this sample.
+    int base = gl_InstanceID * instanceStride;
+    mat4 instanceModel = fetchMatrix(0);
+    mat4 instanceNormalMatrix = fetchMatrix(4);
+    worldLightColor = texelFetch(instanceData, base + 8);
+    worldLight = texelFetch(instanceData, base + 9);
+    worldMaterial = texelFetch(instanceData, base + 10).xy;
+    worldTile = texelFetch(instanceData, base + 11);
+
+    // Assigns the direct passes.
+    worldPosition = vec3(instanceModel * interpolPosition);
+    worldColor = inColor;
+    worldUV = mat2(0.0, -1.0, 1.0, 0.0) * inUV;
+    worldNormal = vec3(instanceNormalMatrix * vec4(interpolNormal, 0.0));
+    worldTangent = vec3(instanceNormalMatrix * vec4(interpolTangent, 0.0));
+    worldBitangent = vec3(instanceNormalMatrix * vec4(interpolBitangent, 0.0));
+
+    // The views are applied in the geometry shader.
+    gl_Position = vec4(worldPosition, 1.0);
+
+}
@@ -6,13 +6,13 @@ in vec3 vertexColor;            // Color from the VS.
 in vec2 vertexUV;               // UV coordinates from the VS.
 in vec3 vertexTangent;          // The vertex tangent.
 in vec3 vertexBitangent;        // The vertex bitangent.
+flat in vec4 instanceLightColor;    // Light color.
+flat in vec4 instanceLight;     // Light position and power.
+flat in vec2 instanceMaterial;  // The skin tone modifier and shininess.
+flat in vec4 instanceTile;      // The tile of the instance.
 
-uniform vec4 lightColor;        // Light color.
-uniform vec3 lightPos;          // Light position.
 uniform vec3 cameraPosition;    // Position of the camera.
-uniform float skinTone;         // The skin tone modifier.
-uniform float lightPower;       // Light power.
-uniform float shininess;        // Object shininess.
+uniform bool instanced;         // Whether the instance data is used.
 
 uniform sampler2D baseColor;    // The base color texture.
 uniform sampler2D normalMap;    // The normal map.
@@ -25,6 +25,17 @@ out vec4 outColor; // Outputs color in RGBA.
 
 void main() {
     
+    // The sample parameters, either from the uniforms or the instance data.
+    vec4 lightColor = instanceLightColor;
+    vec3 lightPos = instanceLight.xyz;
+    float lightPower = instanceLight.w;
+    float skinTone = instanceMaterial.x;
+    float shininess = instanceMaterial.y;
+    
+    // Nothing of an instance can be drawn outside of its tile.
+    if (instanced && (any(lessThan(gl_FragCoord.xy, instanceTile.xy)) || any(greaterThanEqual(gl_FragCoord.xy, instanceTile.zw))))
+        discard;
+    
     // Get the normal ready to use.
     vec3 normal = normalize(vertexNormal);
     vec3 tangent = normalize(vertexTangent);
@@ -15,17 +15,54 @@ uniform mat4 Projection;                // Imports the projection matrix.
 uniform mat4 modelView;                 // Imports the modelView already multiplied.
 uniform mat4 normalMatrix;              // Imports the normal matrix.
 uniform vec3 cameraPosition;            // Position of the camera.
+uniform vec4 lightColor;                // Light color.
+uniform vec3 lightPos;                  // Light position.
+uniform float lightPower;               // Light power.
+uniform float skinTone;                 // The skin tone modifier.
+uniform float shininess;                // Object shininess.
 
 const int MAX_BONES = 100;
 const int MAX_BONE_INFLUENCE = 4;
 uniform mat4 boneMatrices[MAX_BONES];
 
+// When instanced, everything that changes between samples is read from the
+// instance data instead: the modelView and normal matrices, the light, the
+// skin tone and shininess, the tile and the bone palette.
+const int INSTANCE_HEADER_TEXELS = 12;
+uniform bool instanced;                 // Whether the instance data is used.
+uniform samplerBuffer instanceData;     // The data of every instance.
+uniform int instanceStride;             // The amount of texels of each instance.
+uniform vec2 framebufferSize;           // The size of the whole framebuffer.
+
 out vec3 vertexPosition;                // Passes the current vertex to the fragment shader.
 out vec3 vertexNormal;                  // Passes the normal to the fragment shader.
 out vec3 vertexColor;                   // Passes the color to the fragment shader.
 out vec2 vertexUV;                      // Passes the UV coordinates to the fragment shader.
 out vec3 vertexTangent;                 // The vertex tangent.
 out vec3 vertexBitangent;               // The vertex bitangent.
+flat out vec4 instanceLightColor;       // Passes the light color to the fragment shader.
+flat out vec4 instanceLight;            // Passes the light position and power to the fragment shader.
+flat out vec2 instanceMaterial;         // Passes the skin tone and shininess to the fragment shader.
+flat out vec4 instanceTile;             // Passes the tile of the instance to the fragment shader.
+
+// Read a matrix from the instance data.
+mat4 fetchMatrix(int texel) {
+    
+    int base = gl_InstanceID * instanceStride + texel;
+    return mat4(texelFetch(instanceData, base), texelFetch(instanceData, base + 1),
+                texelFetch(instanceData, base + 2), texelFetch(instanceData, base + 3));
+    
+}
+
+// Get the transform of a bone.
+mat4 boneMatrix(int boneId) {
+    
+    if (instanced)
+        return fetchMatrix(INSTANCE_HEADER_TEXELS + boneId * 4);
+    
+    return boneMatrices[boneId];
+    
+}
 
 void main() {
     
@@ -50,10 +87,11 @@ void main() {
             continue;
         
         // Apply the bone transforms to obtain the component points.
-        vec4 partialPosition = boneMatrices[inBoneId[i]] * vec4(inVertex, 1.0);
-        vec3 partialNormal = mat3(boneMatrices[inBoneId[i]]) * inNormal;
-        vec3 partialTangent = mat3(boneMatrices[inBoneId[i]]) * inTang;
-        vec3 partialBitangent = mat3(boneMatrices[inBoneId[i]]) * inBitang;
+        mat4 bone = boneMatrix(inBoneId[i]);
+        vec4 partialPosition = bone * vec4(inVertex, 1.0);
+        vec3 partialNormal = mat3(bone) * inNormal;
+        vec3 partialTangent = mat3(bone) * inTang;
+        vec3 partialBitangent = mat3(bone) * inBitang;
 
         // Add a pondered version of this point.
         interpolPosition += partialPosition * inWeights[i];
@@ -87,15 +125,45 @@ void main() {
 
     }
 
+    // Get the parameters of this sample.
+    mat4 instanceModelView = modelView;
+    mat4 instanceNormalMatrix = normalMatrix;
+    instanceLightColor = lightColor;
+    instanceLight = vec4(lightPos, lightPower);
+    instanceMaterial = vec2(skinTone, shininess);
+    instanceTile = vec4(0.0, 0.0, framebufferSize);
+    
+    if (instanced) {
+        
+        int base = gl_InstanceID * instanceStride;
+        instanceModelView = fetchMatrix(0);
+        instanceNormalMatrix = fetchMatrix(4);
+        instanceLightColor = texelFetch(instanceData, base + 8);
+        instanceLight = texelFetch(instanceData, base + 9);
+        instanceMaterial = texelFetch(instanceData, base + 10).xy;
+        instanceTile = texelFetch(instanceData, base + 11);
+        
+    }
+    
     // Assigns the direct passes.
-    vertexPosition = vec3(modelView * interpolPosition);
+    vertexPosition = vec3(instanceModelView * interpolPosition);
     vertexColor = inColor;
     vertexUV = mat2(0.0, -1.0, 1.0, 0.0) * inUV;
-    vertexNormal = vec3(normalMatrix * vec4(interpolNormal, 0.0));
-    vertexTangent = vec3(normalMatrix * vec4(interpolTangent, 0.0));
-    vertexBitangent = vec3(normalMatrix * vec4(interpolBitangent, 0.0));
+    vertexNormal = vec3(instanceNormalMatrix * vec4(interpolNormal, 0.0));
+    vertexTangent = vec3(instanceNormalMatrix * vec4(interpolTangent, 0.0));
+    vertexBitangent = vec3(instanceNormalMatrix * vec4(interpolBitangent, 0.0));
     
     // Sets the visualized position by applying the camera matrix.
     gl_Position = Projection * vec4(vertexPosition, 1.0);
     
+    // Squeeze the whole view into the tile of the instance, which is the
+    // same as drawing it with the viewport set to the tile.
+    if (instanced) {
+        
+        vec2 tileScale = (instanceTile.zw - instanceTile.xy) / framebufferSize;
+        vec2 tileOffset = (instanceTile.xy + instanceTile.zw) / framebufferSize - 1.0;
+        gl_Position.xy = gl_Position.xy * tileScale + tileOffset * gl_Position.w;
+        
+    }
+    
 }
@@ -0,0 +1,51 @@
+#version 330 core
+
+// The vertices have already been skinned, so there are no bones.
+layout (location = 0) in vec3 inVertex; // Skinned vertex.
+layout (location = 1) in vec3 inNormal; // Skinned normal (not necessarily normalized).
+layout (location = 2) in vec3 inColor;  // Color (not necessarily normalized).
+layout (location = 3) in vec2 inUV;     // UV coordinates.
+layout (location = 4) in vec3 inTang;   // The skinned tangent vector.
+layout (location = 5) in vec3 inBitang; // The skinned bitangent vector.
+
+uniform mat4 Projection;                // Imports the projection matrix.
+uniform mat4 modelView;                 // Imports the modelView already multiplied.
+uniform mat4 normalMatrix;              // Imports the normal matrix.
+uniform vec4 lightColor;                // Light color.
+uniform vec3 lightPos;                  // Light position.
+uniform float lightPower;               // Light power.
+uniform float skinTone;                 // The skin tone modifier.
+uniform float shininess;                // Object shininess.
+uniform vec2 framebufferSize;           // The size of the whole framebuffer.
+
+out vec3 vertexPosition;                // Passes the current vertex to the fragment shader.
+out vec3 vertexNormal;                  // Passes the normal to the fragment shader.
+out vec3 vertexColor;                   // Passes the color to the fragment shader.
+out vec2 vertexUV;                      // Passes the UV coordinates to the fragment shader.
+out vec3 vertexTangent;                 // The vertex tangent.
+out vec3 vertexBitangent;               // The vertex bitangent.
+flat out vec4 instanceLightColor;       // Passes the light color to the fragment shader.
+flat out vec4 instanceLight;            // Passes the light position and power to the fragment shader.
+flat out vec2 instanceMaterial;         // Passes the skin tone and shininess to the fragment shader.
+flat out vec4 instanceTile;             // Passes the tile to the fragment shader.
+
+void main() {
+    
+    // Get the parameters of this sample.
+    instanceLightColor = lightColor;
+    instanceLight = vec4(lightPos, lightPower);
+    instanceMaterial = vec2(skinTone, shininess);
+    instanceTile = vec4(0.0, 0.0, framebufferSize);
+    
+    // Assigns the direct passes.
+    vertexPosition = vec3(modelView * vec4(inVertex, 1.0));
+    vertexColor = inColor;
+    vertexUV = mat2(0.0, -1.0, 1.0, 0.0) * inUV;
+    vertexNormal = vec3(normalMatrix * vec4(inNormal, 0.0));
+    vertexTangent = vec3(normalMatrix * vec4(inTang, 0.0));
+    vertexBitangent = vec3(normalMatrix * vec4(inBitang, 0.0));
+    
+    // Sets the visualized position by applying the camera matrix.
+    gl_Position = Projection * vec4(vertexPosition, 1.0);
+    
+}
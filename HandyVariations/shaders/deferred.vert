@@ -0,0 +1,14 @@
+#version 330 core
+
+out vec2 screenUV;              // Passes the position in the viewport to the fragment shader.
+
+void main() {
+    
+    // Make up a triangle that covers the whole viewport from the vertex IDs.
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    screenUV = position;
+    
+    // Set it on the near plane, the depth is written by the fragment shader.
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+    
+}
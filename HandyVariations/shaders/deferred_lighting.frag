@@ -0,0 +1,88 @@
+#version 330 core
+
+in vec2 screenUV;               // Position in the viewport from the VS.
+
+uniform mat4 inverseProjection; // Imports the inverse of the projection matrix.
+uniform vec4 lightColor;        // Light color.
+uniform vec3 lightPos;          // Light position.
+uniform float lightPower;       // Light power.
+uniform float skinTone;         // The skin tone modifier.
+uniform float shininess;        // Object shininess.
+
+uniform sampler2D gNormal;      // The mapped normals and the coverage.
+uniform sampler2D gAlbedo;      // The base color and the specular mask.
+uniform sampler2D gDepth;       // The depth.
+
+const float minAmbLight = 0.25; // The minimum amount of light that will be used.
+const float screenGamma = 2.2;  // Gamma correction params.
+
+out vec4 outColor; // Outputs color in RGBA.
+
+void main() {
+    
+    // Leave the background where there is no hand.
+    vec4 normalCoverage = texture(gNormal, screenUV);
+    if (normalCoverage.w < 0.5)
+        discard;
+    
+    vec3 normal = normalize(normalCoverage.xyz);
+    vec4 albedo = texture(gAlbedo, screenUV);
+    
+    // Get the position in view space back from the depth.
+    float depth = texture(gDepth, screenUV).x;
+    vec4 viewPosition = inverseProjection * vec4(vec3(screenUV, depth) * 2.0 - 1.0, 1.0);
+    vec3 vertexPosition = viewPosition.xyz / viewPosition.w;
+    
+    // From here on, it is the same lighting as in blinn_phong_normal.frag.
+    
+    // Get the light direction.
+    vec3 lightDir = lightPos - vertexPosition;
+
+    // Get the distance from the light to this fragment.
+    float dist = length(lightDir);
+    dist = dist * dist;
+    
+    // Normalize the light direction as a vector.
+    lightDir = normalize(lightDir);
+
+    // Get the lambertian component as stated in the docs.
+    float lambertian = max(dot(lightDir, normal), 0.0);
+
+    // Edit the base color to modify the tone.
+    vec3 textureColor = clamp(albedo.xyz * skinTone, 0.0, 1.0);
+
+    // init the specular.
+    float specular = albedo.w;
+
+    if (lambertian > 0.0) {
+
+        // Get the direction from the position to the camera as a vector.
+        vec3 viewDir = normalize(-vertexPosition);
+
+        // Blinn-phong calculations.
+        vec3 halfAngle = normalize(lightDir + viewDir);
+        float specAngle = max(dot(halfAngle, normal), 0.0);
+        specular = pow(specAngle, shininess);
+       
+    }
+
+    // Get the minimum color.
+    vec3 ambientColor = textureColor * minAmbLight;
+
+    // Get the diffuse final color.
+    vec3 diffuseColor = textureColor * lambertian * vec3(lightColor) * lightPower / dist;
+    
+    // Get the specular final color.
+    vec3 specularColor = textureColor * specular * vec3(lightColor) * lightPower / dist;
+
+    // Get the final color that would go in the fragment.
+    vec3 fragmentColor = ambientColor + diffuseColor + specularColor;
+    
+    // Apply gamma correction.
+    fragmentColor = pow(fragmentColor, vec3(1.0 / screenGamma));
+
+    // Final color, at the depth the hand was rasterised at.
+    outColor = vec4(fragmentColor, 1.0);
+    gl_FragDepth = depth;
+    
+}
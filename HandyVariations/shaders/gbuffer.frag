@@ -0,0 +1,38 @@
+#version 330 core
+
+in vec3 vertexPosition;         // Position from the VS.
+in vec3 vertexNormal;           // Normal from the VS.
+in vec2 vertexUV;               // UV coordinates from the VS.
+in vec3 vertexTangent;          // The vertex tangent.
+in vec3 vertexBitangent;        // The vertex bitangent.
+
+uniform sampler2D baseColor;    // The base color texture.
+uniform sampler2D normalMap;    // The normal map.
+uniform sampler2D specularMap;  // The specular map.
+
+// Nothing that depends on the light, the skin tone or the shininess is
+// computed here, so that the same pixels can be lit many times.
+layout (location = 0) out vec4 outNormal;   // The mapped normal and the coverage.
+layout (location = 1) out vec4 outAlbedo;   // The base color and the specular mask.
+
+void main() {
+    
+    // Get the normal ready to use.
+    vec3 normal = normalize(vertexNormal);
+    vec3 tangent = normalize(vertexTangent);
+    vec3 bitangent = normalize(vertexBitangent);
+    
+    // Get the matrix to convert stuff to tangent space.
+    mat3 toTangentSpace = mat3(tangent, bitangent, normal);
+    
+    // Get the normal from the normal map and transform it.
+    vec4 mappedNormal = texture(normalMap, vertexUV);
+    normal = normalize(toTangentSpace * mappedNormal.xyz);
+    
+    // Store it, marking the pixel as covered by the hand.
+    outNormal = vec4(normal, 1.0);
+    
+    // Store the base color before the skin tone, and the specular mask.
+    outAlbedo = vec4(texture(baseColor, vertexUV).xyz, texture(specularMap, vertexUV).x);
+    
+}
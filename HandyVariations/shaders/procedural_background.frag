@@ -0,0 +1,114 @@
+#version 330 core
+
+in vec2 texCoords;
+
+uniform int seed;               // The seed of the background.
+
+const int MAX_OCTAVES = 6;      // The most octaves of noise.
+const int MAX_SHAPES = 12;      // The most random shapes.
+
+out vec4 outColor;
+
+// PCG hash of a value.
+uint hash(uint value) {
+    
+    uint state = value * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    
+    return (word >> 22u) ^ word;
+    
+}
+
+// Turn some random bits into a float in [0, 1).
+float toUnit(uint bits) {
+    
+    return float(bits >> 8u) / 16777216.0;
+    
+}
+
+// Get a random float for a parameter of this background.
+float random(uint draw) {
+    
+    return toUnit(hash(uint(seed) ^ hash(draw)));
+    
+}
+
+// Get a random float for a cell of a lattice of this background.
+float latticeValue(ivec2 cell, uint layer) {
+    
+    return toUnit(hash(uint(cell.x) * 73856093u ^ uint(cell.y) * 19349663u ^ hash(uint(seed) + layer)));
+    
+}
+
+// Smoothly interpolated value noise.
+float valueNoise(vec2 position, uint layer) {
+    
+    ivec2 cell = ivec2(floor(position));
+    vec2 offset = fract(position);
+    vec2 weight = offset * offset * (3.0 - 2.0 * offset);
+    
+    float bottom = mix(latticeValue(cell, layer), latticeValue(cell + ivec2(1, 0), layer), weight.x);
+    float top = mix(latticeValue(cell + ivec2(0, 1), layer), latticeValue(cell + ivec2(1, 1), layer), weight.x);
+    
+    return mix(bottom, top, weight.y);
+    
+}
+
+void main() {
+    
+    // Start with a gradient between two colours in a random direction.
+    vec3 colorA = vec3(random(0u), random(1u), random(2u));
+    vec3 colorB = vec3(random(3u), random(4u), random(5u));
+    float angle = random(6u) * 6.2831853;
+    float along = dot(texCoords - 0.5, vec2(cos(angle), sin(angle))) + 0.5;
+    vec3 color = mix(colorA, colorB, clamp(along, 0.0, 1.0));
+    
+    // Add some octaves of noise in another colour.
+    int octaves = 1 + int(random(7u) * float(MAX_OCTAVES));
+    float frequency = 2.0 + random(8u) * 14.0;
+    float amplitude = 0.5;
+    float noise = 0.0;
+    float total = 0.0;
+    
+    for (int i = 0; i < MAX_OCTAVES; i++) {
+        
+        if (i >= octaves)
+            break;
+        
+        noise += amplitude * valueNoise(texCoords * frequency, uint(i));
+        total += amplitude;
+        amplitude *= 0.5;
+        frequency *= 2.0;
+        
+    }
+    
+    vec3 noiseColor = vec3(random(9u), random(10u), random(11u));
+    color = mix(color, noiseColor, noise / total * random(12u));
+    
+    // Draw some ellipses and rectangles on top.
+    int shapes = int(random(13u) * float(MAX_SHAPES + 1));
+    
+    for (int i = 0; i < MAX_SHAPES; i++) {
+        
+        if (i >= shapes)
+            break;
+        
+        uint base = 100u + uint(i) * 8u;
+        vec2 center = vec2(random(base), random(base + 1u));
+        vec2 size = vec2(0.03, 0.03) + 0.25 * vec2(random(base + 2u), random(base + 3u));
+        vec3 shapeColor = vec3(random(base + 4u), random(base + 5u), random(base + 6u));
+        
+        vec2 scaledOffset = abs(texCoords - center) / size;
+        float inside = (random(base + 7u) < 0.5) ? step(length(scaledOffset), 1.0) : step(max(scaledOffset.x, scaledOffset.y), 1.0);
+        color = mix(color, shapeColor, inside);
+        
+    }
+    
+    // Finish with some clutter of small cells of random colours.
+    ivec2 cell = ivec2(floor(texCoords * (20.0 + 60.0 * random(14u))));
+    vec3 cellColor = vec3(latticeValue(cell, 50u), latticeValue(cell, 51u), latticeValue(cell, 52u));
+    color = mix(color, cellColor, random(15u) * 0.3);
+    
+    outColor = vec4(color, 1.0);
+    
+}
@@ -0,0 +1,90 @@
+#version 330 core
+
+in vec2 screenUV;               // Position in the viewport from the VS.
+
+uniform sampler2D image;        // The render, copied out of the framebuffer.
+uniform vec2 imageSize;         // The size of the render in pixels.
+uniform float distortion;       // The radial distortion at the corners, negative for pincushion.
+uniform float aberration;       // The difference of magnification of red and blue.
+uniform float vignetting;       // The light lost at the corners.
+uniform float blur;             // The radius of the blur in pixels.
+uniform float noise;            // The standard deviation of the noise.
+uniform int seed;               // The seed of the noise.
+
+out vec4 outColor;
+
+// PCG hash of a value.
+uint hash(uint value) {
+    
+    uint state = value * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    
+    return (word >> 22u) ^ word;
+    
+}
+
+// Turn some random bits into a float in (0, 1].
+float toUnit(uint bits) {
+    
+    return (float(bits >> 8u) + 1.0) / 16777216.0;
+    
+}
+
+// Sample a channel through the lens, black outside the render.
+float sampleChannel(vec2 position, int channel) {
+    
+    if (any(lessThan(position, vec2(0.0))) || any(greaterThan(position, imageSize)))
+        return 0.0;
+    
+    return texture(image, position / imageSize)[channel];
+    
+}
+
+// Sample the render through the lens, from a point relative to its centre
+// in pixels. The radius is 1 at the corners.
+vec3 sampleLens(vec2 offset) {
+    
+    vec2 center = imageSize * 0.5;
+    float radius2 = dot(offset, offset) / dot(center, center);
+    vec2 distorted = offset * (1.0 + distortion * radius2);
+    
+    // Red and blue are magnified a bit differently than green.
+    return vec3(sampleChannel(center + distorted * (1.0 + aberration), 0),
+                sampleChannel(center + distorted, 1),
+                sampleChannel(center + distorted * (1.0 - aberration), 2));
+    
+}
+
+void main() {
+    
+    vec2 offset = screenUV * imageSize - imageSize * 0.5;
+    
+    // Soften the image like a cheap lens or a strong compression would.
+    vec3 color = sampleLens(offset);
+    if (blur > 0.0) {
+        color += sampleLens(offset + vec2(blur, blur));
+        color += sampleLens(offset + vec2(-blur, blur));
+        color += sampleLens(offset + vec2(blur, -blur));
+        color += sampleLens(offset + vec2(-blur, -blur));
+        color /= 5.0;
+    }
+    
+    // Darken the corners.
+    float radius2 = dot(offset, offset) / dot(imageSize * 0.5, imageSize * 0.5);
+    color *= 1.0 - vignetting * radius2;
+    
+    // Add the noise of the sensor, a Gaussian per channel from the pixel and
+    // the seed.
+    if (noise > 0.0) {
+        uvec2 pixel = uvec2(screenUV * imageSize);
+        uint base = hash(uint(seed) ^ hash(pixel.x * 73856093u ^ pixel.y * 19349663u));
+        for (int c = 0; c < 3; c++) {
+            float u1 = toUnit(hash(base + uint(2 * c)));
+            float u2 = toUnit(hash(base + uint(2 * c + 1)));
+            color[c] += noise * sqrt(-2.0 * log(u1)) * cos(6.28318530718 * u2);
+        }
+    }
+    
+    outColor = vec4(clamp(color, 0.0, 1.0), 1.0);
+    
+}
@@ -0,0 +1,96 @@
+#version 330 core
+
+layout (location = 0) in vec3 inVertex; // Vertex.
+layout (location = 1) in vec3 inNormal; // Normal (not necessarily normalized).
+layout (location = 2) in vec3 inColor;  // Color (not necessarily normalized).
+layout (location = 3) in vec2 inUV;     // UV coordinates.
+layout (location = 4) in vec3 inTang;   // The tangent vector.
+layout (location = 5) in vec3 inBitang; // The bitangent vector.
+layout (location = 6) in ivec4 inBoneId;// The bone IDs.
+layout (location = 7) in vec4 inWeights;// The bone weights.
+
+const int MAX_BONES = 100;
+const int MAX_BONE_INFLUENCE = 4;
+uniform mat4 boneMatrices[MAX_BONES];
+
+// Every output is captured with transform feedback, in this order, so the
+// skinned vertices can be drawn again without the bones.
+out vec3 skinnedPosition;               // The skinned vertex.
+out vec3 skinnedNormal;                 // The skinned normal.
+out vec3 skinnedColor;                  // The color, as it was.
+out vec2 skinnedUV;                     // The UV coordinates, as they were.
+out vec3 skinnedTangent;                // The skinned tangent.
+out vec3 skinnedBitangent;              // The skinned bitangent.
+
+void main() {
+    
+    // Init the value of the variables to 0 to add the right values to them.
+    vec4 interpolPosition = vec4(0.0, 0.0, 0.0, 0.0);
+    vec3 interpolNormal = vec3(0.0, 0.0, 0.0);
+    vec3 interpolTangent = vec3(0.0, 0.0, 0.0);
+    vec3 interpolBitangent = vec3(0.0, 0.0, 0.0);
+
+    // Init the total sums of weights to normalise them at the end.
+    float accumWeight = 0.0;
+    
+    // Iterate through the influencing bones.
+    for(int i = 0; i < MAX_BONE_INFLUENCE; i++) {
+        
+        // If this bone is -1, it is not initialised. Don't use it.
+        if(inBoneId[i] <= -1)
+            continue;
+        
+        // Check that this bone is in the usable range.
+        if(inBoneId[i] >= MAX_BONES)
+            continue;
+        
+        // Apply the bone transforms to obtain the component points.
+        mat4 bone = boneMatrices[inBoneId[i]];
+        vec4 partialPosition = bone * vec4(inVertex, 1.0);
+        vec3 partialNormal = mat3(bone) * inNormal;
+        vec3 partialTangent = mat3(bone) * inTang;
+        vec3 partialBitangent = mat3(bone) * inBitang;
+
+        // Add a pondered version of this point.
+        interpolPosition += partialPosition * inWeights[i];
+        interpolNormal += partialNormal * inWeights[i];
+        interpolTangent += partialTangent * inWeights[i];
+        interpolBitangent += partialBitangent * inWeights[i];
+
+        // Add this weight to the weight accumulator to normalise the
+        // pondered intermediate point.
+        accumWeight += inWeights[i];
+        
+    }
+    
+    // If the accum weight is 0, we understand that no bones have been
+    // applied.
+    if (accumWeight == 0.0) {
+        
+        // Set the original point as the final point.
+        interpolPosition = vec4(inVertex, 1.0);
+        interpolNormal = inNormal;
+        interpolTangent = inTang;
+        interpolBitangent = inBitang;
+
+    } else {
+        
+        // Normalise the boneVertex;
+        interpolPosition /= accumWeight;
+        interpolNormal /= accumWeight;
+        interpolTangent /= accumWeight;
+        interpolBitangent /= accumWeight;
+
+    }
+    
+    // Keep the skinned vertex.
+    skinnedPosition = vec3(interpolPosition);
+    skinnedNormal = interpolNormal;
+    skinnedColor = inColor;
+    skinnedUV = inUV;
+    skinnedTangent = interpolTangent;
+    skinnedBitangent = interpolBitangent;
+    
+    gl_Position = interpolPosition;
+    
+}
@@ -0,0 +1,44 @@
+/**
+ * @file augmentation.h
+ * @brief Augmentation struct header file.
+ * @version 1.0.0 (2024-03-24)
+ * @date 2024-03-24
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_STRUCT_AUGMENTATION_H_
+#define BGQ_OPENGL_STRUCT_AUGMENTATION_H_
+
+#include <cstdint>
+
+namespace bgq_opengl {
+
+	/**
+	 * @brief The augmentation of a sample.
+	 *
+	 * This Struct holds how the image of a sample is changed after it has
+	 * been read back. The geometric part moves the keypoints too.
+	 */
+	struct Augmentation {
+		float scale = 1.0f;					/// The zoom, around the centre of the image.
+		float rotation = 0.0f;				/// The rotation around the centre of the image, in degrees.
+		float offset_x = 0.0f;				/// The horizontal translation, as a fraction of the width.
+		float offset_y = 0.0f;				/// The vertical translation, as a fraction of the height.
+		float brightness = 1.0f;			/// The factor of the brightness.
+		float contrast = 1.0f;				/// The factor of the contrast, around mid grey.
+		float saturation = 1.0f;			/// The factor of the saturation, 0 for grey.
+		float blur = 0.0f;					/// The standard deviation of the blur in pixels, 0 for none.
+		float noise = 0.0f;					/// The standard deviation of the noise in levels, 0 for none.
+		uint32_t noise_offset = 0;			/// Where the noise of the sample starts in the noise table.
+	};
+
+} // namespace bgq_opengl
+
+#endif //!BGQ_OPENGL_STRUCT_AUGMENTATION_H_
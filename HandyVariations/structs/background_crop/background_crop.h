@@ -0,0 +1,39 @@
+/**
+ * @file background_crop.h
+ * @brief Background crop struct header file.
+ * @version 1.0.0 (2024-03-22)
+ * @date 2024-03-22
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_STRUCT_BACKGROUND_CROP_H_
+#define BGQ_OPENGL_STRUCT_BACKGROUND_CROP_H_
+
+namespace bgq_opengl {
+
+	/**
+	 * @brief The crop of a background image.
+	 *
+	 * This Struct holds which background image a sample is composited over
+	 * and which part of it is used. The crop keeps the aspect ratio of the
+	 * sample and, at a scale of 1, is the largest one that fits the image.
+	 */
+	struct BackgroundCrop {
+		int image = 0;				/// The id of the background image.
+		float scale = 1.0f;			/// How much the crop is zoomed in, 1 or more.
+		float offset_x = 0.5f;		/// Where the crop is in the horizontal room left, from 0 to 1.
+		float offset_y = 0.5f;		/// Where the crop is in the vertical room left, from 0 to 1.
+		bool flip = false;			/// Whether the crop is mirrored horizontally.
+		float rotation = 0.0f;		/// The rotation of the crop in degrees, only used by the mosaic.
+	};
+
+} // namespace bgq_opengl
+
+#endif //!BGQ_OPENGL_STRUCT_BACKGROUND_CROP_H_
@@ -0,0 +1,36 @@
+/**
+ * @file batch_sample.h
+ * @brief Batch sample struct header file.
+ * @version 1.0.0 (2024-03-18)
+ * @date 2024-03-18
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_STRUCT_BATCH_SAMPLE_H_
+#define BGQ_OPENGL_STRUCT_BATCH_SAMPLE_H_
+
+#include <vector>
+
+namespace bgq_opengl {
+
+	/**
+	 * @brief A sample of a batch.
+	 *
+	 * This Struct holds what is needed to write the image of a sample once
+	 * the tile it was rendered into has been read back.
+	 */
+	struct BatchSample {
+		int frame_id = 0;					/// The id of the sample.
+		std::vector<float> annotations;		/// The keypoints of the sample, in pixels of its tile.
+	};
+
+} // namespace bgq_opengl
+
+#endif //!BGQ_OPENGL_STRUCT_BATCH_SAMPLE_H_
@@ -0,0 +1,42 @@
+/**
+ * @file codec_benchmark.h
+ * @brief Codec benchmark struct header file.
+ * @version 1.0.0 (2024-03-17)
+ * @date 2024-03-17
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_STRUCT_CODEC_BENCHMARK_H_
+#define BGQ_OPENGL_STRUCT_CODEC_BENCHMARK_H_
+
+#include <cstdint>
+#include <string>
+
+namespace bgq_opengl {
+
+	/**
+	 * @brief The results of a codec in the benchmark.
+	 *
+	 * This Struct holds the settings of one of the encoders being compared
+	 * and the totals measured for it over the frames of the benchmark.
+	 */
+	struct CodecBenchmark {
+		std::string name;				/// The name shown in the report.
+		int codec = 0;					/// The codec.
+		int png_compression_level = 8;	/// The zlib level, for png.
+		int png_filter = -1;			/// The forced filter, for png.
+		double seconds = 0.0;			/// The total time spent encoding.
+		uint64_t raw_bytes = 0;			/// The total size of the pixels.
+		uint64_t encoded_bytes = 0;		/// The total size of the encoded images.
+	};
+
+} // namespace bgq_opengl
+
+#endif //!BGQ_OPENGL_STRUCT_CODEC_BENCHMARK_H_
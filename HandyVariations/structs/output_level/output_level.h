@@ -0,0 +1,47 @@
+/**
+ * @file output_level.h
+ * @brief Output level struct header file.
+ * @version 1.0.0 (2024-03-24)
+ * @date 2024-03-24
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_STRUCT_OUTPUT_LEVEL_H_
+#define BGQ_OPENGL_STRUCT_OUTPUT_LEVEL_H_
+
+#include <string>
+
+#include "classes/annotation_store/annotation_store.h"
+#include "classes/resampler/resampler.h"
+#include "classes/shard_writer/shard_writer.h"
+#include "classes/tensor_shard_writer/tensor_shard_writer.h"
+
+namespace bgq_opengl {
+
+	/**
+	 * @brief A level of the output pyramid.
+	 *
+	 * This Struct holds what is needed to write a smaller copy of every
+	 * sample, resampled from the render, as a dataset of its own.
+	 */
+	struct OutputLevel {
+		int width = 0;								/// The width of the images.
+		int height = 0;								/// The height of the images.
+		std::string directory;						/// The directory the level is written to.
+		Resampler *resampler = nullptr;				/// Resamples the renders to the size of the level.
+		AnnotationStore *annotations_store = nullptr;	/// The .npy array containing the scaled annotations.
+		AnnotationStore *k_matrices_store = nullptr;	/// The .npy array containing the k_matrices.
+		ShardWriter *shard_writer = nullptr;		/// Packs the samples into shards.
+		TensorShardWriter *tensor_writer = nullptr;	/// Packs the raw images into tensor shards.
+	};
+
+} // namespace bgq_opengl
+
+#endif //!BGQ_OPENGL_STRUCT_OUTPUT_LEVEL_H_
@@ -0,0 +1,46 @@
+/**
+ * @file render_params.h
+ * @brief Render parameters struct header file.
+ * @version 1.0.0 (2024-03-24)
+ * @date 2024-03-24
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_STRUCT_RENDER_PARAMS_H_
+#define BGQ_OPENGL_STRUCT_RENDER_PARAMS_H_
+
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "classes/light/light.h"
+
+namespace bgq_opengl {
+
+	/**
+	 * @brief The parameters of a sample.
+	 *
+	 * This Struct holds the values a sample is rendered with, instead of the
+	 * indices of the variation tables they are drawn from. The defaults are
+	 * the entry 0 of every table.
+	 */
+	struct RenderParams {
+		std::vector<glm::vec3> joint_angles;	/// The euler angles of each of the joints in degrees, empty for the rest pose.
+		glm::vec3 arm_position = glm::vec3(0.0f);	/// The translation of the arm.
+		glm::vec3 arm_rotation = glm::vec3(0.0f);	/// The euler angles of the arm in degrees.
+		float skin_tone = 1.0f;					/// The skin tone multiplier.
+		float shininess = 1.0f;					/// The shininess of the skin.
+		Light light = Light(glm::vec3(5.0f, 5.0f, 5.0f), glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), 20.0f);	/// The light.
+		int background = -1;					/// The id of the background image, -1 for none.
+	};
+
+} // namespace bgq_opengl
+
+#endif //!BGQ_OPENGL_STRUCT_RENDER_PARAMS_H_
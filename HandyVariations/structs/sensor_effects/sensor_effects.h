@@ -0,0 +1,41 @@
+/**
+ * @file sensor_effects.h
+ * @brief Sensor effects struct header file.
+ * @version 1.0.0 (2024-03-24)
+ * @date 2024-03-24
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_STRUCT_SENSOR_EFFECTS_H_
+#define BGQ_OPENGL_STRUCT_SENSOR_EFFECTS_H_
+
+#include <cstdint>
+
+namespace bgq_opengl {
+
+	/**
+	 * @brief The sensor effects of a sample.
+	 *
+	 * This Struct holds the strength of each of the effects of the lens and
+	 * the sensor that are applied to a render on the GPU. A value of 0 leaves
+	 * the render as it is.
+	 */
+	struct SensorEffects {
+		float distortion = 0.0f;			/// The radial distortion at the corners, negative for pincushion.
+		float aberration = 0.0f;			/// The difference of magnification of red and blue.
+		float vignetting = 0.0f;			/// The fraction of the light lost at the corners.
+		float blur = 0.0f;					/// The radius of the blur in pixels.
+		float noise = 0.0f;					/// The standard deviation of the noise, over 1.
+		uint32_t seed = 0;					/// The seed of the noise.
+	};
+
+} // namespace bgq_opengl
+
+#endif //!BGQ_OPENGL_STRUCT_SENSOR_EFFECTS_H_
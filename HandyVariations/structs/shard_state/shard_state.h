@@ -0,0 +1,37 @@
+/**
+ * @file shard_state.h
+ * @brief Shard state struct header file.
+ * @version 1.0.0 (2024-03-14)
+ * @date 2024-03-14
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_STRUCT_SHARD_STATE_H_
+#define BGQ_OPENGL_STRUCT_SHARD_STATE_H_
+
+#include <cstdint>
+
+namespace bgq_opengl {
+
+	/**
+	 * @brief The progress of a shard writer.
+	 *
+	 * This Struct holds where a shard writer was at a checkpoint, so that it
+	 * can go on from the shard it left open.
+	 */
+	struct ShardState {
+		int32_t num_of_shards;		/// The amount of complete shards.
+		int32_t num_of_samples;		/// The amount of samples in the open shard, 0 if none is open.
+		uint64_t offset;			/// The valid size of the open shard.
+	};
+
+} // namespace bgq_opengl
+
+#endif //!BGQ_OPENGL_STRUCT_SHARD_STATE_H_
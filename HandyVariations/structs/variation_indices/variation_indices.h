@@ -0,0 +1,39 @@
+/**
+ * @file variation_indices.h
+ * @brief Variation indices struct header file.
+ * @version 1.0.0 (2024-03-02)
+ * @date 2024-03-02
+ * @author Borja García Quiroga <garcaqub@tcd.ie>
+ *
+ *
+ * Copyright (c) Borja García Quiroga, All Rights Reserved.
+ *
+ * The information and material provided below was developed as partial
+ * requirements for the MSc in Computer Science at Trinity College Dublin,
+ * Ireland.
+ */
+
+#ifndef BGQ_OPENGL_STRUCT_VARIATION_INDICES_H_
+#define BGQ_OPENGL_STRUCT_VARIATION_INDICES_H_
+
+namespace bgq_opengl {
+
+	/**
+	 * @brief The variation indices of a sample.
+	 *
+	 * This Struct holds one index per variation table. It is used both for the
+	 * entries selected for a given frame and for the size of each table.
+	 */
+	struct VariationIndices {
+		int joint_angles = 0;	/// Index into the joint angles table.
+		int arm_position = 0;	/// Index into the arm positions table.
+		int arm_rotation = 0;	/// Index into the arm rotations table.
+		int skin_tone = 0;		/// Index into the skin tones table.
+		int lighting = 0;		/// Index into the lighting table.
+		int shininess = 0;		/// Index into the shininess table.
+		int background = 0;		/// Index into the backgrounds table.
+	};
+
+} // namespace bgq_opengl
+
+#endif //!BGQ_OPENGL_STRUCT_VARIATION_INDICES_H_